@@ -0,0 +1,93 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+// persists the sections of a plain configuration struct as individual binary
+// records. each record starts with a header holding the version of the
+// section's layout, its length and a CRC32 of the payload. only sections
+// whose content differs from what was loaded or saved last are written
+// again. sections are given as offsets, as the struct is copied to publish a
+// new snapshot of the configuration.
+//
+// records are not portable: the version of a section must be bumped
+// whenever its memory layout changes. its record is rejected by load() then,
+// and the section must be imported from another source. the records of
+// the other sections remain valid.
+class ConfigStore {
+public:
+    struct Section {
+        char const* Name;
+        uint32_t Version;
+        size_t Offset;
+        size_t Size;
+    };
+
+    struct Header {
+        uint32_t Magic;
+        uint32_t Version;
+        uint32_t Length;
+        uint32_t Crc;
+    };
+
+    // a copy of a dirty section, taken while the config is locked, such
+    // that the record can be written without holding that lock.
+    struct Record {
+        size_t Index;
+        uint32_t Sequence;
+        Header Head;
+        std::vector<uint8_t> Payload;
+    };
+
+    // must read exactly sizeof(Header) and size bytes, respectively
+    using Reader = std::function<bool(char const* name, Header& header, void* data, size_t size)>;
+    using Writer = std::function<bool(char const* name, Header const& header, void const* data, size_t size)>;
+
+    static constexpr uint32_t Magic = 0x4746434F; // "OCFG"
+
+    explicit ConfigStore(std::vector<Section> sections);
+
+    // reads all sections. returns false if any record is missing or invalid,
+    // in which case the contents of the respective sections are undefined.
+    bool load(void* base, Reader const& read);
+
+    // copies the sections whose records are valid, i.e., which were read by
+    // load() or written since, from src to dst. e.g., to keep them while
+    // importing the others from another source. returns their number.
+    size_t copyLoaded(void const* src, void* dst);
+
+    // copies the sections which differ from what was persisted last
+    std::vector<Record> collect(void const* base);
+
+    // writes the records, skipping those superseded by a record collected
+    // later and committed already. returns false if any write failed.
+    bool commit(std::vector<Record> const& records, Writer const& write);
+
+    // the next collect() yields all sections
+    void invalidate();
+
+    // whether the contents of any section differ between both structs, as
+    // told by the CRC of each section.
+    bool differs(void const* lhs, void const* rhs) const;
+
+    size_t getSectionCount() const { return _sections.size(); }
+
+    static uint32_t crc32(void const* data, size_t size, uint32_t crc = 0);
+
+private:
+    struct State {
+        uint32_t Crc;
+        uint32_t Sequence; // of the last committed record
+        bool Persisted; // Crc is valid
+    };
+
+    std::vector<Section> const _sections;
+    std::vector<State> _states;
+    uint32_t _sequence = 0;
+
+    std::mutex _mutex;
+};
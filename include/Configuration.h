@@ -1,14 +1,17 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 #pragma once
 
+#include "ConfigStore.h"
 #include "PinMapping.h"
 #include <TaskSchedulerDeclarations.h>
-#include <condition_variable>
+#include <atomic>
 #include <cstdint>
 #include <ArduinoJson.h>
+#include <memory>
 #include <mutex>
 
 #define CONFIG_FILENAME "/config.json"
+#define CONFIG_STORE_DIR "/cfg"
 #define CONFIG_VERSION 0x00011e00 // 0.1.30 // make sure to clean all after change
 #define CONFIG_VERSION_ONBATTERY 8
 
@@ -279,6 +282,8 @@ struct GRID_CHARGER_CONFIG_T {
     float AutoPowerUpperPowerLimit;
     uint8_t AutoPowerStopBatterySoCThreshold;
     float AutoPowerTargetPowerConsumption;
+    float AutoPowerRampUpRate;
+    float AutoPowerRampDownRate;
     GridChargerProviderType Provider;
     GridChargerCanConfig Can;
     GridChargerHuaweiConfig Huawei;
@@ -316,11 +321,15 @@ struct SOLAR_CHARGER_CONFIG_T {
 };
 using SolarChargerConfig = struct SOLAR_CHARGER_CONFIG_T;
 
+enum MqttPublishModeType : uint8_t { PublishTopics = 0, PublishJson = 1, PublishTopicsAndJson = 2 };
+enum MqttBatchEncodingType : uint8_t { BatchJson = 0, BatchMessagePack = 1 };
+
+// when changing the layout of a section, bump its version in the
+// constructor of ConfigurationClass.
 struct CONFIG_T {
     struct {
         uint32_t Version;
         uint32_t VersionOnBattery;
-        uint32_t SaveCount;
     } Cfg;
 
     struct {
@@ -364,7 +373,11 @@ struct CONFIG_T {
         char Topic[MQTT_MAX_TOPIC_STRLEN + 1];
         bool Retain;
         uint32_t PublishInterval;
+        uint32_t CommandInterval; // milliseconds
+        uint32_t ConfigSaveDelay; // seconds
         bool CleanSession;
+        MqttPublishModeType PublishMode;
+        MqttBatchEncodingType BatchEncoding;
 
         struct {
             char Topic[MQTT_MAX_TOPIC_STRLEN + 1];
@@ -456,28 +469,78 @@ struct CONFIG_T {
 
 class ConfigurationClass {
 public:
-    void init(Scheduler& scheduler);
+    ConfigurationClass();
+
+    void init();
     bool read();
     bool write();
+
+    // the config is persisted as binary records, one per section, of which
+    // only the changed ones are written. config.json is exported from the
+    // background task after the config was saved. at boot, the sections
+    // whose records are missing or of another layout version are imported
+    // from it.
+    bool exportJson();
+
+    // exports config.json if it is outdated, e.g., before a restart
+    void flushExport();
+
+    // removes the binary records, such that config.json is imported at the
+    // next boot. neither records nor config.json are written until then.
+    void discardStore();
+
+    // saves the config from a background task once no further write was
+    // requested for delayMillis, but at the latest MaxWriteDeferralMillis
+    // after the first request. for changes applied automatically, e.g., via
+    // MQTT, which must not stall the caller or wear the flash.
+    void requestWrite(uint32_t delayMillis);
+
+    struct PersistenceStats {
+        uint32_t SavesSinceBoot;
+        uint32_t WriteRequests;
+        uint32_t Coalesced; // requests satisfied by another write
+        bool Pending;
+    };
+    PersistenceStats getPersistenceStats() const;
+
+    // number of times the config was saved, as exported to config.json
+    uint32_t getSaveCount() const { return _saveCount; }
+
+    static constexpr uint32_t MaxWriteDeferralMillis = 5 * 60 * 1000;
+    static constexpr uint32_t ExportDelayMillis = 60 * 1000;
+
+    // read(), migrate() and migrateOnBattery() modify the current snapshot
+    // in place, so they must be called before other tasks use the config.
     void migrate();
     void migrateOnBattery();
-    CONFIG_T const& get();
+
+    // the config is published as immutable snapshots. a writer modifies a
+    // copy of the current snapshot, which replaces it once the WriteGuard is
+    // destroyed. writers only wait for other writers, and readers never wait.
+    //
+    // a replaced snapshot is released as soon as the last reader drops it.
+    // hold the returned pointer for as long as any reference or pointer
+    // into the snapshot is used, e.g., strings handed to a library.
+    std::shared_ptr<CONFIG_T const> get();
 
     class WriteGuard {
     public:
-        WriteGuard();
+        explicit WriteGuard(ConfigurationClass& parent);
         CONFIG_T& getConfig();
         ~WriteGuard();
 
     private:
+        ConfigurationClass& _parent;
         std::unique_lock<std::mutex> _lock;
+        std::shared_ptr<CONFIG_T> _draft;
     };
 
     WriteGuard getWriteGuard();
 
-    INVERTER_CONFIG_T* getFreeInverterSlot();
-    INVERTER_CONFIG_T* getInverterConfig(const uint64_t serial);
-    void deleteInverterById(const uint8_t id);
+    static INVERTER_CONFIG_T* getFreeInverterSlot(CONFIG_T& config);
+    // shares ownership of the snapshot holding the inverter's config
+    std::shared_ptr<INVERTER_CONFIG_T const> getInverterConfig(const uint64_t serial);
+    static void deleteInverterById(CONFIG_T& config, const uint8_t id);
 
     int8_t getIndexForLogModule(const String& moduleName) const;
 
@@ -518,10 +581,47 @@ public:
     static void deserializeGridChargerTruckiConfig(JsonObject const& source, GridChargerTruckiConfig& target);
 
 private:
-    void loop();
     static double roundedFloat(float val);
 
-    Task _loopTask;
+    static bool serialize(CONFIG_T const& config, uint32_t saveCount, JsonDocument& doc);
+    bool writeFile(JsonDocument const& doc);
+
+    bool readStore();
+    bool writeStore(std::vector<ConfigStore::Record> const& records);
+    void countSave();
+    void writeExportMarker(uint32_t saveCount);
+    void requestExport();
+
+    void publish(std::shared_ptr<CONFIG_T> snapshot);
+
+    static void writerLoopHelper(void* context);
+    void writerLoop();
+
+    TaskHandle_t _writerTaskHandle = nullptr;
+    mutable std::mutex _writeRequestMutex;
+    bool _writePending = false;
+    uint32_t _firstRequestMillis = 0;
+    uint32_t _lastRequestMillis = 0;
+    uint32_t _writeDelayMillis = 0;
+    uint32_t _writeRequests = 0;
+    uint32_t _deferredWrites = 0;
+    uint32_t _bootSaveCount = 0;
+    bool _exportPending = false;
+    uint32_t _exportRequestMillis = 0;
+
+    // kept outside of the snapshots, such that saving does not copy the
+    // config. only changed while holding the file mutex.
+    std::atomic<uint32_t> _saveCount = 0;
+
+    // value of _saveCount when config.json was exported last
+    uint32_t _exportedSaveCount = 0;
+    bool _storeDiscarded = false; // guarded by the file mutex
+    ConfigStore _store;
+    ConfigStore _saveCounter;
+    ConfigStore _exportMarker;
+
+    // replaced by writers only, which are serialized
+    std::shared_ptr<CONFIG_T> _current;
 };
 
 extern ConfigurationClass Configuration;
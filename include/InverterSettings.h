@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 #pragma once
 
+#include "WorkerTask.h"
 #include <TaskSchedulerDeclarations.h>
 #include <cstdint>
 
@@ -16,7 +17,10 @@ private:
     void hoyLoop();
 
     Task _settingsTask;
-    Task _hoyTask;
+
+    // the radios are polled by a worker task, commands are queued and
+    // results are parsed by the thread-safe Hoymiles library
+    WorkerTask _hoyWorker;
 };
 
 extern InverterSettingsClass InverterSettings;
@@ -0,0 +1,41 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <ArduinoJson.h>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// extracts a value from a JSON payload using a path like "a/b/[1]/c". the
+// path is parsed once, and a filter is derived from it, such that only the
+// nodes along the path are kept when deserializing a payload. an empty
+// path means the payload is the plain value.
+class JsonPathExtractor {
+public:
+    JsonPathExtractor() = default;
+    explicit JsonPathExtractor(char const* path);
+
+    // client is used to prefix log messages
+    template<typename T>
+    std::optional<T> extract(char const* client, std::string_view src, char const* topic) const;
+
+    // resolves the path in a document which was already deserialized. the
+    // error message is empty if the value was found and converted.
+    template<typename T>
+    std::pair<T, String> resolve(JsonVariantConst root) const;
+
+private:
+    struct Step {
+        std::string Key;
+        int Index; // negative if the step is a key
+    };
+
+    template<typename T>
+    std::optional<T> extractPlain(char const* client, std::string_view src, char const* topic) const;
+
+    std::string _path;
+    std::vector<Step> _steps;
+    JsonDocument _filter;
+};
@@ -0,0 +1,126 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+// bounded ring of log lines which any task can write to without locking or
+// allocating, read by a single consumer. messages are formatted into the
+// ring directly and kept as records of variable length, such that a short
+// line only takes the space it needs. a writer never waits: if the ring
+// lacks the space for a line of LineSize, the message is dropped and counted.
+//
+// a writer reserves space for a line of LineSize, formats the message into
+// it, and returns the unused part unless another writer reserved space in
+// the meantime. the header of the record is written last and tells the
+// consumer that the message is complete. a writer preempted while
+// formatting only holds back the consumer, never other writers.
+template <size_t Capacity, size_t LineSize>
+class LogRing {
+    // the header holds the size of the record and the length of the
+    // message, zero while the record is incomplete
+    static constexpr size_t HeaderSize = sizeof(uint32_t);
+
+    static constexpr uint32_t align(size_t size) { return (size + HeaderSize - 1) & ~(HeaderSize - 1); }
+    static constexpr uint32_t MaxRecordSize = align(HeaderSize + LineSize);
+
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+        "capacity must be a power of two");
+    static_assert(Capacity <= 0x10000, "record sizes must fit the header");
+    static_assert(LineSize > 1 && Capacity >= 2 * MaxRecordSize, "capacity must fit at least two lines");
+
+public:
+    LogRing() = default;
+    LogRing(const LogRing&) = delete;
+    LogRing& operator=(const LogRing&) = delete;
+
+    // any task. returns the result of vsnprintf(), or -1 if the ring is full.
+    // messages longer than LineSize - 1 are truncated.
+    int vprintf(const char* fmt, va_list arguments)
+    {
+        uint32_t pos = _writePos.load(std::memory_order_relaxed);
+        uint32_t padding;
+        uint32_t end;
+
+        while (true) {
+            // a record never wraps around, the end of the buffer is skipped
+            uint32_t offset = pos & (Capacity - 1);
+            padding = (offset + MaxRecordSize > Capacity) ? (Capacity - offset) : 0;
+            end = pos + padding + MaxRecordSize;
+
+            // the consumer did not yet release the space of the previous lap
+            if (end - _readPos.load(std::memory_order_acquire) > Capacity) {
+                _dropped.fetch_add(1, std::memory_order_relaxed);
+                return -1;
+            }
+
+            if (_writePos.compare_exchange_weak(pos, end, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+
+        if (padding > 0) {
+            storeHeader(pos, padding, 0);
+            pos += padding;
+        }
+
+        int written = vsnprintf(text(pos), LineSize, fmt, arguments);
+        uint32_t length = (written > 0) ? std::min<uint32_t>(written, LineSize - 1) : 0;
+
+        // the record includes the terminating null character
+        uint32_t size = align(HeaderSize + length + 1);
+        uint32_t reserved = end;
+        if (size == MaxRecordSize || !_writePos.compare_exchange_strong(reserved, pos + size, std::memory_order_relaxed)) {
+            size = MaxRecordSize;
+        }
+
+        storeHeader(pos, size, length);
+        return written;
+    }
+
+    // consumer only. passes the oldest complete message to the function,
+    // which must not write to this ring. returns false if there is none.
+    template <typename F>
+    bool consume(F&& function)
+    {
+        uint32_t pos = _readPos.load(std::memory_order_relaxed);
+        uint32_t header = __atomic_load_n(&_words[index(pos)], __ATOMIC_ACQUIRE);
+        if (header == 0) {
+            return false;
+        }
+
+        uint32_t size = header & 0xFFFF;
+        uint32_t length = header >> 16;
+        if (length > 0) {
+            function(text(pos), static_cast<size_t>(length));
+        }
+
+        // writers expect the space they reserve to be zero
+        memset(&_words[index(pos)], 0, size);
+        _readPos.store(pos + size, std::memory_order_release);
+        return true;
+    }
+
+    // messages dropped as the ring was full since the last call
+    uint32_t takeDropped() { return _dropped.exchange(0, std::memory_order_relaxed); }
+
+private:
+    static size_t index(uint32_t pos) { return (pos & (Capacity - 1)) / HeaderSize; }
+
+    char* text(uint32_t pos) { return reinterpret_cast<char*>(&_words[index(pos) + 1]); }
+
+    void storeHeader(uint32_t pos, uint32_t size, uint32_t length)
+    {
+        __atomic_store_n(&_words[index(pos)], size | (length << 16), __ATOMIC_RELEASE);
+    }
+
+    uint32_t _words[Capacity / HeaderSize] = {};
+    std::atomic<uint32_t> _writePos { 0 };
+    std::atomic<uint32_t> _readPos { 0 };
+    std::atomic<uint32_t> _dropped { 0 };
+};
@@ -1,14 +1,15 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 #pragma once
 
+#include "LogRing.h"
+#include "MetricsRegistry.h"
 #include <AsyncWebSocket.h>
 #include <TaskSchedulerDeclarations.h>
 #include <Print.h>
+#include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
-#include <mutex>
+#include <atomic>
 #include <vector>
-#include <unordered_map>
-#include <queue>
 #include <memory>
 
 class MessageOutputClass {
@@ -17,6 +18,8 @@ public:
     void init(Scheduler& scheduler);
     void register_ws_output(AsyncWebSocket* output);
 
+    // installed as the vprintf function of the ESP-IDF logging. never blocks
+    // or allocates, such that any task may log at any level.
     static int log_vprintf(const char *fmt, va_list arguments);
 
 private:
@@ -24,18 +27,22 @@ private:
 
     Task _loopTask;
 
-    static constexpr size_t BUFFER_SIZE = 8192;
-    char _buffer[BUFFER_SIZE];
-    size_t _buffer_in = 0;
-    size_t _buffer_out = 0;
+    // every task formats its messages into this ring. messages are written
+    // to the serial port, syslog and the websocket by the task which runs
+    // setup() and loop() only. records are only as long as their line, such
+    // that the ring holds about a hundred typical lines.
+    static constexpr size_t RING_CAPACITY = 8192;
+    static constexpr size_t MAX_LINE_LENGTH = 256;
+    LogRing<RING_CAPACITY, MAX_LINE_LENGTH> _ring;
+    void drain();
 
-    using message_t = std::vector<uint8_t>;
+    // setup() logs faster than the ring could hold, so its messages are
+    // written out right away until the scheduler runs loop().
+    TaskHandle_t _consumer_task = nullptr;
+    std::atomic<bool> _loop_started { false };
+    bool _draining = false;
 
-    // we keep a buffer for every task and only write complete lines to the
-    // serial output and then move them to be pushed through the websocket.
-    // this way we prevent mangling of messages from different contexts.
-    std::unordered_map<TaskHandle_t, message_t> _task_messages;
-    std::queue<message_t> _lines;
+    using message_t = std::vector<uint8_t>;
 
     // we chunk the websocket output to circumvent issues with TCP delayed ACKs:
     // if the websocket client (Windows in particular) is using delayed ACKs,
@@ -55,21 +62,24 @@ private:
 
     AsyncWebSocket* _ws = nullptr;
 
-    std::mutex _msgLock;
-
     void serialWrite(const uint8_t* buffer, size_t size);
+    void output(const uint8_t* buffer, size_t size);
 
+    // the token bucket is shared by all tasks
     static constexpr uint32_t RATE_LIMIT_WINDOW_MS = 1000;
-    static constexpr size_t RATE_LIMIT_MAX_TOKENS = 128;
-    size_t _available_tokens = RATE_LIMIT_MAX_TOKENS;
-    uint32_t _last_token_refill_millis = 0;
-    size_t _rate_limited_packets = 0;
+    static constexpr int32_t RATE_LIMIT_MAX_TOKENS = 128;
+    std::atomic<int32_t> _available_tokens { RATE_LIMIT_MAX_TOKENS };
+    std::atomic<uint32_t> _last_token_refill_millis { 0 };
+    bool consumeToken();
+
+    // messages dropped since the last warning, which is written by loop()
+    std::atomic<uint32_t> _rate_limited_packets { 0 };
     uint32_t _last_rate_limit_warning_millis = 0;
     static constexpr uint32_t RATE_LIMIT_WARNING_INTERVAL_MS = 1000;
-    bool consumeToken();
-    int log_self(const char* fmt, ...);
-    int log_vprintf_rate_limited(const char* fmt, va_list arguments);
-    int log_vprintf_recursive(const char* fmt, va_list arguments);
+
+    // not reset by the warnings
+    Metrics::Counter _rate_limited_total;
+    Metrics::Counter _overrun_total;
 };
 
 extern MessageOutputClass MessageOutput;
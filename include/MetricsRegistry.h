@@ -0,0 +1,154 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// counters, gauges and latency histograms which subsystems register once and
+// then update without locking. the Prometheus endpoint, MQTT and the system
+// status read all registered metrics from the one registry.
+namespace Metrics {
+
+enum class Type : uint8_t {
+    Counter,
+    Gauge,
+    Histogram,
+};
+
+class Metric {
+public:
+    virtual ~Metric() = default;
+    virtual Type getType() const = 0;
+};
+
+// monotonically increasing, e.g., the amount of dropped messages
+class Counter : public Metric {
+public:
+    Type getType() const final { return Type::Counter; }
+    void increment(uint32_t amount = 1) { _value.fetch_add(amount, std::memory_order_relaxed); }
+    uint32_t get() const { return _value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint32_t> _value { 0 };
+};
+
+class Gauge : public Metric {
+public:
+    Type getType() const final { return Type::Gauge; }
+    void set(float value) { _value.store(value, std::memory_order_relaxed); }
+    float get() const { return _value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<float> _value { 0.0f };
+};
+
+// counts observations, e.g., durations in microseconds, in buckets with
+// fixed upper bounds. values above the last bound go to an overflow bucket.
+class Histogram : public Metric {
+public:
+    static constexpr size_t MaxBounds = 12;
+
+    // the bounds must be ascending, excess bounds are ignored
+    explicit Histogram(std::initializer_list<uint32_t> bounds);
+
+    Type getType() const final { return Type::Histogram; }
+
+    void observe(uint32_t value);
+
+    size_t getBoundCount() const { return _boundCount; }
+    uint32_t getBound(size_t bucket) const { return _bounds[bucket]; }
+
+    // observations in the bucket only (not cumulative). the bucket at index
+    // getBoundCount() holds the values above the last bound.
+    uint32_t getBucket(size_t bucket) const { return _buckets[bucket].load(std::memory_order_relaxed); }
+
+    uint32_t getCount() const { return _count.load(std::memory_order_relaxed); }
+    uint64_t getSum() const { return _sum.load(std::memory_order_relaxed); }
+    uint32_t getMax() const { return _max.load(std::memory_order_relaxed); }
+
+private:
+    std::array<uint32_t, MaxBounds> _bounds;
+    size_t _boundCount = 0;
+    std::array<std::atomic<uint32_t>, MaxBounds + 1> _buckets;
+    std::atomic<uint32_t> _count { 0 };
+    std::atomic<uint64_t> _sum { 0 };
+    std::atomic<uint32_t> _max { 0 };
+};
+
+// observes its own lifetime in microseconds
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Histogram& histogram)
+        : _histogram(histogram)
+        , _start(std::chrono::steady_clock::now())
+    {
+    }
+
+    ~ScopedTimer()
+    {
+        auto elapsed = std::chrono::steady_clock::now() - _start;
+        _histogram.observe(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    Histogram& _histogram;
+    std::chrono::steady_clock::time_point _start;
+};
+
+// distinguishes metrics of the same name, e.g., { "serial", "1141..." }
+struct Label {
+    const char* Name = nullptr;
+    std::string Value;
+};
+
+class Registry {
+public:
+    struct Entry {
+        const char* Name; // without prefix, e.g., "powerlimiter_loop_duration_us"
+        const char* Help;
+        Label Instance;
+        std::shared_ptr<Metric const> Value;
+    };
+
+    // the metric is kept alive by the registry until it is removed. names
+    // and help texts must be string literals.
+    std::shared_ptr<Counter> addCounter(const char* name, const char* help, Label label = {});
+    std::shared_ptr<Gauge> addGauge(const char* name, const char* help, Label label = {});
+    std::shared_ptr<Histogram> addHistogram(const char* name, const char* help, std::initializer_list<uint32_t> bounds, Label label = {});
+
+    // registers a metric which outlives the registry, e.g., a member of a
+    // global object which may be updated before it was registered.
+    void add(const char* name, const char* help, Metric const& metric, Label label = {});
+
+    void remove(std::shared_ptr<Metric const> const& metric);
+    void remove(Metric const& metric);
+
+    // a copy of all entries, grouped by name in order of first registration
+    std::vector<Entry> getEntries() const;
+
+private:
+    void add(const char* name, const char* help, Label&& label, std::shared_ptr<Metric const> metric);
+
+    std::vector<Entry> _entries;
+    mutable std::mutex _mutex;
+};
+
+// upper bounds in microseconds suitable for the duration of loops and tasks
+inline constexpr std::initializer_list<uint32_t> DurationBoundsUs = {
+    100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 1000000
+};
+
+} // namespace Metrics
+
+extern Metrics::Registry MetricsRegistry;
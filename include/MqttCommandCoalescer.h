@@ -0,0 +1,68 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// decouples receiving commands via MQTT from applying them. only the latest
+// value per command and target (e.g., inverter serial) is kept, and each of
+// them is applied at most once per interval. commands are pushed from the
+// MQTT task and applied from the TaskScheduler context.
+class MqttCommandCoalescer {
+public:
+    struct Command {
+        uint32_t Id;
+        uint64_t Target;
+        float Value;
+        bool Retain;
+    };
+
+    struct Stats {
+        uint32_t Received;
+        uint32_t Applied;
+        uint32_t Coalesced; // replaced by a newer value before being applied
+        uint32_t Dropped; // no slot available
+    };
+
+    explicit MqttCommandCoalescer(size_t capacity);
+
+    // returns false if the command was dropped
+    bool push(const Command& cmd);
+
+    // applies each pending command which was not applied within the last
+    // intervalMillis. the callback is invoked without holding the lock.
+    template<typename F>
+    void poll(uint32_t nowMillis, uint32_t intervalMillis, F&& apply)
+    {
+        Command cmd;
+        while (takeDue(nowMillis, intervalMillis, cmd)) {
+            apply(cmd);
+        }
+    }
+
+    void clear();
+
+    Stats getStats() const;
+
+private:
+    bool takeDue(uint32_t nowMillis, uint32_t intervalMillis, Command& cmd);
+
+    struct Slot {
+        Command Cmd;
+        uint32_t LastAppliedMillis;
+        bool Used;
+        bool Pending;
+        bool Applied; // LastAppliedMillis is valid
+    };
+
+    std::vector<Slot> _slots;
+
+    uint32_t _received = 0;
+    uint32_t _applied = 0;
+    uint32_t _coalesced = 0;
+    uint32_t _dropped = 0;
+
+    mutable std::mutex _mutex;
+};
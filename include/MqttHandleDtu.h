@@ -11,6 +11,7 @@ public:
 
 private:
     void loop();
+    void publishMetrics();
 
     Task _loopTask;
 };
@@ -2,6 +2,8 @@
 #pragma once
 
 #include "Configuration.h"
+#include "MqttCommandCoalescer.h"
+#include "MqttSettings.h"
 #include <Hoymiles.h>
 #include <TaskSchedulerDeclarations.h>
 #include <espMqttClient.h>
@@ -13,16 +15,21 @@ public:
     MqttHandleInverterClass();
     void init(Scheduler& scheduler);
 
-    static String getTopic(std::shared_ptr<InverterAbstract> inv, const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId);
+    // appends the field's subtopic. returns false if the inverter has no such field.
+    static bool getTopic(MqttTopic& topic, std::shared_ptr<InverterAbstract> inv, const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId);
 
     void subscribeTopics();
     void unsubscribeTopics();
 
+    MqttCommandCoalescer::Stats getCommandStats() const { return _commands.getStats(); }
+
 private:
     void loop();
+    void commandLoop();
     void publishField(std::shared_ptr<InverterAbstract> inv, const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId);
 
     Task _loopTask;
+    Task _commandTask;
 
     uint32_t _lastPublishStats[INV_MAX_COUNT] = { 0 };
 
@@ -43,6 +50,22 @@ private:
         FLD_Q
     };
 
+    // changes smaller than these are not published, except for the periodic
+    // full republish. fields not listed are published on every change.
+    static constexpr frozen::map<FieldId_t, float, 11> _fieldDeadbands = {
+        { FLD_UDC, 0.5f },
+        { FLD_IDC, 0.05f },
+        { FLD_PDC, 1.0f },
+        { FLD_UAC, 0.5f },
+        { FLD_IAC, 0.05f },
+        { FLD_PAC, 1.0f },
+        { FLD_F, 0.05f },
+        { FLD_T, 0.5f },
+        { FLD_PF, 0.01f },
+        { FLD_EFF, 0.1f },
+        { FLD_Q, 1.0f },
+    };
+
     enum class Topic : unsigned {
         LimitPersistentRelative,
         LimitPersistentAbsolute,
@@ -65,6 +88,11 @@ private:
     };
 
     void onMqttMessage(Topic t, const espMqttClientTypes::MessageProperties& properties, const char* topic, const uint8_t* payload, const size_t len);
+    void applyCommand(const MqttCommandCoalescer::Command& cmd);
+
+    // commands are applied in the TaskScheduler context, at a limited rate
+    // per command and inverter, such that they do not flood the radio.
+    MqttCommandCoalescer _commands { _subscriptions.size() * INV_MAX_COUNT };
 };
 
 extern MqttHandleInverterClass MqttHandleInverter;
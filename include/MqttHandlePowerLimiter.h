@@ -2,10 +2,9 @@
 #pragma once
 
 #include "Configuration.h"
+#include "MqttCommandCoalescer.h"
 #include <espMqttClient.h>
 #include <TaskSchedulerDeclarations.h>
-#include <mutex>
-#include <deque>
 #include <functional>
 #include <frozen/map.h>
 #include <frozen/string.h>
@@ -19,6 +18,8 @@ public:
     void subscribeTopics();
     void unsubscribeTopics();
 
+    MqttCommandCoalescer::Stats getCommandStats() const { return _commands.getStats(); }
+
 private:
     void loop();
 
@@ -50,6 +51,7 @@ private:
     };
 
     void onMqttCmd(MqttPowerLimiterCommand command, const espMqttClientTypes::MessageProperties& properties, const char* topic, const uint8_t* payload, size_t len);
+    void applyCmd(MqttCommandCoalescer::Command const& cmd);
 
     Task _loopTask;
 
@@ -57,10 +59,9 @@ private:
     uint32_t _lastPublish;
 
     // MQTT callbacks to process updates on subscribed topics are executed in
-    // the MQTT thread's context. we use this queue to switch processing the
-    // user requests into the main loop's context (TaskScheduler context).
-    mutable std::mutex _mqttMutex;
-    std::deque<std::function<void()>> _mqttCallbacks;
+    // the MQTT thread's context. commands are applied in the main loop's
+    // context (TaskScheduler context), at a limited rate.
+    MqttCommandCoalescer _commands { _subscriptions.size() };
 };
 
 extern MqttHandlePowerLimiterClass MqttHandlePowerLimiter;
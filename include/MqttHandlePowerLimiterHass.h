@@ -2,16 +2,17 @@
 #pragma once
 
 #include <ArduinoJson.h>
+#include <MqttHassPublisher.h>
 #include <TaskSchedulerDeclarations.h>
 
 class MqttHandlePowerLimiterHassClass {
 public:
     void init(Scheduler& scheduler);
-    void publishConfig();
     void forceUpdate();
 
 private:
     void loop();
+    void publishConfig();
     void publish(const String& subtopic, const String& payload);
     void publishNumber(const char* caption, const char* icon, const char* category, const char* commandTopic, const char* stateTopic, const char* unitOfMeasure, const int16_t min, const int16_t max, const float step);
     void publishSelect(const char* caption, const char* icon, const char* category, const char* commandTopic, const char* stateTopic);
@@ -19,6 +20,7 @@ private:
     void createDeviceInfo(JsonDocument& root);
 
     Task _loopTask;
+    MqttHassPass _pass;
 
     bool _wasConnected = false;
     bool _updateForced = false;
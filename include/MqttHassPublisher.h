@@ -0,0 +1,93 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <Arduino.h>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// publishes Home Assistant discovery documents. documents which did not
+// change since they were last published during the current connection are
+// skipped. documents are generated at a limited rate shared by all
+// integrations (see MqttHassPass), such that (re)connecting does not flood
+// the broker while the connection is still fragile.
+class MqttHassPublisherClass {
+public:
+    // publishes the payload to <hass topic><subtopic> unless it is unchanged
+    void publish(const String& subtopic, const String& payload);
+
+    // all documents are published again by the next pass of each
+    // integration. to be called whenever the broker or Home Assistant may
+    // have lost the documents, i.e., on (re)connect and forced updates.
+    void forgetPublished();
+
+    // the budget of documents to generate
+    bool hasToken();
+    bool takeToken();
+
+    static constexpr uint32_t DocumentsPerSecond = 10;
+    static constexpr uint32_t MaxBurst = 10;
+
+private:
+    void refill();
+
+    struct Fingerprint {
+        uint64_t TopicHash;
+        uint16_t TopicLength;
+        uint32_t PayloadHash;
+    };
+    std::vector<Fingerprint> _fingerprints; // sorted by topic hash and length
+
+    uint32_t _tokens = MaxBurst;
+    uint32_t _lastRefillMillis = 0;
+
+    std::mutex _mutex;
+};
+
+extern MqttHassPublisherClass MqttHassPublisher;
+
+// one pass over the discovery documents of an integration, spread over
+// several steps. the generator is run in each step and must call claim()
+// before building each document, skipping the document if it returns
+// false. the generator must yield the documents in the same order in each
+// step.
+class MqttHassPass {
+public:
+    void restart()
+    {
+        _cursor = 0;
+        _active = true;
+    }
+
+    bool isActive() const { return _active; }
+
+    template<typename F>
+    void step(F&& generator)
+    {
+        if (!_active || !MqttHassPublisher.hasToken()) {
+            return;
+        }
+
+        _index = 0;
+        generator();
+
+        if (_cursor >= _index) {
+            _active = false;
+        }
+    }
+
+    bool claim()
+    {
+        size_t index = _index++;
+        if (index != _cursor || !MqttHassPublisher.takeToken()) {
+            return false;
+        }
+        ++_cursor;
+        return true;
+    }
+
+private:
+    size_t _cursor = 0;
+    size_t _index = 0;
+    bool _active = false;
+};
@@ -0,0 +1,62 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// bounded ring of outbound MQTT messages. producers never wait for the
+// consumer beyond a short critical section. if the queue is full, a message
+// replaces the payload of a queued message with the same topic, or it is
+// dropped.
+class MqttPublishQueue {
+public:
+    struct Message {
+        std::string Topic;
+        std::string Payload;
+        bool Retain = false;
+        uint8_t Qos = 0;
+    };
+
+    struct Stats {
+        uint32_t Queued;
+        uint32_t Coalesced;
+        uint32_t Dropped;
+        size_t Depth;
+        size_t HighWater;
+        size_t Capacity;
+    };
+
+    explicit MqttPublishQueue(size_t capacity);
+
+    // returns false if the message was dropped
+    bool push(std::string_view topic, std::string_view payload, const bool retain, const uint8_t qos);
+
+    // moves the oldest message into msg. the previous contents of msg are
+    // recycled as buffers of the freed slot.
+    bool pop(Message& msg);
+
+    void clear();
+
+    Stats getStats() const;
+
+    // payload buffers larger than this are released rather than recycled,
+    // such that rare large messages (e.g., Home Assistant discovery) do not
+    // pin memory in every slot.
+    static constexpr size_t MaxRecycledCapacity = 128;
+
+private:
+    std::vector<Message> _slots;
+    size_t _head = 0;
+    size_t _count = 0;
+
+    uint32_t _queued = 0;
+    uint32_t _coalesced = 0;
+    uint32_t _dropped = 0;
+    size_t _highWater = 0;
+
+    mutable std::mutex _mutex;
+};
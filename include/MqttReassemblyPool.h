@@ -0,0 +1,71 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// reassembles MQTT messages which the client hands over in fragments. the
+// amount of messages in flight, their size and the length of their topic
+// are bounded. the buffers of a slot are allocated when the slot is used
+// for the first time and kept
+// afterwards, such that reassembling does not touch the heap in the long
+// run. a complete message stays in its slot until it is released, so a
+// message handler may not be handed a buffer which is overwritten while it
+// is still processing the message.
+class MqttReassemblyPool {
+public:
+    struct Slot {
+        const uint8_t* data() const { return Buffer.get(); }
+        size_t length() const { return Total; }
+
+    private:
+        friend class MqttReassemblyPool;
+
+        enum class State : uint8_t { Free, Receiving, Complete };
+
+        State Status = State::Free;
+        std::unique_ptr<char[]> Topic;
+        size_t TopicLength = 0;
+        std::unique_ptr<uint8_t[]> Buffer;
+        size_t Total = 0;
+        size_t Received = 0;
+        uint32_t Sequence = 0;
+    };
+
+    struct Stats {
+        uint32_t Reassembled;
+        uint32_t Evicted;
+        uint32_t Dropped;
+    };
+
+    MqttReassemblyPool(size_t slots, size_t capacity, size_t maxTopicLength);
+
+    // adds a fragment of a message. returns the slot holding the complete
+    // message once its last fragment was added, which must be passed to
+    // release() afterwards. returns nullptr otherwise, including if the
+    // message is dropped as it is too large or fragments are missing.
+    Slot* add(std::string_view topic, const uint8_t* payload, size_t len, size_t index, size_t total);
+
+    void release(Slot* slot);
+
+    Stats getStats() const { return { _reassembled, _evicted, _dropped }; }
+
+    size_t getCapacity() const { return _capacity; }
+    size_t getMaxTopicLength() const { return _maxTopicLength; }
+
+private:
+    Slot* find(std::string_view topic);
+    Slot* acquire();
+
+    std::vector<Slot> _slots;
+    size_t _capacity;
+    size_t _maxTopicLength;
+    uint32_t _sequence = 0;
+
+    uint32_t _reassembled = 0;
+    uint32_t _evicted = 0;
+    uint32_t _dropped = 0;
+};
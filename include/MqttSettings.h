@@ -1,14 +1,95 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 #pragma once
 
+#include "Configuration.h"
+#include "MqttPublishQueue.h"
+#include "MqttReassemblyPool.h"
 #include "NetworkSettings.h"
+#include <ArduinoJson.h>
 #include <MqttSubscribeParser.h>
 #include <Ticker.h>
 #include <espMqttClient.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <mutex>
 #include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 
+// topic built in a stack buffer, starting with the configured prefix. the
+// buffer is truncated (and the topic is not published) if it overflows.
+class MqttTopic {
+public:
+    MqttTopic();
+    MqttTopic(const MqttTopic&) = delete;
+    MqttTopic& operator=(const MqttTopic&) = delete;
+
+    MqttTopic& append(std::string_view str);
+    MqttTopic& append(const char* str) { return append(std::string_view(str)); }
+    MqttTopic& append(const String& str) { return append(std::string_view(str.c_str(), str.length())); }
+    MqttTopic& append(uint32_t value);
+    MqttTopic& appendLowerCase(std::string_view str);
+
+    // to publish several leaves below the same base topic
+    size_t length() const { return _length; }
+    MqttTopic& truncate(size_t length);
+
+    const char* c_str() const { return _buffer; }
+    bool overflow() const { return _overflow; }
+
+    // length of the prefix the topic was started with
+    size_t prefixLength() const { return _prefixLength; }
+
+    static constexpr size_t MaxLength = MQTT_MAX_TOPIC_STRLEN + 64;
+
+private:
+    char _buffer[MaxLength + 1];
+    size_t _length = 0;
+    size_t _prefixLength = 0;
+    bool _overflow = false;
+};
+
+// payload formatted into a fixed-size buffer, or referring to an existing
+// string. numbers are formatted like the respective String constructor,
+// strings are trimmed like MqttSettingsClass::publish() does.
+class MqttValue {
+public:
+    MqttValue(const char* str) { assign(str, strlen(str)); }
+    MqttValue(const String& str) { assign(str.c_str(), str.length()); }
+    MqttValue(float value, uint8_t decimals = 2) : MqttValue(static_cast<double>(value), decimals) { }
+    MqttValue(double value, uint8_t decimals = 2);
+
+    template<typename T, typename std::enable_if<std::is_integral<T>::value, int>::type = 0>
+    MqttValue(T value)
+    {
+        int length;
+        if (std::is_signed<T>::value) {
+            length = snprintf(_buffer, sizeof(_buffer), "%lld", static_cast<long long>(value));
+        } else {
+            length = snprintf(_buffer, sizeof(_buffer), "%llu", static_cast<unsigned long long>(value));
+        }
+        _length = std::min<size_t>(length, sizeof(_buffer) - 1);
+    }
+
+    MqttValue(const MqttValue&) = delete;
+    MqttValue& operator=(const MqttValue&) = delete;
+
+    // not necessarily null-terminated
+    const char* data() const { return _data; }
+    size_t length() const { return _length; }
+
+private:
+    void assign(const char* str, size_t length);
+
+    char _buffer[32];
+    const char* _data = _buffer;
+    size_t _length = 0;
+};
+
 class MqttSettingsClass {
 public:
     MqttSettingsClass();
@@ -19,12 +100,49 @@ public:
     void publish(const String& subtopic, const String& payload);
     void publishGeneric(const String& topic, const String& payload, const bool retain, const uint8_t qos = 0);
 
+    // publishes the payload only if it differs from the payload last published
+    // on the same topic, or if the topic was not published for the full
+    // republish interval. numeric payloads are considered unchanged as long as
+    // they differ by less than the deadband from the last published value.
+    void publishIfChanged(const MqttTopic& topic, const MqttValue& value, const float deadband = 0);
+
+    // publishes without any heap allocation on our side
+    void publish(const MqttTopic& topic, const MqttValue& value);
+
+    static constexpr uint32_t FullRepublishIntervalMillis = 60 * 1000;
+
+    // unless the publish mode is PublishTopics, all values published by the
+    // calling task below the base topic (relative to the prefix) until
+    // endBatch() are collected into one document, which is published to
+    // <prefix><base>json, or <prefix><base>msgpack if MessagePack encoding
+    // is selected. returns false if no batch was started, in which case
+    // endBatch() must not be called. use MqttBatch instead.
+    bool beginBatch(std::string_view base);
+    void endBatch();
+
+    // sets the state topic (and value template if necessary) of a Home
+    // Assistant discovery document for the value published to
+    // <prefix><base><subtopic>, according to the publish mode.
+    void setHassStateTopic(JsonDocument& root, std::string_view base, std::string_view subtopic) const;
+
     void subscribe(const String& topic, const uint8_t qos, const OnMessageCallback& cb);
     void unsubscribe(const String& topic);
 
     String getPrefix() const;
+    std::shared_ptr<std::string const> getCachedPrefix() const { return std::atomic_load(&_spPrefix); }
     String getClientId() const;
 
+    MqttPublishQueue::Stats getPublishQueueStats() const { return _publishQueue.getStats(); }
+
+    // enough to hold a full cycle of values of a few devices
+    static constexpr size_t PublishQueueCapacity = 128;
+
+    // messages exceeding the receive buffer of the client arrive in
+    // fragments. messages of power meters and batteries are a few KiB at
+    // most, and rarely more than one is fragmented at the same time.
+    static constexpr size_t FragmentSlots = 2;
+    static constexpr size_t FragmentCapacity = 4096;
+
 private:
     void NetworkEvent(network_event event);
 
@@ -37,11 +155,79 @@ private:
 
     void createMqttClientObject();
 
+    void updatePrefix();
+    bool updatePublishCache(const MqttTopic& topic, const MqttValue& value, const float deadband);
+    void clearPublishCache();
+
+    void send(const MqttTopic& topic, const MqttValue& value);
+    void enqueue(std::string_view topic, std::string_view payload, const bool retain, const uint8_t qos);
+
+    static void publisherLoopHelper(void* context);
+    void publisherLoop();
+    bool collect(std::string_view topic, std::string_view payload, const bool changed);
+
     MqttClient* _mqttClient = nullptr;
+
+    // the client keeps pointers to the hostname, credentials and
+    // certificates, so the snapshot holding them must outlive the client's
+    // use of them. guarded by _clientLock.
+    std::shared_ptr<CONFIG_T const> _spClientConfig;
+    std::atomic<bool> _connected = false;
     Ticker _mqttReconnectTimer;
-    std::map<String, std::vector<uint8_t>> _fragments;
+    MqttReassemblyPool _fragments { FragmentSlots, FragmentCapacity, MQTT_MAX_TOPIC_STRLEN };
     MqttSubscribeParser _mqttSubscribeParser;
     std::mutex _clientLock;
+
+    // publishes are handed to a dedicated task, such that the publishing
+    // tasks never wait on the network (or _clientLock).
+    MqttPublishQueue _publishQueue { PublishQueueCapacity };
+    TaskHandle_t _publisherTaskHandle = nullptr;
+
+    // replaced as a whole by updatePrefix(), such that tasks building
+    // topics keep using a consistent prefix while reconnecting.
+    std::shared_ptr<std::string const> _spPrefix = std::make_shared<std::string const>();
+
+    // sorted by topic hash and length. only hashes are kept to save memory.
+    // the hash is 64 bits wide and compared along with the length, such
+    // that a collision, which would suppress publishing a topic for good,
+    // is practically impossible.
+    struct PublishCacheEntry {
+        uint64_t TopicHash;
+        uint16_t TopicLength;
+        uint32_t PayloadHash;
+        float Value; // NAN if the payload is not a number
+        uint32_t PublishedMillis;
+    };
+    std::vector<PublishCacheEntry> _publishCache;
+    std::mutex _publishCacheLock;
+
+    // one document per base topic, kept such that values skipped by
+    // publishIfChanged() are still part of the next document. only the
+    // task owning _batchLock accesses them.
+    std::mutex _batchLock;
+    std::atomic<TaskHandle_t> _batchTask = nullptr;
+    std::atomic<bool> _batchDocsStale = false;
+    std::map<std::string, JsonDocument, std::less<>> _batchDocs;
+    JsonDocument* _batchDoc = nullptr;
+    std::string _batchBase;
+    bool _batchChanged = false;
+
+    // taken from the config when the batch begins
+    bool _batchMessagePack = false;
+    bool _batchPublishJson = false;
+};
+
+// collects the values published while in scope into one JSON document
+// (see MqttSettingsClass::beginBatch()).
+class MqttBatch {
+public:
+    explicit MqttBatch(std::string_view base);
+    ~MqttBatch();
+    MqttBatch(const MqttBatch&) = delete;
+    MqttBatch& operator=(const MqttBatch&) = delete;
+
+private:
+    bool _active;
 };
 
 extern MqttSettingsClass MqttSettings;
@@ -0,0 +1,57 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <cstdint>
+
+/**
+ * splits the power meter reading between the dynamic power limiter (DPL) and
+ * the automatic power control of the grid charger, such that both act on the
+ * same meter sample and do not react to each other's adjustments.
+ *
+ * the allocation is computed once per power meter update. if power is imported
+ * from the grid, the charger sheds its input power first and only the remainder
+ * is left to the battery-powered inverters. if power is exported, the inverters
+ * shed their output first and only the remainder is left to the charger. each
+ * party regulates against the meter value it would see after the other one
+ * took its share, so the system settles in a single cycle.
+ */
+class PowerArbiterClass {
+public:
+    struct Allocation {
+        uint32_t Timestamp = 0; // of the power meter reading
+        bool Valid = false;
+        float GridPower = 0; // the shared power meter reading
+
+        // meter value the respective controller shall regulate against
+        float InverterGridPower = 0;
+        float ChargerGridPower = 0;
+
+        // the charger sheds all of its input power and power is still
+        // missing, i.e., the inverters may discharge the battery.
+        bool ChargerYields = false;
+
+        // the battery-powered inverters shed all of their output and there
+        // is surplus left, i.e., the charger may start charging.
+        bool InverterYields = false;
+    };
+
+    // returns the allocation for the most recent power meter reading
+    Allocation const& getAllocation();
+
+    // AC input power currently drawn by the grid charger as measured, zero
+    // if unknown or outdated, and whether it is adjusted by the automatic
+    // power control, i.e., whether the charger sheds it if power is imported.
+    // to be updated by the grid charger providers.
+    void setChargerInputPower(float watts, bool automatic)
+    {
+        _chargerInputPower = watts;
+        _chargerInputAutomatic = automatic;
+    }
+
+private:
+    Allocation _allocation;
+    float _chargerInputPower = 0;
+    bool _chargerInputAutomatic = false;
+};
+
+extern PowerArbiterClass PowerArbiter;
@@ -57,10 +57,14 @@ public:
     // used to interlock Huawei R48xx grid charger against battery-powered inverters
     bool isGovernedBatteryPoweredInverterProducing() const;
 
+    // used to split the power meter reading with the grid charger
+    float getBatteryInvertersOutputAcWatts() const;
+
 private:
     void loop();
 
     Task _loopTask;
+    std::shared_ptr<Metrics::Histogram> _spLoopDuration;
 
     std::atomic<bool> _reloadConfigFlag = true;
     uint16_t _lastExpectedInverterOutput = 0;
@@ -97,7 +101,6 @@ private:
     bool updateInverters();
     uint16_t getSolarPassthroughPower() const;
     std::optional<uint16_t> getBatteryDischargeLimit() const;
-    float getBatteryInvertersOutputAcWatts() const;
 
     bool testThreshold(float socThreshold, float voltThreshold,
             std::function<bool(float, float)> compare) const;
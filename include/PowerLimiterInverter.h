@@ -2,6 +2,7 @@
 #pragma once
 
 #include "Configuration.h"
+#include "MetricsRegistry.h"
 #include <Hoymiles.h>
 #include <optional>
 #include <memory>
@@ -10,6 +11,8 @@ class PowerLimiterInverter {
 public:
     static std::unique_ptr<PowerLimiterInverter> create(PowerLimiterInverterConfig const& config);
 
+    virtual ~PowerLimiterInverter();
+
     // send command(s) to inverter to reach desired target state (limit and
     // production). return true if an update is pending, i.e., if the target
     // state is NOT yet reached, false otherwise.
@@ -129,6 +132,9 @@ private:
     // issued to the inverter timed out *or* failed
     uint8_t _updateTimeouts = 0;
 
+    // never reset, published through the metrics registry
+    std::shared_ptr<Metrics::Counter> _spUpdateTimeoutsTotal;
+
     // track (target) state
     std::optional<uint32_t> _oUpdateStartMillis = std::nullopt;
     std::optional<uint16_t> _oTargetPowerLimitWatts = std::nullopt;
@@ -0,0 +1,77 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+// fixed-size ring buffer handing items from exactly one producer task to
+// exactly one consumer task without locking or allocating, e.g., from a
+// worker task blocking on I/O to a task run by the scheduler. the capacity
+// must be a power of two.
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+        "capacity must be a power of two");
+
+public:
+    SpscQueue() = default;
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // producer only. returns false and drops the item if the queue is full.
+    bool push(T const& item)
+    {
+        size_t const tail = _tail.load(std::memory_order_relaxed);
+        if (tail - _head.load(std::memory_order_acquire) == Capacity) {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        _items[tail & (Capacity - 1)] = item;
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer only
+    std::optional<T> pop()
+    {
+        size_t const head = _head.load(std::memory_order_relaxed);
+        if (head == _tail.load(std::memory_order_acquire)) {
+            return std::nullopt;
+        }
+
+        T item = _items[head & (Capacity - 1)];
+        _head.store(head + 1, std::memory_order_release);
+        return item;
+    }
+
+    // approximate if called while the other side is active
+    size_t size() const
+    {
+        return _tail.load(std::memory_order_acquire) - _head.load(std::memory_order_acquire);
+    }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+    // items rejected by push() as the queue was full
+    uint32_t getDropped() const { return _dropped.load(std::memory_order_relaxed); }
+
+    // discards the queued items and the count of dropped ones. only while
+    // the producer is stopped, called by the consumer.
+    void clear()
+    {
+        _head.store(_tail.load(std::memory_order_acquire), std::memory_order_release);
+        _dropped.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    std::array<T, Capacity> _items = {};
+
+    // free-running counters, the difference is the number of queued items
+    std::atomic<size_t> _head { 0 };
+    std::atomic<size_t> _tail { 0 };
+    std::atomic<uint32_t> _dropped { 0 };
+};
@@ -0,0 +1,58 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include "MetricsRegistry.h"
+#include <TaskSchedulerDeclarations.h>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+// measures the callbacks of the tasks run by the scheduler. all of them share
+// the main loop, so a slow task delays all others. the statistics are
+// available through /api/system/tasks and are logged periodically on level
+// debug.
+class TaskProfilerClass {
+public:
+    TaskProfilerClass();
+    void init(Scheduler& scheduler);
+
+    // returns a callback which runs the given one and records its execution
+    // time and how late it was started. the name must be a string literal.
+    TaskCallback wrap(char const* name, TaskCallback callback);
+
+    struct Stats {
+        char const* Name;
+        uint32_t Runs;
+        uint64_t TotalUs;
+        uint32_t MaxUs;
+        uint32_t IntervalMs; // as configured when the task ran last
+        uint64_t TotalLatenessMs;
+        uint32_t MaxLatenessMs;
+    };
+
+    std::vector<Stats> getStats() const;
+
+private:
+    void report();
+
+    struct Entry {
+        explicit Entry(char const* name);
+
+        char const* Name;
+        Metrics::Histogram Duration; // us
+        Metrics::Histogram Lateness; // ms behind the scheduled start
+        std::atomic<uint32_t> IntervalMs { 0 };
+    };
+
+    void run(Entry& entry, TaskCallback const& callback);
+
+    Scheduler* _scheduler = nullptr;
+    Task _reportTask;
+
+    // a deque, as the callbacks refer to their entry
+    std::deque<Entry> _entries;
+    mutable std::mutex _mutex;
+};
+
+extern TaskProfilerClass TaskProfiler;
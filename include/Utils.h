@@ -3,7 +3,10 @@
 
 #include <ArduinoJson.h>
 #include <LittleFS.h>
+#include <algorithm>
 #include <cstdint>
+#include <cstdio>
+#include <string_view>
 #include <utility>
 
 class Utils {
@@ -20,12 +23,16 @@ public:
     template<typename T>
     static std::optional<T> getFromString(char const* val);
 
-    template<typename T>
-    static std::pair<T, String> getJsonValueByPath(JsonDocument const& root, String const& path);
-
-    template <typename T>
-    static std::optional<T> getNumericValueFromMqttPayload(char const* client,
-            std::string const& src, char const* topic, char const* jsonPath);
+    // copies the beginning of a payload into the buffer to be logged,
+    // appending "..." if the payload is truncated.
+    template<size_t N>
+    static char const* getLogExcerpt(char (&buffer)[N], std::string_view src) {
+        static_assert(N > 3, "buffer too small");
+        size_t length = std::min(src.length(), N - 4);
+        snprintf(buffer, N, "%.*s%s", static_cast<int>(length), src.data(),
+                (src.length() > length) ? "..." : "");
+        return buffer;
+    }
 
     template<typename T>
     static std::optional<T> getJsonElement(JsonObjectConst const root, char const* key, size_t nesting = 0) {
@@ -36,4 +43,16 @@ public:
     }
 
     static bool getEpoch(time_t* epoch, uint32_t ms = 20);
+
+    // seconds since boot. unlike millis() / 1000, which wraps around after
+    // 49.7 days, this wraps around at 2^32 such that differences of
+    // timestamps are valid across the wrap.
+    static uint32_t getUptimeSeconds();
+
+    // pass the previous result as hash to continue hashing
+    static uint32_t fnv1aHash(const char* data, size_t length, uint32_t hash = 2166136261u);
+    static uint64_t fnv1aHash64(const char* data, size_t length, uint64_t hash = 14695981039346656037ull);
 };
+
+template<>
+std::optional<float> Utils::getFromString(char const* val);
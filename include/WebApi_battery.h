@@ -12,6 +12,7 @@ private:
     void onStatus(AsyncWebServerRequest* request);
     void onAdminGet(AsyncWebServerRequest* request);
     void onAdminPost(AsyncWebServerRequest* request);
+    void onCells(AsyncWebServerRequest* request);
 
     AsyncWebServer* _server;
 };
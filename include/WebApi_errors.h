@@ -64,6 +64,11 @@ enum WebApiError {
     MqttLwtQos,
     MqttClientIdLength,
     MqttHassTopicTrailingSlash,
+    MqttPublishMode,
+    MqttBatchEncoding,
+    MqttBatchEncodingHass,
+    MqttCommandInterval,
+    MqttConfigSaveDelay,
 
     NetworkBase = 8000,
     NetworkIpInvalid,
@@ -1,10 +1,14 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 #pragma once
 
+#include "MetricsRegistry.h"
 #include <ESPAsyncWebServer.h>
 #include <Hoymiles.h>
 #include <TaskSchedulerDeclarations.h>
-#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
 
 class WebApiPrometheusClass {
 public:
@@ -13,23 +17,20 @@ public:
 private:
     void onPrometheusMetricsGet(AsyncWebServerRequest* request);
 
-    void addField(AsyncResponseStream* stream, const String& serial, const uint8_t idx, std::shared_ptr<InverterAbstract> inv, const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId, const char* metricName, const char* channelName = nullptr);
-
-    void addPanelInfo(AsyncResponseStream* stream, const String& serial, const uint8_t idx, std::shared_ptr<InverterAbstract> inv, const ChannelType_t type, const ChannelNum_t channel);
-
     enum MetricType_t {
         NONE = 0,
         GAUGE,
         COUNTER,
+        HISTOGRAM,
     };
-    const char* _metricTypes[3] = { 0, "gauge", "counter" };
+    static constexpr const char* _metricTypes[4] = { 0, "gauge", "counter", "histogram" };
 
     struct publish_type_t {
         FieldId_t field;
         MetricType_t type;
     };
 
-    const publish_type_t _publishFields[14] = {
+    static constexpr publish_type_t _publishFields[14] = {
         { FLD_PAC, MetricType_t::GAUGE },
         { FLD_UAC, MetricType_t::GAUGE },
         { FLD_IAC, MetricType_t::GAUGE },
@@ -45,4 +46,100 @@ private:
         { FLD_EFF, MetricType_t::GAUGE },
         { FLD_IRR, MetricType_t::GAUGE },
     };
+
+    // metrics of the inverters. the families and the label sets of their
+    // samples only depend on the inverter configuration, so they are built
+    // once and shared by all scrapes until the configuration changes.
+    enum class InverterMetric : uint8_t {
+        LastUpdate,
+        LimitRelative,
+        LimitAbsolute,
+        PanelInfo,
+        MaxPower,
+        YieldTotalOffset,
+        Field,
+    };
+
+    struct Sample {
+        uint8_t Inverter; // index into Layout::Inverters
+        ChannelType_t Type;
+        ChannelNum_t Channel;
+        FieldId_t Field;
+        uint16_t Labels; // index into Layout::Labels
+    };
+
+    struct Family {
+        String Name;
+        String Help;
+        MetricType_t Type;
+        InverterMetric Metric;
+        std::vector<Sample> Samples;
+    };
+
+    struct Layout {
+        uint32_t Key;
+        std::vector<uint64_t> Inverters; // serials by position
+        std::vector<String> Labels;
+        std::vector<Family> Families;
+    };
+
+    static uint32_t getLayoutKey();
+    static std::shared_ptr<Layout const> buildLayout(uint32_t key);
+    std::shared_ptr<Layout const> getLayout();
+
+    std::shared_ptr<Layout const> _layout;
+    std::mutex _layoutMutex;
+
+    // metrics which are not related to a particular inverter
+    struct ScalarMetric {
+        const char* Name;
+        const char* Help;
+        MetricType_t Type;
+        uint8_t Digits;
+        std::optional<float> (*Read)();
+    };
+
+    static const ScalarMetric _scalarMetrics[];
+    static const size_t _scalarMetricCount;
+
+    // produces the exposition line by line while the chunked response is
+    // sent, such that the body is never held in memory as a whole.
+    class MetricsWriter {
+    public:
+        explicit MetricsWriter(std::shared_ptr<Layout const> layout);
+
+        // fills the buffer with the next part of the body, returns 0 at its end
+        size_t fill(uint8_t* buffer, size_t maxLen);
+
+    private:
+        bool nextLine();
+        bool nextInfoLine();
+        bool nextScalarLine();
+        bool nextRegistryLine();
+        bool formatEntry(const Metrics::Registry::Entry& entry);
+        bool nextInverterLine();
+        bool formatSample(const Family& family, const Sample& sample);
+        bool header(const char* name, const char* help, MetricType_t type);
+
+        std::shared_ptr<Layout const> _layout;
+        std::vector<Metrics::Registry::Entry> _entries;
+
+        enum class Section : uint8_t { Info, Scalar, Registry, Inverter, Done };
+        Section _section = Section::Info;
+        size_t _family = 0;
+        size_t _sample = 0;
+        uint8_t _headerLine = 0;
+
+        char _line[384];
+        size_t _lineLen = 0;
+        size_t _linePos = 0;
+
+        // the sample of a scalar metric is formatted before its header,
+        // which is skipped if the value is not available
+        char _value[32];
+
+        // the buckets of a histogram are copied before its first line, such
+        // that the cumulative counts and the total count are consistent
+        std::array<uint32_t, Metrics::Histogram::MaxBounds + 1> _buckets;
+    };
 };
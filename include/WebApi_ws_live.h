@@ -2,6 +2,7 @@
 #pragma once
 
 #include "Configuration.h"
+#include "MetricsRegistry.h"
 #include <ArduinoJson.h>
 #include <ESPAsyncWebServer.h>
 #include <Hoymiles.h>
@@ -24,6 +25,18 @@ private:
     static void addField(JsonObject& root, std::shared_ptr<InverterAbstract> inv, const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId, String topic = "");
     static void addTotalField(JsonObject& root, const String& name, const float value, const String& unit, const uint8_t digits);
 
+    // adds the members of curr which are missing in or differ from prev to
+    // delta. returns false if prev has members which curr lacks, as the
+    // client cannot learn about removed members from a delta.
+    static bool diffJson(JsonObjectConst prev, JsonObjectConst curr, JsonObject delta);
+    static AsyncWebSocketSharedBuffer serializeFrame(const JsonDocument& root, bool msgPack);
+
+    // sends the frame to the given clients or all clients if nullptr, each
+    // in the format it negotiated.
+    void sendFrame(const JsonDocument& root, const std::vector<uint32_t>* clientIds = nullptr);
+    void sendFullFrame(const std::vector<uint32_t>& clientIds);
+    void resetFrames();
+
     void onLivedataStatus(AsyncWebServerRequest* request);
     void onWebsocketEvent(AsyncWebSocket* server, AsyncWebSocketClient* client, AwsEventType type, void* arg, uint8_t* data, size_t len);
 
@@ -38,11 +51,31 @@ private:
 
     uint32_t _lastPublishStats[INV_MAX_COUNT] = { 0 };
 
+    // the state the connected clients know about, deltas are relative to it
+    JsonDocument _lastCommon;
+    JsonDocument _lastInverters[INV_MAX_COUNT];
+
+    // full frames are sent periodically such that a client which missed
+    // a delta, e.g., as its message queue was full, recovers eventually.
+    static constexpr uint32_t KeyframeIntervalMillis = 60 * 1000;
+    uint32_t _lastKeyframe = 0;
+    bool _keyframeRequested = false;
+
+    // clients which connected or changed their format since the last frame
+    // was sent
+    std::vector<uint32_t> _pendingClients;
+
+    // clients which requested MessagePack instead of JSON frames by sending
+    // {"format":"msgpack"}
+    std::vector<uint32_t> _msgPackClients;
+    std::mutex _clientsMutex;
+
     std::mutex _mutex;
 
     Task _wsCleanupTask;
     void wsCleanupTaskCb();
 
     Task _sendDataTask;
+    std::shared_ptr<Metrics::Histogram> _spSendDataDuration;
     void sendDataTaskCb();
 };
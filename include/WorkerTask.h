@@ -0,0 +1,51 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+// a FreeRTOS task which calls a function until it is stopped, such that I/O
+// which blocks or needs to be polled frequently does not delay the tasks of
+// the cooperative scheduler. results are handed to the scheduler through an
+// SpscQueue or a structure which is thread-safe already.
+//
+// the function must return at least every 100 ms or so, as stop() waits
+// for the current call to return. it must block or delay while idle, as the
+// task would otherwise starve tasks of lower priority on its core.
+class WorkerTask {
+public:
+    // the protocol core, which runs the WiFi and driver tasks. the scheduler
+    // runs on ARDUINO_RUNNING_CORE, which is the other core on dual-core
+    // chips, such that workers and scheduler run in parallel.
+    static constexpr BaseType_t IoCore = 0;
+
+    using Function = std::function<void()>;
+
+    // the name must be a string literal
+    WorkerTask(char const* name, uint32_t stackSize, UBaseType_t priority, BaseType_t core = IoCore);
+    ~WorkerTask();
+
+    WorkerTask(const WorkerTask&) = delete;
+    WorkerTask& operator=(const WorkerTask&) = delete;
+
+    bool start(Function function);
+    void stop();
+
+    bool isRunning() const { return _taskHandle != nullptr; }
+
+private:
+    static void loopHelper(void* context);
+
+    char const* _name;
+    uint32_t _stackSize;
+    UBaseType_t _priority;
+    BaseType_t _core;
+
+    Function _function;
+    TaskHandle_t _taskHandle = nullptr;
+    std::atomic<bool> _stop { false };
+    std::atomic<bool> _taskDone { false };
+};
@@ -4,6 +4,8 @@
 #include <stdint.h>
 #include <driver/twai.h>
 #include <battery/Provider.h>
+#include <SpscQueue.h>
+#include <WorkerTask.h>
 
 namespace Batteries {
 
@@ -25,7 +27,15 @@ protected:
     bool getBit(uint8_t value, uint8_t bit);
 
 private:
+    void receiveLoop();
+
     char const* _providerName = "Battery CAN";
+
+    // twai_receive() blocks, so messages are received by a worker task and
+    // handed to loop(), which runs on the scheduler
+    WorkerTask _receiver { "BatteryCAN", 3072, 1/*prio*/ };
+    SpscQueue<twai_message_t, 32> _rxQueue;
+    uint32_t _reportedDrops = 0;
 };
 
 } // namespace Batteries
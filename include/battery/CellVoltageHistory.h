@@ -0,0 +1,130 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <battery/SerialBmsData.h>
+
+namespace Batteries {
+
+/**
+ * keeps a compact time series of per-cell voltages for balancing analysis.
+ *
+ * the storage is a ring of fixed-size blocks, which is allocated once when
+ * the amount of cells is known. each block starts with the absolute cell
+ * voltages, every following sample is stored as one signed byte per cell,
+ * i.e., as the difference in millivolts against the previous sample. a new
+ * block is started if a difference does not fit, if samples are missing, or
+ * if the block is full. when all blocks are used, the oldest block is
+ * dropped as a whole.
+ *
+ * samples are stored at most once per interval, but every observation is
+ * accounted for in the statistics of the respective block (minimum, maximum,
+ * average, spread and imbalance), such that statistics over the retained
+ * time window are available by merging the block summaries.
+ */
+class CellVoltageHistory {
+public:
+    static constexpr uint8_t SamplesPerBlock = 32;
+    static constexpr size_t MaxCells = CellVoltages::MaxCells;
+
+    CellVoltageHistory(size_t capacityBytes, uint32_t intervalSeconds);
+
+    // timestamp in seconds, which must wrap around at 2^32 (unlike
+    // millis() / 1000). returns true if the observation was stored as a new
+    // sample (as opposed to only being accounted for in statistics).
+    bool add(uint32_t timestamp, CellVoltages const& cells);
+
+    void clear();
+
+    uint32_t getIntervalSeconds() const { return _intervalSeconds; }
+    uint8_t getCellCount() const;
+    size_t getSampleCount() const;
+    size_t getSampleCapacity() const;
+
+    struct CellStats {
+        uint16_t MinMilliVolt = 0;
+        uint16_t MaxMilliVolt = 0;
+        uint16_t AvgMilliVolt = 0;
+
+        // average deviation from the pack's average cell voltage
+        float ImbalanceMilliVolt = 0;
+    };
+
+    struct Summary {
+        uint32_t Observations = 0;
+        uint8_t CellCount = 0;
+        uint16_t SpreadMilliVolt = 0; // latest observation
+        uint16_t MaxSpreadMilliVolt = 0;
+        uint16_t AvgSpreadMilliVolt = 0;
+        std::array<CellStats, MaxCells> Cells = {};
+    };
+
+    // statistics over all observations within the retained time window
+    Summary getSummary() const;
+
+    struct Sample {
+        uint32_t Timestamp = 0;
+        uint8_t CellCount = 0;
+        std::array<uint16_t, MaxCells> MilliVolt = {};
+    };
+
+    // read position which stays valid while samples are added or evicted,
+    // in which case reading continues with the oldest retained sample. a
+    // change of the amount of cells ends reading with this cursor.
+    struct Cursor {
+        uint32_t Generation = 0; // of the series, assigned by the first read
+        uint32_t Block = 0; // sequence number
+        uint8_t Index = 0; // within the block
+        bool HasPrevious = false;
+        Sample Previous;
+    };
+
+    // decodes the sample at the cursor and advances it. returns false if
+    // there are no (more) samples.
+    bool read(Cursor& cursor, Sample& sample) const;
+
+private:
+    struct BlockHeader {
+        uint32_t Sequence;
+        uint32_t Start;
+        uint32_t Observations;
+        uint32_t SpreadSum;
+        uint16_t MaxSpread;
+        uint8_t Samples;
+    };
+
+    void configure(uint8_t cellCount);
+    void startBlock(uint32_t timestamp, CellVoltages const& cells);
+    bool appendSample(CellVoltages const& cells);
+    void observe(CellVoltages const& cells);
+    size_t blockIndex(size_t age) const;
+
+    size_t const _capacityBytes;
+    uint32_t const _intervalSeconds;
+
+    mutable std::mutex _mutex;
+
+    uint8_t _cellCount = 0;
+    uint32_t _generation = 0;
+    size_t _blockCount = 0;
+    size_t _oldest = 0; // index of the oldest block
+    size_t _used = 0; // amount of blocks in use
+    uint32_t _nextSequence = 1;
+    uint32_t _lastStored = 0;
+    uint16_t _lastSpread = 0;
+    std::array<uint16_t, MaxCells> _lastMilliVolt = {};
+
+    std::unique_ptr<BlockHeader[]> _headers;
+    std::unique_ptr<uint16_t[]> _bases;
+    std::unique_ptr<int8_t[]> _deltas;
+    std::unique_ptr<uint16_t[]> _mins;
+    std::unique_ptr<uint16_t[]> _maxs;
+    std::unique_ptr<uint32_t[]> _sums;
+    std::unique_ptr<int32_t[]> _imbalanceSums;
+};
+
+} // namespace Batteries
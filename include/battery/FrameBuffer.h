@@ -0,0 +1,90 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace Batteries {
+
+/**
+ * fixed-capacity byte ring buffer used by the serial BMS providers to
+ * assemble incoming frames without touching the heap. the capacity must be a
+ * power of two, such that indices can be wrapped using a simple mask. all
+ * positions are relative to the oldest byte held by the buffer.
+ */
+template<size_t N>
+class FrameBuffer {
+    static_assert(N > 0 && (N & (N - 1)) == 0, "capacity must be a power of two");
+
+public:
+    static constexpr size_t capacity() { return N; }
+
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+    bool full() const { return _size == N; }
+
+    // returns false if the buffer is full, in which case the byte is dropped.
+    bool push(uint8_t byte)
+    {
+        if (full()) { return false; }
+        _data[(_head + _size) & (N - 1)] = byte;
+        ++_size;
+        return true;
+    }
+
+    // drops the given amount of bytes from the front of the buffer
+    void discard(size_t count)
+    {
+        if (count > _size) { count = _size; }
+        _head = (_head + count) & (N - 1);
+        _size -= count;
+    }
+
+    void clear()
+    {
+        _head = 0;
+        _size = 0;
+    }
+
+    uint8_t operator[](size_t pos) const { return _data[(_head + pos) & (N - 1)]; }
+
+    // reads a big-endian integer at the given position. yields zero if the
+    // value would extend beyond the bytes held by the buffer.
+    template<typename T>
+    T get(size_t pos) const
+    {
+        static_assert(std::is_integral<T>::value, "get() requires an integral type");
+
+        if (pos + sizeof(T) > _size) { return 0; }
+
+        using U = typename std::make_unsigned<T>::type;
+        U res = 0;
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            res = static_cast<U>((res << 8) | (*this)[pos + i]);
+        }
+        return static_cast<T>(res);
+    }
+
+    // calls fnc once or twice with a pointer and a length, such that all
+    // bytes are visited in order without copying them (buffer wraps around).
+    template<typename F>
+    void forEachSegment(F&& fnc) const
+    {
+        if (_size == 0) { return; }
+
+        size_t first = std::min(_size, N - _head);
+        fnc(_data.data() + _head, first);
+
+        if (first < _size) { fnc(_data.data(), _size - first); }
+    }
+
+private:
+    std::array<uint8_t, N> _data = {};
+    size_t _head = 0;
+    size_t _size = 0;
+};
+
+} // namespace Batteries
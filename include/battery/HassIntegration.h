@@ -3,6 +3,7 @@
 
 #include <Arduino.h>
 #include <ArduinoJson.h>
+#include <MqttHassPublisher.h>
 #include <battery/Stats.h>
 #include <memory>
 
@@ -36,6 +37,7 @@ private:
     std::shared_ptr<Stats> _spStats = nullptr;
 
     bool _publishSensors = true;
+    mutable MqttHassPass _pass;
 };
 
 } // namespace Batteries
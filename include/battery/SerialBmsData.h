@@ -0,0 +1,183 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cinttypes>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <optional>
+
+namespace Batteries {
+
+/**
+ * fixed-capacity, always zero-terminated string for text data points decoded
+ * from serial BMS frames. longer input is truncated.
+ */
+template<size_t N>
+class FixedString {
+public:
+    void assign(char const* src, size_t len)
+    {
+        _len = std::min(len, N);
+        std::memcpy(_data.data(), src, _len);
+        _data[_len] = '\0';
+    }
+
+    void assign(char const* src) { assign(src, std::strlen(src)); }
+
+    char* buffer() { return _data.data(); }
+    static constexpr size_t capacity() { return N; }
+    void resize(size_t len) { _len = std::min(len, N); _data[_len] = '\0'; }
+
+    char const* c_str() const { return _data.data(); }
+    size_t size() const { return _len; }
+    bool empty() const { return _len == 0; }
+
+    bool operator==(FixedString const& other) const
+    {
+        return _len == other._len && std::memcmp(_data.data(), other._data.data(), _len) == 0;
+    }
+    bool operator!=(FixedString const& other) const { return !(*this == other); }
+
+private:
+    std::array<char, N + 1> _data = {};
+    size_t _len = 0;
+};
+
+/**
+ * cell voltages in the order reported by the BMS. replaces the map used
+ * before so that decoding a frame does not need to allocate.
+ */
+struct CellVoltages {
+    static constexpr size_t MaxCells = 32;
+
+    std::array<uint16_t, MaxCells> MilliVolt = {};
+    uint8_t Count = 0;
+
+    void clear() { Count = 0; }
+
+    bool add(uint16_t milliVolt)
+    {
+        if (Count >= MaxCells) { return false; }
+        MilliVolt[Count++] = milliVolt;
+        return true;
+    }
+
+    uint16_t const* begin() const { return MilliVolt.data(); }
+    uint16_t const* end() const { return MilliVolt.data() + Count; }
+
+    uint16_t getMin() const { return Count ? *std::min_element(begin(), end()) : 0; }
+    uint16_t getMax() const { return Count ? *std::max_element(begin(), end()) : 0; }
+
+    uint16_t getAvg() const
+    {
+        if (Count == 0) { return 0; }
+        uint32_t sum = 0;
+        for (auto mv : *this) { sum += mv; }
+        return static_cast<uint16_t>(sum / Count);
+    }
+
+    bool operator==(CellVoltages const& other) const
+    {
+        return Count == other.Count && std::equal(begin(), end(), other.begin());
+    }
+    bool operator!=(CellVoltages const& other) const { return !(*this == other); }
+};
+
+/**
+ * allocation-free conversion of data point values to text, used for MQTT
+ * payloads and debug output. the result is truncated to the buffer size.
+ */
+inline void formatDataPointValue(char* buf, size_t len, bool v)
+{
+    snprintf(buf, len, "%s", v ? "yes" : "no");
+}
+
+inline void formatDataPointValue(char* buf, size_t len, uint8_t v) { snprintf(buf, len, "%u", v); }
+inline void formatDataPointValue(char* buf, size_t len, uint16_t v) { snprintf(buf, len, "%u", v); }
+inline void formatDataPointValue(char* buf, size_t len, uint32_t v) { snprintf(buf, len, "%" PRIu32, v); }
+inline void formatDataPointValue(char* buf, size_t len, int16_t v) { snprintf(buf, len, "%d", v); }
+inline void formatDataPointValue(char* buf, size_t len, int32_t v) { snprintf(buf, len, "%" PRId32, v); }
+
+template<size_t N>
+void formatDataPointValue(char* buf, size_t len, FixedString<N> const& v)
+{
+    snprintf(buf, len, "%s", v.c_str());
+}
+
+inline void formatDataPointValue(char* buf, size_t len, CellVoltages const& v)
+{
+    size_t used = snprintf(buf, len, "(");
+    for (uint8_t i = 0; i < v.Count && used < len; ++i) {
+        used += snprintf(buf + used, len - used, "%s%u=%u",
+                (i > 0 ? ", " : ""), i + 1, v.MilliVolt[i]);
+    }
+    if (used < len) { snprintf(buf + used, len - used, ")"); }
+}
+
+/**
+ * common base of the fixed-layout data point snapshots of the serial BMS
+ * providers. the derived struct holds one member per data point, the traits
+ * map each label to its member and to its ordinal index, which is used to
+ * track which data points are actually present.
+ */
+template<typename Derived, typename Label, template<Label> class Traits, size_t Count>
+class DataPointSnapshot {
+public:
+    static constexpr size_t size() { return Count; }
+
+    template<Label L>
+    bool has() const { return _present.test(Traits<L>::index); }
+
+    template<Label L>
+    void set(typename Traits<L>::type const& val)
+    {
+        Traits<L>::of(self()) = val;
+        _present.set(Traits<L>::index);
+    }
+
+    // marks the data point as present and returns its member for in-place
+    // decoding of compound values
+    template<Label L>
+    typename Traits<L>::type& emplace()
+    {
+        _present.set(Traits<L>::index);
+        return Traits<L>::of(self());
+    }
+
+    template<Label L>
+    typename Traits<L>::type const& ref() const { return Traits<L>::of(self()); }
+
+    template<Label L>
+    std::optional<typename Traits<L>::type> get() const
+    {
+        if (!has<L>()) { return std::nullopt; }
+        return ref<L>();
+    }
+
+    // takes over the respective value from other if it is present there and
+    // if it differs from the value currently held. returns true if so.
+    template<Label L>
+    bool mergeFrom(Derived const& other)
+    {
+        if (!other.template has<L>()) { return false; }
+        if (has<L>() && ref<L>() == other.template ref<L>()) { return false; }
+        set<L>(other.template ref<L>());
+        return true;
+    }
+
+    void clear() { _present.reset(); }
+    bool empty() const { return _present.none(); }
+
+private:
+    Derived& self() { return static_cast<Derived&>(*this); }
+    Derived const& self() const { return static_cast<Derived const&>(*this); }
+
+    std::bitset<Count> _present;
+};
+
+} // namespace Batteries
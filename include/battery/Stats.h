@@ -5,10 +5,13 @@
 #include <stdint.h>
 #include <AsyncJson.h>
 #include <cfloat>
+#include <memory>
 #include <string>
 
 namespace Batteries {
 
+class CellVoltageHistory;
+
 // mandatory interface for all kinds of batteries
 class Stats {
 public:
@@ -56,6 +59,10 @@ public:
 
     virtual bool supportsAlarmsAndWarnings() const { return true; };
 
+    // time series of the individual cell voltages. only available for
+    // batteries which report the voltage of each cell.
+    virtual std::shared_ptr<CellVoltageHistory const> getCellVoltageHistory() const { return nullptr; }
+
 protected:
     virtual void mqttPublish() const;
 
@@ -88,6 +95,8 @@ protected:
 
     void setManufacturer(const String& m);
 
+    static std::shared_ptr<CellVoltageHistory> createCellVoltageHistory();
+
     template<typename T>
     static void addLiveViewInSection(JsonVariant& root,
         std::string const& section, std::string const& name,
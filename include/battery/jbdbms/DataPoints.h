@@ -1,10 +1,10 @@
 #pragma once
 
-#include <Arduino.h>
-#include <map>
+#include <cstddef>
+#include <cstdint>
 #include <frozen/map.h>
 #include <frozen/string.h>
-#include <DataPoints.h>
+#include <battery/SerialBmsData.h>
 
 namespace Batteries::JbdBms {
 
@@ -38,80 +38,65 @@ static const frozen::map<AlarmBits, frozen::string, 16> AlarmBitTexts = {
 #undef ALARM_TEXT
 };
 
+/**
+ * single source of truth for all data points reported by the JBD BMS: label,
+ * the type used to store the value, and the unit. the label enum, the
+ * snapshot struct and the traits are generated from this list.
+ */
+#define JBDBMS_DATA_POINTS(fnc) \
+    fnc(CellsMilliVolt,                         tCells,             "mV") \
+    fnc(BatteryTempOneCelsius,                  int16_t,            "°C") \
+    fnc(BatteryTempTwoCelsius,                  int16_t,            "°C") \
+    fnc(BatteryVoltageMilliVolt,                uint32_t,           "mV") \
+    fnc(BatteryCurrentMilliAmps,                int32_t,            "mA") \
+    fnc(BatterySoCPercent,                      uint8_t,            "%") \
+    fnc(BatteryTemperatureSensorAmount,         uint8_t,            "") \
+    fnc(BatteryCycles,                          uint16_t,           "") \
+    fnc(BatteryCellAmount,                      uint16_t,           "") \
+    fnc(AlarmsBitmask,                          uint16_t,           "") \
+    fnc(BalancingEnabled,                       bool,               "") \
+    fnc(CellAmountSetting,                      uint8_t,            "") \
+    fnc(BatteryCapacitySettingAmpHours,         uint32_t,           "Ah") \
+    fnc(BatteryChargeEnabled,                   bool,               "") \
+    fnc(BatteryDischargeEnabled,                bool,               "") \
+    fnc(DateOfManufacturing,                    FixedString<10>,    "") \
+    fnc(BmsSoftwareVersion,                     FixedString<5>,     "") \
+    fnc(BmsHardwareVersion,                     FixedString<31>,    "") \
+    fnc(ActualBatteryCapacityAmpHours,          uint32_t,           "Ah")
+
 enum class DataPointLabel : uint8_t {
-    CellsMilliVolt,
-    BatteryTempOneCelsius,
-    BatteryTempTwoCelsius,
-    BatteryVoltageMilliVolt,
-    BatteryCurrentMilliAmps,
-    BatterySoCPercent,
-    BatteryTemperatureSensorAmount,
-    BatteryCycles,
-    BatteryCellAmount,
-    AlarmsBitmask,
-    BalancingEnabled,
-    CellAmountSetting,
-    BatteryCapacitySettingAmpHours,
-    BatteryChargeEnabled,
-    BatteryDischargeEnabled,
-    DateOfManufacturing,
-    BmsSoftwareVersion,
-    BmsHardwareVersion,
-    ActualBatteryCapacityAmpHours
+#define LABEL_ENUM(n, t, u) n,
+    JBDBMS_DATA_POINTS(LABEL_ENUM)
+#undef LABEL_ENUM
+    Count
 };
 
-using tCells = ::tCellVoltages;
+static constexpr size_t DataPointCount = static_cast<size_t>(DataPointLabel::Count);
+
+using tCells = ::Batteries::CellVoltages;
 
 template<DataPointLabel> struct DataPointLabelTraits;
 
+/**
+ * all data points decoded from the BMS responses, using a fixed layout such
+ * that decoding and keeping the values does not need the heap. the types of
+ * the members are *not* always equal to the type used in the serial message.
+ */
+struct Snapshot : public DataPointSnapshot<Snapshot, DataPointLabel, DataPointLabelTraits, DataPointCount> {
+#define SNAPSHOT_MEMBER(n, t, u) t n = {};
+    JBDBMS_DATA_POINTS(SNAPSHOT_MEMBER)
+#undef SNAPSHOT_MEMBER
+};
+
 #define LABEL_TRAIT(n, t, u) template<> struct DataPointLabelTraits<DataPointLabel::n> { \
     using type = t; \
     static constexpr char const name[] = #n; \
     static constexpr char const unit[] = u; \
+    static constexpr size_t index = static_cast<size_t>(DataPointLabel::n); \
+    static type& of(Snapshot& s) { return s.n; } \
+    static type const& of(Snapshot const& s) { return s.n; } \
 };
-
-/**
- * the types associated with the labels are the types for the respective data
- * points in the JbdBms::DataPoint class. they are *not* always equal to the
- * type used in the serial message.
- *
- * it is unfortunate that we have to repeat all enum values here to define the
- * traits. code generation could help here (labels are defined in a single
- * source of truth and this code is generated -- no typing errors, etc.).
- * however, the compiler will complain if an enum is misspelled or traits are
- * defined for a removed enum, so we will notice. it will also complain when a
- * trait is missing and if a data point for a label without traits is added to
- * the DataPointContainer class, because the traits must be available then.
- * even though this is tedious to maintain, human errors will be caught.
- */
-LABEL_TRAIT(CellsMilliVolt,                         tCells,      "mV");
-LABEL_TRAIT(BatteryTempOneCelsius,                  int16_t,     "°C");
-LABEL_TRAIT(BatteryTempTwoCelsius,                  int16_t,     "°C");
-LABEL_TRAIT(BatteryVoltageMilliVolt,                uint32_t,    "mV");
-LABEL_TRAIT(BatteryCurrentMilliAmps,                int32_t,     "mA");
-LABEL_TRAIT(BatterySoCPercent,                      uint8_t,     "%");
-LABEL_TRAIT(BatteryTemperatureSensorAmount,         uint8_t,     "");
-LABEL_TRAIT(BatteryCycles,                          uint16_t,    "");
-LABEL_TRAIT(BatteryCellAmount,                      uint16_t,    "");
-LABEL_TRAIT(AlarmsBitmask,                          uint16_t,    "");
-LABEL_TRAIT(BalancingEnabled,                       bool,        "");
-LABEL_TRAIT(CellAmountSetting,                      uint8_t,     "");
-LABEL_TRAIT(BatteryCapacitySettingAmpHours,         uint32_t,    "Ah");
-LABEL_TRAIT(BatteryChargeEnabled,                   bool,        "");
-LABEL_TRAIT(BatteryDischargeEnabled,                bool,        "");
-LABEL_TRAIT(DateOfManufacturing,                    std::string, "");
-LABEL_TRAIT(BmsSoftwareVersion,                     std::string, "");
-LABEL_TRAIT(BmsHardwareVersion,                     std::string, "");
-LABEL_TRAIT(ActualBatteryCapacityAmpHours,          uint32_t,    "Ah");
+JBDBMS_DATA_POINTS(LABEL_TRAIT)
 #undef LABEL_TRAIT
 
 } // namespace Batteries::JbdBms
-
-using JbdBmsDataPoint = DataPoint<bool, uint8_t, uint16_t, uint32_t,
-              int16_t, int32_t, std::string, Batteries::JbdBms::tCells>;
-
-template class DataPointContainer<JbdBmsDataPoint, Batteries::JbdBms::DataPointLabel, Batteries::JbdBms::DataPointLabelTraits>;
-
-namespace Batteries::JbdBms {
-    using DataPointContainer = DataPointContainer<JbdBmsDataPoint, DataPointLabel, DataPointLabelTraits>;
-} // namespace Batteries::JbdBms
@@ -0,0 +1,47 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <cstdint>
+#include <battery/FrameBuffer.h>
+#include <battery/jbdbms/DataPoints.h>
+#include <battery/jbdbms/SerialMessage.h>
+
+namespace Batteries::JbdBms {
+
+// the data length is a single byte, so frames never exceed 262 bytes
+using tFrameBuffer = ::Batteries::FrameBuffer<512>;
+
+/**
+ * decodes JBD BMS response frames straight from the receive buffer into a
+ * fixed-layout snapshot. neither the parser nor the snapshot use the heap.
+ */
+class FrameParser {
+public:
+    enum class Result : uint8_t {
+        Ok,
+        InvalidStartMarker,
+        InvalidDataLength,
+        InvalidEndMarker,
+        InvalidChecksum,
+        InvalidStatus
+    };
+
+    static char const* getResultText(Result result);
+
+    // the snapshot is cleared before decoding the frame into it
+    static Result parse(tFrameBuffer const& frame, Snapshot& snapshot);
+
+    static SerialMessage::Command getCommand(tFrameBuffer const& frame) {
+        return static_cast<SerialMessage::Command>(frame[1]);
+    }
+
+private:
+    enum class Status : uint8_t {
+        Ok = 0x00,
+        Error = 0x80
+    };
+
+    static Result validate(tFrameBuffer const& frame);
+};
+
+} // namespace Batteries::JbdBms
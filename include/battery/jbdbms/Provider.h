@@ -8,6 +8,7 @@
 #include <battery/jbdbms/Stats.h>
 #include <battery/jbdbms/DataPoints.h>
 #include <battery/jbdbms/SerialMessage.h>
+#include <battery/jbdbms/FrameParser.h>
 #include <battery/jbdbms/HassIntegration.h>
 
 namespace Batteries::JbdBms {
@@ -47,7 +48,7 @@ private:
     void rxData(uint8_t inbyte);
     void reset();
     void frameComplete();
-    void processDataPoints(DataPointContainer const& dataPoints);
+    void processDataPoints();
 
     enum class Interface : unsigned {
         Invalid,
@@ -80,7 +81,8 @@ private:
     uint32_t _lastStatusPrinted = 0;
     uint32_t _lastRequest = 0;
     uint8_t _dataLength = 0;
-    JbdBms::SerialResponse::tData _buffer = {};
+    tFrameBuffer _buffer;
+    Snapshot _snapshot;
     std::shared_ptr<Stats> _stats;
     std::shared_ptr<HassIntegration> _hassIntegration;
 };
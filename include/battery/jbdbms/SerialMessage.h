@@ -1,20 +1,13 @@
 #pragma once
 
-#include <utility>
-#include <vector>
-#include <Arduino.h>
-
-#include <battery/jbdbms/DataPoints.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
 
 namespace Batteries::JbdBms {
 
-// Only valid for receiving messages
 class SerialMessage {
     public:
-        using tData = std::vector<uint8_t>;
-
-        SerialMessage() = delete;
-
         enum class Command : uint8_t {
             Init = 0x00,
             ReadBasicInformation = 0x03,
@@ -23,55 +16,14 @@ class SerialMessage {
             ControlMosInstruction = 0xE1,
         };
 
-        uint8_t getStartMarker() const { return _raw[0]; }
-        virtual Command getCommand() const = 0;
-        uint8_t getDataLength() const { return _raw[3]; }
-        uint16_t getChecksum() const { return get<uint16_t>(_raw.cend()-3); }
-        uint8_t getEndMarker() const { return *(_raw.cend()-1); }
-
-        bool isValid() const;
-
-        uint8_t const* data() { return _raw.data(); }
-        size_t size() { return _raw.size(); }
-
         static constexpr uint8_t startMarker = 0xDD;
         static constexpr uint8_t endMarker = 0x77;
 
-    protected:
-        template <typename... Args>
-        explicit SerialMessage(Args&&... args) : _raw(std::forward<Args>(args)...) { }
-
-        template<typename T, typename It> T get(It&& pos) const;
-        template<typename It> bool getBool(It&& pos) const;
-        template<typename It> int16_t getTemperature(It&& pos) const;
-        template<typename It> std::string getString(It&& pos, size_t len, bool replaceZeroes = false) const;
-        template<typename It> std::string getProductionDate(It&& pos) const;
-        template<typename T> void set(tData::iterator const& pos, T val);
-        uint16_t calcChecksum() const;
-        void updateChecksum();
-
-        tData _raw;
-        DataPointContainer _dp;
-};
-
-class SerialResponse : public SerialMessage {
-    public:
-        enum class Status : uint8_t {
-            Ok = 0x00,
-            Error = 0x80
-        };
-
-        using tData = SerialMessage::tData;
-        explicit SerialResponse(tData&& raw);
-
-        Command getCommand() const { return static_cast<Command>(_raw[1]); }
-        Status getStatus() const { return static_cast<Status>(_raw[2]); }
-
-        bool isValid() const;
-
-        DataPointContainer const& getDataPoints() const { return _dp; }
+        // start marker, status, command, data length, checksum, end marker
+        static constexpr size_t overhead = 7;
 };
 
+// responses are decoded by the FrameParser, only commands are assembled here
 class SerialCommand : public SerialMessage {
     public:
         enum class Status : uint8_t {
@@ -85,9 +37,15 @@ class SerialCommand : public SerialMessage {
         Command getCommand() const { return static_cast<Command>(_raw[2]); }
         static Command getLastCommand() { return _lastCmd; }
 
-        bool isValid() const;
+        uint8_t const* data() const { return _raw.data(); }
+        size_t size() const { return _raw.size(); }
 
     private:
+        template<typename T> void set(size_t pos, T val);
+        uint16_t calcChecksum() const;
+
+        std::array<uint8_t, overhead> _raw = {};
+
         static Command _lastCmd;
 };
 
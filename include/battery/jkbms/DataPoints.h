@@ -1,10 +1,10 @@
 #pragma once
 
-#include <Arduino.h>
-#include <map>
+#include <cstddef>
+#include <cstdint>
 #include <frozen/map.h>
 #include <frozen/string.h>
-#include <DataPoints.h>
+#include <battery/SerialBmsData.h>
 
 namespace Batteries::JkBms {
 
@@ -56,160 +56,113 @@ static const frozen::map<StatusBits, frozen::string, 4> StatusBitTexts = {
 #undef STATUS_TEXT
 };
 
+/**
+ * single source of truth for all data points reported by the JK BMS: label,
+ * field type as used in the serial protocol, the type used to store the
+ * value, and the unit. the label enum, the snapshot struct and the traits are
+ * generated from this list, so they cannot get out of sync.
+ */
+#define JKBMS_DATA_POINTS(fnc) \
+    fnc(CellsMilliVolt,                         0x79, tCells,             "mV") \
+    fnc(BmsTempCelsius,                         0x80, int16_t,            "°C") \
+    fnc(BatteryTempOneCelsius,                  0x81, int16_t,            "°C") \
+    fnc(BatteryTempTwoCelsius,                  0x82, int16_t,            "°C") \
+    fnc(BatteryVoltageMilliVolt,                0x83, uint32_t,           "mV") \
+    fnc(BatteryCurrentMilliAmps,                0x84, int32_t,            "mA") \
+    fnc(BatterySoCPercent,                      0x85, uint8_t,            "%") \
+    fnc(BatteryTemperatureSensorAmount,         0x86, uint8_t,            "") \
+    fnc(BatteryCycles,                          0x87, uint16_t,           "") \
+    fnc(BatteryCycleCapacity,                   0x89, uint32_t,           "Ah") \
+    fnc(BatteryCellAmount,                      0x8a, uint16_t,           "") \
+    fnc(AlarmsBitmask,                          0x8b, uint16_t,           "") \
+    fnc(StatusBitmask,                          0x8c, uint16_t,           "") \
+    fnc(TotalOvervoltageThresholdMilliVolt,     0x8e, uint32_t,           "mV") \
+    fnc(TotalUndervoltageThresholdMilliVolt,    0x8f, uint32_t,           "mV") \
+    fnc(CellOvervoltageThresholdMilliVolt,      0x90, uint16_t,           "mV") \
+    fnc(CellOvervoltageRecoveryMilliVolt,       0x91, uint16_t,           "mV") \
+    fnc(CellOvervoltageProtectionDelaySeconds,  0x92, uint16_t,           "s") \
+    fnc(CellUndervoltageThresholdMilliVolt,     0x93, uint16_t,           "mV") \
+    fnc(CellUndervoltageRecoveryMilliVolt,      0x94, uint16_t,           "mV") \
+    fnc(CellUndervoltageProtectionDelaySeconds, 0x95, uint16_t,           "s") \
+    fnc(CellVoltageDiffThresholdMilliVolt,      0x96, uint16_t,           "mV") \
+    fnc(DischargeOvercurrentThresholdAmperes,   0x97, uint16_t,           "A") \
+    fnc(DischargeOvercurrentDelaySeconds,       0x98, uint16_t,           "s") \
+    fnc(ChargeOvercurrentThresholdAmps,         0x99, uint16_t,           "A") \
+    fnc(ChargeOvercurrentDelaySeconds,          0x9a, uint16_t,           "s") \
+    fnc(BalanceCellVoltageThresholdMilliVolt,   0x9b, uint16_t,           "mV") \
+    fnc(BalanceVoltageDiffThresholdMilliVolt,   0x9c, uint16_t,           "mV") \
+    fnc(BalancingEnabled,                       0x9d, bool,               "") \
+    fnc(BmsTempProtectionThresholdCelsius,      0x9e, uint16_t,           "°C") \
+    fnc(BmsTempRecoveryThresholdCelsius,        0x9f, uint16_t,           "°C") \
+    fnc(BatteryTempProtectionThresholdCelsius,  0xa0, uint16_t,           "°C") \
+    fnc(BatteryTempRecoveryThresholdCelsius,    0xa1, uint16_t,           "°C") \
+    fnc(BatteryTempDiffThresholdCelsius,        0xa2, uint16_t,           "°C") \
+    fnc(ChargeHighTempThresholdCelsius,         0xa3, uint16_t,           "°C") \
+    fnc(DischargeHighTempThresholdCelsius,      0xa4, uint16_t,           "°C") \
+    fnc(ChargeLowTempThresholdCelsius,          0xa5, int16_t,            "°C") \
+    fnc(ChargeLowTempRecoveryCelsius,           0xa6, int16_t,            "°C") \
+    fnc(DischargeLowTempThresholdCelsius,       0xa7, int16_t,            "°C") \
+    fnc(DischargeLowTempRecoveryCelsius,        0xa8, int16_t,            "°C") \
+    fnc(CellAmountSetting,                      0xa9, uint8_t,            "") \
+    fnc(BatteryCapacitySettingAmpHours,         0xaa, uint32_t,           "Ah") \
+    fnc(BatteryChargeEnabled,                   0xab, bool,               "") \
+    fnc(BatteryDischargeEnabled,                0xac, bool,               "") \
+    fnc(CurrentCalibrationMilliAmps,            0xad, uint16_t,           "mA") \
+    fnc(BmsAddress,                             0xae, uint8_t,            "") \
+    fnc(BatteryType,                            0xaf, uint8_t,            "") \
+    fnc(SleepWaitTime,                          0xb0, uint16_t,           "s") /* what's this? */ \
+    fnc(LowCapacityAlarmThresholdPercent,       0xb1, uint8_t,            "%") \
+    fnc(ModificationPassword,                   0xb2, FixedString<10>,    "") \
+    fnc(DedicatedChargerSwitch,                 0xb3, bool,               "") /* what's this? */ \
+    fnc(EquipmentId,                            0xb4, FixedString<8>,     "") \
+    fnc(DateOfManufacturing,                    0xb5, FixedString<4>,     "") \
+    fnc(BmsHourMeterMinutes,                    0xb6, uint32_t,           "min") \
+    fnc(BmsSoftwareVersion,                     0xb7, FixedString<15>,    "") \
+    fnc(CurrentCalibration,                     0xb8, bool,               "") \
+    fnc(ActualBatteryCapacityAmpHours,          0xb9, uint32_t,           "Ah") \
+    fnc(ProductId,                              0xba, FixedString<24>,    "") \
+    fnc(ProtocolVersion,                        0xc0, uint8_t,            "")
+
 enum class DataPointLabel : uint8_t {
-    CellsMilliVolt = 0x79,
-    BmsTempCelsius = 0x80,
-    BatteryTempOneCelsius = 0x81,
-    BatteryTempTwoCelsius = 0x82,
-    BatteryVoltageMilliVolt = 0x83,
-    BatteryCurrentMilliAmps = 0x84,
-    BatterySoCPercent = 0x85,
-    BatteryTemperatureSensorAmount = 0x86,
-    BatteryCycles = 0x87,
-    BatteryCycleCapacity = 0x89,
-    BatteryCellAmount = 0x8a,
-    AlarmsBitmask = 0x8b,
-    StatusBitmask = 0x8c,
-    TotalOvervoltageThresholdMilliVolt = 0x8e,
-    TotalUndervoltageThresholdMilliVolt = 0x8f,
-    CellOvervoltageThresholdMilliVolt = 0x90,
-    CellOvervoltageRecoveryMilliVolt = 0x91,
-    CellOvervoltageProtectionDelaySeconds = 0x92,
-    CellUndervoltageThresholdMilliVolt = 0x93,
-    CellUndervoltageRecoveryMilliVolt = 0x94,
-    CellUndervoltageProtectionDelaySeconds = 0x95,
-    CellVoltageDiffThresholdMilliVolt = 0x96,
-    DischargeOvercurrentThresholdAmperes = 0x97,
-    DischargeOvercurrentDelaySeconds = 0x98,
-    ChargeOvercurrentThresholdAmps = 0x99,
-    ChargeOvercurrentDelaySeconds = 0x9a,
-    BalanceCellVoltageThresholdMilliVolt = 0x9b,
-    BalanceVoltageDiffThresholdMilliVolt = 0x9c,
-    BalancingEnabled = 0x9d,
-    BmsTempProtectionThresholdCelsius = 0x9e,
-    BmsTempRecoveryThresholdCelsius = 0x9f,
-    BatteryTempProtectionThresholdCelsius = 0xa0,
-    BatteryTempRecoveryThresholdCelsius = 0xa1,
-    BatteryTempDiffThresholdCelsius = 0xa2,
-    ChargeHighTempThresholdCelsius = 0xa3,
-    DischargeHighTempThresholdCelsius = 0xa4,
-    ChargeLowTempThresholdCelsius = 0xa5,
-    ChargeLowTempRecoveryCelsius = 0xa6,
-    DischargeLowTempThresholdCelsius = 0xa7,
-    DischargeLowTempRecoveryCelsius = 0xa8,
-    CellAmountSetting = 0xa9,
-    BatteryCapacitySettingAmpHours = 0xaa,
-    BatteryChargeEnabled = 0xab,
-    BatteryDischargeEnabled = 0xac,
-    CurrentCalibrationMilliAmps = 0xad,
-    BmsAddress = 0xae,
-    BatteryType = 0xaf,
-    SleepWaitTime = 0xb0, // what's this?
-    LowCapacityAlarmThresholdPercent = 0xb1,
-    ModificationPassword = 0xb2,
-    DedicatedChargerSwitch = 0xb3, // what's this?
-    EquipmentId = 0xb4,
-    DateOfManufacturing = 0xb5,
-    BmsHourMeterMinutes = 0xb6,
-    BmsSoftwareVersion = 0xb7,
-    CurrentCalibration = 0xb8,
-    ActualBatteryCapacityAmpHours = 0xb9,
-    ProductId = 0xba,
-    ProtocolVersion = 0xc0
+#define LABEL_ENUM(n, id, t, u) n = id,
+    JKBMS_DATA_POINTS(LABEL_ENUM)
+#undef LABEL_ENUM
+};
+
+// ordinal position of each data point, used to track its presence
+enum class DataPointIndex : uint8_t {
+#define INDEX_ENUM(n, id, t, u) n,
+    JKBMS_DATA_POINTS(INDEX_ENUM)
+#undef INDEX_ENUM
+    Count
 };
 
-using tCells = tCellVoltages;
+static constexpr size_t DataPointCount = static_cast<size_t>(DataPointIndex::Count);
+
+using tCells = ::Batteries::CellVoltages;
 
 template<DataPointLabel> struct DataPointLabelTraits;
 
-#define LABEL_TRAIT(n, t, u) template<> struct DataPointLabelTraits<DataPointLabel::n> { \
+/**
+ * all data points decoded from one or more frames, using a fixed layout such
+ * that decoding and keeping the values does not need the heap. the types of
+ * the members are *not* always equal to the type used in the serial message.
+ */
+struct Snapshot : public DataPointSnapshot<Snapshot, DataPointLabel, DataPointLabelTraits, DataPointCount> {
+#define SNAPSHOT_MEMBER(n, id, t, u) t n = {};
+    JKBMS_DATA_POINTS(SNAPSHOT_MEMBER)
+#undef SNAPSHOT_MEMBER
+};
+
+#define LABEL_TRAIT(n, id, t, u) template<> struct DataPointLabelTraits<DataPointLabel::n> { \
     using type = t; \
     static constexpr char const name[] = #n; \
     static constexpr char const unit[] = u; \
+    static constexpr size_t index = static_cast<size_t>(DataPointIndex::n); \
+    static type& of(Snapshot& s) { return s.n; } \
+    static type const& of(Snapshot const& s) { return s.n; } \
 };
-
-/**
- * the types associated with the labels are the types for the respective data
- * points in the JkBms::DataPoint class. they are *not* always equal to the
- * type used in the serial message.
- *
- * it is unfortunate that we have to repeat all enum values here to define the
- * traits. code generation could help here (labels are defined in a single
- * source of truth and this code is generated -- no typing errors, etc.).
- * however, the compiler will complain if an enum is misspelled or traits are
- * defined for a removed enum, so we will notice. it will also complain when a
- * trait is missing and if a data point for a label without traits is added to
- * the DataPointContainer class, because the traits must be available then.
- * even though this is tedious to maintain, human errors will be caught.
- */
-LABEL_TRAIT(CellsMilliVolt,                         tCells,      "mV");
-LABEL_TRAIT(BmsTempCelsius,                         int16_t,     "°C");
-LABEL_TRAIT(BatteryTempOneCelsius,                  int16_t,     "°C");
-LABEL_TRAIT(BatteryTempTwoCelsius,                  int16_t,     "°C");
-LABEL_TRAIT(BatteryVoltageMilliVolt,                uint32_t,    "mV");
-LABEL_TRAIT(BatteryCurrentMilliAmps,                int32_t,     "mA");
-LABEL_TRAIT(BatterySoCPercent,                      uint8_t,     "%");
-LABEL_TRAIT(BatteryTemperatureSensorAmount,         uint8_t,     "");
-LABEL_TRAIT(BatteryCycles,                          uint16_t,    "");
-LABEL_TRAIT(BatteryCycleCapacity,                   uint32_t,    "Ah");
-LABEL_TRAIT(BatteryCellAmount,                      uint16_t,    "");
-LABEL_TRAIT(AlarmsBitmask,                          uint16_t,    "");
-LABEL_TRAIT(StatusBitmask,                          uint16_t,    "");
-LABEL_TRAIT(TotalOvervoltageThresholdMilliVolt,     uint32_t,    "mV");
-LABEL_TRAIT(TotalUndervoltageThresholdMilliVolt,    uint32_t,    "mV");
-LABEL_TRAIT(CellOvervoltageThresholdMilliVolt,      uint16_t,    "mV");
-LABEL_TRAIT(CellOvervoltageRecoveryMilliVolt,       uint16_t,    "mV");
-LABEL_TRAIT(CellOvervoltageProtectionDelaySeconds,  uint16_t,    "s");
-LABEL_TRAIT(CellUndervoltageThresholdMilliVolt,     uint16_t,    "mV");
-LABEL_TRAIT(CellUndervoltageRecoveryMilliVolt,      uint16_t,    "mV");
-LABEL_TRAIT(CellUndervoltageProtectionDelaySeconds, uint16_t,    "s");
-LABEL_TRAIT(CellVoltageDiffThresholdMilliVolt,      uint16_t,    "mV");
-LABEL_TRAIT(DischargeOvercurrentThresholdAmperes,   uint16_t,    "A");
-LABEL_TRAIT(DischargeOvercurrentDelaySeconds,       uint16_t,    "s");
-LABEL_TRAIT(ChargeOvercurrentThresholdAmps,         uint16_t,    "A");
-LABEL_TRAIT(ChargeOvercurrentDelaySeconds,          uint16_t,    "s");
-LABEL_TRAIT(BalanceCellVoltageThresholdMilliVolt,   uint16_t,    "mV");
-LABEL_TRAIT(BalanceVoltageDiffThresholdMilliVolt,   uint16_t,    "mV");
-LABEL_TRAIT(BalancingEnabled,                       bool,        "");
-LABEL_TRAIT(BmsTempProtectionThresholdCelsius,      uint16_t,    "°C");
-LABEL_TRAIT(BmsTempRecoveryThresholdCelsius,        uint16_t,    "°C");
-LABEL_TRAIT(BatteryTempProtectionThresholdCelsius,  uint16_t,    "°C");
-LABEL_TRAIT(BatteryTempRecoveryThresholdCelsius,    uint16_t,    "°C");
-LABEL_TRAIT(BatteryTempDiffThresholdCelsius,        uint16_t,    "°C");
-LABEL_TRAIT(ChargeHighTempThresholdCelsius,         uint16_t,    "°C");
-LABEL_TRAIT(DischargeHighTempThresholdCelsius,      uint16_t,    "°C");
-LABEL_TRAIT(ChargeLowTempThresholdCelsius,          int16_t,     "°C");
-LABEL_TRAIT(ChargeLowTempRecoveryCelsius,           int16_t,     "°C");
-LABEL_TRAIT(DischargeLowTempThresholdCelsius,       int16_t,     "°C");
-LABEL_TRAIT(DischargeLowTempRecoveryCelsius,        int16_t,     "°C");
-LABEL_TRAIT(CellAmountSetting,                      uint8_t,     "");
-LABEL_TRAIT(BatteryCapacitySettingAmpHours,         uint32_t,    "Ah");
-LABEL_TRAIT(BatteryChargeEnabled,                   bool,        "");
-LABEL_TRAIT(BatteryDischargeEnabled,                bool,        "");
-LABEL_TRAIT(CurrentCalibrationMilliAmps,            uint16_t,    "mA");
-LABEL_TRAIT(BmsAddress,                             uint8_t,     "");
-LABEL_TRAIT(BatteryType,                            uint8_t,     "");
-LABEL_TRAIT(SleepWaitTime,                          uint16_t,    "s");
-LABEL_TRAIT(LowCapacityAlarmThresholdPercent,       uint8_t,     "%");
-LABEL_TRAIT(ModificationPassword,                   std::string, "");
-LABEL_TRAIT(DedicatedChargerSwitch,                 bool,        "");
-LABEL_TRAIT(EquipmentId,                            std::string, "");
-LABEL_TRAIT(DateOfManufacturing,                    std::string, "");
-LABEL_TRAIT(BmsHourMeterMinutes,                    uint32_t,    "min");
-LABEL_TRAIT(BmsSoftwareVersion,                     std::string, "");
-LABEL_TRAIT(CurrentCalibration,                     bool,        "");
-LABEL_TRAIT(ActualBatteryCapacityAmpHours,          uint32_t,    "Ah");
-LABEL_TRAIT(ProductId,                              std::string, "");
-LABEL_TRAIT(ProtocolVersion,                        uint8_t,     "");
+JKBMS_DATA_POINTS(LABEL_TRAIT)
 #undef LABEL_TRAIT
 
 } // namespace Batteries::JkBms
-
-using JkBmsDataPoint = DataPoint<bool, uint8_t, uint16_t, uint32_t,
-              int16_t, int32_t, std::string, Batteries::JkBms::tCells>;
-
-template class DataPointContainer<JkBmsDataPoint, Batteries::JkBms::DataPointLabel, Batteries::JkBms::DataPointLabelTraits>;
-
-namespace Batteries::JkBms {
-    using DataPointContainer = DataPointContainer<JkBmsDataPoint, DataPointLabel, DataPointLabelTraits>;
-} // namespace Batteries::JkBms
@@ -0,0 +1,46 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <cstdint>
+#include <battery/FrameBuffer.h>
+#include <battery/jkbms/DataPoints.h>
+
+namespace Batteries::JkBms {
+
+// a full "read all" response of a 24 cell BMS is less than 400 bytes
+using tFrameBuffer = ::Batteries::FrameBuffer<512>;
+
+/**
+ * decodes JK BMS response frames straight from the receive buffer into a
+ * fixed-layout snapshot. neither the parser nor the snapshot use the heap.
+ */
+class FrameParser {
+public:
+    enum class Result : uint8_t {
+        Ok,
+        InvalidStartMarker,
+        InvalidFrameLength,
+        InvalidEndMarker,
+        InvalidChecksum,
+        UnknownFieldType // data points decoded up to the unknown field are valid
+    };
+
+    static char const* getResultText(Result result);
+
+    // the snapshot is cleared before decoding the frame into it
+    Result parse(tFrameBuffer const& frame, Snapshot& snapshot);
+
+    uint8_t getUnknownFieldType() const { return _unknownFieldType; }
+
+    // the protocol version is reported by the BMS and is needed to decode the
+    // battery current, hence the first frame will lack the current value.
+    uint8_t getProtocolVersion() const { return _protocolVersion; }
+
+private:
+    Result validate(tFrameBuffer const& frame) const;
+
+    uint8_t _protocolVersion = -1;
+    uint8_t _unknownFieldType = 0;
+};
+
+} // namespace Batteries::JkBms
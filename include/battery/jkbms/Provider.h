@@ -8,6 +8,7 @@
 #include <battery/jkbms/Stats.h>
 #include <battery/jkbms/DataPoints.h>
 #include <battery/jkbms/SerialMessage.h>
+#include <battery/jkbms/FrameParser.h>
 #include <battery/jkbms/Dummy.h>
 #include <battery/jkbms/HassIntegration.h>
 
@@ -50,7 +51,7 @@ private:
     void rxData(uint8_t inbyte);
     void reset();
     void frameComplete();
-    void processDataPoints(DataPointContainer const& dataPoints);
+    void processDataPoints();
 
     enum class Interface : unsigned {
         Invalid,
@@ -79,8 +80,9 @@ private:
     uint32_t _lastStatusPrinted = 0;
     uint32_t _lastRequest = 0;
     uint16_t _frameLength = 0;
-    uint8_t _protocolVersion = -1;
-    SerialResponse::tData _buffer = {};
+    tFrameBuffer _buffer;
+    FrameParser _parser;
+    Snapshot _snapshot;
     std::shared_ptr<Stats> _stats;
     std::shared_ptr<HassIntegration> _hassIntegration;
 };
@@ -1,19 +1,13 @@
 #pragma once
 
-#include <utility>
-#include <vector>
-#include <Arduino.h>
-
-#include <battery/jkbms/DataPoints.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
 
 namespace Batteries::JkBms {
 
 class SerialMessage {
     public:
-        using tData = std::vector<uint8_t>;
-
-        SerialMessage() = delete;
-
         enum class Command : uint8_t {
             Activate = 0x01,
             Write = 0x02,
@@ -22,72 +16,41 @@ class SerialMessage {
             ReadAll = 0x06
         };
 
-        Command getCommand() const { return static_cast<Command>(_raw[8]); }
-
         enum class Source : uint8_t {
             BMS = 0x00,
             Bluetooth = 0x01,
             GPS = 0x02,
             Host = 0x03
         };
-        Source getSource() const { return static_cast<Source>(_raw[9]); }
 
         enum class Type : uint8_t {
             Command = 0x00,
             Response = 0x01,
             Unsolicited = 0x02
         };
-        Type getType() const { return static_cast<Type>(_raw[10]); }
-
-        // this does *not* include the two byte start marker
-        uint16_t getFrameLength() const { return get<uint16_t>(_raw.cbegin()+2); }
-
-        uint32_t getTerminalId() const { return get<uint32_t>(_raw.cbegin()+4); }
-
-        // there are 20 bytes of overhead. two of those are the start marker
-        // bytes, which are *not* counted by the frame length.
-        uint16_t getVariableFieldLength() const { return getFrameLength() - 18; }
-
-        // the upper byte of the 4-byte "record number" is reserved (for encryption)
-        uint32_t getSequence() const { return get<uint32_t>(_raw.cend()-9) >> 8; }
-
-        bool isValid() const;
-
-        uint8_t const* data() { return _raw.data(); }
-        size_t size() { return _raw.size(); }
-
-    protected:
-        template <typename... Args>
-        explicit SerialMessage(Args&&... args) : _raw(std::forward<Args>(args)...) { }
-
-        template<typename T, typename It> T get(It&& pos) const;
-        template<typename It> bool getBool(It&& pos) const;
-        template<typename It> int16_t getTemperature(It&& pos) const;
-        template<typename It> std::string getString(It&& pos, size_t len, bool replaceZeroes = false) const;
-        void processBatteryCurrent(tData::const_iterator& pos, uint8_t protocolVersion);
-        template<typename T> void set(tData::iterator const& pos, T val);
-        uint16_t calcChecksum() const;
-        void updateChecksum();
-
-        tData _raw;
-        DataPointContainer _dp;
 
         static constexpr uint16_t startMarker = 0x4e57;
         static constexpr uint8_t endMarker = 0x68;
-};
-
-class SerialResponse : public SerialMessage {
-    public:
-        using tData = SerialMessage::tData;
-        explicit SerialResponse(tData&& raw, uint8_t protocolVersion = -1);
 
-        DataPointContainer const& getDataPoints() const { return _dp; }
+        // there are 20 bytes of overhead. two of those are the start marker
+        // bytes, which are *not* counted by the frame length.
+        static constexpr size_t overhead = 20;
 };
 
+// responses are decoded by the FrameParser, only commands are assembled here
 class SerialCommand : public SerialMessage {
     public:
         using Command = SerialMessage::Command;
         explicit SerialCommand(Command cmd);
+
+        uint8_t const* data() const { return _raw.data(); }
+        size_t size() const { return _raw.size(); }
+
+    private:
+        template<typename T> void set(size_t pos, T val);
+        uint16_t calcChecksum() const;
+
+        std::array<uint8_t, overhead> _raw = {};
 };
 
 } // namespace Batteries::JkBms
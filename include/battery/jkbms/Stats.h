@@ -1,7 +1,9 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 #pragma once
 
+#include <array>
 #include <battery/Stats.h>
+#include <battery/CellVoltageHistory.h>
 #include <battery/jkbms/DataPoints.h>
 
 namespace Batteries::JkBms {
@@ -21,12 +23,21 @@ public:
     uint32_t getMqttFullPublishIntervalMs() const final { return 60 * 1000; }
     std::optional<String> getHassDeviceName() const final;
 
-    void updateFrom(DataPointContainer const& dp);
+    std::shared_ptr<CellVoltageHistory const> getCellVoltageHistory() const final { return _spCellHistory; }
+
+    void updateFrom(Snapshot const& snapshot);
 
 private:
     void getJsonData(JsonVariant& root, bool verbose) const;
 
-    DataPointContainer _dataPoints;
+    template<DataPointLabel L>
+    bool merge(Snapshot const& snapshot, uint32_t timestamp);
+
+    template<DataPointLabel L>
+    void publishDataPoint(bool fullPublish) const;
+
+    Snapshot _snapshot;
+    std::array<uint32_t, DataPointCount> _timestamps = {};
     mutable uint32_t _lastMqttPublish = 0;
     mutable uint32_t _lastFullMqttPublish = 0;
 
@@ -34,6 +45,8 @@ private:
     uint16_t _cellAvgMilliVolt = 0;
     uint16_t _cellMaxMilliVolt = 0;
     uint32_t _cellVoltageTimestamp = 0;
+
+    std::shared_ptr<CellVoltageHistory> _spCellHistory = createCellVoltageHistory();
 };
 
 } // namespace Batteries::JkBms
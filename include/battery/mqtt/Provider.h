@@ -2,6 +2,7 @@
 
 #include <memory>
 #include <espMqttClient.h>
+#include <JsonPathExtractor.h>
 #include <battery/Provider.h>
 #include <battery/mqtt/Stats.h>
 
@@ -22,22 +23,26 @@ private:
     String _voltageTopic;
     String _currentTopic;
     String _dischargeCurrentLimitTopic;
+    JsonPathExtractor _socExtractor;
+    JsonPathExtractor _voltageExtractor;
+    JsonPathExtractor _currentExtractor;
+    JsonPathExtractor _dischargeCurrentLimitExtractor;
     std::shared_ptr<Stats> _stats = std::make_shared<Stats>();
     uint8_t _socPrecision = 0;
     uint8_t _currentPrecision = 0;
 
     void onMqttMessageSoC(espMqttClientTypes::MessageProperties const& properties,
             char const* topic, uint8_t const* payload, size_t len,
-            char const* jsonPath);
+            JsonPathExtractor const* extractor);
     void onMqttMessageVoltage(espMqttClientTypes::MessageProperties const& properties,
             char const* topic, uint8_t const* payload, size_t len,
-            char const* jsonPath);
+            JsonPathExtractor const* extractor);
     void onMqttMessageCurrent(espMqttClientTypes::MessageProperties const& properties,
             char const* topic, uint8_t const* payload, size_t len,
-            char const* jsonPath);
+            JsonPathExtractor const* extractor);
     void onMqttMessageDischargeCurrentLimit(espMqttClientTypes::MessageProperties const& properties,
             char const* topic, uint8_t const* payload, size_t len,
-            char const* jsonPath);
+            JsonPathExtractor const* extractor);
     uint8_t calculatePrecision(float value);
 };
 
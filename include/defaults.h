@@ -80,7 +80,11 @@
 #define MQTT_LWT_OFFLINE "offline"
 #define MQTT_LWT_QOS 2U
 #define MQTT_PUBLISH_INTERVAL 5U
+#define MQTT_COMMAND_INTERVAL 1000U
+#define MQTT_CONFIG_SAVE_DELAY 30U
 #define MQTT_CLEAN_SESSION true
+#define MQTT_PUBLISH_MODE 0U
+#define MQTT_BATCH_ENCODING 0U
 
 #define DTU_SERIAL 0x99978563412U
 #define DTU_POLL_INTERVAL 5000U
@@ -183,6 +187,8 @@
 #define GRIDCHARGER_AUTO_POWER_UPPER_POWER_LIMIT 2000
 #define GRIDCHARGER_AUTO_POWER_STOP_BATTERYSOC_THRESHOLD 95
 #define GRIDCHARGER_AUTO_POWER_TARGET_POWER_CONSUMPTION 0
+#define GRIDCHARGER_AUTO_POWER_RAMP_UP_RATE 100
+#define GRIDCHARGER_AUTO_POWER_RAMP_DOWN_RATE 500
 
 #define GRIDCHARGER_CAN_CONTROLLER_FREQUENCY 8000000UL
 
@@ -0,0 +1,83 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <cstdint>
+#include <optional>
+
+namespace GridChargers {
+
+/**
+ * the surplus controller's view of a grid charger. all power values refer to
+ * the AC input of the charger, i.e., to the power as seen by the power meter.
+ */
+class PowerActuator {
+public:
+    virtual ~PowerActuator() = default;
+
+    // AC power currently drawn by the charger, if known
+    virtual std::optional<float> getInputPower() const = 0;
+
+    // the charger is switched off rather than operated below the minimum.
+    // the maximum accounts for the device and for battery limits, it may
+    // change at any time and may be zero.
+    virtual float getMinInputPower() const = 0;
+    virtual float getMaxInputPower() const = 0;
+
+    virtual void setInputPower(float watts) = 0;
+};
+
+/**
+ * PI controller which adjusts the power drawn by a grid charger such that
+ * the grid power approaches the target (usually zero, i.e., the charger
+ * consumes the surplus). used by the automatic power control of all grid
+ * chargers.
+ *
+ * the integrator is limited to the range the actuator can actually reach
+ * (anti-windup by back-calculation): it is kept in line with the output if
+ * the output is clamped by the actuator's limits, by the ramp rates, or
+ * because the charger does not follow the commanded power (e.g., because
+ * the battery is in its absorption phase). while the charger is off, the
+ * integrator follows the surplus, such that the charger is only switched on
+ * if the surplus reaches the minimum power, which avoids switching on and off
+ * repeatedly if the surplus is close to the minimum power.
+ */
+class SurplusController {
+public:
+    struct Parameters {
+        float ProportionalGain = 0.3f;
+        float IntegralGain = 0.3f; // per second
+        float RampUpWattsPerSecond = 100;
+        float RampDownWattsPerSecond = 500;
+
+        // the commanded power may exceed the measured input power by this
+        // amount at most. zero disables this limit.
+        float TrackingHeadroomWatts = 300;
+    };
+
+    void setParameters(Parameters const& parameters) { _parameters = parameters; }
+    Parameters const& getParameters() const { return _parameters; }
+
+    // processes a new grid power reading (positive values: consumption) and
+    // commands the actuator accordingly. returns the commanded power.
+    float update(PowerActuator& actuator, float targetGridPower,
+            float gridPower, uint32_t nowMillis);
+
+    // to be called when the charger was switched off by other means
+    void reset();
+
+    float getOutput() const { return _output; }
+    bool isActive() const { return _output > 0; }
+
+    // time steps are capped, such that a long pause in updates does not
+    // result in an excessive integration or ramp step.
+    static constexpr uint32_t MaxTimeStepMillis = 10 * 1000;
+
+private:
+    Parameters _parameters;
+
+    float _integral = 0;
+    float _output = 0;
+    std::optional<uint32_t> _oLastUpdateMillis = std::nullopt;
+};
+
+} // namespace GridChargers
@@ -9,6 +9,7 @@
 #include <string>
 #include <tuple>
 #include <cstdint>
+#include <optional>
 #include <gridcharger/huawei/DataPoints.h>
 
 namespace GridChargers::Huawei {
@@ -107,12 +108,40 @@ private:
 
     bool readRectifierState(can_message_t const& msg) const;
 
-    bool readAcks(can_message_t const& msg) const;
+    bool readAcks(can_message_t const& msg);
 
     std::optional<uint32_t> _lastSettingsUpdateMillis = std::nullopt;
     void sendSettings();
 
     void enqueueParameter(Setting setting, float val);
+    bool encodeParameter(Setting setting, float val, command_t& cmd) const;
+    void processWrites();
+
+    static constexpr std::array<Setting, 8> Settings = {
+        Setting::OnlineVoltage, Setting::OfflineVoltage,
+        Setting::OnlineCurrent, Setting::OfflineCurrent,
+        Setting::InputCurrentLimit, Setting::ProductionDisable,
+        Setting::FanOnlineFullSpeed, Setting::FanOfflineFullSpeed
+    };
+    static std::optional<size_t> getSettingIndex(Setting setting);
+
+    // parameter writes are not queued, but kept per register such that a
+    // new value supersedes one that was not yet sent. writes to different
+    // registers are sent back-to-back, while a register with a write in
+    // flight is only written again after it was acknowledged or timed out.
+    struct REGISTER_STATE {
+        std::optional<float> pending = std::nullopt;
+        uint8_t tries = 0;
+        bool awaitingAck = false;
+        uint32_t sentMillis = 0;
+        uint32_t acks = 0;
+        uint32_t coalesced = 0;
+        uint32_t lastRoundTripMillis = 0;
+        uint32_t maxRoundTripMillis = 0;
+    };
+    using register_state_t = struct REGISTER_STATE;
+    std::array<register_state_t, Settings.size()> _registers;
+    static constexpr uint32_t AckTimeoutMillis = 1000;
 };
 
 } // namespace GridChargers::Huawei
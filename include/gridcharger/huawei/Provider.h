@@ -5,6 +5,7 @@
 #include <memory>
 #include <optional>
 #include <gridcharger/Provider.h>
+#include <gridcharger/SurplusController.h>
 #include <gridcharger/huawei/HardwareInterface.h>
 #include <gridcharger/huawei/DataPoints.h>
 #include <gridcharger/huawei/Stats.h>
@@ -23,7 +24,7 @@ namespace GridChargers::Huawei {
 #define HUAWEI_MODE_AUTO_EXT 2
 #define HUAWEI_MODE_AUTO_INT 3
 
-class Provider : public ::GridChargers::Provider {
+class Provider : public ::GridChargers::Provider, private PowerActuator {
 public:
     bool init() final;
     void deinit() final;
@@ -50,6 +51,13 @@ public:
 
 private:
     void _setParameter(float val, HardwareInterface::Setting setting, bool pollFeedback = false);
+
+    // PowerActuator interface used by the internal automatic mode
+    std::optional<float> getInputPower() const final;
+    float getMinInputPower() const final;
+    float getMaxInputPower() const final;
+    void setInputPower(float watts) final;
+    float getEfficiency() const;
     void _setProduction(bool enable) const;
 
     void setFan(bool online, bool fullSpeed);
@@ -78,7 +86,9 @@ private:
     uint32_t _autoModeBlockedTillMillis = 0;      // Timestamp to block running auto mode for some time
 
     uint8_t _autoPowerEnabledCounter = 0;
+    uint32_t _lastAutoPowerCounterMillis = 0;
     bool _autoPowerEnabled = false;
+    SurplusController _surplusController;
     bool _batteryEmergencyCharging = false;
 
     enum class Topic : unsigned {
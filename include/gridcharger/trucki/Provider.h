@@ -2,14 +2,16 @@
 #pragma once
 
 #include <atomic>
+#include <condition_variable>
 #include <gridcharger/Provider.h>
+#include <gridcharger/SurplusController.h>
 #include <gridcharger/trucki/Stats.h>
 #include <HttpGetter.h>
 #include <Utils.h>
 
 namespace GridChargers::Trucki {
 
-class Provider : public ::GridChargers::Provider {
+class Provider : public ::GridChargers::Provider, private PowerActuator {
 public:
     bool init() final;
     void deinit() final;
@@ -55,6 +57,13 @@ private:
 
     void powerControlLoop();
 
+    // PowerActuator interface used by the automatic power control
+    std::optional<float> getInputPower() const final;
+    float getMinInputPower() const final;
+    float getMaxInputPower() const final;
+    void setInputPower(float watts) final;
+    float getEfficiency() const;
+
     static void dataPollingLoopHelper(void* context);
     void dataPollingLoop();
     void pollData();
@@ -89,6 +98,7 @@ private:
 
     bool _autoPowerEnabled = false;
     bool _batteryEmergencyCharging = false;
+    SurplusController _surplusController;
 };
 
 } // namespace GridChargers::Trucki
@@ -18,6 +18,15 @@ public:
     uint32_t getLastUpdate() const;
     bool isDataValid() const;
 
+    struct Sample {
+        float PowerTotal = 0;
+        uint32_t Timestamp = 0;
+        bool Valid = false;
+    };
+
+    // power reading and timestamp belonging to the same update
+    Sample getSample() const;
+
 private:
     void loop();
 
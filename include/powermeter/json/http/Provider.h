@@ -10,6 +10,7 @@
 #include <stdint.h>
 #include <Configuration.h>
 #include <HttpGetter.h>
+#include <JsonPathExtractor.h>
 #include <powermeter/Provider.h>
 
 using Auth_t = HttpRequestConfig::Auth;
@@ -41,6 +42,7 @@ private:
     uint32_t _lastPoll = 0;
 
     std::array<std::unique_ptr<HttpGetter>, POWERMETER_HTTP_JSON_MAX_VALUES> _httpGetters;
+    std::array<JsonPathExtractor, POWERMETER_HTTP_JSON_MAX_VALUES> _extractors;
 
     TaskHandle_t _taskHandle = nullptr;
     bool _stopPolling;
@@ -4,6 +4,7 @@
 #include <Configuration.h>
 #include <powermeter/Provider.h>
 #include <espMqttClient.h>
+#include <JsonPathExtractor.h>
 #include <vector>
 #include <mutex>
 #include <array>
@@ -28,6 +29,9 @@ private:
 
     PowerMeterMqttConfig const _cfg;
 
+    // compiled from the JSON paths of _cfg, one per value
+    std::array<JsonPathExtractor, POWERMETER_MQTT_MAX_VALUES> _extractors;
+
     std::vector<String> _mqttSubscriptions;
 };
 
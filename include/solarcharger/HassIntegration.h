@@ -2,12 +2,18 @@
 #pragma once
 
 #include <Arduino.h>
+#include <MqttHassPublisher.h>
 
 namespace SolarChargers {
 
 class HassIntegration {
+public:
+    MqttHassPass& getPass() const { return _pass; }
+
 protected:
     void publish(const String& subtopic, const String& payload) const;
+
+    mutable MqttHassPass _pass;
 };
 
 } // namespace SolarChargers
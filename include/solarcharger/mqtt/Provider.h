@@ -8,6 +8,7 @@
 #include <solarcharger/mqtt/Stats.h>
 #include <VeDirectMpptController.h>
 #include <espMqttClient.h>
+#include <JsonPathExtractor.h>
 
 namespace SolarChargers::Mqtt {
 
@@ -30,20 +31,23 @@ private:
     String _outputPowerTopic;
     String _outputVoltageTopic;
     String _outputCurrentTopic;
+    JsonPathExtractor _outputPowerExtractor;
+    JsonPathExtractor _outputVoltageExtractor;
+    JsonPathExtractor _outputCurrentExtractor;
     std::vector<String> _subscribedTopics;
     std::shared_ptr<Stats> _stats = std::make_shared<Stats>();
 
     void onMqttMessageOutputPower(espMqttClientTypes::MessageProperties const& properties,
             char const* topic, uint8_t const* payload, size_t len,
-            char const* jsonPath) const;
+            JsonPathExtractor const* extractor) const;
 
     void onMqttMessageOutputVoltage(espMqttClientTypes::MessageProperties const& properties,
             char const* topic, uint8_t const* payload, size_t len,
-            char const* jsonPath) const;
+            JsonPathExtractor const* extractor) const;
 
     void onMqttMessageOutputCurrent(espMqttClientTypes::MessageProperties const& properties,
             char const* topic, uint8_t const* payload, size_t len,
-            char const* jsonPath) const;
+            JsonPathExtractor const* extractor) const;
 };
 
 } // namespace SolarChargers::Mqtt
@@ -43,7 +43,7 @@ void HoymilesClass::initCMT(const int8_t pin_sdio, const int8_t pin_clk, const i
 
 void HoymilesClass::loop()
 {
-    std::lock_guard<std::mutex> lock(_mutex);
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
     _radioNrf->loop();
     _radioCmt->loop();
 
@@ -182,6 +182,7 @@ std::shared_ptr<InverterAbstract> HoymilesClass::addInverter(const char* name, c
     if (i) {
         i->setName(name);
         i->init();
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
         _inverters.push_back(std::move(i));
         return _inverters.back();
     }
@@ -191,6 +192,7 @@ std::shared_ptr<InverterAbstract> HoymilesClass::addInverter(const char* name, c
 
 std::shared_ptr<InverterAbstract> HoymilesClass::getInverterByPos(const uint8_t pos)
 {
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
     if (pos >= _inverters.size()) {
         return nullptr;
     } else {
@@ -200,6 +202,7 @@ std::shared_ptr<InverterAbstract> HoymilesClass::getInverterByPos(const uint8_t
 
 std::shared_ptr<InverterAbstract> HoymilesClass::getInverterBySerial(const uint64_t serial)
 {
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
     for (auto& inv : _inverters) {
         if (inv->serial() == serial) {
             return inv;
@@ -214,6 +217,8 @@ std::shared_ptr<InverterAbstract> HoymilesClass::getInverterByFragment(const fra
         return nullptr;
     }
 
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+
     for (auto& inv : _inverters) {
         serial_u p;
         p.u64 = inv->serial();
@@ -231,9 +236,9 @@ std::shared_ptr<InverterAbstract> HoymilesClass::getInverterByFragment(const fra
 
 void HoymilesClass::removeInverterBySerial(const uint64_t serial)
 {
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
     for (uint8_t i = 0; i < _inverters.size(); i++) {
         if (_inverters[i]->serial() == serial) {
-            std::lock_guard<std::mutex> lock(_mutex);
             _inverters[i]->getRadio()->removeCommands(_inverters[i].get());
             _inverters.erase(_inverters.begin() + i);
             return;
@@ -243,6 +248,7 @@ void HoymilesClass::removeInverterBySerial(const uint64_t serial)
 
 size_t HoymilesClass::getNumInverters() const
 {
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
     return _inverters.size();
 }
 
@@ -3,6 +3,7 @@
  * Copyright (C) 2022-2026 Thomas Basler and others
  */
 #include "MqttSubscribeParser.h"
+#include <cstring>
 
 void MqttSubscribeParser::register_callback(const std::string& topic, uint8_t qos, const OnMessageCallback& cb)
 {
@@ -11,6 +12,39 @@ void MqttSubscribeParser::register_callback(const std::string& topic, uint8_t qo
     cbf.qos = qos;
     cbf.cb = cb;
     _callbacks.push_back(cbf);
+
+    // invalid subscriptions are still passed to the broker, but never match
+    if (!is_valid_sub(topic)) {
+        return;
+    }
+
+    topic_node_t* node = &_root;
+    std::string_view levels(topic);
+    while (true) {
+        size_t pos = levels.find('/');
+        std::string_view level = levels.substr(0, pos);
+
+        std::unique_ptr<topic_node_t>* child;
+        if (level == "+") {
+            child = &node->plus;
+        } else if (level == "#") {
+            child = &node->hash;
+        } else {
+            child = &node->children[std::string(level)];
+        }
+
+        if (!*child) {
+            *child = std::make_unique<topic_node_t>();
+        }
+        node = child->get();
+
+        if (pos == std::string_view::npos) {
+            break;
+        }
+        levels.remove_prefix(pos + 1);
+    }
+
+    node->callbacks.push_back(cb);
 }
 
 void MqttSubscribeParser::unregister_callback(const std::string& topic)
@@ -22,18 +56,20 @@ void MqttSubscribeParser::unregister_callback(const std::string& topic)
             ++it;
         }
     }
+
+    if (is_valid_sub(topic)) {
+        remove(_root, topic);
+    }
 }
 
 void MqttSubscribeParser::handle_message(const espMqttClientTypes::MessageProperties& properties, const char* topic, const uint8_t* payload, size_t len)
 {
-    bool result = false;
-    for (const auto& cb : _callbacks) {
-        if (mosquitto_topic_matches_sub(cb.topic.c_str(), topic, &result) == MOSQ_ERR_SUCCESS) {
-            if (result) {
-                cb.cb(properties, topic, payload, len);
-            }
-        }
+    /* Topics must not be empty and must not contain wildcards */
+    if (!topic || topic[0] == 0 || strpbrk(topic, "+#") != nullptr) {
+        return;
     }
+
+    dispatch(_root, topic, true, properties, topic, payload, len);
 }
 
 std::vector<cb_filter_t> MqttSubscribeParser::get_callbacks()
@@ -41,6 +77,122 @@ std::vector<cb_filter_t> MqttSubscribeParser::get_callbacks()
     return _callbacks;
 }
 
+/* Is every level either a wildcard or free of wildcard characters, with # being the last level? */
+bool MqttSubscribeParser::is_valid_sub(std::string_view sub)
+{
+    if (sub.empty()) {
+        return false;
+    }
+
+    while (true) {
+        size_t pos = sub.find('/');
+        std::string_view level = sub.substr(0, pos);
+        bool last = (pos == std::string_view::npos);
+
+        if (level == "#") {
+            return last;
+        }
+        if (level != "+" && level.find_first_of("+#") != std::string_view::npos) {
+            return false;
+        }
+
+        if (last) {
+            return true;
+        }
+        sub.remove_prefix(pos + 1);
+    }
+}
+
+/* Removes all callbacks of the subscription and prunes nodes which became empty.
+ * Returns whether the node itself is empty afterwards. */
+bool MqttSubscribeParser::remove(topic_node_t& node, std::string_view sub)
+{
+    size_t pos = sub.find('/');
+    std::string_view level = sub.substr(0, pos);
+
+    std::unique_ptr<topic_node_t>* child = nullptr;
+    auto it = node.children.end();
+    if (level == "+") {
+        child = &node.plus;
+    } else if (level == "#") {
+        child = &node.hash;
+    } else {
+        it = node.children.find(level);
+        if (it != node.children.end()) {
+            child = &it->second;
+        }
+    }
+
+    if (!child || !*child) {
+        return node.empty();
+    }
+
+    bool childEmpty;
+    if (pos == std::string_view::npos) {
+        (*child)->callbacks.clear();
+        childEmpty = (*child)->empty();
+    } else {
+        childEmpty = remove(**child, sub.substr(pos + 1));
+    }
+
+    if (childEmpty) {
+        if (it != node.children.end()) {
+            node.children.erase(it);
+        } else {
+            child->reset();
+        }
+    }
+
+    return node.empty();
+}
+
+/* Invokes the callbacks of all subscriptions below the given node matching the remaining topic levels. */
+void MqttSubscribeParser::dispatch(const topic_node_t& node, std::string_view levels, bool first,
+    const espMqttClientTypes::MessageProperties& properties, const char* topic, const uint8_t* payload, size_t len)
+{
+    size_t pos = levels.find('/');
+    std::string_view level = levels.substr(0, pos);
+    bool last = (pos == std::string_view::npos);
+
+    auto invoke = [&](const topic_node_t& n) {
+        for (const auto& cb : n.callbacks) {
+            cb(properties, topic, payload, len);
+        }
+    };
+
+    auto visit = [&](const topic_node_t& child) {
+        if (!last) {
+            dispatch(child, levels.substr(pos + 1), false, properties, topic, payload, len);
+            return;
+        }
+
+        invoke(child);
+
+        /* foo/# also matches foo */
+        if (child.hash) {
+            invoke(*child.hash);
+        }
+    };
+
+    auto it = node.children.find(level);
+    if (it != node.children.end()) {
+        visit(*it->second);
+    }
+
+    /* Wildcards in the first level do not match topics starting with $ */
+    if (first && !level.empty() && level[0] == '$') {
+        return;
+    }
+
+    if (node.plus) {
+        visit(*node.plus);
+    }
+
+    if (node.hash) {
+        invoke(*node.hash);
+    }
+}
+
 /* Does a topic match a subscription? */
 int MqttSubscribeParser::mosquitto_topic_matches_sub(const char* sub, const char* topic, bool* result)
 {
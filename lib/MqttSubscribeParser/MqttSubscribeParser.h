@@ -3,7 +3,11 @@
 
 #include <cstdint>
 #include <espMqttClient.h>
+#include <functional>
+#include <map>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 typedef std::function<void(const espMqttClientTypes::MessageProperties& properties, const char* topic, const uint8_t* payload, size_t len)> OnMessageCallback;
@@ -21,13 +25,32 @@ public:
     void handle_message(const espMqttClientTypes::MessageProperties& properties, const char* topic, const uint8_t* payload, size_t len);
     std::vector<cb_filter_t> get_callbacks();
 
-private:
-    int mosquitto_topic_matches_sub(const char* sub, const char* topic, bool* result);
-
-    std::vector<cb_filter_t> _callbacks;
-
     enum mosq_err_t {
         MOSQ_ERR_SUCCESS = 0,
         MOSQ_ERR_INVAL = 3,
     };
+
+    static int mosquitto_topic_matches_sub(const char* sub, const char* topic, bool* result);
+
+private:
+    // one node per topic level. subscriptions are stored at the node
+    // reached by their last level, such that dispatching a message costs
+    // one lookup per topic level and wildcard branch, independent of the
+    // amount of subscriptions.
+    struct topic_node_t {
+        std::map<std::string, std::unique_ptr<topic_node_t>, std::less<>> children;
+        std::unique_ptr<topic_node_t> plus;
+        std::unique_ptr<topic_node_t> hash;
+        std::vector<OnMessageCallback> callbacks;
+
+        bool empty() const { return children.empty() && !plus && !hash && callbacks.empty(); }
+    };
+
+    static bool is_valid_sub(std::string_view sub);
+    static bool remove(topic_node_t& node, std::string_view sub);
+    static void dispatch(const topic_node_t& node, std::string_view levels, bool first,
+        const espMqttClientTypes::MessageProperties& properties, const char* topic, const uint8_t* payload, size_t len);
+
+    std::vector<cb_filter_t> _callbacks;
+    topic_node_t _root;
 };
@@ -0,0 +1,151 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#include "ConfigStore.h"
+#include <cstring>
+
+ConfigStore::ConfigStore(std::vector<Section> sections)
+    : _sections(std::move(sections))
+    , _states(_sections.size(), State { 0, 0, false })
+{
+}
+
+uint32_t ConfigStore::crc32(void const* data, size_t size, uint32_t crc)
+{
+    // reflected CRC-32 (IEEE 802.3), processing a nibble at a time
+    static uint32_t const table[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+        0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+        0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+    };
+
+    auto p = static_cast<uint8_t const*>(data);
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i) {
+        crc ^= p[i];
+        crc = (crc >> 4) ^ table[crc & 0x0F];
+        crc = (crc >> 4) ^ table[crc & 0x0F];
+    }
+    return ~crc;
+}
+
+bool ConfigStore::load(void* base, Reader const& read)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    bool valid = true;
+    for (size_t i = 0; i < _sections.size(); ++i) {
+        auto const& section = _sections[i];
+        auto& state = _states[i];
+        state.Persisted = false;
+
+        void* data = static_cast<uint8_t*>(base) + section.Offset;
+
+        Header header;
+        if (!read(section.Name, header, data, section.Size)) {
+            valid = false;
+            continue;
+        }
+
+        uint32_t crc = crc32(data, section.Size);
+        if (header.Magic != Magic || header.Version != section.Version
+                || header.Length != section.Size || header.Crc != crc) {
+            valid = false;
+            continue;
+        }
+
+        state.Crc = crc;
+        state.Persisted = true;
+    }
+
+    return valid;
+}
+
+size_t ConfigStore::copyLoaded(void const* src, void* dst)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    size_t copied = 0;
+    for (size_t i = 0; i < _sections.size(); ++i) {
+        if (!_states[i].Persisted) {
+            continue;
+        }
+
+        auto const& section = _sections[i];
+        memcpy(static_cast<uint8_t*>(dst) + section.Offset,
+            static_cast<uint8_t const*>(src) + section.Offset, section.Size);
+        ++copied;
+    }
+
+    return copied;
+}
+
+std::vector<ConfigStore::Record> ConfigStore::collect(void const* base)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    std::vector<Record> records;
+    for (size_t i = 0; i < _sections.size(); ++i) {
+        auto const& section = _sections[i];
+        auto data = static_cast<uint8_t const*>(base) + section.Offset;
+
+        uint32_t crc = crc32(data, section.Size);
+        if (_states[i].Persisted && _states[i].Crc == crc) {
+            continue;
+        }
+
+        Record record { i, ++_sequence, { Magic, section.Version, static_cast<uint32_t>(section.Size), crc }, {} };
+        record.Payload.assign(data, data + section.Size);
+        records.push_back(std::move(record));
+    }
+
+    return records;
+}
+
+bool ConfigStore::commit(std::vector<Record> const& records, Writer const& write)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    bool success = true;
+    for (auto const& record : records) {
+        auto& state = _states[record.Index];
+
+        // sequence numbers are compared as the distance to wrap around
+        if (state.Sequence != 0 && static_cast<int32_t>(record.Sequence - state.Sequence) < 0) {
+            continue;
+        }
+
+        if (!write(_sections[record.Index].Name, record.Head, record.Payload.data(), record.Payload.size())) {
+            // the record on flash is in an unknown state
+            state.Persisted = false;
+            success = false;
+            continue;
+        }
+
+        state.Crc = record.Head.Crc;
+        state.Sequence = record.Sequence;
+        state.Persisted = true;
+    }
+
+    return success;
+}
+
+bool ConfigStore::differs(void const* lhs, void const* rhs) const
+{
+    for (auto const& section : _sections) {
+        auto lhsData = static_cast<uint8_t const*>(lhs) + section.Offset;
+        auto rhsData = static_cast<uint8_t const*>(rhs) + section.Offset;
+        if (crc32(lhsData, section.Size) != crc32(rhsData, section.Size)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void ConfigStore::invalidate()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto& state : _states) {
+        state.Persisted = false;
+    }
+}
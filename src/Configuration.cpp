@@ -7,26 +7,92 @@
 #include "Utils.h"
 #include "defaults.h"
 #include <LittleFS.h>
+#include <algorithm>
+#include <cstddef>
 #include <esp_log.h>
 #include <nvs_flash.h>
 
 #undef TAG
 static const char* TAG = "configuration";
 
-CONFIG_T config;
-
-static std::condition_variable sWriterCv;
+// serializes writers, which each copy the current snapshot
 static std::mutex sWriterMutex;
-static unsigned sWriterCount = 0;
 
-void ConfigurationClass::init(Scheduler& scheduler)
+// the web API and the background writer may write at the same time
+static std::mutex sFileMutex;
+
+static String getStorePath(char const* name)
 {
-    scheduler.addTask(_loopTask);
-    _loopTask.setCallback(std::bind(&ConfigurationClass::loop, this));
-    _loopTask.setIterations(TASK_FOREVER);
-    _loopTask.enable();
+    return String(CONFIG_STORE_DIR "/") + name + ".bin";
+}
 
-    memset(&config, 0x0, sizeof(config));
+static bool readStoreRecord(char const* name, ConfigStore::Header& header, void* data, size_t size)
+{
+    File f = LittleFS.open(getStorePath(name), "r", false);
+    if (!f || f.size() != sizeof(header) + size) {
+        return false;
+    }
+
+    return f.read(reinterpret_cast<uint8_t*>(&header), sizeof(header)) == sizeof(header)
+        && f.read(static_cast<uint8_t*>(data), size) == size;
+}
+
+static bool writeStoreRecord(char const* name, ConfigStore::Header const& header, void const* data, size_t size)
+{
+    if (!LittleFS.exists(CONFIG_STORE_DIR)) {
+        LittleFS.mkdir(CONFIG_STORE_DIR);
+    }
+
+    File f = LittleFS.open(getStorePath(name), "w");
+    if (!f) {
+        return false;
+    }
+
+    bool success = f.write(reinterpret_cast<uint8_t const*>(&header), sizeof(header)) == sizeof(header)
+        && f.write(static_cast<uint8_t const*>(data), size) == size;
+    f.close();
+
+    if (!success) {
+        ESP_LOGE(TAG, "Failed to write configuration section %s", name);
+    }
+    return success;
+}
+
+ConfigurationClass::ConfigurationClass()
+    // the second value is the version of the section's memory layout. it
+    // must be bumped whenever the respective struct in CONFIG_T changes,
+    // such that the section is imported from config.json once.
+    : _store({
+        { "cfg", 2, offsetof(CONFIG_T, Cfg), sizeof(CONFIG_T::Cfg) },
+        { "wifi", 1, offsetof(CONFIG_T, WiFi), sizeof(CONFIG_T::WiFi) },
+        { "mdns", 1, offsetof(CONFIG_T, Mdns), sizeof(CONFIG_T::Mdns) },
+        { "syslog", 1, offsetof(CONFIG_T, Syslog), sizeof(CONFIG_T::Syslog) },
+        { "ntp", 1, offsetof(CONFIG_T, Ntp), sizeof(CONFIG_T::Ntp) },
+        { "mqtt", 1, offsetof(CONFIG_T, Mqtt), sizeof(CONFIG_T::Mqtt) },
+        { "dtu", 1, offsetof(CONFIG_T, Dtu), sizeof(CONFIG_T::Dtu) },
+        { "security", 1, offsetof(CONFIG_T, Security), sizeof(CONFIG_T::Security) },
+        { "display", 1, offsetof(CONFIG_T, Display), sizeof(CONFIG_T::Display) },
+        { "led", 1, offsetof(CONFIG_T, Led_Single), sizeof(CONFIG_T::Led_Single) },
+        { "pinmapping", 1, offsetof(CONFIG_T, Dev_PinMapping), sizeof(CONFIG_T::Dev_PinMapping) },
+        { "inverters", 1, offsetof(CONFIG_T, Inverter), sizeof(CONFIG_T::Inverter) },
+        { "logging", 1, offsetof(CONFIG_T, Logging), sizeof(CONFIG_T::Logging) },
+        { "solarcharger", 1, offsetof(CONFIG_T, SolarCharger), sizeof(CONFIG_T::SolarCharger) },
+        { "powermeter", 1, offsetof(CONFIG_T, PowerMeter), sizeof(CONFIG_T::PowerMeter) },
+        { "powerlimiter", 1, offsetof(CONFIG_T, PowerLimiter), sizeof(CONFIG_T::PowerLimiter) },
+        { "battery", 1, offsetof(CONFIG_T, Battery), sizeof(CONFIG_T::Battery) },
+        { "gridcharger", 1, offsetof(CONFIG_T, GridCharger), sizeof(CONFIG_T::GridCharger) },
+    })
+    , _saveCounter({ { "savecount", 1, 0, sizeof(uint32_t) } })
+    , _exportMarker({ { "export", 1, 0, sizeof(_exportedSaveCount) } })
+    , _current(std::make_shared<CONFIG_T>())
+{
+}
+
+void ConfigurationClass::init()
+{
+    uint32_t constexpr stackSize = 4096;
+    xTaskCreate(writerLoopHelper, "configWriter",
+            stackSize, this, 1/*prio*/, &_writerTaskHandle);
 }
 
 // we want a representation of our floating-point value in the JSON that
@@ -128,13 +194,13 @@ void ConfigurationClass::serializePowerMeterUdpVictronConfig(PowerMeterUdpVictro
 
 void ConfigurationClass::serializeBatteryConfig(BatteryConfig const& source, JsonObject& target)
 {
-    target["enabled"] = config.Battery.Enabled;
-    target["provider"] = config.Battery.Provider;
-    target["enable_discharge_current_limit"] = config.Battery.EnableDischargeCurrentLimit;
-    target["discharge_current_limit"] = config.Battery.DischargeCurrentLimit;
-    target["discharge_current_limit_below_soc"] = config.Battery.DischargeCurrentLimitBelowSoc;
-    target["discharge_current_limit_below_voltage"] = config.Battery.DischargeCurrentLimitBelowVoltage;
-    target["use_battery_reported_discharge_current_limit"] = config.Battery.UseBatteryReportedDischargeCurrentLimit;
+    target["enabled"] = source.Enabled;
+    target["provider"] = source.Provider;
+    target["enable_discharge_current_limit"] = source.EnableDischargeCurrentLimit;
+    target["discharge_current_limit"] = source.DischargeCurrentLimit;
+    target["discharge_current_limit_below_soc"] = source.DischargeCurrentLimitBelowSoc;
+    target["discharge_current_limit_below_voltage"] = source.DischargeCurrentLimitBelowVoltage;
+    target["use_battery_reported_discharge_current_limit"] = source.UseBatteryReportedDischargeCurrentLimit;
 }
 
 void ConfigurationClass::serializeBatteryZendureConfig(BatteryZendureConfig const& source, JsonObject& target)
@@ -242,6 +308,8 @@ void ConfigurationClass::serializeGridChargerConfig(GridChargerConfig const& sou
     target["upper_power_limit"] = source.AutoPowerUpperPowerLimit;
     target["stop_batterysoc_threshold"] = source.AutoPowerStopBatterySoCThreshold;
     target["target_power_consumption"] = source.AutoPowerTargetPowerConsumption;
+    target["ramp_up_rate"] = source.AutoPowerRampUpRate;
+    target["ramp_down_rate"] = source.AutoPowerRampDownRate;
 }
 
 void ConfigurationClass::serializeGridChargerCanConfig(GridChargerCanConfig const& source, JsonObject& target)
@@ -267,18 +335,280 @@ void ConfigurationClass::serializeGridChargerTruckiConfig(GridChargerTruckiConfi
 
 bool ConfigurationClass::write()
 {
+    {
+        // a pending deferred write would save the same config
+        std::lock_guard<std::mutex> lock(_writeRequestMutex);
+        _writePending = false;
+    }
+
+    bool success = writeStore(_store.collect(get().get()));
+    countSave();
+
+    requestExport();
+    return success;
+}
+
+bool ConfigurationClass::writeStore(std::vector<ConfigStore::Record> const& records)
+{
+    std::lock_guard<std::mutex> lock(sFileMutex);
+
+    if (_storeDiscarded) {
+        return false;
+    }
+
+    if (records.empty()) {
+        return true;
+    }
+
+    uint32_t start = millis();
+
+    bool success = _store.commit(records, writeStoreRecord);
+
+    ESP_LOGI(TAG, "Saved %u of %u configuration sections in %" PRIu32 " ms",
+        records.size(), _store.getSectionCount(), millis() - start);
+
+    return success;
+}
+
+bool ConfigurationClass::readStore()
+{
+    uint32_t start = millis();
+
+    if (!_store.load(_current.get(), readStoreRecord)) {
+        return false;
+    }
+
+    uint32_t saveCount = 0;
+    if (!_saveCounter.load(&saveCount, readStoreRecord)) {
+        saveCount = 0;
+    }
+    _saveCount = saveCount;
+
+    // config.json is exported again if the marker is missing
+    if (!_exportMarker.load(&_exportedSaveCount, readStoreRecord)) {
+        _exportedSaveCount = 0;
+    }
+
+    ESP_LOGI(TAG, "Loaded %u configuration sections in %" PRIu32 " ms",
+        _store.getSectionCount(), millis() - start);
+
+    return true;
+}
+
+bool ConfigurationClass::exportJson()
+{
+    auto snapshot = get();
+    uint32_t saveCount = _saveCount;
+
+    JsonDocument doc;
+    if (!serialize(*snapshot, saveCount, doc) || !writeFile(doc)) {
+        ESP_LOGE(TAG, "Failed to export configuration");
+        return false;
+    }
+
+    writeExportMarker(saveCount);
+    return true;
+}
+
+void ConfigurationClass::countSave()
+{
+    std::lock_guard<std::mutex> lock(sFileMutex);
+
+    uint32_t saveCount = ++_saveCount;
+
+    if (_storeDiscarded) {
+        return;
+    }
+
+    _saveCounter.commit(_saveCounter.collect(&saveCount), writeStoreRecord);
+}
+
+void ConfigurationClass::writeExportMarker(uint32_t saveCount)
+{
+    std::lock_guard<std::mutex> lock(sFileMutex);
+
+    if (_storeDiscarded) {
+        return;
+    }
+
+    _exportedSaveCount = saveCount;
+    _exportMarker.commit(_exportMarker.collect(&_exportedSaveCount), writeStoreRecord);
+}
+
+void ConfigurationClass::flushExport()
+{
+    {
+        std::lock_guard<std::mutex> lock(_writeRequestMutex);
+        if (!_exportPending) {
+            return;
+        }
+        _exportPending = false;
+    }
+
+    exportJson();
+}
+
+void ConfigurationClass::requestExport()
+{
+    std::lock_guard<std::mutex> lock(_writeRequestMutex);
+
+    _exportPending = true;
+    _exportRequestMillis = millis();
+
+    if (_writerTaskHandle != nullptr) {
+        xTaskNotifyGive(_writerTaskHandle);
+    }
+}
+
+void ConfigurationClass::discardStore()
+{
+    {
+        std::lock_guard<std::mutex> lock(_writeRequestMutex);
+        _writePending = false;
+        _exportPending = false;
+    }
+
+    std::lock_guard<std::mutex> lock(sFileMutex);
+    _storeDiscarded = true;
+
+    File dir = LittleFS.open(CONFIG_STORE_DIR);
+    if (!dir || !dir.isDirectory()) {
+        return;
+    }
+
+    std::vector<String> paths;
+    File file = dir.openNextFile();
+    while (file) {
+        paths.push_back(file.path());
+        file = dir.openNextFile();
+    }
+    dir.close();
+
+    for (auto const& path : paths) {
+        LittleFS.remove(path);
+    }
+    LittleFS.rmdir(CONFIG_STORE_DIR);
+}
+
+bool ConfigurationClass::writeFile(JsonDocument const& doc)
+{
+    std::lock_guard<std::mutex> lock(sFileMutex);
+
+    // config.json may have been uploaded to be imported at the next boot
+    if (_storeDiscarded) {
+        return false;
+    }
+
     File f = LittleFS.open(CONFIG_FILENAME, "w");
     if (!f) {
         return false;
     }
-    config.Cfg.SaveCount++;
 
-    JsonDocument doc;
+    // Serialize JSON to file
+    if (serializeJson(doc, f) == 0) {
+        ESP_LOGE(TAG, "Failed to write file");
+        return false;
+    }
+
+    f.close();
+    return true;
+}
+
+void ConfigurationClass::requestWrite(uint32_t delayMillis)
+{
+    std::lock_guard<std::mutex> lock(_writeRequestMutex);
+
+    uint32_t now = millis();
+    if (!_writePending) {
+        _writePending = true;
+        _firstRequestMillis = now;
+    }
+    _lastRequestMillis = now;
+    _writeDelayMillis = delayMillis;
+    ++_writeRequests;
+
+    if (_writerTaskHandle != nullptr) {
+        xTaskNotifyGive(_writerTaskHandle);
+    }
+}
+
+ConfigurationClass::PersistenceStats ConfigurationClass::getPersistenceStats() const
+{
+    std::lock_guard<std::mutex> lock(_writeRequestMutex);
+
+    uint32_t pending = _writePending ? 1 : 0;
+    uint32_t coalesced = (_writeRequests > _deferredWrites + pending) ? (_writeRequests - _deferredWrites - pending) : 0;
+    return { _saveCount - _bootSaveCount, _writeRequests, coalesced, _writePending };
+}
+
+void ConfigurationClass::writerLoopHelper(void* context)
+{
+    auto instance = static_cast<ConfigurationClass*>(context);
+    instance->writerLoop();
+    vTaskDelete(nullptr);
+}
+
+void ConfigurationClass::writerLoop()
+{
+    TickType_t wait = portMAX_DELAY;
+
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, wait);
+
+        bool save = false;
+        bool exportDue = false;
+        wait = portMAX_DELAY;
+
+        {
+            std::lock_guard<std::mutex> lock(_writeRequestMutex);
+
+            uint32_t now = millis();
+
+            if (_writePending) {
+                uint32_t quiet = now - _lastRequestMillis;
+                uint32_t deferred = now - _firstRequestMillis;
+                if (quiet < _writeDelayMillis && deferred < MaxWriteDeferralMillis) {
+                    wait = pdMS_TO_TICKS(std::min(_writeDelayMillis - quiet, MaxWriteDeferralMillis - deferred));
+                } else {
+                    _writePending = false;
+                    ++_deferredWrites;
+                    save = true;
+                }
+            }
+
+            // the export is requested again after saving
+            if (_exportPending && !save) {
+                uint32_t quiet = now - _exportRequestMillis;
+                if (quiet < ExportDelayMillis) {
+                    wait = std::min(wait, pdMS_TO_TICKS(ExportDelayMillis - quiet));
+                } else {
+                    _exportPending = false;
+                    exportDue = true;
+                }
+            }
+        }
+
+        if (save) {
+            if (!writeStore(_store.collect(get().get()))) {
+                ESP_LOGE(TAG, "Failed to save configuration");
+            }
+            countSave();
+
+            requestExport();
+        }
 
+        if (exportDue) {
+            exportJson();
+        }
+    }
+}
+
+bool ConfigurationClass::serialize(CONFIG_T const& config, uint32_t saveCount, JsonDocument& doc)
+{
     JsonObject cfg = doc["cfg"].to<JsonObject>();
     cfg["version"] = config.Cfg.Version;
     cfg["version_onbattery"] = config.Cfg.VersionOnBattery;
-    cfg["save_count"] = config.Cfg.SaveCount;
+    cfg["save_count"] = saveCount;
 
     JsonObject wifi = doc["wifi"].to<JsonObject>();
     wifi["ssid"] = config.WiFi.Ssid;
@@ -317,7 +647,11 @@ bool ConfigurationClass::write()
     mqtt["topic"] = config.Mqtt.Topic;
     mqtt["retain"] = config.Mqtt.Retain;
     mqtt["publish_interval"] = config.Mqtt.PublishInterval;
+    mqtt["command_interval"] = config.Mqtt.CommandInterval;
+    mqtt["config_save_delay"] = config.Mqtt.ConfigSaveDelay;
     mqtt["clean_session"] = config.Mqtt.CleanSession;
+    mqtt["publish_mode"] = config.Mqtt.PublishMode;
+    mqtt["batch_encoding"] = config.Mqtt.BatchEncoding;
 
     JsonObject mqtt_lwt = mqtt["lwt"].to<JsonObject>();
     mqtt_lwt["topic"] = config.Mqtt.Lwt.Topic;
@@ -455,18 +789,7 @@ bool ConfigurationClass::write()
     JsonObject gridcharger_trucki = gridcharger["trucki"].to<JsonObject>();
     serializeGridChargerTruckiConfig(config.GridCharger.Trucki, gridcharger_trucki);
 
-    if (!Utils::checkJsonAlloc(doc, __FUNCTION__, __LINE__)) {
-        return false;
-    }
-
-    // Serialize JSON to file
-    if (serializeJson(doc, f) == 0) {
-        ESP_LOGE(TAG, "Failed to write file");
-        return false;
-    }
-
-    f.close();
-    return true;
+    return Utils::checkJsonAlloc(doc, __FUNCTION__, __LINE__);
 }
 
 void ConfigurationClass::deserializeHttpRequestConfig(JsonObject const& source_http_config, HttpRequestConfig& target)
@@ -669,6 +992,8 @@ void ConfigurationClass::deserializeGridChargerConfig(JsonObject const& source,
     target.AutoPowerUpperPowerLimit = source["upper_power_limit"] | GRIDCHARGER_AUTO_POWER_UPPER_POWER_LIMIT;
     target.AutoPowerStopBatterySoCThreshold = source["stop_batterysoc_threshold"] | GRIDCHARGER_AUTO_POWER_STOP_BATTERYSOC_THRESHOLD;
     target.AutoPowerTargetPowerConsumption = source["target_power_consumption"] | GRIDCHARGER_AUTO_POWER_TARGET_POWER_CONSUMPTION;
+    target.AutoPowerRampUpRate = source["ramp_up_rate"] | GRIDCHARGER_AUTO_POWER_RAMP_UP_RATE;
+    target.AutoPowerRampDownRate = source["ramp_down_rate"] | GRIDCHARGER_AUTO_POWER_RAMP_DOWN_RATE;
 }
 
 void ConfigurationClass::deserializeGridChargerCanConfig(JsonObject const& source, GridChargerCanConfig& target)
@@ -699,6 +1024,28 @@ void ConfigurationClass::deserializeGridChargerTruckiConfig(JsonObject const& so
 
 bool ConfigurationClass::read()
 {
+    CONFIG_T& config = *_current;
+
+    if (readStore()) {
+        _bootSaveCount = _saveCount;
+
+        // the export might have been interrupted by a reset
+        if (_exportedSaveCount != _bootSaveCount) {
+            requestExport();
+        }
+
+        return true;
+    }
+
+    // sections of another layout version or missing are imported from
+    // config.json. the others are kept, as config.json is only exported
+    // some time after saving.
+    auto upStored = std::make_unique<CONFIG_T>(config);
+
+    memset(&config, 0x0, sizeof(config));
+
+    uint32_t start = millis();
+
     File f = LittleFS.open(CONFIG_FILENAME, "r", false);
     Utils::skipBom(f);
 
@@ -726,7 +1073,10 @@ bool ConfigurationClass::read()
     JsonObject cfg = doc["cfg"];
     config.Cfg.Version = cfg["version"] | CONFIG_VERSION;
     config.Cfg.VersionOnBattery = cfg["version_onbattery"] | version_onbattery;
-    config.Cfg.SaveCount = cfg["save_count"] | 0;
+    uint32_t saveCount = cfg["save_count"] | 0;
+    _saveCount = saveCount;
+    _bootSaveCount = saveCount;
+    _exportedSaveCount = error ? (saveCount - 1) : saveCount;
 
     JsonObject wifi = doc["wifi"];
     strlcpy(config.WiFi.Ssid, wifi["ssid"] | WIFI_SSID, sizeof(config.WiFi.Ssid));
@@ -796,7 +1146,11 @@ bool ConfigurationClass::read()
     strlcpy(config.Mqtt.Topic, mqtt["topic"] | MQTT_TOPIC, sizeof(config.Mqtt.Topic));
     config.Mqtt.Retain = mqtt["retain"] | MQTT_RETAIN;
     config.Mqtt.PublishInterval = mqtt["publish_interval"] | MQTT_PUBLISH_INTERVAL;
+    config.Mqtt.CommandInterval = mqtt["command_interval"] | MQTT_COMMAND_INTERVAL;
+    config.Mqtt.ConfigSaveDelay = mqtt["config_save_delay"] | MQTT_CONFIG_SAVE_DELAY;
     config.Mqtt.CleanSession = mqtt["clean_session"] | MQTT_CLEAN_SESSION;
+    config.Mqtt.PublishMode = static_cast<decltype(config.Mqtt.PublishMode)>(mqtt["publish_mode"] | MQTT_PUBLISH_MODE);
+    config.Mqtt.BatchEncoding = static_cast<decltype(config.Mqtt.BatchEncoding)>(mqtt["batch_encoding"] | MQTT_BATCH_ENCODING);
 
     JsonObject mqtt_lwt = mqtt["lwt"];
     strlcpy(config.Mqtt.Lwt.Topic, mqtt_lwt["topic"] | MQTT_LWT_TOPIC, sizeof(config.Mqtt.Lwt.Topic));
@@ -913,6 +1267,16 @@ bool ConfigurationClass::read()
 
     f.close();
 
+    size_t kept = _store.copyLoaded(upStored.get(), &config);
+    upStored.reset();
+
+    ESP_LOGI(TAG, "Imported %u configuration sections from %s in %" PRIu32 " ms",
+        _store.getSectionCount() - kept, CONFIG_FILENAME, millis() - start);
+
+    // subsequent boots load the binary store
+    writeStore(_store.collect(&config));
+    _saveCounter.commit(_saveCounter.collect(&saveCount), writeStoreRecord);
+
     // Check for default DTU serial
     if (config.Dtu.Serial == DTU_SERIAL) {
         const uint64_t dtuId = Utils::generateDtuSerial();
@@ -925,11 +1289,18 @@ bool ConfigurationClass::read()
         ESP_LOGI(TAG, "DTU serial check: Using existing serial");
     }
 
+    // config.json lacks the sections kept
+    if (_exportedSaveCount != _saveCount || kept > 0) {
+        requestExport();
+    }
+
     return true;
 }
 
 void ConfigurationClass::migrate()
 {
+    CONFIG_T& config = *_current;
+
     File f = LittleFS.open(CONFIG_FILENAME, "r", false);
     if (!f) {
         ESP_LOGE(TAG, "Failed to open file, cancel migration");
@@ -1023,6 +1394,8 @@ void ConfigurationClass::migrate()
 
 void ConfigurationClass::migrateOnBattery()
 {
+    CONFIG_T& config = *_current;
+
     File f = LittleFS.open(CONFIG_FILENAME, "r", false);
     if (!f) {
         ESP_LOGE(TAG, "Failed to open file, cancel OpenDTU-OnBattery migration");
@@ -1213,17 +1586,22 @@ void ConfigurationClass::migrateOnBattery()
     read();
 }
 
-CONFIG_T const& ConfigurationClass::get()
+std::shared_ptr<CONFIG_T const> ConfigurationClass::get()
 {
-    return config;
+    return std::atomic_load(&_current);
 }
 
 ConfigurationClass::WriteGuard ConfigurationClass::getWriteGuard()
 {
-    return WriteGuard();
+    return WriteGuard(*this);
+}
+
+void ConfigurationClass::publish(std::shared_ptr<CONFIG_T> snapshot)
+{
+    std::atomic_store(&_current, std::move(snapshot));
 }
 
-INVERTER_CONFIG_T* ConfigurationClass::getFreeInverterSlot()
+INVERTER_CONFIG_T* ConfigurationClass::getFreeInverterSlot(CONFIG_T& config)
 {
     for (uint8_t i = 0; i < INV_MAX_COUNT; i++) {
         if (config.Inverter[i].Serial == 0) {
@@ -1234,18 +1612,20 @@ INVERTER_CONFIG_T* ConfigurationClass::getFreeInverterSlot()
     return nullptr;
 }
 
-INVERTER_CONFIG_T* ConfigurationClass::getInverterConfig(const uint64_t serial)
+std::shared_ptr<INVERTER_CONFIG_T const> ConfigurationClass::getInverterConfig(const uint64_t serial)
 {
+    auto const spConfig = get();
+
     for (uint8_t i = 0; i < INV_MAX_COUNT; i++) {
-        if (config.Inverter[i].Serial == serial) {
-            return &config.Inverter[i];
+        if (spConfig->Inverter[i].Serial == serial) {
+            return std::shared_ptr<INVERTER_CONFIG_T const>(spConfig, &spConfig->Inverter[i]);
         }
     }
 
     return nullptr;
 }
 
-void ConfigurationClass::deleteInverterById(const uint8_t id)
+void ConfigurationClass::deleteInverterById(CONFIG_T& config, const uint8_t id)
 {
     config.Inverter[id].Serial = 0ULL;
     strlcpy(config.Inverter[id].Name, "", sizeof(config.Inverter[id].Name));
@@ -1269,8 +1649,10 @@ void ConfigurationClass::deleteInverterById(const uint8_t id)
 
 int8_t ConfigurationClass::getIndexForLogModule(const String& moduleName) const
 {
+    auto const spConfig = std::atomic_load(&_current);
+
     for (uint8_t i = 0; i < LOG_MODULE_COUNT; i++) {
-        if (strcmp(config.Logging.Modules[i].Name, moduleName.c_str()) == 0) {
+        if (strcmp(spConfig->Logging.Modules[i].Name, moduleName.c_str()) == 0) {
             return i;
         }
     }
@@ -1278,35 +1660,27 @@ int8_t ConfigurationClass::getIndexForLogModule(const String& moduleName) const
     return -1;
 }
 
-void ConfigurationClass::loop()
+ConfigurationClass::WriteGuard::WriteGuard(ConfigurationClass& parent)
+    : _parent(parent)
+    , _lock(sWriterMutex)
+    , _draft(std::make_shared<CONFIG_T>(*parent._current))
 {
-    std::unique_lock<std::mutex> lock(sWriterMutex);
-    if (sWriterCount == 0) {
-        return;
-    }
-
-    sWriterCv.notify_all();
-    sWriterCv.wait(lock, [] { return sWriterCount == 0; });
 }
 
 CONFIG_T& ConfigurationClass::WriteGuard::getConfig()
 {
-    return config;
-}
-
-ConfigurationClass::WriteGuard::WriteGuard()
-    : _lock(sWriterMutex)
-{
-    sWriterCount++;
-    sWriterCv.wait(_lock);
+    return *_draft;
 }
 
 ConfigurationClass::WriteGuard::~WriteGuard()
 {
-    sWriterCount--;
-    if (sWriterCount == 0) {
-        sWriterCv.notify_all();
+    // e.g., the value received via MQTT was the same. the draft is a
+    // bytewise copy, so unchanged members, padding included, compare equal.
+    if (!_parent._store.differs(_draft.get(), _parent._current.get())) {
+        return;
     }
+
+    _parent.publish(std::move(_draft));
 }
 
 ConfigurationClass Configuration;
@@ -4,18 +4,20 @@
  */
 #include "Datastore.h"
 #include "Configuration.h"
+#include "TaskProfiler.h"
 #include <Hoymiles.h>
 
 DatastoreClass Datastore;
 
 DatastoreClass::DatastoreClass()
-    : _loopTask(1 * TASK_SECOND, TASK_FOREVER, std::bind(&DatastoreClass::loop, this))
+    : _loopTask(1 * TASK_SECOND, TASK_FOREVER)
 {
 }
 
 void DatastoreClass::init(Scheduler& scheduler)
 {
     scheduler.addTask(_loopTask);
+    _loopTask.setCallback(TaskProfiler.wrap("Datastore", std::bind(&DatastoreClass::loop, this)));
     _loopTask.enable();
 }
 
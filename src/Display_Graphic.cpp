@@ -7,6 +7,7 @@
 #include "Datastore.h"
 #include "I18n.h"
 #include "PinMapping.h"
+#include "TaskProfiler.h"
 #include <battery/Controller.h>
 #include <powermeter/Controller.h>
 #include <NetworkSettings.h>
@@ -47,7 +48,7 @@ static const char* const i18n_battery_soc_2_fractions[] = { "SoC: %.2f%%", "SoC:
 static const char* const i18n_date_format[] = { "%m/%d/%Y %H:%M", "%d.%m.%Y %H:%M", "%d/%m/%Y %H:%M" };
 
 DisplayGraphicClass::DisplayGraphicClass()
-    : _loopTask(TASK_IMMEDIATE, TASK_FOREVER, std::bind(&DisplayGraphicClass::loop, this))
+    : _loopTask(TASK_IMMEDIATE, TASK_FOREVER)
 {
 }
 
@@ -80,16 +81,17 @@ void DisplayGraphicClass::init(Scheduler& scheduler)
     _diagram.init(scheduler, _display);
 
     scheduler.addTask(_loopTask);
+    _loopTask.setCallback(TaskProfiler.wrap("Display", std::bind(&DisplayGraphicClass::loop, this)));
     _loopTask.setInterval(_period);
     _loopTask.enable();
 
-    auto& config = Configuration.get();
-    setDiagramMode(static_cast<DiagramMode_t>(config.Display.Diagram.Mode));
-    setOrientation(config.Display.Rotation);
-    enablePowerSafe = config.Display.PowerSafe;
-    enableScreensaver = config.Display.ScreenSaver;
-    setContrast(config.Display.Contrast);
-    setLocale(config.Display.Locale);
+    auto const config = Configuration.get();
+    setDiagramMode(static_cast<DiagramMode_t>(config->Display.Diagram.Mode));
+    setOrientation(config->Display.Rotation);
+    enablePowerSafe = config->Display.PowerSafe;
+    enableScreensaver = config->Display.ScreenSaver;
+    setContrast(config->Display.Contrast);
+    setLocale(config->Display.Locale);
     setStartupDisplay();
 }
 
@@ -335,8 +337,8 @@ void DisplayGraphicClass::loop()
     // three-second slots is used to NOT overwrite the total inverter energy.
     bool timing = (_mExtra % 9) >= 3;
 
-    bool powerMeterAvailable = Configuration.get().PowerMeter.Enabled;
-    bool batteryAvailable = Configuration.get().Battery.Enabled && Battery.getStats()->isSoCValid();
+    bool powerMeterAvailable = Configuration.get()->PowerMeter.Enabled;
+    bool batteryAvailable = Configuration.get()->Battery.Enabled && Battery.getStats()->isSoCValid();
 
     if (showText && timing && !displayPowerSave && (powerMeterAvailable || batteryAvailable)) {
         // erase the third line and print the battery SoC or power meter value instead.
@@ -91,7 +91,7 @@ HttpRequestResult HttpGetter::performGetRequest()
         // will spam the console if done the other way around.
         ipaddr = INADDR_NONE;
 
-        if (Configuration.get().Mdns.Enabled) {
+        if (Configuration.get()->Mdns.Enabled) {
             ipaddr = MDNS.queryHost(_host); // INADDR_NONE if failed
         }
 
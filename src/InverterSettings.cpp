@@ -16,13 +16,13 @@ InverterSettingsClass InverterSettings;
 
 InverterSettingsClass::InverterSettingsClass()
     : _settingsTask(INVERTER_UPDATE_SETTINGS_INTERVAL, TASK_FOREVER, std::bind(&InverterSettingsClass::settingsLoop, this))
-    , _hoyTask(TASK_IMMEDIATE, TASK_FOREVER, std::bind(&InverterSettingsClass::hoyLoop, this))
+    , _hoyWorker("HoyRadio", 6144, 1/*prio*/)
 {
 }
 
 void InverterSettingsClass::init(Scheduler& scheduler)
 {
-    const CONFIG_T& config = Configuration.get();
+    auto const config = Configuration.get();
     const PinMapping_t& pin = PinMapping.get();
 
     // Initialize inverter communication
@@ -50,26 +50,26 @@ void InverterSettingsClass::init(Scheduler& scheduler)
         ESP_LOGI(TAG, "CMT2300A: Initialize communication");
         Hoymiles.initCMT(pin.cmt_sdio, pin.cmt_clk, pin.cmt_cs, pin.cmt_fcs, pin.cmt_gpio2, pin.cmt_gpio3);
         ESP_LOGI(TAG, "CMT2300A: Setting country mode...");
-        Hoymiles.getRadioCmt()->setCountryMode(static_cast<CountryModeId_t>(config.Dtu.Cmt.CountryMode));
+        Hoymiles.getRadioCmt()->setCountryMode(static_cast<CountryModeId_t>(config->Dtu.Cmt.CountryMode));
         ESP_LOGI(TAG, "CMT2300A: Setting CMT target frequency...");
-        Hoymiles.getRadioCmt()->setInverterTargetFrequency(config.Dtu.Cmt.Frequency);
+        Hoymiles.getRadioCmt()->setInverterTargetFrequency(config->Dtu.Cmt.Frequency);
     }
 
     // Configure common radio settings
     ESP_LOGI(TAG, "RF: Setting radio PA level...");
-    Hoymiles.getRadioNrf()->setPALevel((rf24_pa_dbm_e)config.Dtu.Nrf.PaLevel);
-    Hoymiles.getRadioCmt()->setPALevel(config.Dtu.Cmt.PaLevel);
+    Hoymiles.getRadioNrf()->setPALevel((rf24_pa_dbm_e)config->Dtu.Nrf.PaLevel);
+    Hoymiles.getRadioCmt()->setPALevel(config->Dtu.Cmt.PaLevel);
 
     ESP_LOGI(TAG, "RF: Setting DTU serial...");
-    Hoymiles.getRadioNrf()->setDtuSerial(config.Dtu.Serial);
-    Hoymiles.getRadioCmt()->setDtuSerial(config.Dtu.Serial);
+    Hoymiles.getRadioNrf()->setDtuSerial(config->Dtu.Serial);
+    Hoymiles.getRadioCmt()->setDtuSerial(config->Dtu.Serial);
 
     ESP_LOGI(TAG, "RF: Setting poll interval...");
-    Hoymiles.setPollInterval(config.Dtu.PollInterval);
+    Hoymiles.setPollInterval(config->Dtu.PollInterval);
 
     // Configure inverters
     for (uint8_t i = 0; i < INV_MAX_COUNT; i++) {
-        const auto& inv_cfg = config.Inverter[i];
+        const auto& inv_cfg = config->Inverter[i];
         if (inv_cfg.Serial == 0) {
             continue;
         }
@@ -99,8 +99,7 @@ void InverterSettingsClass::init(Scheduler& scheduler)
     }
     ESP_LOGI(TAG, "Initialization complete");
 
-    scheduler.addTask(_hoyTask);
-    _hoyTask.enable();
+    _hoyWorker.start(std::bind(&InverterSettingsClass::hoyLoop, this));
 
     scheduler.addTask(_settingsTask);
     _settingsTask.enable();
@@ -108,11 +107,11 @@ void InverterSettingsClass::init(Scheduler& scheduler)
 
 void InverterSettingsClass::settingsLoop()
 {
-    const CONFIG_T& config = Configuration.get();
+    auto const config = Configuration.get();
     const bool isDayPeriod = SunPosition.isDayPeriod();
 
     for (uint8_t i = 0; i < INV_MAX_COUNT; i++) {
-        auto const& inv_cfg = config.Inverter[i];
+        auto const& inv_cfg = config->Inverter[i];
         if (inv_cfg.Serial == 0) {
             continue;
         }
@@ -129,4 +128,8 @@ void InverterSettingsClass::settingsLoop()
 void InverterSettingsClass::hoyLoop()
 {
     Hoymiles.loop();
+
+    // the NRF receive channel is switched every 4 ms, so the radios are
+    // polled once per tick
+    vTaskDelay(1);
 }
@@ -0,0 +1,188 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#include "JsonPathExtractor.h"
+#include "Utils.h"
+
+#undef TAG
+static const char* TAG = "utils";
+
+template<typename T>
+char const* getExtractorTypename();
+
+template<>
+char const* getExtractorTypename<float>() { return "float"; }
+
+JsonPathExtractor::JsonPathExtractor(char const* path)
+    : _path(path)
+{
+    if (_path.empty()) { return; }
+
+    std::string_view remaining(_path);
+    while (true) {
+        size_t pos = remaining.find('/');
+        std::string_view key = remaining.substr(0, pos);
+
+        // handle double forward slashes and paths starting or ending with a slash
+        if (!key.empty()) {
+            if (key.front() == '[' && key.back() == ']') {
+                std::string idx(key.substr(1, key.length() - 2));
+                _steps.push_back({ std::string(key), atoi(idx.c_str()) });
+            } else {
+                _steps.push_back({ std::string(key), -1 });
+            }
+        }
+
+        if (pos == std::string_view::npos) { break; }
+        remaining.remove_prefix(pos + 1);
+    }
+
+    if (_steps.empty()) {
+        _filter.set(true);
+        return;
+    }
+
+    // the filter of the first element of an array applies to all elements
+    JsonObject obj;
+    JsonArray arr;
+    if (_steps.front().Index < 0) {
+        obj = _filter.to<JsonObject>();
+    } else {
+        arr = _filter.to<JsonArray>();
+    }
+
+    for (size_t i = 0; i < _steps.size(); ++i) {
+        Step const& step = _steps[i];
+
+        if (i + 1 == _steps.size()) {
+            if (step.Index < 0) {
+                obj[step.Key] = true;
+            } else {
+                arr.add(true);
+            }
+            break;
+        }
+
+        if (_steps[i + 1].Index < 0) {
+            obj = (step.Index < 0) ? obj[step.Key].to<JsonObject>() : arr.add<JsonObject>();
+        } else {
+            arr = (step.Index < 0) ? obj[step.Key].to<JsonArray>() : arr.add<JsonArray>();
+        }
+    }
+}
+
+template<typename T>
+std::optional<T> JsonPathExtractor::extractPlain(char const* client,
+        std::string_view src, char const* topic) const
+{
+    // the payload is not null-terminated, and a plain number is short
+    char value[32];
+    std::optional<T> res;
+    if (src.length() < sizeof(value)) {
+        memcpy(value, src.data(), src.length());
+        value[src.length()] = '\0';
+        res = Utils::getFromString<T>(value);
+    }
+
+    if (!res.has_value()) {
+        char logValue[36];
+        ESP_LOGE(TAG, "[%s] Topic '%s': cannot parse payload '%s' as %s", client, topic,
+                Utils::getLogExcerpt(logValue, src), getExtractorTypename<T>());
+    }
+
+    return res;
+}
+
+template<typename T>
+std::optional<T> JsonPathExtractor::extract(char const* client,
+        std::string_view src, char const* topic) const
+{
+    if (_path.empty()) {
+        return extractPlain<T>(client, src, topic);
+    }
+
+    char logValue[36];
+
+    JsonDocument json;
+
+    const DeserializationError error = deserializeJson(json, src.data(), src.length(),
+            DeserializationOption::Filter(_filter));
+    if (error) {
+        ESP_LOGE(TAG, "[%s] Topic '%s': cannot parse payload '%s' as JSON", client, topic,
+                Utils::getLogExcerpt(logValue, src));
+        return std::nullopt;
+    }
+
+    if (json.overflowed()) {
+        ESP_LOGE(TAG, "[%s] Topic '%s': payload too large to process as JSON", client, topic);
+        return std::nullopt;
+    }
+
+    auto res = resolve<T>(json.as<JsonVariantConst>());
+    if (!res.second.isEmpty()) {
+        ESP_LOGE(TAG, "[%s] Topic '%s': %s", client, topic, res.second.c_str());
+        return std::nullopt;
+    }
+
+    return res.first;
+}
+
+template<typename T>
+std::pair<T, String> JsonPathExtractor::resolve(JsonVariantConst root) const
+{
+    size_t constexpr kErrBufferSize = 256;
+    char errBuffer[kErrBufferSize];
+
+    // NOTE: "Because ArduinoJson implements the Null Object Pattern, it is
+    // always safe to read the object: if the key doesn't exist, it returns an
+    // empty value."
+    auto value = root;
+    for (auto const& step : _steps) {
+        if (step.Index < 0) {
+            value = value[step.Key];
+            if (value.isNull()) {
+                snprintf(errBuffer, kErrBufferSize, "Unable to access JSON key "
+                        "'%s' (JSON path '%s')", step.Key.c_str(), _path.c_str());
+                return { T(), String(errBuffer) };
+            }
+            continue;
+        }
+
+        if (!value.is<JsonArrayConst>()) {
+            snprintf(errBuffer, kErrBufferSize, "Cannot access non-array JSON "
+                    "node using array index '%s' (JSON path '%s')",
+                    step.Key.c_str(), _path.c_str());
+            return { T(), String(errBuffer) };
+        }
+
+        value = value[step.Index];
+        if (value.isNull()) {
+            snprintf(errBuffer, kErrBufferSize, "Unable to access JSON array "
+                    "index %d (JSON path '%s')", step.Index, _path.c_str());
+            return { T(), String(errBuffer) };
+        }
+    }
+
+    if (value.is<T>()) {
+        return { value.as<T>(), "" };
+    }
+
+    if (!value.is<char const*>()) {
+        snprintf(errBuffer, kErrBufferSize, "Value '%s' at JSON path '%s' is "
+                "neither a string nor of type %s", value.as<String>().c_str(),
+                _path.c_str(), getExtractorTypename<T>());
+        return { T(), String(errBuffer) };
+    }
+
+    auto res = Utils::getFromString<T>(value.as<char const*>());
+    if (!res.has_value()) {
+        snprintf(errBuffer, kErrBufferSize, "String '%s' at JSON path '%s' "
+                "cannot be converted to %s", value.as<char const*>(),
+                _path.c_str(), getExtractorTypename<T>());
+        return { T(), String(errBuffer) };
+    }
+
+    return { *res, "" };
+}
+
+template std::optional<float> JsonPathExtractor::extract(char const* client,
+        std::string_view src, char const* topic) const;
+template std::pair<float, String> JsonPathExtractor::resolve(JsonVariantConst root) const;
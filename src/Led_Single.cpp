@@ -74,7 +74,7 @@ void LedSingleClass::init(Scheduler& scheduler)
 void LedSingleClass::setLoop()
 {
     if (_allMode == LedState_t::On) {
-        const CONFIG_T& config = Configuration.get();
+        auto const config = Configuration.get();
 
         // Update network status
         _ledMode[0] = LedState_t::Off;
@@ -84,7 +84,7 @@ void LedSingleClass::setLoop()
         }
 
         struct tm timeinfo;
-        if (getLocalTime(&timeinfo, 5) && (!config.Mqtt.Enabled || (config.Mqtt.Enabled && MqttSettings.getConnected()))) {
+        if (getLocalTime(&timeinfo, 5) && (!config->Mqtt.Enabled || (config->Mqtt.Enabled && MqttSettings.getConnected()))) {
             _ledMode[0] = LedState_t::On;
         }
 
@@ -129,7 +129,7 @@ void LedSingleClass::outputLoop()
 void LedSingleClass::setLed(const uint8_t ledNo, const bool ledState)
 {
     const auto& pin = PinMapping.get();
-    const auto& config = Configuration.get();
+    auto const config = Configuration.get();
 
     if (pin.led[ledNo] == GPIO_NUM_NC) {
         return;
@@ -141,7 +141,7 @@ void LedSingleClass::setLed(const uint8_t ledNo, const bool ledState)
     const uint32_t currentPWM = ledcRead(pin.led[ledNo]);
 #endif
 
-    const uint32_t targetPWM = ledState ? pwmTable[config.Led_Single[ledNo].Brightness] : LED_OFF;
+    const uint32_t targetPWM = ledState ? pwmTable[config->Led_Single[ledNo].Brightness] : LED_OFF;
 
     if (currentPWM == targetPWM) {
         return;
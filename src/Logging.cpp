@@ -12,7 +12,7 @@ static const char* TAG = "logging";
 
 LoggingClass::LoggingClass()
 {
-    _configurableModules.reserve(13);
+    _configurableModules.reserve(14);
     _configurableModules.push_back("CORE");
     _configurableModules.push_back("hoymiles");
     _configurableModules.push_back("mqtt");
@@ -25,6 +25,7 @@ LoggingClass::LoggingClass()
     _configurableModules.push_back("gridCharger");
     _configurableModules.push_back("powerMeter");
     _configurableModules.push_back("solarCharger");
+    _configurableModules.push_back("taskProfiler");
     _configurableModules.push_back("veDirect");
 }
 
@@ -35,7 +36,8 @@ const std::vector<String>& LoggingClass::getConfigurableModules() const
 
 void LoggingClass::applyLogLevels()
 {
-    const auto& config = Configuration.get().Logging;
+    auto const spConfig = Configuration.get();
+    const auto& config = spConfig->Logging;
 
     ESP_LOGD(TAG, "Set default log level: %" PRId8, config.Default);
     esp_log_level_set("*", static_cast<esp_log_level_t>(config.Default));
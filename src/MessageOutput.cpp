@@ -17,128 +17,61 @@ void MessageOutputClass::init(Scheduler& scheduler)
 {
     scheduler.addTask(_loopTask);
     _loopTask.enable();
-    memset(_buffer, 0, sizeof(_buffer));
+    _consumer_task = xTaskGetCurrentTaskHandle();
     esp_log_set_vprintf(log_vprintf);
+
+    MetricsRegistry.add("logging_rate_limited_messages_total",
+        "Log messages dropped by the rate limiter", _rate_limited_total);
+    MetricsRegistry.add("logging_overrun_messages_total",
+        "Log messages dropped as the log ring was full", _overrun_total);
 }
 
 void MessageOutputClass::register_ws_output(AsyncWebSocket* output)
 {
-    std::lock_guard<std::mutex> lock(_msgLock);
-
     _ws = output;
 }
 
 int MessageOutputClass::log_vprintf(const char* fmt, va_list arguments)
 {
-    std::lock_guard<std::mutex> lock(MessageOutput._msgLock);
-    return MessageOutput.log_vprintf_rate_limited(fmt, arguments);
-}
-
-bool MessageOutputClass::consumeToken()
-{
-    uint32_t now = millis();
-
-    uint32_t elapsed = now - _last_token_refill_millis;
-    size_t new_tokens = RATE_LIMIT_MAX_TOKENS * elapsed / RATE_LIMIT_WINDOW_MS;
-
-    if (new_tokens > 0) {
-        _available_tokens = std::min(_available_tokens + new_tokens, RATE_LIMIT_MAX_TOKENS);
-        _last_token_refill_millis = now;
-    }
-
-    if (_available_tokens > 0) {
-        --_available_tokens;
-        return true;
-    }
-
-    return false;
-}
-
-int MessageOutputClass::log_self(const char* fmt, ...)
-{
-    va_list args;
-    va_start(args, fmt);
-    int ret = log_vprintf_recursive(fmt, args);
-    va_end(args);
-    return ret;
-}
-
-int MessageOutputClass::log_vprintf_rate_limited(const char* fmt, va_list arguments)
-{
-    if (!consumeToken()) {
-        if (_rate_limited_packets == 0) {
-            _last_rate_limit_warning_millis = millis();
-        }
-        ++_rate_limited_packets;
+    if (!MessageOutput.consumeToken()) {
+        MessageOutput._rate_limited_packets.fetch_add(1, std::memory_order_relaxed);
+        MessageOutput._rate_limited_total.increment();
         return 0;
     }
 
-    if (_rate_limited_packets > 0) {
-        uint32_t elapsed = millis() - _last_rate_limit_warning_millis;
-        if (elapsed > RATE_LIMIT_WARNING_INTERVAL_MS) {
-            log_self("W (%d) logging: Rate limited %d message%s in the last %d ms\n",
-                millis(), _rate_limited_packets,
-                (_rate_limited_packets > 1 ? "s" : ""), elapsed);
-            _rate_limited_packets = 0;
-            _last_rate_limit_warning_millis = millis();
-        }
+    int ret = MessageOutput._ring.vprintf(fmt, arguments);
+
+    if (!MessageOutput._loop_started.load(std::memory_order_relaxed)
+            && xTaskGetCurrentTaskHandle() == MessageOutput._consumer_task) {
+        MessageOutput.drain();
     }
 
-    return log_vprintf_recursive(fmt, arguments);
+    return ret;
 }
 
-int MessageOutputClass::log_vprintf_recursive(const char* fmt, va_list arguments)
+bool MessageOutputClass::consumeToken()
 {
-    // we can only write up to the end of the buffer
-    auto len = sizeof(_buffer) - _buffer_in;
-
-    // do not overwrite messages that still need processing. be careful not to
-    // overwrite the length prefix of the next message waiting to be processed,
-    // i.e., the byte that _buffer_out points to.
-    if (_buffer_out > _buffer_in) {
-        len = _buffer_out - _buffer_in;
-    }
-
-    len -= 1; // leave room for length prefix
+    uint32_t now = millis();
 
-    auto prefix = &_buffer[_buffer_in];
-    auto start = prefix + 1;
-    auto written = vsnprintf(start, len, fmt, arguments);
+    uint32_t last = _last_token_refill_millis.load(std::memory_order_relaxed);
+    uint32_t elapsed = std::min(now - last, RATE_LIMIT_WINDOW_MS);
+    int32_t new_tokens = RATE_LIMIT_MAX_TOKENS * elapsed / RATE_LIMIT_WINDOW_MS;
 
-    if (written < 0) {
-        if (Serial) {
-            static char const err_msg[] = "ERROR: vsnprintf failed: %d\n";
-            char err_buf[sizeof(err_msg) + 10];
-            auto err_written = snprintf(err_buf, sizeof(err_buf), err_msg, written);
-            Serial.write(err_buf, err_written);
-        }
-
-        *prefix = 0;
-        return written;
+    // only the task which advances the refill timestamp adds the new tokens
+    if (new_tokens > 0 && _last_token_refill_millis.compare_exchange_strong(last, now, std::memory_order_relaxed)) {
+        int32_t tokens = _available_tokens.load(std::memory_order_relaxed);
+        while (!_available_tokens.compare_exchange_weak(tokens,
+                std::min(tokens + new_tokens, RATE_LIMIT_MAX_TOKENS), std::memory_order_relaxed)) { }
     }
 
-    if (written >= len) {
-        // buffer was too small, at least at the current location
-        *prefix = 0;
-
-        if (_buffer_in > 0 && _buffer_out <= _buffer_in) {
-            // we can safely reset the buffer as there is no data ahead that
-            // still needs processing, so we try again from the beginning.
-            _buffer_in = 0;
-            return log_vprintf_recursive(fmt, arguments);
+    int32_t tokens = _available_tokens.load(std::memory_order_relaxed);
+    while (tokens > 0) {
+        if (_available_tokens.compare_exchange_weak(tokens, tokens - 1, std::memory_order_relaxed)) {
+            return true;
         }
-
-        if (Serial) {
-            Serial.write("ERROR: log buffer overrun\n");
-        }
-
-        return -1;
     }
 
-    written = std::min(written, 255); // effectively truncate to 255 bytes
-    *prefix = static_cast<uint8_t>(written);
-    _buffer_in += 1 + written; // now points to terminating null byte of message we just wrote
-    return written;
+    return false;
 }
 
 void MessageOutputClass::serialWrite(const uint8_t* buffer, size_t size)
@@ -199,30 +132,54 @@ void MessageOutputClass::send_ws_chunk(const uint8_t* buffer, size_t size)
     _last_ws_chunk_sent = millis();
 }
 
-void MessageOutputClass::loop()
+void MessageOutputClass::output(const uint8_t* buffer, size_t size)
 {
-    std::unique_lock<std::mutex> lock(_msgLock);
-
-    while (_buffer_out != _buffer_in) {
-        uint8_t msg_len = static_cast<uint8_t>(_buffer[_buffer_out]);
-        if (msg_len == 0) {
-            // we only read a null byte while we still have messages to process
-            // if we are at the end of the buffer and the next message is at the
-            // front. wrap around.
-            _buffer_out = 0;
-            continue;
-        }
+    serialWrite(buffer, size);
+    Syslog.write(buffer, size);
+    send_ws_chunk(buffer, size);
+}
+
+void MessageOutputClass::drain()
+{
+    // messages logged while writing to the outputs are written by the
+    // enclosing call
+    if (_draining) {
+        return;
+    }
+    _draining = true;
+
+    // the message is passed on while it occupies its space in the ring, so
+    // messages logged while writing to the outputs are appended behind it
+    while (_ring.consume([this](char const* text, size_t length) {
+        output(reinterpret_cast<const uint8_t*>(text), length);
+    })) { }
 
-        lock.unlock();
-        taskYIELD(); // allow high priority tasks to log while we process the buffer
+    _draining = false;
+}
+
+void MessageOutputClass::loop()
+{
+    _loop_started.store(true, std::memory_order_relaxed);
+    drain();
 
-        auto msg_start = reinterpret_cast<const uint8_t*>(&_buffer[_buffer_out]) + 1;
-        serialWrite(msg_start, msg_len);
-        Syslog.write(msg_start, msg_len);
-        send_ws_chunk(msg_start, msg_len);
+    char warning[96];
 
-        lock.lock();
+    uint32_t overrun = _ring.takeDropped();
+    if (overrun > 0) {
+        _overrun_total.increment(overrun);
+        int len = snprintf(warning, sizeof(warning), "W (%" PRIu32 ") logging: Log buffer overrun, dropped %" PRIu32 " message%s\n",
+            static_cast<uint32_t>(millis()), overrun, (overrun > 1 ? "s" : ""));
+        output(reinterpret_cast<const uint8_t*>(warning), std::min<size_t>(len, sizeof(warning) - 1));
+    }
 
-        _buffer_out += 1 + msg_len;
+    uint32_t elapsed = millis() - _last_rate_limit_warning_millis;
+    if (elapsed > RATE_LIMIT_WARNING_INTERVAL_MS) {
+        uint32_t limited = _rate_limited_packets.exchange(0, std::memory_order_relaxed);
+        if (limited > 0) {
+            int len = snprintf(warning, sizeof(warning), "W (%" PRIu32 ") logging: Rate limited %" PRIu32 " message%s in the last %" PRIu32 " ms\n",
+                static_cast<uint32_t>(millis()), limited, (limited > 1 ? "s" : ""), elapsed);
+            output(reinterpret_cast<const uint8_t*>(warning), std::min<size_t>(len, sizeof(warning) - 1));
+        }
+        _last_rate_limit_warning_millis = millis();
     }
 }
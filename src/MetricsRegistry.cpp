@@ -0,0 +1,103 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#include "MetricsRegistry.h"
+#include <algorithm>
+#include <cstring>
+
+Metrics::Registry MetricsRegistry;
+
+namespace Metrics {
+
+Histogram::Histogram(std::initializer_list<uint32_t> bounds)
+{
+    for (auto bound : bounds) {
+        if (_boundCount == MaxBounds) { break; }
+        _bounds[_boundCount++] = bound;
+    }
+
+    for (auto& bucket : _buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+void Histogram::observe(uint32_t value)
+{
+    auto bound = std::lower_bound(_bounds.begin(), _bounds.begin() + _boundCount, value);
+    _buckets[bound - _bounds.begin()].fetch_add(1, std::memory_order_relaxed);
+
+    _count.fetch_add(1, std::memory_order_relaxed);
+    _sum.fetch_add(value, std::memory_order_relaxed);
+
+    uint32_t max = _max.load(std::memory_order_relaxed);
+    while (value > max && !_max.compare_exchange_weak(max, value, std::memory_order_relaxed)) { }
+}
+
+std::shared_ptr<Counter> Registry::addCounter(const char* name, const char* help, Label label)
+{
+    auto counter = std::make_shared<Counter>();
+    add(name, help, std::move(label), counter);
+    return counter;
+}
+
+std::shared_ptr<Gauge> Registry::addGauge(const char* name, const char* help, Label label)
+{
+    auto gauge = std::make_shared<Gauge>();
+    add(name, help, std::move(label), gauge);
+    return gauge;
+}
+
+std::shared_ptr<Histogram> Registry::addHistogram(const char* name, const char* help, std::initializer_list<uint32_t> bounds, Label label)
+{
+    auto histogram = std::make_shared<Histogram>(bounds);
+    add(name, help, std::move(label), histogram);
+    return histogram;
+}
+
+void Registry::add(const char* name, const char* help, Metric const& metric, Label label)
+{
+    // does not own the metric
+    add(name, help, std::move(label), std::shared_ptr<Metric const>(std::shared_ptr<Metric const>(), &metric));
+}
+
+void Registry::add(const char* name, const char* help, Label&& label, std::shared_ptr<Metric const> metric)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _entries.push_back({ name, help, std::move(label), std::move(metric) });
+}
+
+void Registry::remove(std::shared_ptr<Metric const> const& metric)
+{
+    remove(*metric);
+}
+
+void Registry::remove(Metric const& metric)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _entries.erase(std::remove_if(_entries.begin(), _entries.end(),
+        [&metric](Entry const& entry) { return entry.Value.get() == &metric; }), _entries.end());
+}
+
+std::vector<Registry::Entry> Registry::getEntries() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    std::vector<Entry> result;
+    result.reserve(_entries.size());
+
+    // metrics sharing a name form one family, which must be contiguous
+    for (size_t i = 0; i < _entries.size(); ++i) {
+        auto const& first = _entries[i];
+        bool seen = std::any_of(_entries.begin(), _entries.begin() + i,
+            [&first](Entry const& e) { return strcmp(e.Name, first.Name) == 0; });
+        if (seen) { continue; }
+
+        for (size_t j = i; j < _entries.size(); ++j) {
+            if (strcmp(_entries[j].Name, first.Name) == 0) {
+                result.push_back(_entries[j]);
+            }
+        }
+    }
+
+    return result;
+}
+
+} // namespace Metrics
@@ -0,0 +1,84 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#include "MqttCommandCoalescer.h"
+
+MqttCommandCoalescer::MqttCommandCoalescer(size_t capacity)
+    : _slots(capacity, Slot { {}, 0, false, false, false })
+{
+}
+
+bool MqttCommandCoalescer::push(const Command& cmd)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    ++_received;
+
+    Slot* free = nullptr;
+    Slot* idle = nullptr;
+    for (auto& slot : _slots) {
+        if (!slot.Used) {
+            if (free == nullptr) { free = &slot; }
+            continue;
+        }
+
+        if (slot.Cmd.Id == cmd.Id && slot.Cmd.Target == cmd.Target) {
+            if (slot.Pending) { ++_coalesced; }
+            slot.Cmd = cmd;
+            slot.Pending = true;
+            return true;
+        }
+
+        if (!slot.Pending && idle == nullptr) { idle = &slot; }
+    }
+
+    // forgetting when an idle command was applied allows to apply it again
+    // immediately, which is acceptable if that many commands are in use.
+    Slot* slot = (free != nullptr) ? free : idle;
+    if (slot == nullptr) {
+        ++_dropped;
+        return false;
+    }
+
+    slot->Cmd = cmd;
+    slot->Used = true;
+    slot->Pending = true;
+    slot->Applied = false;
+    return true;
+}
+
+bool MqttCommandCoalescer::takeDue(uint32_t nowMillis, uint32_t intervalMillis, Command& cmd)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    for (auto& slot : _slots) {
+        if (!slot.Pending) { continue; }
+
+        if (slot.Applied && (nowMillis - slot.LastAppliedMillis) < intervalMillis) {
+            continue;
+        }
+
+        cmd = slot.Cmd;
+        slot.Pending = false;
+        slot.Applied = true;
+        slot.LastAppliedMillis = nowMillis;
+        ++_applied;
+        return true;
+    }
+
+    return false;
+}
+
+void MqttCommandCoalescer::clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto& slot : _slots) {
+        slot.Used = false;
+        slot.Pending = false;
+        slot.Applied = false;
+    }
+}
+
+MqttCommandCoalescer::Stats MqttCommandCoalescer::getStats() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return { _received, _applied, _coalesced, _dropped };
+}
@@ -4,28 +4,31 @@
  */
 #include "MqttHandleDtu.h"
 #include "Configuration.h"
+#include "MetricsRegistry.h"
 #include "MqttSettings.h"
 #include "NetworkSettings.h"
+#include "TaskProfiler.h"
 #include <CpuTemperature.h>
 #include <Hoymiles.h>
 
 MqttHandleDtuClass MqttHandleDtu;
 
 MqttHandleDtuClass::MqttHandleDtuClass()
-    : _loopTask(TASK_IMMEDIATE, TASK_FOREVER, std::bind(&MqttHandleDtuClass::loop, this))
+    : _loopTask(TASK_IMMEDIATE, TASK_FOREVER)
 {
 }
 
 void MqttHandleDtuClass::init(Scheduler& scheduler)
 {
     scheduler.addTask(_loopTask);
-    _loopTask.setInterval(Configuration.get().Mqtt.PublishInterval * TASK_SECOND);
+    _loopTask.setCallback(TaskProfiler.wrap("MQTT:DTU", std::bind(&MqttHandleDtuClass::loop, this)));
+    _loopTask.setInterval(Configuration.get()->Mqtt.PublishInterval * TASK_SECOND);
     _loopTask.enable();
 }
 
 void MqttHandleDtuClass::loop()
 {
-    _loopTask.setInterval(Configuration.get().Mqtt.PublishInterval * TASK_SECOND);
+    _loopTask.setInterval(Configuration.get()->Mqtt.PublishInterval * TASK_SECOND);
 
     if (!MqttSettings.getConnected() || !Hoymiles.isAllRadioIdle()) {
         _loopTask.forceNextIteration();
@@ -48,4 +51,33 @@ void MqttHandleDtuClass::loop()
     if (!std::isnan(temperature)) {
         MqttSettings.publish("dtu/temperature", String(temperature));
     }
+
+    publishMetrics();
+}
+
+void MqttHandleDtuClass::publishMetrics()
+{
+    for (auto const& entry : MetricsRegistry.getEntries()) {
+        String topic = String("dtu/metrics/") + entry.Name;
+        if (entry.Instance.Name != nullptr) {
+            topic += "/" + String(entry.Instance.Value.c_str());
+        }
+
+        switch (entry.Value->getType()) {
+        case Metrics::Type::Counter:
+            MqttSettings.publish(topic, String(static_cast<Metrics::Counter const&>(*entry.Value).get()));
+            break;
+        case Metrics::Type::Gauge:
+            MqttSettings.publish(topic, String(static_cast<Metrics::Gauge const&>(*entry.Value).get()));
+            break;
+        case Metrics::Type::Histogram: {
+            auto const& histogram = static_cast<Metrics::Histogram const&>(*entry.Value);
+            uint32_t count = histogram.getCount();
+            MqttSettings.publish(topic + "/count", String(count));
+            MqttSettings.publish(topic + "/max", String(histogram.getMax()));
+            MqttSettings.publish(topic + "/avg", String(count > 0 ? static_cast<uint32_t>(histogram.getSum() / count) : 0));
+            break;
+        }
+        }
+    }
 }
@@ -6,6 +6,7 @@
 #include "MqttHandleInverter.h"
 #include "MqttSettings.h"
 #include "NetworkSettings.h"
+#include "TaskProfiler.h"
 #include "Utils.h"
 #include "__compiled_constants.h"
 #include "defaults.h"
@@ -18,13 +19,14 @@ static const char* TAG = "mqtt";
 MqttHandleHassClass MqttHandleHass;
 
 MqttHandleHassClass::MqttHandleHassClass()
-    : _loopTask(TASK_IMMEDIATE, TASK_FOREVER, std::bind(&MqttHandleHassClass::loop, this))
+    : _loopTask(TASK_IMMEDIATE, TASK_FOREVER)
 {
 }
 
 void MqttHandleHassClass::init(Scheduler& scheduler)
 {
     scheduler.addTask(_loopTask);
+    _loopTask.setCallback(TaskProfiler.wrap("MQTT:HASS", std::bind(&MqttHandleHassClass::loop, this)));
     _loopTask.enable();
 }
 
@@ -40,19 +42,29 @@ void MqttHandleHassClass::loop()
     }
 
     if (_updateForced && _publishConfigTimeout.occured()) {
-        publishConfig();
         _updateForced = false;
+
+        if (Configuration.get()->Mqtt.Hass.Enabled) {
+            ESP_LOGI(TAG, "Publish HA config");
+            _publishConfigTimeout.set(MAX_CONFIG_PUBLISH_RATIO);
+            _pass.restart();
+        }
     }
+
+    // spread over several iterations, see MqttHassPass
+    _pass.step([this]() { publishConfig(); });
 }
 
 void MqttHandleHassClass::forceUpdate()
 {
+    // e.g., entities deleted in Home Assistant shall be recreated
+    MqttHassPublisher.forgetPublished();
     _updateForced = true;
 }
 
 void MqttHandleHassClass::publishConfig()
 {
-    if (!Configuration.get().Mqtt.Hass.Enabled) {
+    if (!Configuration.get()->Mqtt.Hass.Enabled) {
         return;
     }
 
@@ -60,10 +72,7 @@ void MqttHandleHassClass::publishConfig()
         return;
     }
 
-    ESP_LOGI(TAG, "Publish HA config");
-    _publishConfigTimeout.set(MAX_CONFIG_PUBLISH_RATIO);
-
-    const CONFIG_T& config = Configuration.get();
+    auto const config = Configuration.get();
 
     // publish DTU sensors
     publishDtuSensor("IP", "dtu/ip", "", "mdi:network-outline", DEVICE_CLS_NONE, STATE_CLS_NONE, CATEGORY_DIAGNOSTIC);
@@ -80,7 +89,7 @@ void MqttHandleHassClass::publishConfig()
     publishDtuSensor("AC Power", "ac/power", "W", "", DEVICE_CLS_PWR, STATE_CLS_MEASUREMENT, CATEGORY_NONE);
     publishDtuSensor("DC Power", "dc/power", "W", "", DEVICE_CLS_PWR, STATE_CLS_MEASUREMENT, CATEGORY_NONE);
 
-    publishDtuBinarySensor("Status", config.Mqtt.Lwt.Topic, config.Mqtt.Lwt.Value_Online, config.Mqtt.Lwt.Value_Offline, DEVICE_CLS_CONNECTIVITY, STATE_CLS_NONE, CATEGORY_DIAGNOSTIC);
+    publishDtuBinarySensor("Status", config->Mqtt.Lwt.Topic, config->Mqtt.Lwt.Value_Online, config->Mqtt.Lwt.Value_Offline, DEVICE_CLS_CONNECTIVITY, STATE_CLS_NONE, CATEGORY_DIAGNOSTIC);
 
     // Loop all inverters
     for (uint8_t i = 0; i < Hoymiles.getNumInverters(); i++) {
@@ -114,7 +123,7 @@ void MqttHandleHassClass::publishConfig()
             for (auto& c : inv->Statistics()->getChannelsByType(t)) {
                 for (uint8_t f = 0; f < DEVICE_CLS_ASSIGN_LIST_LEN; f++) {
                     bool clear = false;
-                    if (t == TYPE_DC && !config.Mqtt.Hass.IndividualPanels) {
+                    if (t == TYPE_DC && !config->Mqtt.Hass.IndividualPanels) {
                         clear = true;
                     }
                     publishInverterField(inv, t, c, deviceFieldAssignment[f], clear);
@@ -131,6 +140,10 @@ void MqttHandleHassClass::publishInverterField(std::shared_ptr<InverterAbstract>
         return;
     }
 
+    if (!_pass.claim()) {
+        return;
+    }
+
     const String serial = inv->serialString();
 
     String fieldName;
@@ -153,7 +166,8 @@ void MqttHandleHassClass::publishInverterField(std::shared_ptr<InverterAbstract>
         + "/config";
 
     if (!clear) {
-        const String stateTopic = MqttSettings.getPrefix() + MqttHandleInverter.getTopic(inv, type, channel, fieldType.fieldId);
+        MqttTopic stateTopic;
+        MqttHandleInverter.getTopic(stateTopic, inv, type, channel, fieldType.fieldId);
 
         String name;
         if (type != TYPE_DC) {
@@ -168,12 +182,15 @@ void MqttHandleHassClass::publishInverterField(std::shared_ptr<InverterAbstract>
         createInverterInfo(root, inv);
         addCommonMetadata(root, unit_of_measure, "", fieldType.deviceClsId, fieldType.stateClsId, CATEGORY_NONE);
 
+        // the state topic relative to the inverter's base topic
+        const size_t baseLength = stateTopic.prefixLength() + serial.length() + 1;
+        setInverterStateTopic(root, serial, stateTopic.c_str() + baseLength);
+
         root["name"] = name;
-        root["stat_t"] = stateTopic;
         root["uniq_id"] = serial + "_ch" + chanNum + "_" + fieldName;
 
-        if (Configuration.get().Mqtt.Hass.Expire) {
-            root["exp_aft"] = Hoymiles.getNumInverters() * max<uint32_t>(Hoymiles.PollInterval()/1000U, Configuration.get().Mqtt.PublishInterval) * inv->getReachableThreshold();
+        if (Configuration.get()->Mqtt.Hass.Expire) {
+            root["exp_aft"] = Hoymiles.getNumInverters() * max<uint32_t>(Hoymiles.PollInterval()/1000U, Configuration.get()->Mqtt.PublishInterval) * inv->getReachableThreshold();
         }
 
         publish(configTopic, root);
@@ -187,6 +204,10 @@ void MqttHandleHassClass::publishInverterButton(
     const String& icon,
     const DeviceClassType device_class, const StateClassType state_class, const CategoryType category)
 {
+    if (!_pass.claim()) {
+        return;
+    }
+
     const String serial = inv->serialString();
 
     String buttonId = name;
@@ -218,6 +239,10 @@ void MqttHandleHassClass::publishInverterNumber(
     const String& unit_of_measure, const String& icon,
     const StateClassType state_class, const CategoryType category)
 {
+    if (!_pass.claim()) {
+        return;
+    }
+
     const String serial = inv->serialString();
 
     String buttonId = name;
@@ -229,7 +254,6 @@ void MqttHandleHassClass::publishInverterNumber(
         + "/config";
 
     const String cmdTopic = MqttSettings.getPrefix() + serial + "/" + command_topic;
-    const String statTopic = MqttSettings.getPrefix() + serial + "/" + stateTopic;
 
     JsonDocument root;
     createInverterInfo(root, inv);
@@ -238,7 +262,7 @@ void MqttHandleHassClass::publishInverterNumber(
     root["name"] = name;
     root["uniq_id"] = serial + "_" + buttonId;
     root["cmd_t"] = cmdTopic;
-    root["stat_t"] = statTopic;
+    setInverterStateTopic(root, serial, stateTopic);
     root["min"] = min;
     root["max"] = max;
     root["step"] = step;
@@ -246,6 +270,14 @@ void MqttHandleHassClass::publishInverterNumber(
     publish(configTopic, root);
 }
 
+void MqttHandleHassClass::setInverterStateTopic(JsonDocument& root, const String& serial, const String& subtopic)
+{
+    const String base = serial + "/";
+    MqttSettings.setHassStateTopic(root,
+        std::string_view(base.c_str(), base.length()),
+        std::string_view(subtopic.c_str(), subtopic.length()));
+}
+
 void MqttHandleHassClass::createInverterInfo(JsonDocument& root, std::shared_ptr<InverterAbstract> inv)
 {
     createDeviceInfo(
@@ -303,9 +335,7 @@ String MqttHandleHassClass::getDtuUrl()
 
 void MqttHandleHassClass::publish(const String& subtopic, const String& payload)
 {
-    String topic = Configuration.get().Mqtt.Hass.Topic;
-    topic += subtopic;
-    MqttSettings.publishGeneric(topic, payload, Configuration.get().Mqtt.Hass.Retain);
+    MqttHassPublisher.publish(subtopic, payload);
     yield();
 }
 
@@ -343,7 +373,7 @@ void MqttHandleHassClass::addCommonMetadata(
 
 void MqttHandleHassClass::publishBinarySensor(
     JsonDocument& doc,
-    const String& root_device, const String& unique_id_prefix, const String& name, const String& state_topic, const String& payload_on, const String& payload_off,
+    const String& root_device, const String& unique_id_prefix, const String& name, const String& payload_on, const String& payload_off,
     const DeviceClassType device_class, const StateClassType state_class, const CategoryType category)
 {
     String sensor_id = name;
@@ -352,7 +382,6 @@ void MqttHandleHassClass::publishBinarySensor(
 
     doc["name"] = name;
     doc["uniq_id"] = unique_id_prefix + "_" + sensor_id;
-    doc["stat_t"] = MqttSettings.getPrefix() + state_topic;
     doc["pl_on"] = payload_on;
     doc["pl_off"] = payload_off;
 
@@ -366,27 +395,37 @@ void MqttHandleHassClass::publishDtuBinarySensor(
     const String& name, const String& state_topic, const String& payload_on, const String& payload_off,
     const DeviceClassType device_class, const StateClassType state_class, const CategoryType category)
 {
+    if (!_pass.claim()) {
+        return;
+    }
+
     const String dtuId = getDtuUniqueId();
 
     JsonDocument root;
     createDtuInfo(root);
-    publishBinarySensor(root, dtuId, dtuId, name, state_topic, payload_on, payload_off, device_class, state_class, category);
+    root["stat_t"] = MqttSettings.getPrefix() + state_topic;
+    publishBinarySensor(root, dtuId, dtuId, name, payload_on, payload_off, device_class, state_class, category);
 }
 
 void MqttHandleHassClass::publishInverterBinarySensor(
     std::shared_ptr<InverterAbstract> inv, const String& name, const String& state_topic, const String& payload_on, const String& payload_off,
     const DeviceClassType device_class, const StateClassType state_class, const CategoryType category)
 {
+    if (!_pass.claim()) {
+        return;
+    }
+
     const String serial = inv->serialString();
 
     JsonDocument root;
     createInverterInfo(root, inv);
-    publishBinarySensor(root, "dtu_" + serial, serial, name, serial + "/" + state_topic, payload_on, payload_off, device_class, state_class, category);
+    setInverterStateTopic(root, serial, state_topic);
+    publishBinarySensor(root, "dtu_" + serial, serial, name, payload_on, payload_off, device_class, state_class, category);
 }
 
 void MqttHandleHassClass::publishSensor(
     JsonDocument& doc,
-    const String& root_device, const String& unique_id_prefix, const String& name, const String& state_topic,
+    const String& root_device, const String& unique_id_prefix, const String& name,
     const String& unit_of_measure, const String& icon,
     const DeviceClassType device_class, const StateClassType state_class, const CategoryType category)
 {
@@ -396,14 +435,13 @@ void MqttHandleHassClass::publishSensor(
 
     doc["name"] = name;
     doc["uniq_id"] = unique_id_prefix + "_" + sensor_id;
-    doc["stat_t"] = MqttSettings.getPrefix() + state_topic;
 
     addCommonMetadata(doc, unit_of_measure, icon, device_class, state_class, category);
 
-    const CONFIG_T& config = Configuration.get();
-    doc["avty_t"] = MqttSettings.getPrefix() + config.Mqtt.Lwt.Topic;
-    doc["pl_avail"] = config.Mqtt.Lwt.Value_Online;
-    doc["pl_not_avail"] = config.Mqtt.Lwt.Value_Offline;
+    auto const config = Configuration.get();
+    doc["avty_t"] = MqttSettings.getPrefix() + config->Mqtt.Lwt.Topic;
+    doc["pl_avail"] = config->Mqtt.Lwt.Value_Online;
+    doc["pl_not_avail"] = config->Mqtt.Lwt.Value_Offline;
 
     const String configTopic = "sensor/" + root_device + "/" + sensor_id + "/config";
     publish(configTopic, doc);
@@ -414,11 +452,16 @@ void MqttHandleHassClass::publishDtuSensor(
     const String& unit_of_measure, const String& icon,
     const DeviceClassType device_class, const StateClassType state_class, const CategoryType category)
 {
+    if (!_pass.claim()) {
+        return;
+    }
+
     const String dtuId = getDtuUniqueId();
 
     JsonDocument root;
     createDtuInfo(root);
-    publishSensor(root, dtuId, dtuId, name, state_topic, unit_of_measure, icon, device_class, state_class, category);
+    root["stat_t"] = MqttSettings.getPrefix() + state_topic;
+    publishSensor(root, dtuId, dtuId, name, unit_of_measure, icon, device_class, state_class, category);
 }
 
 void MqttHandleHassClass::publishInverterSensor(
@@ -426,9 +469,14 @@ void MqttHandleHassClass::publishInverterSensor(
     const String& unit_of_measure, const String& icon,
     const DeviceClassType device_class, const StateClassType state_class, const CategoryType category)
 {
+    if (!_pass.claim()) {
+        return;
+    }
+
     const String serial = inv->serialString();
 
     JsonDocument root;
     createInverterInfo(root, inv);
-    publishSensor(root, "dtu_" + serial, serial, name, serial + "/" + state_topic, unit_of_measure, icon, device_class, state_class, category);
+    setInverterStateTopic(root, serial, state_topic);
+    publishSensor(root, "dtu_" + serial, serial, name, unit_of_measure, icon, device_class, state_class, category);
 }
@@ -4,17 +4,17 @@
  */
 #include "MqttHandleInverter.h"
 #include "MqttSettings.h"
+#include "TaskProfiler.h"
 #include <ctime>
 
 #undef TAG
 static const char* TAG = "mqtt";
 
-#define PUBLISH_MAX_INTERVAL 60000
-
 MqttHandleInverterClass MqttHandleInverter;
 
 MqttHandleInverterClass::MqttHandleInverterClass()
-    : _loopTask(TASK_IMMEDIATE, TASK_FOREVER, std::bind(&MqttHandleInverterClass::loop, this))
+    : _loopTask(TASK_IMMEDIATE, TASK_FOREVER)
+    , _commandTask(TASK_IMMEDIATE, TASK_FOREVER)
 {
 }
 
@@ -23,13 +23,24 @@ void MqttHandleInverterClass::init(Scheduler& scheduler)
     subscribeTopics();
 
     scheduler.addTask(_loopTask);
-    _loopTask.setInterval(Configuration.get().Mqtt.PublishInterval * TASK_SECOND);
+    _loopTask.setCallback(TaskProfiler.wrap("MQTT:Inverter", std::bind(&MqttHandleInverterClass::loop, this)));
+    _loopTask.setInterval(Configuration.get()->Mqtt.PublishInterval * TASK_SECOND);
     _loopTask.enable();
+
+    scheduler.addTask(_commandTask);
+    _commandTask.setCallback(TaskProfiler.wrap("MQTT:InverterCmd", std::bind(&MqttHandleInverterClass::commandLoop, this)));
+    _commandTask.enable();
+}
+
+void MqttHandleInverterClass::commandLoop()
+{
+    _commands.poll(millis(), Configuration.get()->Mqtt.CommandInterval,
+        std::bind(&MqttHandleInverterClass::applyCommand, this, std::placeholders::_1));
 }
 
 void MqttHandleInverterClass::loop()
 {
-    _loopTask.setInterval(Configuration.get().Mqtt.PublishInterval * TASK_SECOND);
+    _loopTask.setInterval(Configuration.get()->Mqtt.PublishInterval * TASK_SECOND);
 
     if (!MqttSettings.getConnected() || !Hoymiles.isAllRadioIdle()) {
         _loopTask.forceNextIteration();
@@ -40,54 +51,65 @@ void MqttHandleInverterClass::loop()
     for (uint8_t i = 0; i < Hoymiles.getNumInverters(); i++) {
         auto inv = Hoymiles.getInverterByPos(i);
 
-        const String subtopic = inv->serialString();
+        MqttTopic topic;
+        topic.append(inv->serialString());
+        const size_t base = topic.length();
 
-        // Name
-        MqttSettings.publish(subtopic + "/name", inv->name());
+        topic.append("/");
+        MqttBatch batch(std::string_view(topic.c_str() + topic.prefixLength(), topic.length() - topic.prefixLength()));
 
-        // Radio Statistics
-        MqttSettings.publish(subtopic + "/radio/tx_request", String(inv->RadioStats.TxRequestData));
-        MqttSettings.publish(subtopic + "/radio/tx_re_request", String(inv->RadioStats.TxReRequestFragment));
-        MqttSettings.publish(subtopic + "/radio/rx_success", String(inv->RadioStats.RxSuccess));
-        MqttSettings.publish(subtopic + "/radio/rx_fail_nothing", String(inv->RadioStats.RxFailNoAnswer));
-        MqttSettings.publish(subtopic + "/radio/rx_fail_partial", String(inv->RadioStats.RxFailPartialAnswer));
-        MqttSettings.publish(subtopic + "/radio/rx_fail_corrupt", String(inv->RadioStats.RxFailCorruptData));
-        MqttSettings.publish(subtopic + "/radio/rssi", String(inv->getLastRssi()));
+        auto publish = [&topic, base](const char* subtopic, const MqttValue& value, const float deadband = 0) {
+            MqttSettings.publishIfChanged(topic.truncate(base).append(subtopic), value, deadband);
+        };
+
+        // Name
+        publish("/name", inv->name());
+
+        // Radio Statistics. the request and success counters increase with
+        // every poll, so they are published in steps.
+        publish("/radio/tx_request", inv->RadioStats.TxRequestData, 10);
+        publish("/radio/tx_re_request", inv->RadioStats.TxReRequestFragment);
+        publish("/radio/rx_success", inv->RadioStats.RxSuccess, 10);
+        publish("/radio/rx_fail_nothing", inv->RadioStats.RxFailNoAnswer);
+        publish("/radio/rx_fail_partial", inv->RadioStats.RxFailPartialAnswer);
+        publish("/radio/rx_fail_corrupt", inv->RadioStats.RxFailCorruptData);
+        publish("/radio/rssi", inv->getLastRssi(), 3);
 
         if (inv->DevInfo()->getLastUpdate() > 0) {
             // Bootloader Version
-            MqttSettings.publish(subtopic + "/device/bootloaderversion", String(inv->DevInfo()->getFwBootloaderVersion()));
+            publish("/device/bootloaderversion", inv->DevInfo()->getFwBootloaderVersion());
 
             // Firmware Version
-            MqttSettings.publish(subtopic + "/device/fwbuildversion", String(inv->DevInfo()->getFwBuildVersion()));
+            publish("/device/fwbuildversion", inv->DevInfo()->getFwBuildVersion());
 
             // Firmware Build DateTime
-            MqttSettings.publish(subtopic + "/device/fwbuilddatetime", inv->DevInfo()->getFwBuildDateTimeStr());
+            publish("/device/fwbuilddatetime", inv->DevInfo()->getFwBuildDateTimeStr());
 
             // Hardware part number
-            MqttSettings.publish(subtopic + "/device/hwpartnumber", String(inv->DevInfo()->getHwPartNumber()));
+            publish("/device/hwpartnumber", inv->DevInfo()->getHwPartNumber());
 
             // Hardware version
-            MqttSettings.publish(subtopic + "/device/hwversion", inv->DevInfo()->getHwVersion());
+            publish("/device/hwversion", inv->DevInfo()->getHwVersion());
         }
 
         if (inv->SystemConfigPara()->getLastUpdate() > 0) {
             // Limit
-            MqttSettings.publish(subtopic + "/status/limit_relative", String(inv->SystemConfigPara()->getLimitPercent()));
+            publish("/status/limit_relative", inv->SystemConfigPara()->getLimitPercent());
 
             uint16_t maxpower = inv->DevInfo()->getMaxPower();
             if (maxpower > 0) {
-                MqttSettings.publish(subtopic + "/status/limit_absolute", String(inv->SystemConfigPara()->getLimitPercent() * maxpower / 100));
+                publish("/status/limit_absolute", inv->SystemConfigPara()->getLimitPercent() * maxpower / 100);
             }
         }
 
-        MqttSettings.publish(subtopic + "/status/reachable", String(inv->isReachable()));
-        MqttSettings.publish(subtopic + "/status/producing", String(inv->isProducing()));
+        publish("/status/reachable", inv->isReachable());
+        publish("/status/producing", inv->isProducing());
 
         if (inv->Statistics()->getLastUpdate() > 0) {
-            MqttSettings.publish(subtopic + "/status/last_update", String(std::time(0) - (millis() - inv->Statistics()->getLastUpdate()) / 1000));
+            // the derived timestamp jitters by one second between publishes
+            publish("/status/last_update", std::time(0) - (millis() - inv->Statistics()->getLastUpdate()) / 1000, 2);
         } else {
-            MqttSettings.publish(subtopic + "/status/last_update", String(0));
+            publish("/status/last_update", 0);
         }
 
         const uint32_t lastUpdateInternal = inv->Statistics()->getLastUpdateFromInternal();
@@ -98,10 +120,11 @@ void MqttHandleInverterClass::loop()
             for (auto& t : inv->Statistics()->getChannelTypes()) {
                 for (auto& c : inv->Statistics()->getChannelsByType(t)) {
                     if (t == TYPE_DC) {
-                        INVERTER_CONFIG_T* inv_cfg = Configuration.getInverterConfig(inv->serial());
+                        auto const inv_cfg = Configuration.getInverterConfig(inv->serial());
                         if (inv_cfg != nullptr) {
                             // TODO(tbnobody)
-                            MqttSettings.publish(inv->serialString() + "/" + String(static_cast<uint8_t>(c) + 1) + "/name", inv_cfg->channel[c].Name);
+                            topic.truncate(base).append("/").append(static_cast<uint32_t>(c) + 1).append("/name");
+                            MqttSettings.publishIfChanged(topic, inv_cfg->channel[c].Name);
                         }
                     }
                     for (uint8_t f = 0; f < sizeof(_publishFields) / sizeof(FieldId_t); f++) {
@@ -117,48 +140,55 @@ void MqttHandleInverterClass::loop()
 
 void MqttHandleInverterClass::publishField(std::shared_ptr<InverterAbstract> inv, const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId)
 {
-    const String topic = getTopic(inv, type, channel, fieldId);
-    if (topic == "") {
+    MqttTopic topic;
+    if (!getTopic(topic, inv, type, channel, fieldId)) {
         return;
     }
 
-    MqttSettings.publish(topic, inv->Statistics()->getChannelFieldValueString(type, channel, fieldId));
+    auto it = _fieldDeadbands.find(fieldId);
+    float deadband = (it != _fieldDeadbands.end()) ? it->second : 0;
+
+    auto stats = inv->Statistics();
+    MqttValue value(stats->getChannelFieldValue(type, channel, fieldId), stats->getChannelFieldDigits(type, channel, fieldId));
+
+    MqttSettings.publishIfChanged(topic, value, deadband);
 }
 
-String MqttHandleInverterClass::getTopic(std::shared_ptr<InverterAbstract> inv, const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId)
+bool MqttHandleInverterClass::getTopic(MqttTopic& topic, std::shared_ptr<InverterAbstract> inv, const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId)
 {
     if (!inv->Statistics()->hasChannelFieldValue(type, channel, fieldId)) {
-        return "";
+        return false;
     }
 
-    String chanName;
-    if (type == TYPE_INV && fieldId == FLD_PDC) {
-        chanName = "powerdc";
-    } else {
-        chanName = inv->Statistics()->getChannelFieldName(type, channel, fieldId);
-        chanName.toLowerCase();
-    }
+    topic.append(inv->serialString()).append("/");
 
-    String chanNum;
     if (type == TYPE_DC) {
         // TODO(tbnobody)
-        chanNum = static_cast<uint8_t>(channel) + 1;
+        topic.append(static_cast<uint32_t>(channel) + 1);
     } else {
-        chanNum = channel;
+        topic.append(static_cast<uint32_t>(channel));
     }
 
-    return inv->serialString() + "/" + chanNum + "/" + chanName;
+    topic.append("/");
+
+    if (type == TYPE_INV && fieldId == FLD_PDC) {
+        topic.append("powerdc");
+    } else {
+        topic.appendLowerCase(inv->Statistics()->getChannelFieldName(type, channel, fieldId));
+    }
+
+    return true;
 }
 
 void MqttHandleInverterClass::onMqttMessage(Topic t, const espMqttClientTypes::MessageProperties& properties, const char* topic, const uint8_t* payload, const size_t len)
 {
-    const CONFIG_T& config = Configuration.get();
+    auto const config = Configuration.get();
 
     char token_topic[MQTT_MAX_TOPIC_STRLEN + 40]; // respect all subtopics
     strncpy(token_topic, topic, MQTT_MAX_TOPIC_STRLEN + 40); // convert const char* to char*
 
     char* serial_str;
-    char* rest = &token_topic[strlen(config.Mqtt.Topic)];
+    char* rest = &token_topic[strlen(config->Mqtt.Topic)];
 
     serial_str = strtok_r(rest, "/", &rest);
 
@@ -168,9 +198,7 @@ void MqttHandleInverterClass::onMqttMessage(Topic t, const espMqttClientTypes::M
 
     const uint64_t serial = strtoull(serial_str, 0, 16);
 
-    auto inv = Hoymiles.getInverterBySerial(serial);
-
-    if (inv == nullptr) {
+    if (Hoymiles.getInverterBySerial(serial) == nullptr) {
         ESP_LOGW(TAG, "Inverter not found");
         return;
     }
@@ -185,7 +213,22 @@ void MqttHandleInverterClass::onMqttMessage(Topic t, const espMqttClientTypes::M
         return;
     }
 
-    switch (t) {
+    if (!_commands.push({ static_cast<uint32_t>(t), serial, payload_val, properties.retain })) {
+        ESP_LOGW(TAG, "Too many pending commands, dropping '%s'", topic);
+    }
+}
+
+void MqttHandleInverterClass::applyCommand(const MqttCommandCoalescer::Command& cmd)
+{
+    // the inverter might have been removed in the meantime
+    auto inv = Hoymiles.getInverterBySerial(cmd.Target);
+    if (inv == nullptr) {
+        return;
+    }
+
+    const float payload_val = cmd.Value;
+
+    switch (static_cast<Topic>(cmd.Id)) {
     case Topic::LimitPersistentRelative:
         // Set inverter limit relative persistent
         ESP_LOGI(TAG, "Limit Persistent: %.1f %%", payload_val);
@@ -201,7 +244,7 @@ void MqttHandleInverterClass::onMqttMessage(Topic t, const espMqttClientTypes::M
     case Topic::LimitNonPersistentRelative:
         // Set inverter limit relative non persistent
         ESP_LOGI(TAG, "Limit Non-Persistent: %.1f %%", payload_val);
-        if (!properties.retain) {
+        if (!cmd.Retain) {
             inv->sendActivePowerControlRequest(payload_val, PowerLimitControlType::RelativNonPersistent);
         } else {
             ESP_LOGW(TAG, "Ignored because retained");
@@ -211,7 +254,7 @@ void MqttHandleInverterClass::onMqttMessage(Topic t, const espMqttClientTypes::M
     case Topic::LimitNonPersistentAbsolute:
         // Set inverter limit absolute non persistent
         ESP_LOGI(TAG, "Limit Non-Persistent: %.1f W", payload_val);
-        if (!properties.retain) {
+        if (!cmd.Retain) {
             inv->sendActivePowerControlRequest(payload_val, PowerLimitControlType::AbsolutNonPersistent);
         } else {
             ESP_LOGW(TAG, "Ignored because retained");
@@ -227,7 +270,7 @@ void MqttHandleInverterClass::onMqttMessage(Topic t, const espMqttClientTypes::M
     case Topic::Restart:
         // Restart inverter
         ESP_LOGI(TAG, "Restart inverter");
-        if (!properties.retain && payload_val == 1) {
+        if (!cmd.Retain && payload_val == 1) {
             inv->sendRestartControlRequest();
         } else {
             ESP_LOGW(TAG, "Ignored because retained or numeric value not '1'");
@@ -237,7 +280,7 @@ void MqttHandleInverterClass::onMqttMessage(Topic t, const espMqttClientTypes::M
     case Topic::ResetRfStats:
         // Reset RF Stats
         ESP_LOGI(TAG, "Reset RF stats");
-        if (!properties.retain && payload_val == 1) {
+        if (!cmd.Retain && payload_val == 1) {
             inv->resetRadioStats();
         } else {
             ESP_LOGW(TAG, "Ignored because retained or numeric value not '1'");
@@ -6,37 +6,44 @@
 #include "Configuration.h"
 #include "Datastore.h"
 #include "MqttSettings.h"
+#include "TaskProfiler.h"
 #include <Hoymiles.h>
 
 MqttHandleInverterTotalClass MqttHandleInverterTotal;
 
 MqttHandleInverterTotalClass::MqttHandleInverterTotalClass()
-    : _loopTask(TASK_IMMEDIATE, TASK_FOREVER, std::bind(&MqttHandleInverterTotalClass::loop, this))
+    : _loopTask(TASK_IMMEDIATE, TASK_FOREVER)
 {
 }
 
 void MqttHandleInverterTotalClass::init(Scheduler& scheduler)
 {
     scheduler.addTask(_loopTask);
-    _loopTask.setInterval(Configuration.get().Mqtt.PublishInterval * TASK_SECOND);
+    _loopTask.setCallback(TaskProfiler.wrap("MQTT:InverterTotal", std::bind(&MqttHandleInverterTotalClass::loop, this)));
+    _loopTask.setInterval(Configuration.get()->Mqtt.PublishInterval * TASK_SECOND);
     _loopTask.enable();
 }
 
 void MqttHandleInverterTotalClass::loop()
 {
     // Update interval from config
-    _loopTask.setInterval(Configuration.get().Mqtt.PublishInterval * TASK_SECOND);
+    _loopTask.setInterval(Configuration.get()->Mqtt.PublishInterval * TASK_SECOND);
 
     if (!MqttSettings.getConnected() || !Hoymiles.isAllRadioIdle()) {
         _loopTask.forceNextIteration();
         return;
     }
 
-    MqttSettings.publish("ac/power", String(Datastore.getTotalAcPowerEnabled(), Datastore.getTotalAcPowerDigits()));
-    MqttSettings.publish("ac/yieldtotal", String(Datastore.getTotalAcYieldTotalEnabled(), Datastore.getTotalAcYieldTotalDigits()));
-    MqttSettings.publish("ac/yieldday", String(Datastore.getTotalAcYieldDayEnabled(), Datastore.getTotalAcYieldDayDigits()));
-    MqttSettings.publish("ac/is_valid", String(Datastore.getIsAllEnabledReachable()));
-    MqttSettings.publish("dc/power", String(Datastore.getTotalDcPowerEnabled(), Datastore.getTotalDcPowerDigits()));
-    MqttSettings.publish("dc/irradiation", String(Datastore.getTotalDcIrradiation(), 3));
-    MqttSettings.publish("dc/is_valid", String(Datastore.getIsAllEnabledReachable()));
+    auto publish = [](const char* subtopic, const MqttValue& value) {
+        MqttTopic topic;
+        MqttSettings.publish(topic.append(subtopic), value);
+    };
+
+    publish("ac/power", MqttValue(Datastore.getTotalAcPowerEnabled(), Datastore.getTotalAcPowerDigits()));
+    publish("ac/yieldtotal", MqttValue(Datastore.getTotalAcYieldTotalEnabled(), Datastore.getTotalAcYieldTotalDigits()));
+    publish("ac/yieldday", MqttValue(Datastore.getTotalAcYieldDayEnabled(), Datastore.getTotalAcYieldDayDigits()));
+    publish("ac/is_valid", Datastore.getIsAllEnabledReachable());
+    publish("dc/power", MqttValue(Datastore.getTotalDcPowerEnabled(), Datastore.getTotalDcPowerDigits()));
+    publish("dc/irradiation", MqttValue(Datastore.getTotalDcIrradiation(), 3));
+    publish("dc/is_valid", Datastore.getIsAllEnabledReachable());
 }
@@ -5,6 +5,7 @@
 #include "MqttSettings.h"
 #include "MqttHandlePowerLimiter.h"
 #include "PowerLimiter.h"
+#include "TaskProfiler.h"
 #include <ctime>
 #include <string>
 #include <LogHelper.h>
@@ -18,7 +19,7 @@ MqttHandlePowerLimiterClass MqttHandlePowerLimiter;
 void MqttHandlePowerLimiterClass::init(Scheduler& scheduler)
 {
     scheduler.addTask(_loopTask);
-    _loopTask.setCallback(std::bind(&MqttHandlePowerLimiterClass::loop, this));
+    _loopTask.setCallback(TaskProfiler.wrap("MQTT:DPL", std::bind(&MqttHandlePowerLimiterClass::loop, this)));
     _loopTask.setIterations(TASK_FOREVER);
     _loopTask.enable();
 
@@ -64,56 +65,51 @@ void MqttHandlePowerLimiterClass::unsubscribeTopics()
 
 void MqttHandlePowerLimiterClass::loop()
 {
-    std::unique_lock<std::mutex> mqttLock(_mqttMutex);
+    auto const config = Configuration.get();
 
-    auto const& config = Configuration.get();
+    _commands.poll(millis(), config->Mqtt.CommandInterval,
+            std::bind(&MqttHandlePowerLimiterClass::applyCmd, this, std::placeholders::_1));
 
-    if (!config.PowerLimiter.Enabled) {
-        _mqttCallbacks.clear();
-        return;
-    }
-
-    for (auto& callback : _mqttCallbacks) { callback(); }
-    _mqttCallbacks.clear();
-
-    mqttLock.unlock();
+    if (!config->PowerLimiter.Enabled) { return; }
 
     if (!MqttSettings.getConnected() ) { return; }
 
-    if ((millis() - _lastPublish) < (config.Mqtt.PublishInterval * 1000)) {
+    if ((millis() - _lastPublish) < (config->Mqtt.PublishInterval * 1000)) {
         return;
     }
 
     _lastPublish = millis();
 
+    MqttBatch batch("powerlimiter/");
+
     auto val = static_cast<unsigned>(PowerLimiter.getMode());
     MqttSettings.publish("powerlimiter/status/mode", String(val));
 
-    MqttSettings.publish("powerlimiter/status/upper_power_limit", String(config.PowerLimiter.TotalUpperPowerLimit));
+    MqttSettings.publish("powerlimiter/status/upper_power_limit", String(config->PowerLimiter.TotalUpperPowerLimit));
 
-    MqttSettings.publish("powerlimiter/status/target_power_consumption", String(config.PowerLimiter.TargetPowerConsumption));
+    MqttSettings.publish("powerlimiter/status/target_power_consumption", String(config->PowerLimiter.TargetPowerConsumption));
 
     MqttSettings.publish("powerlimiter/status/inverter_update_timeouts", String(PowerLimiter.getInverterUpdateTimeouts()));
 
     // no thresholds are relevant for setups without a battery
     if (!PowerLimiter.usesBatteryPoweredInverter()) { return; }
 
-    MqttSettings.publish("powerlimiter/status/threshold/voltage/start", String(config.PowerLimiter.VoltageStartThreshold));
-    MqttSettings.publish("powerlimiter/status/threshold/voltage/stop", String(config.PowerLimiter.VoltageStopThreshold));
+    MqttSettings.publish("powerlimiter/status/threshold/voltage/start", String(config->PowerLimiter.VoltageStartThreshold));
+    MqttSettings.publish("powerlimiter/status/threshold/voltage/stop", String(config->PowerLimiter.VoltageStopThreshold));
 
-    if (config.SolarCharger.Enabled) {
+    if (config->SolarCharger.Enabled) {
         MqttSettings.publish("powerlimiter/status/full_solar_passthrough_active", String(PowerLimiter.isFullSolarPassthroughActive()));
-        MqttSettings.publish("powerlimiter/status/threshold/voltage/full_solar_passthrough_start", String(config.PowerLimiter.FullSolarPassThroughStartVoltage));
-        MqttSettings.publish("powerlimiter/status/threshold/voltage/full_solar_passthrough_stop", String(config.PowerLimiter.FullSolarPassThroughStopVoltage));
+        MqttSettings.publish("powerlimiter/status/threshold/voltage/full_solar_passthrough_start", String(config->PowerLimiter.FullSolarPassThroughStartVoltage));
+        MqttSettings.publish("powerlimiter/status/threshold/voltage/full_solar_passthrough_stop", String(config->PowerLimiter.FullSolarPassThroughStopVoltage));
     }
 
-    if (!config.Battery.Enabled || config.PowerLimiter.IgnoreSoc) { return; }
+    if (!config->Battery.Enabled || config->PowerLimiter.IgnoreSoc) { return; }
 
-    MqttSettings.publish("powerlimiter/status/threshold/soc/start", String(config.PowerLimiter.BatterySocStartThreshold));
-    MqttSettings.publish("powerlimiter/status/threshold/soc/stop", String(config.PowerLimiter.BatterySocStopThreshold));
+    MqttSettings.publish("powerlimiter/status/threshold/soc/start", String(config->PowerLimiter.BatterySocStartThreshold));
+    MqttSettings.publish("powerlimiter/status/threshold/soc/stop", String(config->PowerLimiter.BatterySocStopThreshold));
 
-    if (config.SolarCharger.Enabled) {
-        MqttSettings.publish("powerlimiter/status/threshold/soc/full_solar_passthrough", String(config.PowerLimiter.FullSolarPassThroughSoc));
+    if (config->SolarCharger.Enabled) {
+        MqttSettings.publish("powerlimiter/status/threshold/soc/full_solar_passthrough", String(config->PowerLimiter.FullSolarPassThroughSoc));
     }
 }
 
@@ -128,84 +124,104 @@ void MqttHandlePowerLimiterClass::onMqttCmd(MqttPowerLimiterCommand command, con
         DTU_LOGE("cannot parse payload of topic '%s' as float: %s", topic, strValue.c_str());
         return;
     }
+
+    if (!_commands.push({ static_cast<uint32_t>(command), 0, payload_val, properties.retain })) {
+        DTU_LOGW("too many pending commands, dropping '%s'", topic);
+    }
+}
+
+void MqttHandlePowerLimiterClass::applyCmd(MqttCommandCoalescer::Command const& cmd)
+{
+    auto const command = static_cast<MqttPowerLimiterCommand>(cmd.Id);
+    float const payload_val = cmd.Value;
     const int intValue = static_cast<int>(payload_val);
 
     if (command == MqttPowerLimiterCommand::Mode) {
-        std::lock_guard<std::mutex> mqttLock(_mqttMutex);
+        if (!Configuration.get()->PowerLimiter.Enabled) { return; }
+
         using Mode = PowerLimiterClass::Mode;
         Mode mode = static_cast<Mode>(intValue);
         if (mode == Mode::UnconditionalFullSolarPassthrough) {
             DTU_LOGI("Power limiter unconditional full solar PT");
-            _mqttCallbacks.push_back(std::bind(&PowerLimiterClass::setMode,
-                        &PowerLimiter, Mode::UnconditionalFullSolarPassthrough));
+            PowerLimiter.setMode(Mode::UnconditionalFullSolarPassthrough);
         } else if (mode == Mode::Disabled) {
             DTU_LOGI("Power limiter disabled (override)");
-            _mqttCallbacks.push_back(std::bind(&PowerLimiterClass::setMode,
-                        &PowerLimiter, Mode::Disabled));
+            PowerLimiter.setMode(Mode::Disabled);
         } else if (mode == Mode::Normal) {
             DTU_LOGI("Power limiter normal operation");
-            _mqttCallbacks.push_back(std::bind(&PowerLimiterClass::setMode,
-                        &PowerLimiter, Mode::Normal));
+            PowerLimiter.setMode(Mode::Normal);
         } else {
             DTU_LOGE("PowerLimiter - unknown mode %d", intValue);
         }
         return;
     }
 
+    // sets the value and returns true unless it is unchanged
+    auto update = [&](PowerLimiterConfig& cfg, bool verbose) -> bool {
+        switch (command) {
+            case MqttPowerLimiterCommand::Mode:
+                // handled separately above, as it does not change the config
+                return false;
+            case MqttPowerLimiterCommand::BatterySoCStartThreshold:
+                if (cfg.BatterySocStartThreshold == intValue) { return false; }
+                if (verbose) { DTU_LOGI("Setting battery SoC start threshold to: %d %%", intValue); }
+                cfg.BatterySocStartThreshold = intValue;
+                break;
+            case MqttPowerLimiterCommand::BatterySoCStopThreshold:
+                if (cfg.BatterySocStopThreshold == intValue) { return false; }
+                if (verbose) { DTU_LOGI("Setting battery SoC stop threshold to: %d %%", intValue); }
+                cfg.BatterySocStopThreshold = intValue;
+                break;
+            case MqttPowerLimiterCommand::FullSolarPassthroughSoC:
+                if (cfg.FullSolarPassThroughSoc == intValue) { return false; }
+                if (verbose) { DTU_LOGI("Setting full solar passthrough SoC to: %d %%", intValue); }
+                cfg.FullSolarPassThroughSoc = intValue;
+                break;
+            case MqttPowerLimiterCommand::VoltageStartThreshold:
+                if (cfg.VoltageStartThreshold == payload_val) { return false; }
+                if (verbose) { DTU_LOGI("Setting voltage start threshold to: %.2f V", payload_val); }
+                cfg.VoltageStartThreshold = payload_val;
+                break;
+            case MqttPowerLimiterCommand::VoltageStopThreshold:
+                if (cfg.VoltageStopThreshold == payload_val) { return false; }
+                if (verbose) { DTU_LOGI("Setting voltage stop threshold to: %.2f V", payload_val); }
+                cfg.VoltageStopThreshold = payload_val;
+                break;
+            case MqttPowerLimiterCommand::FullSolarPassThroughStartVoltage:
+                if (cfg.FullSolarPassThroughStartVoltage == payload_val) { return false; }
+                if (verbose) { DTU_LOGI("Setting full solar passthrough start voltage to: %.2f V", payload_val); }
+                cfg.FullSolarPassThroughStartVoltage = payload_val;
+                break;
+            case MqttPowerLimiterCommand::FullSolarPassThroughStopVoltage:
+                if (cfg.FullSolarPassThroughStopVoltage == payload_val) { return false; }
+                if (verbose) { DTU_LOGI("Setting full solar passthrough stop voltage to: %.2f V", payload_val); }
+                cfg.FullSolarPassThroughStopVoltage = payload_val;
+                break;
+            case MqttPowerLimiterCommand::UpperPowerLimit:
+                if (cfg.TotalUpperPowerLimit == intValue) { return false; }
+                if (verbose) { DTU_LOGI("Setting total upper power limit to: %d W", intValue); }
+                cfg.TotalUpperPowerLimit = intValue;
+                break;
+            case MqttPowerLimiterCommand::TargetPowerConsumption:
+                if (cfg.TargetPowerConsumption == intValue) { return false; }
+                if (verbose) { DTU_LOGI("Setting target power consumption to: %d W", intValue); }
+                cfg.TargetPowerConsumption = intValue;
+                break;
+        }
+        return true;
+    };
+
+    // the whole config is copied by a write guard, so it is only taken if
+    // the value actually changes, which is checked on a copy of the DPL's
+    // part of the config.
+    auto powerLimiter = Configuration.get()->PowerLimiter;
+    if (!update(powerLimiter, false)) { return; }
+
     auto guard = Configuration.getWriteGuard();
     auto& config = guard.getConfig();
+    update(config.PowerLimiter, true);
 
-    switch (command) {
-        case MqttPowerLimiterCommand::Mode:
-            // handled separately above to avoid locking two mutexes
-            break;
-        case MqttPowerLimiterCommand::BatterySoCStartThreshold:
-            if (config.PowerLimiter.BatterySocStartThreshold == intValue) { return; }
-            DTU_LOGI("Setting battery SoC start threshold to: %d %%", intValue);
-            config.PowerLimiter.BatterySocStartThreshold = intValue;
-            break;
-        case MqttPowerLimiterCommand::BatterySoCStopThreshold:
-            if (config.PowerLimiter.BatterySocStopThreshold == intValue) { return; }
-            DTU_LOGI("Setting battery SoC stop threshold to: %d %%", intValue);
-            config.PowerLimiter.BatterySocStopThreshold = intValue;
-            break;
-        case MqttPowerLimiterCommand::FullSolarPassthroughSoC:
-            if (config.PowerLimiter.FullSolarPassThroughSoc == intValue) { return; }
-            DTU_LOGI("Setting full solar passthrough SoC to: %d %%", intValue);
-            config.PowerLimiter.FullSolarPassThroughSoc = intValue;
-            break;
-        case MqttPowerLimiterCommand::VoltageStartThreshold:
-            if (config.PowerLimiter.VoltageStartThreshold == payload_val) { return; }
-            DTU_LOGI("Setting voltage start threshold to: %.2f V", payload_val);
-            config.PowerLimiter.VoltageStartThreshold = payload_val;
-            break;
-        case MqttPowerLimiterCommand::VoltageStopThreshold:
-            if (config.PowerLimiter.VoltageStopThreshold == payload_val) { return; }
-            DTU_LOGI("Setting voltage stop threshold to: %.2f V", payload_val);
-            config.PowerLimiter.VoltageStopThreshold = payload_val;
-            break;
-        case MqttPowerLimiterCommand::FullSolarPassThroughStartVoltage:
-            if (config.PowerLimiter.FullSolarPassThroughStartVoltage == payload_val) { return; }
-            DTU_LOGI("Setting full solar passthrough start voltage to: %.2f V", payload_val);
-            config.PowerLimiter.FullSolarPassThroughStartVoltage = payload_val;
-            break;
-        case MqttPowerLimiterCommand::FullSolarPassThroughStopVoltage:
-            if (config.PowerLimiter.FullSolarPassThroughStopVoltage == payload_val) { return; }
-            DTU_LOGI("Setting full solar passthrough stop voltage to: %.2f V", payload_val);
-            config.PowerLimiter.FullSolarPassThroughStopVoltage = payload_val;
-            break;
-        case MqttPowerLimiterCommand::UpperPowerLimit:
-            if (config.PowerLimiter.TotalUpperPowerLimit == intValue) { return; }
-            DTU_LOGI("Setting total upper power limit to: %d W", intValue);
-            config.PowerLimiter.TotalUpperPowerLimit = intValue;
-            break;
-        case MqttPowerLimiterCommand::TargetPowerConsumption:
-            if (config.PowerLimiter.TargetPowerConsumption == intValue) { return; }
-            DTU_LOGI("Setting target power consumption to: %d W", intValue);
-            config.PowerLimiter.TargetPowerConsumption = intValue;
-            break;
-    }
-
-    // not reached if the value did not change
-    Configuration.write();
+    // not reached if the value did not change. home automations might
+    // adjust values every few seconds, so saving is deferred.
+    Configuration.requestWrite(config.Mqtt.ConfigSaveDelay * 1000);
 }
@@ -5,8 +5,10 @@
 #include "MqttHandlePowerLimiterHass.h"
 #include "MqttHandleHass.h"
 #include "Configuration.h"
+#include "MqttHassPublisher.h"
 #include "MqttSettings.h"
 #include "NetworkSettings.h"
+#include "TaskProfiler.h"
 #include "Utils.h"
 #include "PowerLimiter.h"
 #include "__compiled_constants.h"
@@ -16,41 +18,45 @@ MqttHandlePowerLimiterHassClass MqttHandlePowerLimiterHass;
 void MqttHandlePowerLimiterHassClass::init(Scheduler& scheduler)
 {
     scheduler.addTask(_loopTask);
-    _loopTask.setCallback(std::bind(&MqttHandlePowerLimiterHassClass::loop, this));
+    _loopTask.setCallback(TaskProfiler.wrap("MQTT:DPL-HASS", std::bind(&MqttHandlePowerLimiterHassClass::loop, this)));
     _loopTask.setIterations(TASK_FOREVER);
     _loopTask.enable();
 }
 
 void MqttHandlePowerLimiterHassClass::loop()
 {
-    if (!Configuration.get().PowerLimiter.Enabled) {
+    if (!Configuration.get()->PowerLimiter.Enabled) {
         return;
     }
     if (_updateForced) {
-        publishConfig();
+        _pass.restart();
         _updateForced = false;
     }
 
     if (MqttSettings.getConnected() && !_wasConnected) {
         // Connection established
         _wasConnected = true;
-        publishConfig();
+        _pass.restart();
     } else if (!MqttSettings.getConnected() && _wasConnected) {
         // Connection lost
         _wasConnected = false;
     }
+
+    _pass.step([this]() { publishConfig(); });
 }
 
 void MqttHandlePowerLimiterHassClass::forceUpdate()
 {
+    // e.g., entities deleted in Home Assistant shall be recreated
+    MqttHassPublisher.forgetPublished();
     _updateForced = true;
 }
 
 void MqttHandlePowerLimiterHassClass::publishConfig()
 {
-    auto const& config = Configuration.get();
+    auto const config = Configuration.get();
 
-    if (!config.Mqtt.Hass.Enabled) {
+    if (!config->Mqtt.Hass.Enabled) {
         return;
     }
 
@@ -58,7 +64,7 @@ void MqttHandlePowerLimiterHassClass::publishConfig()
         return;
     }
 
-    if (!config.PowerLimiter.Enabled) {
+    if (!config->PowerLimiter.Enabled) {
         return;
     }
 
@@ -76,7 +82,7 @@ void MqttHandlePowerLimiterHassClass::publishConfig()
     publishNumber("DPL battery voltage stop threshold", "mdi:battery-charging",
             "config", "threshold/voltage/stop", "threshold/voltage/stop", "V", 16, 60, 0.1);
 
-    if (config.SolarCharger.Enabled) {
+    if (config->SolarCharger.Enabled) {
         publishBinarySensor("full solar passthrough active",
             "mdi:transmission-tower-import",
             "full_solar_passthrough_active", "1", "0");
@@ -91,13 +97,13 @@ void MqttHandlePowerLimiterHassClass::publishConfig()
                 "threshold/voltage/full_solar_passthrough_stop", "V", 16, 60, 0.1);
     }
 
-    if (config.Battery.Enabled && !config.PowerLimiter.IgnoreSoc) {
+    if (config->Battery.Enabled && !config->PowerLimiter.IgnoreSoc) {
         publishNumber("DPL battery SoC start threshold", "mdi:battery-charging",
                 "config", "threshold/soc/start", "threshold/soc/start", "%", 0, 100, 1.0);
         publishNumber("DPL battery SoC stop threshold", "mdi:battery-charging",
                 "config", "threshold/soc/stop", "threshold/soc/stop", "%", 0, 100, 1.0);
 
-        if (config.SolarCharger.Enabled) {
+        if (config->SolarCharger.Enabled) {
             publishNumber("DPL full solar passthrough SoC",
                     "mdi:transmission-tower-import", "config",
                     "threshold/soc/full_solar_passthrough",
@@ -110,6 +116,9 @@ void MqttHandlePowerLimiterHassClass::publishSelect(
     const char* caption, const char* icon, const char* category,
     const char* commandTopic, const char* stateTopic)
 {
+    if (!_pass.claim()) {
+        return;
+    }
 
     String selectId = caption;
     selectId.replace(" ", "_");
@@ -118,7 +127,6 @@ void MqttHandlePowerLimiterHassClass::publishSelect(
     const String configTopic = "select/" + MqttHandleHass.getDtuUniqueId() + "/" + selectId + "/config";
 
     const String cmdTopic = MqttSettings.getPrefix() + "powerlimiter/cmd/" + commandTopic;
-    const String statTopic = MqttSettings.getPrefix() + "powerlimiter/status/" + stateTopic;
 
     JsonDocument root;
 
@@ -129,7 +137,7 @@ void MqttHandlePowerLimiterHassClass::publishSelect(
     }
     root["ent_cat"] = category;
     root["cmd_t"] = cmdTopic;
-    root["stat_t"] = statTopic;
+    MqttSettings.setHassStateTopic(root, "powerlimiter/", std::string("status/") + stateTopic);
     JsonArray options = root["options"].to<JsonArray>();
     options.add("0");
     options.add("1");
@@ -151,6 +159,9 @@ void MqttHandlePowerLimiterHassClass::publishNumber(
     const char* commandTopic, const char* stateTopic, const char* unitOfMeasure,
     const int16_t min, const int16_t max, const float step)
 {
+    if (!_pass.claim()) {
+        return;
+    }
 
     String numberId = caption;
     numberId.replace(" ", "_");
@@ -159,7 +170,6 @@ void MqttHandlePowerLimiterHassClass::publishNumber(
     const String configTopic = "number/" + MqttHandleHass.getDtuUniqueId() + "/" + numberId + "/config";
 
     const String cmdTopic = MqttSettings.getPrefix() + "powerlimiter/cmd/" + commandTopic;
-    const String statTopic = MqttSettings.getPrefix() + "powerlimiter/status/" + stateTopic;
 
     JsonDocument root;
 
@@ -170,16 +180,16 @@ void MqttHandlePowerLimiterHassClass::publishNumber(
     }
     root["ent_cat"] = category;
     root["cmd_t"] = cmdTopic;
-    root["stat_t"] = statTopic;
+    MqttSettings.setHassStateTopic(root, "powerlimiter/", std::string("status/") + stateTopic);
     root["unit_of_meas"] = unitOfMeasure;
     root["min"] = min;
     root["max"] = max;
     root["step"] = step;
     root["mode"] = "box";
 
-    auto const& config = Configuration.get();
-    if (config.Mqtt.Hass.Expire) {
-        root["exp_aft"] = config.Mqtt.PublishInterval * 3;
+    auto const config = Configuration.get();
+    if (config->Mqtt.Hass.Expire) {
+        root["exp_aft"] = config->Mqtt.PublishInterval * 3;
     }
 
     createDeviceInfo(root);
@@ -197,6 +207,9 @@ void MqttHandlePowerLimiterHassClass::publishBinarySensor(
     const char* caption, const char* icon,
     const char* stateTopic, const char* payload_on, const char* payload_off)
 {
+    if (!_pass.claim()) {
+        return;
+    }
 
     String numberId = caption;
     numberId.replace(" ", "_");
@@ -204,7 +217,6 @@ void MqttHandlePowerLimiterHassClass::publishBinarySensor(
 
     const String configTopic = "binary_sensor/" + MqttHandleHass.getDtuUniqueId() + "/" + numberId + "/config";
 
-    const String statTopic = MqttSettings.getPrefix() + "powerlimiter/status/" + stateTopic;
 
     JsonDocument root;
 
@@ -213,13 +225,13 @@ void MqttHandlePowerLimiterHassClass::publishBinarySensor(
     if (strcmp(icon, "")) {
         root["ic"] = icon;
     }
-    root["stat_t"] = statTopic;
+    MqttSettings.setHassStateTopic(root, "powerlimiter/", std::string("status/") + stateTopic);
     root["pl_on"] = payload_on;
     root["pl_off"] = payload_off;
 
-    auto const& config = Configuration.get();
-    if (config.Mqtt.Hass.Expire) {
-        root["exp_aft"] = config.Mqtt.PublishInterval * 3;
+    auto const config = Configuration.get();
+    if (config->Mqtt.Hass.Expire) {
+        root["exp_aft"] = config->Mqtt.PublishInterval * 3;
     }
 
     createDeviceInfo(root);
@@ -248,7 +260,5 @@ void MqttHandlePowerLimiterHassClass::createDeviceInfo(JsonDocument& root)
 
 void MqttHandlePowerLimiterHassClass::publish(const String& subtopic, const String& payload)
 {
-    String topic = Configuration.get().Mqtt.Hass.Topic;
-    topic += subtopic;
-    MqttSettings.publishGeneric(topic.c_str(), payload.c_str(), Configuration.get().Mqtt.Hass.Retain);
+    MqttHassPublisher.publish(subtopic, payload);
 }
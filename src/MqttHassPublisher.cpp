@@ -0,0 +1,85 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#include "MqttHassPublisher.h"
+#include "Configuration.h"
+#include "MqttSettings.h"
+#include "Utils.h"
+#include <algorithm>
+#include <tuple>
+
+MqttHassPublisherClass MqttHassPublisher;
+
+void MqttHassPublisherClass::publish(const String& subtopic, const String& payload)
+{
+    // the fingerprint must only be recorded if the document is sent
+    if (!MqttSettings.getConnected()) {
+        return;
+    }
+
+    auto const config = Configuration.get();
+
+    String topic = config->Mqtt.Hass.Topic;
+    topic += subtopic;
+
+    Fingerprint fingerprint;
+    fingerprint.TopicHash = Utils::fnv1aHash64(topic.c_str(), topic.length());
+    fingerprint.TopicLength = static_cast<uint16_t>(topic.length());
+    fingerprint.PayloadHash = Utils::fnv1aHash(payload.c_str(), payload.length());
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        auto it = std::lower_bound(_fingerprints.begin(), _fingerprints.end(), fingerprint,
+            [](const Fingerprint& a, const Fingerprint& b) {
+                return std::tie(a.TopicHash, a.TopicLength) < std::tie(b.TopicHash, b.TopicLength);
+            });
+
+        if (it != _fingerprints.end() && it->TopicHash == fingerprint.TopicHash
+                && it->TopicLength == fingerprint.TopicLength) {
+            if (it->PayloadHash == fingerprint.PayloadHash) {
+                return;
+            }
+            it->PayloadHash = fingerprint.PayloadHash;
+        } else {
+            _fingerprints.insert(it, fingerprint);
+        }
+    }
+
+    MqttSettings.publishGeneric(topic, payload, config->Mqtt.Hass.Retain);
+}
+
+void MqttHassPublisherClass::forgetPublished()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _fingerprints.clear();
+    _fingerprints.shrink_to_fit();
+}
+
+void MqttHassPublisherClass::refill()
+{
+    uint32_t now = millis();
+    uint32_t tokens = (now - _lastRefillMillis) * DocumentsPerSecond / 1000;
+    if (tokens == 0) {
+        return;
+    }
+
+    _tokens = std::min(MaxBurst, _tokens + tokens);
+    _lastRefillMillis = now;
+}
+
+bool MqttHassPublisherClass::hasToken()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    refill();
+    return _tokens > 0;
+}
+
+bool MqttHassPublisherClass::takeToken()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    refill();
+    if (_tokens == 0) {
+        return false;
+    }
+    --_tokens;
+    return true;
+}
@@ -0,0 +1,76 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#include "MqttPublishQueue.h"
+#include <algorithm>
+
+MqttPublishQueue::MqttPublishQueue(size_t capacity)
+    : _slots(std::max<size_t>(capacity, 1))
+{
+}
+
+bool MqttPublishQueue::push(std::string_view topic, std::string_view payload, const bool retain, const uint8_t qos)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (_count == _slots.size()) {
+        for (size_t i = 0; i < _count; ++i) {
+            Message& queued = _slots[(_head + i) % _slots.size()];
+            if (queued.Topic != topic || queued.Retain != retain || queued.Qos != qos) {
+                continue;
+            }
+
+            queued.Payload.assign(payload.data(), payload.length());
+            ++_coalesced;
+            return true;
+        }
+
+        ++_dropped;
+        return false;
+    }
+
+    Message& slot = _slots[(_head + _count) % _slots.size()];
+    slot.Topic.assign(topic.data(), topic.length());
+    slot.Payload.assign(payload.data(), payload.length());
+    slot.Retain = retain;
+    slot.Qos = qos;
+
+    ++_count;
+    ++_queued;
+    _highWater = std::max(_highWater, _count);
+    return true;
+}
+
+bool MqttPublishQueue::pop(Message& msg)
+{
+    if (msg.Payload.capacity() > MaxRecycledCapacity) {
+        std::string().swap(msg.Payload);
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (_count == 0) {
+        return false;
+    }
+
+    Message& slot = _slots[_head];
+    std::swap(slot.Topic, msg.Topic);
+    std::swap(slot.Payload, msg.Payload);
+    msg.Retain = slot.Retain;
+    msg.Qos = slot.Qos;
+
+    _head = (_head + 1) % _slots.size();
+    --_count;
+    return true;
+}
+
+void MqttPublishQueue::clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _head = 0;
+    _count = 0;
+}
+
+MqttPublishQueue::Stats MqttPublishQueue::getStats() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return { _queued, _coalesced, _dropped, _count, _highWater, _slots.size() };
+}
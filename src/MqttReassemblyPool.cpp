@@ -0,0 +1,106 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#include "MqttReassemblyPool.h"
+#include <cstring>
+
+MqttReassemblyPool::MqttReassemblyPool(size_t slots, size_t capacity, size_t maxTopicLength)
+    : _slots(slots)
+    , _capacity(capacity)
+    , _maxTopicLength(maxTopicLength)
+{
+}
+
+MqttReassemblyPool::Slot* MqttReassemblyPool::add(std::string_view topic, const uint8_t* payload, size_t len, size_t index, size_t total)
+{
+    Slot* slot = find(topic);
+
+    // first fragment of a new message, replacing an incomplete one
+    if (index == 0) {
+        if (total > _capacity || topic.length() > _maxTopicLength) {
+            if (slot != nullptr) { slot->Status = Slot::State::Free; }
+            ++_dropped;
+            return nullptr;
+        }
+
+        if (slot == nullptr) {
+            slot = acquire();
+        }
+        if (slot == nullptr) {
+            ++_dropped;
+            return nullptr;
+        }
+
+        if (!slot->Buffer) {
+            slot->Buffer.reset(new uint8_t[_capacity]);
+            slot->Topic.reset(new char[_maxTopicLength + 1]);
+        }
+
+        memcpy(slot->Topic.get(), topic.data(), topic.length());
+        slot->Topic[topic.length()] = '\0';
+        slot->TopicLength = topic.length();
+        slot->Total = total;
+        slot->Received = 0;
+        slot->Sequence = ++_sequence;
+        slot->Status = Slot::State::Receiving;
+    }
+
+    // the first fragment was missed or dropped
+    if (slot == nullptr) {
+        return nullptr;
+    }
+
+    if (index != slot->Received || total != slot->Total || slot->Received + len > slot->Total) {
+        slot->Status = Slot::State::Free;
+        ++_dropped;
+        return nullptr;
+    }
+
+    memcpy(slot->Buffer.get() + slot->Received, payload, len);
+    slot->Received += len;
+
+    if (slot->Received < slot->Total) {
+        return nullptr;
+    } // wait for last fragment
+
+    slot->Status = Slot::State::Complete;
+    ++_reassembled;
+    return slot;
+}
+
+void MqttReassemblyPool::release(Slot* slot)
+{
+    if (slot != nullptr) {
+        slot->Status = Slot::State::Free;
+    }
+}
+
+MqttReassemblyPool::Slot* MqttReassemblyPool::find(std::string_view topic)
+{
+    for (auto& slot : _slots) {
+        if (slot.Status == Slot::State::Receiving
+                && std::string_view(slot.Topic.get(), slot.TopicLength) == topic) {
+            return &slot;
+        }
+    }
+    return nullptr;
+}
+
+MqttReassemblyPool::Slot* MqttReassemblyPool::acquire()
+{
+    Slot* oldest = nullptr;
+    for (auto& slot : _slots) {
+        if (slot.Status == Slot::State::Free) {
+            return &slot;
+        }
+
+        // a message being handled must not be overwritten
+        if (slot.Status == Slot::State::Receiving
+                && (oldest == nullptr || slot.Sequence - oldest->Sequence > UINT32_MAX / 2)) {
+            oldest = &slot;
+        }
+    }
+
+    if (oldest != nullptr) {
+        ++_evicted;
+    }
+    return oldest;
+}
@@ -4,12 +4,157 @@
  */
 #include "MqttSettings.h"
 #include "Configuration.h"
+#include "MqttHassPublisher.h"
+#include "Utils.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
 #include <frozen/map.h>
 #include <frozen/string.h>
+#include <tuple>
 
 #undef TAG
 static const char* TAG = "mqtt";
 
+namespace {
+
+float parseNumber(const MqttValue& value)
+{
+    // the number itself is never followed by anything but whitespace or
+    // the null terminator, so strtof() stops within the value.
+    const char* begin = value.data();
+    char* end = nullptr;
+    float number = strtof(begin, &end);
+    if (value.length() == 0 || end != begin + value.length()) {
+        return NAN;
+    }
+    return number;
+}
+
+// strtof() also accepts "nan", "inf", hex numbers, etc., which are not
+// valid JSON numbers.
+bool isJsonNumber(std::string_view str)
+{
+    size_t i = 0;
+    auto digits = [&str, &i]() {
+        size_t start = i;
+        while (i < str.length() && isdigit(static_cast<unsigned char>(str[i]))) { ++i; }
+        return i > start;
+    };
+
+    if (i < str.length() && str[i] == '-') { ++i; }
+    if (i < str.length() && str[i] == '0') {
+        ++i;
+    } else if (!digits()) {
+        return false;
+    }
+    if (i < str.length() && str[i] == '.') {
+        ++i;
+        if (!digits()) { return false; }
+    }
+    if (i < str.length() && (str[i] == 'e' || str[i] == 'E')) {
+        ++i;
+        if (i < str.length() && (str[i] == '+' || str[i] == '-')) { ++i; }
+        if (!digits()) { return false; }
+    }
+    return i == str.length();
+}
+
+// JSON documents keep the number as published, while raw values would be
+// copied into MessagePack documents verbatim, hence they get a binary number.
+// the view is not null-terminated, so it is parsed within its bounds.
+void setNumber(JsonVariant dst, std::string_view number, bool messagePack)
+{
+    if (!messagePack) {
+        dst.set(serialized(std::string(number)));
+        return;
+    }
+
+    int64_t integer;
+    auto last = number.data() + number.length();
+    auto result = std::from_chars(number.data(), last, integer);
+    if (result.ec == std::errc() && result.ptr == last) {
+        dst.set(integer);
+        return;
+    }
+
+    // fractions and integers out of range. a float would round counters
+    // like energy totals above some 10000 kWh.
+    char buffer[32];
+    if (number.length() >= sizeof(buffer)) {
+        dst.set(number);
+        return;
+    }
+    memcpy(buffer, number.data(), number.length());
+    buffer[number.length()] = '\0';
+    dst.set(strtod(buffer, nullptr));
+}
+
+} // namespace
+
+MqttTopic::MqttTopic()
+{
+    _buffer[0] = '\0';
+    append(*MqttSettings.getCachedPrefix());
+    _prefixLength = _length;
+}
+
+MqttTopic& MqttTopic::append(std::string_view str)
+{
+    size_t count = std::min(str.length(), MaxLength - _length);
+    _overflow |= (count < str.length());
+    memcpy(_buffer + _length, str.data(), count);
+    _length += count;
+    _buffer[_length] = '\0';
+    return *this;
+}
+
+MqttTopic& MqttTopic::append(uint32_t value)
+{
+    char digits[11];
+    int count = snprintf(digits, sizeof(digits), "%u", static_cast<unsigned>(value));
+    return append(std::string_view(digits, count));
+}
+
+MqttTopic& MqttTopic::appendLowerCase(std::string_view str)
+{
+    size_t start = _length;
+    append(str);
+    for (size_t i = start; i < _length; ++i) {
+        _buffer[i] = tolower(_buffer[i]);
+    }
+    return *this;
+}
+
+MqttTopic& MqttTopic::truncate(size_t length)
+{
+    if (length < _length) {
+        _length = length;
+        _buffer[_length] = '\0';
+        _overflow = false;
+    }
+    return *this;
+}
+
+MqttValue::MqttValue(double value, uint8_t decimals)
+{
+    int length = snprintf(_buffer, sizeof(_buffer), "%.*f", decimals, value);
+    _length = std::min<size_t>(length, sizeof(_buffer) - 1);
+}
+
+void MqttValue::assign(const char* str, size_t length)
+{
+    while (length > 0 && isspace(static_cast<unsigned char>(str[0]))) {
+        ++str;
+        --length;
+    }
+    while (length > 0 && isspace(static_cast<unsigned char>(str[length - 1]))) {
+        --length;
+    }
+    _data = str;
+    _length = length;
+}
+
 MqttSettingsClass::MqttSettingsClass()
 {
 }
@@ -33,8 +178,14 @@ void MqttSettingsClass::NetworkEvent(network_event event)
 void MqttSettingsClass::onMqttConnect(const bool sessionPresent)
 {
     ESP_LOGI(TAG, "Connected to MQTT.");
-    const CONFIG_T& config = Configuration.get();
-    publish(config.Mqtt.Lwt.Topic, config.Mqtt.Lwt.Value_Online);
+    _connected = true;
+    clearPublishCache();
+
+    // the documents may be gone even if they were retained, e.g., if the
+    // broker was restarted without persistence.
+    MqttHassPublisher.forgetPublished();
+    auto spConfig = Configuration.get();
+    publish(spConfig->Mqtt.Lwt.Topic, spConfig->Mqtt.Lwt.Value_Online);
 
     std::lock_guard<std::mutex> lock(_clientLock);
     if (_mqttClient != nullptr) {
@@ -79,6 +230,7 @@ void MqttSettingsClass::onMqttDisconnect(espMqttClientTypes::DisconnectReason re
     const char* reasonStr = (it != reasons.end()) ? it->second.data() : "Unknown";
 
     ESP_LOGW(TAG, "Disconnected from MQTT. Reason: %s", reasonStr);
+    _connected = false;
 
     _mqttReconnectTimer.once(
         2, +[](MqttSettingsClass* instance) { instance->performConnect(); }, this);
@@ -94,30 +246,36 @@ void MqttSettingsClass::onMqttMessage(const espMqttClientTypes::MessagePropertie
         return _mqttSubscribeParser.handle_message(properties, topic, payload, len);
     }
 
-    auto& fragment = _fragments[String(topic)];
-
-    // first fragment of a new message
-    if (index == 0) {
-        fragment.clear();
-        fragment.reserve(total);
+    bool warned = false;
+    if (index == 0 && total > _fragments.getCapacity()) {
+        ESP_LOGW(TAG, "Fragmented MQTT message on topic '%s' exceeds %zu bytes, dropping",
+            topic, _fragments.getCapacity());
+        warned = true;
+    } else if (index == 0 && strlen(topic) > _fragments.getMaxTopicLength()) {
+        ESP_LOGW(TAG, "Topic '%s' of fragmented MQTT message exceeds %zu characters, dropping",
+            topic, _fragments.getMaxTopicLength());
+        warned = true;
     }
 
-    fragment.insert(fragment.end(), payload, payload + len);
-
-    if (fragment.size() < total) {
+    uint32_t dropped = _fragments.getStats().Dropped;
+    auto slot = _fragments.add(topic, payload, len, index, total);
+    if (slot == nullptr) {
+        if (!warned && _fragments.getStats().Dropped != dropped) {
+            ESP_LOGW(TAG, "Fragmented MQTT message on topic '%s' is incomplete, dropping", topic);
+        }
         return;
-    } // wait for last fragment
+    }
 
     ESP_LOGD(TAG, "Fragmented MQTT message reassembled for topic '%s'", topic);
 
-    _mqttSubscribeParser.handle_message(properties, topic, fragment.data(), total);
+    _mqttSubscribeParser.handle_message(properties, topic, slot->data(), slot->length());
 
-    _fragments.erase(String(topic));
+    _fragments.release(slot);
 }
 
 void MqttSettingsClass::performConnect()
 {
-    if (NetworkSettings.isConnected() && Configuration.get().Mqtt.Enabled) {
+    if (NetworkSettings.isConnected() && Configuration.get()->Mqtt.Enabled) {
         using std::placeholders::_1;
         using std::placeholders::_2;
         using std::placeholders::_3;
@@ -131,30 +289,31 @@ void MqttSettingsClass::performConnect()
         }
 
         ESP_LOGI(TAG, "Connecting to MQTT...");
-        const CONFIG_T& config = Configuration.get();
-        const String willTopic = getPrefix() + config.Mqtt.Lwt.Topic;
+        auto const config = Configuration.get();
+        _spClientConfig = config;
+        const String willTopic = getPrefix() + config->Mqtt.Lwt.Topic;
         String clientId = getClientId();
-        if (config.Mqtt.Tls.Enabled) {
-            static_cast<espMqttClientSecure*>(_mqttClient)->setCACert(config.Mqtt.Tls.RootCaCert);
-            static_cast<espMqttClientSecure*>(_mqttClient)->setServer(config.Mqtt.Hostname, config.Mqtt.Port);
-            if (config.Mqtt.Tls.CertLogin) {
-                static_cast<espMqttClientSecure*>(_mqttClient)->setCertificate(config.Mqtt.Tls.ClientCert);
-                static_cast<espMqttClientSecure*>(_mqttClient)->setPrivateKey(config.Mqtt.Tls.ClientKey);
+        if (config->Mqtt.Tls.Enabled) {
+            static_cast<espMqttClientSecure*>(_mqttClient)->setCACert(config->Mqtt.Tls.RootCaCert);
+            static_cast<espMqttClientSecure*>(_mqttClient)->setServer(config->Mqtt.Hostname, config->Mqtt.Port);
+            if (config->Mqtt.Tls.CertLogin) {
+                static_cast<espMqttClientSecure*>(_mqttClient)->setCertificate(config->Mqtt.Tls.ClientCert);
+                static_cast<espMqttClientSecure*>(_mqttClient)->setPrivateKey(config->Mqtt.Tls.ClientKey);
             } else {
-                static_cast<espMqttClientSecure*>(_mqttClient)->setCredentials(config.Mqtt.Username, config.Mqtt.Password);
+                static_cast<espMqttClientSecure*>(_mqttClient)->setCredentials(config->Mqtt.Username, config->Mqtt.Password);
             }
-            static_cast<espMqttClientSecure*>(_mqttClient)->setWill(willTopic.c_str(), config.Mqtt.Lwt.Qos, config.Mqtt.Retain, config.Mqtt.Lwt.Value_Offline);
+            static_cast<espMqttClientSecure*>(_mqttClient)->setWill(willTopic.c_str(), config->Mqtt.Lwt.Qos, config->Mqtt.Retain, config->Mqtt.Lwt.Value_Offline);
             static_cast<espMqttClientSecure*>(_mqttClient)->setClientId(clientId.c_str());
-            static_cast<espMqttClientSecure*>(_mqttClient)->setCleanSession(config.Mqtt.CleanSession);
+            static_cast<espMqttClientSecure*>(_mqttClient)->setCleanSession(config->Mqtt.CleanSession);
             static_cast<espMqttClientSecure*>(_mqttClient)->onConnect(std::bind(&MqttSettingsClass::onMqttConnect, this, _1));
             static_cast<espMqttClientSecure*>(_mqttClient)->onDisconnect(std::bind(&MqttSettingsClass::onMqttDisconnect, this, _1));
             static_cast<espMqttClientSecure*>(_mqttClient)->onMessage(std::bind(&MqttSettingsClass::onMqttMessage, this, _1, _2, _3, _4, _5, _6));
         } else {
-            static_cast<espMqttClient*>(_mqttClient)->setServer(config.Mqtt.Hostname, config.Mqtt.Port);
-            static_cast<espMqttClient*>(_mqttClient)->setCredentials(config.Mqtt.Username, config.Mqtt.Password);
-            static_cast<espMqttClient*>(_mqttClient)->setWill(willTopic.c_str(), config.Mqtt.Lwt.Qos, config.Mqtt.Retain, config.Mqtt.Lwt.Value_Offline);
+            static_cast<espMqttClient*>(_mqttClient)->setServer(config->Mqtt.Hostname, config->Mqtt.Port);
+            static_cast<espMqttClient*>(_mqttClient)->setCredentials(config->Mqtt.Username, config->Mqtt.Password);
+            static_cast<espMqttClient*>(_mqttClient)->setWill(willTopic.c_str(), config->Mqtt.Lwt.Qos, config->Mqtt.Retain, config->Mqtt.Lwt.Value_Offline);
             static_cast<espMqttClient*>(_mqttClient)->setClientId(clientId.c_str());
-            static_cast<espMqttClient*>(_mqttClient)->setCleanSession(config.Mqtt.CleanSession);
+            static_cast<espMqttClient*>(_mqttClient)->setCleanSession(config->Mqtt.CleanSession);
             static_cast<espMqttClient*>(_mqttClient)->onConnect(std::bind(&MqttSettingsClass::onMqttConnect, this, _1));
             static_cast<espMqttClient*>(_mqttClient)->onDisconnect(std::bind(&MqttSettingsClass::onMqttDisconnect, this, _1));
             static_cast<espMqttClient*>(_mqttClient)->onMessage(std::bind(&MqttSettingsClass::onMqttMessage, this, _1, _2, _3, _4, _5, _6));
@@ -165,18 +324,24 @@ void MqttSettingsClass::performConnect()
 
 void MqttSettingsClass::performDisconnect()
 {
-    const CONFIG_T& config = Configuration.get();
-    publish(config.Mqtt.Lwt.Topic, config.Mqtt.Lwt.Value_Offline);
+    // bypasses the queue, as the message must be sent before disconnecting
+    auto const config = Configuration.get();
+    const String topic = getPrefix() + config->Mqtt.Lwt.Topic;
     std::lock_guard<std::mutex> lock(_clientLock);
     if (_mqttClient == nullptr) {
         return;
     }
+    _mqttClient->publish(topic.c_str(), 0, config->Mqtt.Retain, config->Mqtt.Lwt.Value_Offline);
     _mqttClient->disconnect();
 }
 
 void MqttSettingsClass::performReconnect()
 {
     performDisconnect();
+    _publishQueue.clear();
+    clearPublishCache();
+    MqttHassPublisher.forgetPublished();
+    updatePrefix();
 
     createMqttClientObject();
 
@@ -186,21 +351,18 @@ void MqttSettingsClass::performReconnect()
 
 bool MqttSettingsClass::getConnected()
 {
-    std::lock_guard<std::mutex> lock(_clientLock);
-    if (_mqttClient == nullptr) {
-        return false;
-    }
-    return _mqttClient->connected();
+    // not asking the client, as _clientLock may be held by the publisher
+    return _connected;
 }
 
 String MqttSettingsClass::getPrefix() const
 {
-    return Configuration.get().Mqtt.Topic;
+    return Configuration.get()->Mqtt.Topic;
 }
 
 String MqttSettingsClass::getClientId() const
 {
-    String clientId = Configuration.get().Mqtt.ClientId;
+    String clientId = Configuration.get()->Mqtt.ClientId;
     if (clientId == "") {
         clientId = NetworkSettings.getApName();
     }
@@ -215,35 +377,308 @@ void MqttSettingsClass::publish(const String& subtopic, const String& payload)
     String value = payload;
     value.trim();
 
-    publishGeneric(topic, value, Configuration.get().Mqtt.Retain, 0);
+    if (collect(std::string_view(topic.c_str(), topic.length()), std::string_view(value.c_str(), value.length()), true)) {
+        return;
+    }
+
+    publishGeneric(topic, value, Configuration.get()->Mqtt.Retain, 0);
 }
 
 void MqttSettingsClass::publishGeneric(const String& topic, const String& payload, const bool retain, const uint8_t qos)
 {
-    std::lock_guard<std::mutex> lock(_clientLock);
-    if (_mqttClient == nullptr) {
+    enqueue(std::string_view(topic.c_str(), topic.length()), std::string_view(payload.c_str(), payload.length()), retain, qos);
+}
+
+void MqttSettingsClass::publish(const MqttTopic& topic, const MqttValue& value)
+{
+    if (topic.overflow()) {
+        ESP_LOGW(TAG, "Topic '%s...' exceeds %zu characters, not publishing", topic.c_str(), MqttTopic::MaxLength);
+        return;
+    }
+
+    if (collect(std::string_view(topic.c_str(), topic.length()), std::string_view(value.data(), value.length()), true)) {
         return;
     }
-    _mqttClient->publish(topic.c_str(), qos, retain, payload.c_str());
+
+    send(topic, value);
+}
+
+void MqttSettingsClass::send(const MqttTopic& topic, const MqttValue& value)
+{
+    enqueue(std::string_view(topic.c_str(), topic.length()), std::string_view(value.data(), value.length()),
+        Configuration.get()->Mqtt.Retain, 0);
+}
+
+void MqttSettingsClass::enqueue(std::string_view topic, std::string_view payload, const bool retain, const uint8_t qos)
+{
+    if (!_publishQueue.push(topic, payload, retain, qos)) {
+        ESP_LOGD(TAG, "Publish queue full, dropping message for topic '%.*s'", static_cast<int>(topic.length()), topic.data());
+    }
+
+    if (_publisherTaskHandle != nullptr) {
+        xTaskNotifyGive(_publisherTaskHandle);
+    }
+}
+
+void MqttSettingsClass::publisherLoopHelper(void* context)
+{
+    static_cast<MqttSettingsClass*>(context)->publisherLoop();
+}
+
+void MqttSettingsClass::publisherLoop()
+{
+    MqttPublishQueue::Message msg;
+
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        while (_publishQueue.pop(msg)) {
+            std::lock_guard<std::mutex> lock(_clientLock);
+            if (_mqttClient == nullptr) {
+                continue;
+            }
+            _mqttClient->publish(msg.Topic.c_str(), msg.Qos, msg.Retain,
+                reinterpret_cast<const uint8_t*>(msg.Payload.data()), msg.Payload.length());
+        }
+    }
+}
+
+void MqttSettingsClass::publishIfChanged(const MqttTopic& topic, const MqttValue& value, const float deadband)
+{
+    // nothing is published while disconnected, so it must not be cached either
+    if (!getConnected()) {
+        return;
+    }
+
+    if (topic.overflow()) {
+        ESP_LOGW(TAG, "Topic '%s...' exceeds %zu characters, not publishing", topic.c_str(), MqttTopic::MaxLength);
+        return;
+    }
+
+    bool changed = updatePublishCache(topic, value, deadband);
+
+    // unchanged values are collected as well, as the JSON document is
+    // published as a whole.
+    if (collect(std::string_view(topic.c_str(), topic.length()), std::string_view(value.data(), value.length()), changed)) {
+        return;
+    }
+
+    if (!changed) {
+        return;
+    }
+
+    send(topic, value);
+}
+
+bool MqttSettingsClass::updatePublishCache(const MqttTopic& topic, const MqttValue& value, const float deadband)
+{
+    PublishCacheEntry entry;
+    entry.TopicHash = Utils::fnv1aHash64(topic.c_str(), topic.length());
+    entry.TopicLength = static_cast<uint16_t>(topic.length());
+    entry.PayloadHash = Utils::fnv1aHash(value.data(), value.length());
+    entry.Value = parseNumber(value);
+    entry.PublishedMillis = millis();
+
+    std::lock_guard<std::mutex> lock(_publishCacheLock);
+
+    auto it = std::lower_bound(_publishCache.begin(), _publishCache.end(), entry,
+        [](const PublishCacheEntry& a, const PublishCacheEntry& b) {
+            return std::tie(a.TopicHash, a.TopicLength) < std::tie(b.TopicHash, b.TopicLength);
+        });
+
+    if (it == _publishCache.end() || it->TopicHash != entry.TopicHash || it->TopicLength != entry.TopicLength) {
+        _publishCache.insert(it, entry);
+        return true;
+    }
+
+    bool changed = it->PayloadHash != entry.PayloadHash;
+    if (changed && deadband > 0 && !std::isnan(entry.Value) && !std::isnan(it->Value)) {
+        changed = std::fabs(entry.Value - it->Value) >= deadband;
+    }
+
+    bool due = (entry.PublishedMillis - it->PublishedMillis) >= FullRepublishIntervalMillis;
+
+    if (!changed && !due) {
+        return false;
+    }
+
+    *it = entry;
+    return true;
+}
+
+void MqttSettingsClass::clearPublishCache()
+{
+    std::lock_guard<std::mutex> lock(_publishCacheLock);
+    _publishCache.clear();
+    _publishCache.shrink_to_fit();
+
+    // the documents belong to the task currently batching (if any), so
+    // they are discarded when the next batch begins.
+    _batchDocsStale = true;
+}
+
+bool MqttSettingsClass::beginBatch(std::string_view base)
+{
+    auto const config = Configuration.get();
+    if (config->Mqtt.PublishMode == MqttPublishModeType::PublishTopics) {
+        return false;
+    }
+
+    if (_batchTask == xTaskGetCurrentTaskHandle()) {
+        ESP_LOGE(TAG, "Nested batch for '%.*s' not supported", static_cast<int>(base.length()), base.data());
+        return false;
+    }
+
+    _batchLock.lock();
+    _batchTask = xTaskGetCurrentTaskHandle();
+
+    if (_batchDocsStale.exchange(false)) {
+        _batchDocs.clear();
+    }
+
+    auto it = _batchDocs.find(base);
+    if (it == _batchDocs.end()) {
+        it = _batchDocs.emplace(std::string(base), JsonDocument()).first;
+    }
+
+    _batchDoc = &it->second;
+    _batchBase.assign(*getCachedPrefix());
+    _batchBase.append(base.data(), base.length());
+    _batchChanged = false;
+    _batchMessagePack = (config->Mqtt.BatchEncoding == MqttBatchEncodingType::BatchMessagePack);
+    _batchPublishJson = (config->Mqtt.PublishMode == MqttPublishModeType::PublishJson);
+
+    return true;
+}
+
+void MqttSettingsClass::endBatch()
+{
+    if (_batchChanged && getConnected()) {
+        // MessagePack payloads contain null bytes, which is fine as the
+        // queue does not rely on null-terminated strings.
+        std::string payload;
+        std::string topic(_batchBase);
+        if (_batchMessagePack) {
+            serializeMsgPack(*_batchDoc, payload);
+            topic += "msgpack";
+        } else {
+            serializeJson(*_batchDoc, payload);
+            topic += "json";
+        }
+
+        enqueue(topic, payload, Configuration.get()->Mqtt.Retain, 0);
+    }
+
+    _batchDoc = nullptr;
+    _batchTask = nullptr;
+    _batchLock.unlock();
+}
+
+bool MqttSettingsClass::collect(std::string_view topic, std::string_view payload, const bool changed)
+{
+    if (_batchTask != xTaskGetCurrentTaskHandle()) {
+        return false;
+    }
+
+    if (topic.substr(0, _batchBase.length()) != _batchBase) {
+        return false;
+    }
+
+    // one nested object per topic level below the base topic
+    JsonObject obj = _batchDoc->is<JsonObject>() ? _batchDoc->as<JsonObject>() : _batchDoc->to<JsonObject>();
+    std::string_view levels = topic.substr(_batchBase.length());
+    while (true) {
+        size_t pos = levels.find('/');
+        std::string_view level = levels.substr(0, pos);
+        if (pos == std::string_view::npos) {
+            if (isJsonNumber(payload)) {
+                setNumber(obj[level], payload, _batchMessagePack);
+            } else {
+                obj[level] = payload;
+            }
+            break;
+        }
+
+        levels.remove_prefix(pos + 1);
+        if (level.empty()) { continue; }
+
+        JsonVariant child = obj[level];
+        obj = child.is<JsonObject>() ? child.as<JsonObject>() : child.to<JsonObject>();
+    }
+
+    _batchChanged |= changed;
+
+    return _batchPublishJson;
+}
+
+void MqttSettingsClass::setHassStateTopic(JsonDocument& root, std::string_view base, std::string_view subtopic) const
+{
+    std::string topic(*getCachedPrefix());
+    topic.append(base.data(), base.length());
+
+    if (Configuration.get()->Mqtt.PublishMode != MqttPublishModeType::PublishJson) {
+        topic.append(subtopic.data(), subtopic.length());
+        root["stat_t"] = topic;
+        return;
+    }
+
+    std::string tpl = "{{ value_json";
+    while (!subtopic.empty()) {
+        size_t pos = subtopic.find('/');
+        std::string_view level = subtopic.substr(0, pos);
+        if (!level.empty()) {
+            tpl.append("['").append(level.data(), level.length()).append("']");
+        }
+        subtopic.remove_prefix(pos == std::string_view::npos ? subtopic.length() : pos + 1);
+    }
+    tpl.append(" }}");
+
+    topic.append("json");
+    root["stat_t"] = topic;
+    root["val_tpl"] = tpl;
+}
+
+MqttBatch::MqttBatch(std::string_view base)
+    : _active(MqttSettings.beginBatch(base))
+{
+}
+
+MqttBatch::~MqttBatch()
+{
+    if (_active) {
+        MqttSettings.endBatch();
+    }
+}
+
+void MqttSettingsClass::updatePrefix()
+{
+    std::atomic_store(&_spPrefix, std::make_shared<std::string const>(Configuration.get()->Mqtt.Topic));
 }
 
 void MqttSettingsClass::init()
 {
+    updatePrefix();
+
     using std::placeholders::_1;
     NetworkSettings.onEvent(std::bind(&MqttSettingsClass::NetworkEvent, this, _1));
 
     createMqttClientObject();
+
+    uint32_t constexpr stackSize = 4096;
+    xTaskCreate(publisherLoopHelper, "mqttPublisher",
+            stackSize, this, 1/*prio*/, &_publisherTaskHandle);
 }
 
 void MqttSettingsClass::createMqttClientObject()
 {
     std::lock_guard<std::mutex> lock(_clientLock);
+    _connected = false;
     if (_mqttClient != nullptr) {
         delete _mqttClient;
         _mqttClient = nullptr;
     }
-    const CONFIG_T& config = Configuration.get();
-    if (config.Mqtt.Tls.Enabled) {
+    auto const config = Configuration.get();
+    if (config->Mqtt.Tls.Enabled) {
         _mqttClient = static_cast<MqttClient*>(new espMqttClientSecure);
     } else {
         _mqttClient = static_cast<MqttClient*>(new espMqttClient);
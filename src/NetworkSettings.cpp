@@ -6,6 +6,7 @@
 #include "Configuration.h"
 #include "SyslogLogger.h"
 #include "PinMapping.h"
+#include "TaskProfiler.h"
 #include "Utils.h"
 #include "__compiled_constants.h"
 #include "defaults.h"
@@ -16,7 +17,7 @@
 static const char* TAG = "network";
 
 NetworkSettingsClass::NetworkSettingsClass()
-    : _loopTask(TASK_IMMEDIATE, TASK_FOREVER, std::bind(&NetworkSettingsClass::loop, this))
+    : _loopTask(TASK_IMMEDIATE, TASK_FOREVER)
     , _apIp(192, 168, 4, 1)
     , _apNetmask(255, 255, 255, 0)
     , _dnsServer(std::make_unique<DNSServer>())
@@ -57,6 +58,7 @@ void NetworkSettingsClass::init(Scheduler& scheduler)
     setupMode();
 
     scheduler.addTask(_loopTask);
+    _loopTask.setCallback(TaskProfiler.wrap("Network", std::bind(&NetworkSettingsClass::loop, this)));
     _loopTask.enable();
 
     Syslog.init(scheduler);
@@ -148,7 +150,7 @@ void NetworkSettingsClass::raiseEvent(const network_event event)
 
 void NetworkSettingsClass::handleMDNS()
 {
-    const bool mdnsEnabled = Configuration.get().Mdns.Enabled;
+    const bool mdnsEnabled = Configuration.get()->Mdns.Enabled;
 
     // Return if no state change
     if (_lastMdnsEnabled == mdnsEnabled) {
@@ -183,7 +185,7 @@ void NetworkSettingsClass::setupMode()
         WiFi.mode(WIFI_AP_STA);
         String ssidString = getApName();
         WiFi.softAPConfig(_apIp, _apIp, _apNetmask);
-        WiFi.softAP(ssidString.c_str(), Configuration.get().Security.Password);
+        WiFi.softAP(ssidString.c_str(), Configuration.get()->Security.Password);
         _dnsServer->setErrorReplyCode(DNSReplyCode::NoError);
         _dnsServer->start(DNS_PORT, "*", WiFi.softAPIP());
         _dnsServerStatus = true;
@@ -207,7 +209,7 @@ void NetworkSettingsClass::enableAdminMode()
     _connectRedoTimer = 0;
 
     _adminTimeoutCounter = 0;
-    _adminTimeoutCounterMax = Configuration.get().WiFi.ApTimeout * 60;
+    _adminTimeoutCounterMax = Configuration.get()->WiFi.ApTimeout * 60;
     _adminEnabled = true;
     setupMode();
 }
@@ -222,7 +224,7 @@ void NetworkSettingsClass::disableAdminMode()
 bool NetworkSettingsClass::wifiConfigured() const
 {
     // Check if SSID is empty
-    return strcmp(Configuration.get().WiFi.Ssid, "");
+    return strcmp(Configuration.get()->WiFi.Ssid, "");
 }
 
 String NetworkSettingsClass::getApName() const
@@ -315,7 +317,8 @@ void NetworkSettingsClass::applyConfig()
 {
     setHostname();
 
-    const auto& config = Configuration.get().WiFi;
+    auto const spConfig = Configuration.get();
+    const auto& config = spConfig->WiFi;
 
     if (!wifiConfigured()) {
         return;
@@ -372,7 +375,8 @@ void NetworkSettingsClass::setStaticIp()
         return;
     }
 
-    const auto& config = Configuration.get().WiFi;
+    auto const spConfig = Configuration.get();
+    const auto& config = spConfig->WiFi;
     const char* mode = (_networkMode == network_mode::WiFi) ? "WiFi" : "Ethernet";
     const char* ipType = config.Dhcp ? "DHCP" : "static";
 
@@ -481,13 +485,13 @@ String NetworkSettingsClass::macAddress() const
 
 String NetworkSettingsClass::getHostname()
 {
-    const CONFIG_T& config = Configuration.get();
+    auto const config = Configuration.get();
     char preparedHostname[WIFI_MAX_HOSTNAME_STRLEN + 1];
     char resultHostname[WIFI_MAX_HOSTNAME_STRLEN + 1];
     uint8_t pos = 0;
 
     const uint32_t chipId = Utils::getChipId();
-    snprintf(preparedHostname, WIFI_MAX_HOSTNAME_STRLEN + 1, config.WiFi.Hostname, chipId);
+    snprintf(preparedHostname, WIFI_MAX_HOSTNAME_STRLEN + 1, config->WiFi.Hostname, chipId);
 
     const char* pC = preparedHostname;
     while (*pC && pos < WIFI_MAX_HOSTNAME_STRLEN) { // while !null and not over length
@@ -0,0 +1,61 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#include <algorithm>
+#include <powermeter/Controller.h>
+#include "Configuration.h"
+#include "PowerArbiter.h"
+#include "PowerLimiter.h"
+#include <LogHelper.h>
+
+#undef TAG
+static const char* TAG = "dynamicPowerLimiter";
+static const char* SUBTAG = "Arbiter";
+
+PowerArbiterClass PowerArbiter;
+
+PowerArbiterClass::Allocation const& PowerArbiterClass::getAllocation()
+{
+    auto sample = PowerMeter.getSample();
+
+    if (sample.Timestamp == _allocation.Timestamp && sample.Valid == _allocation.Valid) {
+        return _allocation;
+    }
+
+    auto const config = Configuration.get();
+    float inverterTarget = config->PowerLimiter.TargetPowerConsumption;
+    float chargerTarget = config->GridCharger.AutoPowerTargetPowerConsumption;
+
+    float chargerInput = std::max(_chargerInputPower, 0.0f);
+    float inverterOutput = PowerLimiter.getBatteryInvertersOutputAcWatts();
+
+    float meter = sample.PowerTotal;
+
+    // importing more than the charger's target: the charger reduces its
+    // input first, up to all of it, unless it is not controlled automatically
+    // (manual limits, emergency charging).
+    float chargerShed = 0;
+    if (_chargerInputAutomatic) {
+        chargerShed = std::min(chargerInput, std::max(meter - chargerTarget, 0.0f));
+    }
+
+    // exporting more than the inverters' target: battery-powered inverters
+    // reduce their output first, up to all of it.
+    float inverterShed = std::min(inverterOutput, std::max(inverterTarget - meter, 0.0f));
+
+    _allocation.Timestamp = sample.Timestamp;
+    _allocation.Valid = sample.Valid;
+    _allocation.GridPower = meter;
+    _allocation.InverterGridPower = meter - chargerShed;
+    _allocation.ChargerGridPower = meter + inverterShed;
+    _allocation.ChargerYields = (chargerInput - chargerShed) < 1
+        && _allocation.InverterGridPower > inverterTarget;
+    _allocation.InverterYields = (inverterOutput - inverterShed) < 1
+        && _allocation.ChargerGridPower < chargerTarget;
+
+    DTU_LOGD("meter %.1f W (%s): charger input %.0f W sheds %.0f W%s, "
+            "inverter output %.0f W sheds %.0f W%s",
+            meter, (sample.Valid ? "valid" : "stale"),
+            chargerInput, chargerShed, (_allocation.ChargerYields ? " (yields)" : ""),
+            inverterOutput, inverterShed, (_allocation.InverterYields ? " (yields)" : ""));
+
+    return _allocation;
+}
@@ -7,6 +7,7 @@
 #include <battery/Stats.h>
 #include <powermeter/Controller.h>
 #include "PowerLimiter.h"
+#include "PowerArbiter.h"
 #include "Configuration.h"
 #include "MqttSettings.h"
 #include "NetworkSettings.h"
@@ -17,6 +18,7 @@
 #include <limits>
 #include <frozen/map.h>
 #include "SunPosition.h"
+#include "TaskProfiler.h"
 #include <LogHelper.h>
 
 #undef TAG
@@ -46,9 +48,12 @@ PowerLimiterClass PowerLimiter;
 void PowerLimiterClass::init(Scheduler& scheduler)
 {
     scheduler.addTask(_loopTask);
-    _loopTask.setCallback(std::bind(&PowerLimiterClass::loop, this));
+    _loopTask.setCallback(TaskProfiler.wrap("DPL", std::bind(&PowerLimiterClass::loop, this)));
     _loopTask.setIterations(TASK_FOREVER);
     _loopTask.enable();
+
+    _spLoopDuration = MetricsRegistry.addHistogram("powerlimiter_loop_duration_us",
+        "Duration of the dynamic power limiter loop", Metrics::DurationBoundsUs);
 }
 
 frozen::string const& PowerLimiterClass::getStatusText(PowerLimiterClass::Status status) const
@@ -94,9 +99,9 @@ void PowerLimiterClass::announceStatus(PowerLimiterClass::Status status)
 
 void PowerLimiterClass::reloadConfig()
 {
-    auto const& config = Configuration.get();
+    auto const config = Configuration.get();
 
-    if (!config.PowerLimiter.Enabled || Mode::Disabled == _mode) {
+    if (!config->PowerLimiter.Enabled || Mode::Disabled == _mode) {
         _retirees.insert(
             _retirees.end(),
             std::make_move_iterator(_inverters.begin()),
@@ -114,7 +119,7 @@ void PowerLimiterClass::reloadConfig()
         bool stillGoverned = false;
 
         for (size_t i = 0; i < INV_MAX_COUNT; ++i) {
-            auto const& inv = config.PowerLimiter.Inverters[i];
+            auto const& inv = config->PowerLimiter.Inverters[i];
             if (inv.Serial == 0ULL) { break; }
             stillGoverned = inv.Serial == (*iter)->getSerial() && inv.IsGoverned;
             if (stillGoverned) { break; }
@@ -128,7 +133,7 @@ void PowerLimiterClass::reloadConfig()
     }
 
     for (size_t i = 0; i < INV_MAX_COUNT; ++i) {
-        auto const& invConfig = config.PowerLimiter.Inverters[i];
+        auto const& invConfig = config->PowerLimiter.Inverters[i];
 
         if (invConfig.Serial == 0ULL) { break; }
 
@@ -145,7 +150,9 @@ void PowerLimiterClass::reloadConfig()
 
 void PowerLimiterClass::loop()
 {
-    auto const& config = Configuration.get();
+    Metrics::ScopedTimer timer(*_spLoopDuration);
+
+    auto const config = Configuration.get();
 
     // we know that the Hoymiles library refuses to send any message to any
     // inverter until the system has valid time information. until then we can
@@ -166,7 +173,7 @@ void PowerLimiterClass::loop()
         return announceStatus(Status::ConfigReload);
     }
 
-    if (!config.PowerLimiter.Enabled) {
+    if (!config->PowerLimiter.Enabled) {
         return announceStatus(Status::DisabledByConfig);
     }
 
@@ -208,7 +215,8 @@ void PowerLimiterClass::loop()
     // arrives. this can be the case for readings provided by networked meter
     // readers, where a packet needs to travel through the network for some
     // time after the actual measurement was done by the reader.
-    if (PowerMeter.isDataValid() && PowerMeter.getLastUpdate() <= (latestInverterStats + 2000)) {
+    auto const& allocation = PowerArbiter.getAllocation();
+    if (allocation.Valid && allocation.Timestamp <= (latestInverterStats + 2000)) {
         return announceStatus(Status::PowerMeterPending);
     }
 
@@ -282,7 +290,7 @@ void PowerLimiterClass::loop()
 
         // if we reach this line we come from stop and have to consider the 'Solar-Passthrough' and the 'Use Battery at night' settings.
         auto solarPassThroughEnabled = isSolarPassThroughEnabled();
-        auto isBatteryAlwaysUseAtNightEnabled = config.PowerLimiter.BatteryAlwaysUseAtNight;
+        auto isBatteryAlwaysUseAtNightEnabled = config->PowerLimiter.BatteryAlwaysUseAtNight;
 
         // When `Use Battery at night` is disabled or when its day, battery should not be discharged
         if (!isBatteryAlwaysUseAtNightEnabled || day) {
@@ -305,14 +313,14 @@ void PowerLimiterClass::loop()
         // and we are above the 'battery start threshold'
         if (!isSolarPassThroughEnabled() || !isStartThresholdReached()) { return false; }
 
-        if (testThreshold(config.PowerLimiter.FullSolarPassThroughSoc,
-                        config.PowerLimiter.FullSolarPassThroughStartVoltage,
+        if (testThreshold(config->PowerLimiter.FullSolarPassThroughSoc,
+                        config->PowerLimiter.FullSolarPassThroughStartVoltage,
                         [](float a, float b) -> bool { return a >= b; })) {
             return true;
         }
 
-        if (testThreshold(config.PowerLimiter.FullSolarPassThroughSoc,
-                        config.PowerLimiter.FullSolarPassThroughStopVoltage,
+        if (testThreshold(config->PowerLimiter.FullSolarPassThroughSoc,
+                        config->PowerLimiter.FullSolarPassThroughStopVoltage,
                         [](float a, float b) -> bool { return a < b; })) {
             return false;
         }
@@ -328,7 +336,7 @@ void PowerLimiterClass::loop()
 
         if (dcVoltage <= 0.0) { return 0.0; }
 
-        return dcVoltage + (acPower * config.PowerLimiter.VoltageLoadCorrectionFactor);
+        return dcVoltage + (acPower * config->PowerLimiter.VoltageLoadCorrectionFactor);
     };
 
     _loadCorrectedVoltage = getLoadCorrectedVoltage();
@@ -339,13 +347,13 @@ void PowerLimiterClass::loop()
             millis()/1000,
             (SunPosition.isDayPeriod()?"day":"night"),
             _nextInverterRestart.second/1000,
-            config.PowerLimiter.RestartHour);
+            config->PowerLimiter.RestartHour);
 
     if (usesBatteryPoweredInverter()) {
         DTU_LOGD("battery interface %sabled, SoC %.1f %% (%s), age %u s (%s)",
-                (config.Battery.Enabled?"en":"dis"),
+                (config->Battery.Enabled?"en":"dis"),
                 Battery.getStats()->getSoC(),
-                (config.PowerLimiter.IgnoreSoc?"ignored":"used"),
+                (config->PowerLimiter.IgnoreSoc?"ignored":"used"),
                 Battery.getStats()->getSoCAgeSeconds(),
                 (Battery.getStats()->isSoCValid()?"valid":"stale"));
 
@@ -353,39 +361,39 @@ void PowerLimiterClass::loop()
         DTU_LOGD("battery voltage %.2f V, load-corrected voltage %.2f V @ %.0f W, factor %.5f 1/A",
                 dcVoltage, _loadCorrectedVoltage,
                 getBatteryInvertersOutputAcWatts(),
-                config.PowerLimiter.VoltageLoadCorrectionFactor);
+                config->PowerLimiter.VoltageLoadCorrectionFactor);
 
         DTU_LOGD("battery discharge %s, start %.2f V or %u %%, stop %.2f V or %u %%",
                 (((_batteryState == BatteryState::DISCHARGE_ALLOWED) || (_batteryState == BatteryState::DISCHARGE_NIGHT))?"allowed":
                 (_batteryState == BatteryState::NO_DISCHARGE)?"restricted":"stopped"),
-                config.PowerLimiter.VoltageStartThreshold,
-                config.PowerLimiter.BatterySocStartThreshold,
-                config.PowerLimiter.VoltageStopThreshold,
-                config.PowerLimiter.BatterySocStopThreshold);
+                config->PowerLimiter.VoltageStartThreshold,
+                config->PowerLimiter.BatterySocStartThreshold,
+                config->PowerLimiter.VoltageStopThreshold,
+                config->PowerLimiter.BatterySocStopThreshold);
 
         if (isSolarPassThroughEnabled()) {
             DTU_LOGD("full solar-passthrough %s, start %.2f V or %u %%, stop %.2f V",
                     (isFullSolarPassthroughActive()?"active":"dormant"),
-                    config.PowerLimiter.FullSolarPassThroughStartVoltage,
-                    config.PowerLimiter.FullSolarPassThroughSoc,
-                    config.PowerLimiter.FullSolarPassThroughStopVoltage);
+                    config->PowerLimiter.FullSolarPassThroughStartVoltage,
+                    config->PowerLimiter.FullSolarPassThroughSoc,
+                    config->PowerLimiter.FullSolarPassThroughStopVoltage);
         }
 
         DTU_LOGD("start %sreached, stop %sreached, solar-passthrough %sabled, use at night %sabled and %s",
                 (isStartThresholdReached()?"":"NOT "),
                 (isStopThresholdReached()?"":"NOT "),
                 (isSolarPassThroughEnabled()?"en":"dis"),
-                (config.PowerLimiter.BatteryAlwaysUseAtNight?"en":"dis"),
+                (config->PowerLimiter.BatteryAlwaysUseAtNight?"en":"dis"),
                 ((_batteryState == BatteryState::DISCHARGE_NIGHT)?"active":"dormant"));
 
         DTU_LOGD("total max AC power is %u W, conduction losses are %u %%",
-            config.PowerLimiter.TotalUpperPowerLimit,
-            config.PowerLimiter.ConductionLosses);
+            config->PowerLimiter.TotalUpperPowerLimit,
+            config->PowerLimiter.ConductionLosses);
     }
 
     uint16_t inverterTotalPower = calcTargetOutput();
 
-    auto totalAllowance = config.PowerLimiter.TotalUpperPowerLimit;
+    auto totalAllowance = config->PowerLimiter.TotalUpperPowerLimit;
     inverterTotalPower = std::min(inverterTotalPower, totalAllowance);
 
     auto coveredBySolar = updateInverterLimits(inverterTotalPower, sSolarPoweredFilter, sSolarPoweredExpression);
@@ -414,11 +422,11 @@ void PowerLimiterClass::loop()
 
 std::pair<float, char const*> PowerLimiterClass::getInverterDcVoltage() const
 {
-    auto const& config = Configuration.get();
+    auto const config = Configuration.get();
 
     auto iter = _inverters.cbegin();
     while(iter != _inverters.cend()) {
-        if ((*iter)->getSerial() == config.PowerLimiter.InverterSerialForDcVoltage) {
+        if ((*iter)->getSerial() == config->PowerLimiter.InverterSerialForDcVoltage) {
             break;
         }
         ++iter;
@@ -431,7 +439,7 @@ std::pair<float, char const*> PowerLimiterClass::getInverterDcVoltage() const
     }
 
     if ((*iter)->isReachable()) {
-        voltage = (*iter)->getDcVoltage(config.PowerLimiter.InverterChannelIdForDcVoltage);
+        voltage = (*iter)->getDcVoltage(config->PowerLimiter.InverterChannelIdForDcVoltage);
     }
 
     return { voltage, (*iter)->getSerialStr() };
@@ -445,7 +453,7 @@ std::pair<float, char const*> PowerLimiterClass::getInverterDcVoltage() const
  * the voltage reported by the inverter is used.
  */
 float PowerLimiterClass::getBatteryVoltage(bool log) const {
-    auto const& config = Configuration.get();
+    auto const config = Configuration.get();
 
     float res = 0;
 
@@ -461,7 +469,7 @@ float PowerLimiterClass::getBatteryVoltage(bool log) const {
 
     float bmsVoltage = -1;
     auto stats = Battery.getStats();
-    if (config.Battery.Enabled
+    if (config->Battery.Enabled
             && stats->isVoltageValid()
             && stats->getVoltageAgeSeconds() < 60) {
         res = bmsVoltage = stats->getVoltage();
@@ -483,8 +491,8 @@ float PowerLimiterClass::getBatteryVoltage(bool log) const {
 uint16_t PowerLimiterClass::dcPowerBusToInverterAc(uint16_t dcPower) const
 {
     // account for losses between power bus and inverter (cables, junctions...)
-    auto const& config = Configuration.get();
-    float lossesFactor = 1.00 - static_cast<float>(config.PowerLimiter.ConductionLosses)/100;
+    auto const config = Configuration.get();
+    float lossesFactor = 1.00 - static_cast<float>(config->PowerLimiter.ConductionLosses)/100;
 
     // we cannot know the efficiency at the new limit. even if we could we
     // cannot know which inverter is assigned which limit. hence we use a
@@ -554,16 +562,20 @@ uint8_t PowerLimiterClass::getPowerLimiterState() const
 
 uint16_t PowerLimiterClass::calcTargetOutput() const
 {
-    auto const& config = Configuration.get();
-    auto targetConsumption = config.PowerLimiter.TargetPowerConsumption;
-    auto baseLoad = config.PowerLimiter.BaseLoadLimit;
+    auto const config = Configuration.get();
+    auto targetConsumption = config->PowerLimiter.TargetPowerConsumption;
+    auto baseLoad = config->PowerLimiter.BaseLoadLimit;
 
-    auto meterValid = PowerMeter.isDataValid();
-    auto meterValue = PowerMeter.getPowerTotal();
+    // the meter value as left to the inverters after the grid charger took
+    // its share, see PowerArbiter.
+    auto const& allocation = PowerArbiter.getAllocation();
+    auto meterValid = allocation.Valid;
+    auto meterValue = allocation.InverterGridPower;
 
-    DTU_LOGD("targeting %d W, base load is %u W, power meter reads %.1f W (%s)",
-            targetConsumption, baseLoad, meterValue,
-            (meterValid?"valid":"stale"));
+    DTU_LOGD("targeting %d W, base load is %u W, power meter reads %.1f W "
+            "(%s), %.1f W after grid charger allocation",
+            targetConsumption, baseLoad, allocation.GridPower,
+            (meterValid?"valid":"stale"), meterValue);
 
     if (!meterValid) { return baseLoad; }
 
@@ -644,8 +656,8 @@ uint16_t PowerLimiterClass::updateInverterLimits(uint16_t powerRequested,
 
     int32_t diff = powerRequested - producing;
 
-    auto const& config = Configuration.get();
-    uint16_t hysteresis = config.PowerLimiter.TargetPowerConsumptionHysteresis;
+    auto const config = Configuration.get();
+    uint16_t hysteresis = config->PowerLimiter.TargetPowerConsumptionHysteresis;
 
     bool plural = matchingInverters.size() != 1;
     DTU_LOGD("requesting %d W from %d %s inverter%s currently "
@@ -722,11 +734,13 @@ uint16_t PowerLimiterClass::calcPowerBusUsage(uint16_t powerRequested) const
 {
     // We check if the PSU is on and disable battery-powered inverters in this
     // case. The PSU should reduce power or shut down first before the
-    // battery-powered inverters kick in. The only case where this is not
-    // desired is if the battery is over the Full Solar Passthrough Threshold.
-    // In this case battery-powered inverters should produce power and the PSU
-    // will shut down as a consequence.
-    if (!isFullSolarPassthroughActive() && GridCharger.getAutoPowerStatus()) {
+    // battery-powered inverters kick in, which is the case once the PSU
+    // yields all of its input power for the current power meter reading.
+    // The only case where this is not desired is if the battery is over the
+    // Full Solar Passthrough Threshold. In this case battery-powered inverters
+    // should produce power and the PSU will shut down as a consequence.
+    if (!isFullSolarPassthroughActive() && GridCharger.getAutoPowerStatus()
+            && !PowerArbiter.getAllocation().ChargerYields) {
         DTU_LOGD("DC power bus usage blocked by GridCharger auto power");
         return 0;
     }
@@ -843,12 +857,12 @@ std::optional<uint16_t> PowerLimiterClass::getBatteryDischargeLimit() const
 bool PowerLimiterClass::testThreshold(float socThreshold, float voltThreshold,
         std::function<bool(float, float)> compare) const
 {
-    auto const& config = Configuration.get();
+    auto const config = Configuration.get();
 
     // prefer SoC provided through battery interface, unless disabled by user
     auto stats = Battery.getStats();
-    if (!config.PowerLimiter.IgnoreSoc
-            && config.Battery.Enabled
+    if (!config->PowerLimiter.IgnoreSoc
+            && config->Battery.Enabled
             && socThreshold > 0.0
             && stats->isSoCValid()
             && stats->getSoCAgeSeconds() < 60) {
@@ -863,33 +877,33 @@ bool PowerLimiterClass::testThreshold(float socThreshold, float voltThreshold,
 
 bool PowerLimiterClass::isStartThresholdReached() const
 {
-    auto const& config = Configuration.get();
+    auto const config = Configuration.get();
 
     return testThreshold(
-            config.PowerLimiter.BatterySocStartThreshold,
-            config.PowerLimiter.VoltageStartThreshold,
+            config->PowerLimiter.BatterySocStartThreshold,
+            config->PowerLimiter.VoltageStartThreshold,
             [](float a, float b) -> bool { return a >= b; }
     );
 }
 
 bool PowerLimiterClass::isStopThresholdReached() const
 {
-    auto const& config = Configuration.get();
+    auto const config = Configuration.get();
 
     return testThreshold(
-            config.PowerLimiter.BatterySocStopThreshold,
-            config.PowerLimiter.VoltageStopThreshold,
+            config->PowerLimiter.BatterySocStopThreshold,
+            config->PowerLimiter.VoltageStopThreshold,
             [](float a, float b) -> bool { return a <= b; }
     );
 }
 
 bool PowerLimiterClass::isBelowStopThreshold() const
 {
-    auto const& config = Configuration.get();
+    auto const config = Configuration.get();
 
     return testThreshold(
-            config.PowerLimiter.BatterySocStopThreshold,
-            config.PowerLimiter.VoltageStopThreshold,
+            config->PowerLimiter.BatterySocStopThreshold,
+            config->PowerLimiter.VoltageStopThreshold,
             [](float a, float b) -> bool { return a < b; }
     );
 }
@@ -902,7 +916,7 @@ void PowerLimiterClass::calcNextInverterRestart()
         return;
     }
 
-    auto const& config = Configuration.get();
+    auto const config = Configuration.get();
     struct tm timeinfo;
     getLocalTime(&timeinfo, 5); // always succeeds as we call this method only
                                 // from the DPL loop *after* we already made
@@ -910,9 +924,9 @@ void PowerLimiterClass::calcNextInverterRestart()
 
     // calculation first step is offset to next restart in minutes
     uint16_t dayMinutes = timeinfo.tm_hour * 60 + timeinfo.tm_min;
-    uint16_t targetMinutes = config.PowerLimiter.RestartHour * 60;
+    uint16_t targetMinutes = config->PowerLimiter.RestartHour * 60;
     uint32_t restartMillis = 0;
-    if (config.PowerLimiter.RestartHour > timeinfo.tm_hour) {
+    if (config->PowerLimiter.RestartHour > timeinfo.tm_hour) {
         // next restart is on the same day
         restartMillis = targetMinutes - dayMinutes;
     } else {
@@ -921,7 +935,7 @@ void PowerLimiterClass::calcNextInverterRestart()
     }
 
     DTU_LOGD("Localtime read %02d:%02d / configured RestartHour %d",
-            timeinfo.tm_hour, timeinfo.tm_min, config.PowerLimiter.RestartHour);
+            timeinfo.tm_hour, timeinfo.tm_min, config->PowerLimiter.RestartHour);
     DTU_LOGD("dayMinutes %d / targetMinutes %d", dayMinutes, targetMinutes);
     DTU_LOGD("next inverter restart in %d minutes", restartMillis);
 
@@ -936,15 +950,15 @@ void PowerLimiterClass::calcNextInverterRestart()
 
 bool PowerLimiterClass::isSolarPassThroughEnabled() const
 {
-    auto const& config = Configuration.get();
+    auto const config = Configuration.get();
 
     // solar passthrough only applies to setups with battery-powered inverters
     if (!usesBatteryPoweredInverter()) { return false; }
 
     // solarcharger is needed for solar passthrough
-    if (!config.SolarCharger.Enabled) { return false; }
+    if (!config->SolarCharger.Enabled) { return false; }
 
-    return config.PowerLimiter.SolarPassThroughEnabled;
+    return config->PowerLimiter.SolarPassThroughEnabled;
 }
 
 bool PowerLimiterClass::usesBatteryPoweredInverter() const
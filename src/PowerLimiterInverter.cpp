@@ -43,6 +43,14 @@ PowerLimiterInverter::PowerLimiterInverter(PowerLimiterInverterConfig const& con
             static_cast<uint32_t>(config.Serial & 0xFFFFFFFF));
 
     snprintf(_logPrefix, sizeof(_logPrefix), "Inverter %s", _serialStr);
+
+    _spUpdateTimeoutsTotal = MetricsRegistry.addCounter("powerlimiter_update_timeouts_total",
+        "Limit or power updates which timed out or failed", { "serial", _serialStr });
+}
+
+PowerLimiterInverter::~PowerLimiterInverter()
+{
+    if (_spUpdateTimeoutsTotal) { MetricsRegistry.remove(_spUpdateTimeoutsTotal); }
 }
 
 PowerLimiterInverter::Eligibility PowerLimiterInverter::getEligibility() const
@@ -120,6 +128,7 @@ bool PowerLimiterInverter::update()
 
     auto updateFailure = [this,&reset]() -> bool {
         ++_updateTimeouts;
+        _spUpdateTimeoutsTotal->increment();
 
         // NOTE that these thresholds are not correlated to a specific time, since
         // this counts timeouts and failures, not absolute time. after any timeout or
@@ -3,6 +3,7 @@
  * Copyright (C) 2024-2026 Thomas Basler and others
  */
 #include "RestartHelper.h"
+#include "Configuration.h"
 #include "Display_Graphic.h"
 #include "Led_Single.h"
 #include <Esp.h>
@@ -28,6 +29,7 @@ void RestartHelperClass::triggerRestart()
 void RestartHelperClass::loop()
 {
     if (_rebootTask.isFirstIteration()) {
+        Configuration.flushExport();
         LedSingle.turnAllOff();
         Display.setStatus(false);
     } else {
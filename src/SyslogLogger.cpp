@@ -28,7 +28,8 @@ void SyslogLogger::init(Scheduler& scheduler)
 
 void SyslogLogger::updateSettings(const String&& hostname)
 {
-    auto& config = Configuration.get().Syslog;
+    auto const spConfig = Configuration.get();
+    auto& config = spConfig->Syslog;
 
     // Disable logger while it is reconfigured.
     disable();
@@ -107,7 +108,7 @@ void SyslogLogger::enable()
 
 bool SyslogLogger::resolveAndStart()
 {
-    if (Configuration.get().Mdns.Enabled) {
+    if (Configuration.get()->Mdns.Enabled) {
         _address = MDNS.queryHost(_syslog_hostname); // INADDR_NONE if failed
     }
     if (_address != INADDR_NONE) {
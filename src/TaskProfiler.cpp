@@ -0,0 +1,88 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#include "TaskProfiler.h"
+#include <esp_log.h>
+
+#undef TAG
+static const char* TAG = "taskProfiler";
+
+TaskProfilerClass TaskProfiler;
+
+TaskProfilerClass::TaskProfilerClass()
+    : _reportTask(60 * TASK_SECOND, TASK_FOREVER, std::bind(&TaskProfilerClass::report, this))
+{
+}
+
+void TaskProfilerClass::init(Scheduler& scheduler)
+{
+    _scheduler = &scheduler;
+
+    scheduler.addTask(_reportTask);
+    _reportTask.enableDelayed();
+}
+
+TaskProfilerClass::Entry::Entry(char const* name)
+    : Name(name)
+    , Duration(Metrics::DurationBoundsUs)
+    , Lateness({ 1, 5, 10, 50, 100, 500, 1000, 5000 })
+{
+}
+
+TaskCallback TaskProfilerClass::wrap(char const* name, TaskCallback callback)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    Entry& entry = _entries.emplace_back(name);
+
+    return [this, &entry, callback]() { run(entry, callback); };
+}
+
+void TaskProfilerClass::run(Entry& entry, TaskCallback const& callback)
+{
+    if (_scheduler != nullptr) {
+        Task& task = _scheduler->currentTask();
+        entry.IntervalMs.store(task.getInterval(), std::memory_order_relaxed);
+
+        // requires _TASK_TIMECRITICAL
+        long delay = task.getStartDelay();
+        entry.Lateness.observe(delay > 0 ? delay : 0);
+    }
+
+    Metrics::ScopedTimer timer(entry.Duration);
+    callback();
+}
+
+std::vector<TaskProfilerClass::Stats> TaskProfilerClass::getStats() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    std::vector<Stats> stats;
+    stats.reserve(_entries.size());
+
+    for (auto const& entry : _entries) {
+        stats.push_back({
+            entry.Name,
+            entry.Duration.getCount(),
+            entry.Duration.getSum(),
+            entry.Duration.getMax(),
+            entry.IntervalMs.load(std::memory_order_relaxed),
+            entry.Lateness.getSum(),
+            entry.Lateness.getMax(),
+        });
+    }
+
+    return stats;
+}
+
+void TaskProfilerClass::report()
+{
+    for (auto const& s : getStats()) {
+        if (s.Runs == 0) {
+            continue;
+        }
+
+        ESP_LOGD(TAG, "%-18s runs %" PRIu32 ", avg %" PRIu32 " us, max %" PRIu32 " us, "
+                      "interval %" PRIu32 " ms, late avg %" PRIu32 " ms, max %" PRIu32 " ms",
+            s.Name, s.Runs,
+            static_cast<uint32_t>(s.TotalUs / s.Runs), s.MaxUs, s.IntervalMs,
+            static_cast<uint32_t>(s.TotalLatenessMs / s.Runs), s.MaxLatenessMs);
+    }
+}
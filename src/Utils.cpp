@@ -7,6 +7,7 @@
 #include "PinMapping.h"
 #include <LittleFS.h>
 #include <MD5Builder.h>
+#include <esp_timer.h>
 
 #undef TAG
 static const char* TAG = "utils";
@@ -156,148 +157,38 @@ std::optional<float> Utils::getFromString(char const* val)
     return res;
 }
 
-template<typename T>
-char const* getTypename();
-
-template<>
-char const* getTypename<float>() { return "float"; }
-
-template<typename T>
-std::pair<T, String> Utils::getJsonValueByPath(JsonDocument const& root, String const& path)
+bool Utils::getEpoch(time_t* epoch, uint32_t ms /* = 20 */)
 {
-    size_t constexpr kErrBufferSize = 256;
-    char errBuffer[kErrBufferSize];
-    constexpr char delimiter = '/';
-    int start = 0;
-    int end = path.indexOf(delimiter);
-    auto value = root.as<JsonVariantConst>();
-
-    // NOTE: "Because ArduinoJson implements the Null Object Pattern, it is
-    // always safe to read the object: if the key doesn't exist, it returns an
-    // empty value."
-    auto getNext = [&](String const& key) -> bool {
-        // handle double forward slashes and paths starting or ending with a slash
-        if (key.isEmpty()) { return true; }
-
-        if (key[0] == '[' && key[key.length() - 1] == ']') {
-            if (!value.is<JsonArrayConst>()) {
-                snprintf(errBuffer, kErrBufferSize, "Cannot access non-array "
-                        "JSON node using array index '%s' (JSON path '%s', "
-                        "position %i)", key.c_str(), path.c_str(), start);
-                return false;
-            }
-
-            auto idx = key.substring(1, key.length() - 1).toInt();
-            value = value[idx];
-
-            if (value.isNull()) {
-                snprintf(errBuffer, kErrBufferSize, "Unable to access JSON "
-                        "array index %li (JSON path '%s', position %i)",
-                        idx, path.c_str(), start);
-                return false;
-            }
-
+    uint32_t start = millis();
+    while((millis()-start) <= ms) {
+        time(epoch);
+        if (*epoch > 1577836800) { /* epoch 2020-01-01T00:00:00 */
             return true;
         }
-
-        value = value[key];
-
-        if (value.isNull()) {
-            snprintf(errBuffer, kErrBufferSize, "Unable to access JSON key "
-                    "'%s' (JSON path '%s', position %i)",
-                    key.c_str(), path.c_str(), start);
-            return false;
-        }
-
-        return true;
-    };
-
-    while (end != -1) {
-        if (!getNext(path.substring(start, end))) {
-              return { T(), String(errBuffer) };
-        }
-        start = end + 1;
-        end = path.indexOf(delimiter, start);
-    }
-
-    if (!getNext(path.substring(start))) {
-        return { T(), String(errBuffer) };
-    }
-
-    if (value.is<T>()) {
-        return { value.as<T>(), "" };
-    }
-
-    if (!value.is<char const*>()) {
-        snprintf(errBuffer, kErrBufferSize, "Value '%s' at JSON path '%s' is "
-                "neither a string nor of type %s", value.as<String>().c_str(),
-                path.c_str(), getTypename<T>());
-        return { T(), String(errBuffer) };
-    }
-
-    auto res = getFromString<T>(value.as<char const*>());
-    if (!res.has_value()) {
-        snprintf(errBuffer, kErrBufferSize, "String '%s' at JSON path '%s' cannot "
-                "be converted to %s", value.as<String>().c_str(), path.c_str(),
-                getTypename<T>());
-        return { T(), String(errBuffer) };
+        delay(10);
     }
-
-    return { *res, "" };
+    return false;
 }
 
-template std::pair<float, String> Utils::getJsonValueByPath(JsonDocument const& root, String const& path);
-
-template <typename T>
-std::optional<T> Utils::getNumericValueFromMqttPayload(char const* client,
-        std::string const& src, char const* topic, char const* jsonPath)
+uint32_t Utils::getUptimeSeconds()
 {
-    std::string logValue = src.substr(0, 32);
-    if (src.length() > logValue.length()) { logValue += "..."; }
-
-    if (strlen(jsonPath) == 0) {
-        auto res = getFromString<T>(src.c_str());
-        if (!res.has_value()) {
-            ESP_LOGE(TAG, "[%s] Topic '%s': cannot parse payload '%s' as float", client, topic, logValue.c_str());
-            return std::nullopt;
-        }
-        return res;
-    }
-
-    JsonDocument json;
-
-    const DeserializationError error = deserializeJson(json, src);
-    if (error) {
-        ESP_LOGE(TAG, "[%s] Topic '%s': cannot parse payload '%s' as JSON", client, topic, logValue.c_str());
-        return std::nullopt;
-    }
-
-    if (json.overflowed()) {
-        ESP_LOGE(TAG, "[%s] Topic '%s': payload too large to process as JSON", client, topic);
-        return std::nullopt;
-    }
+    return static_cast<uint32_t>(esp_timer_get_time() / 1000000);
+}
 
-    auto pathResolutionResult = getJsonValueByPath<T>(json, jsonPath);
-    if (!pathResolutionResult.second.isEmpty()) {
-        ESP_LOGE(TAG, "[%s] Topic '%s': %s", client, topic, pathResolutionResult.second.c_str());
-        return std::nullopt;
+uint32_t Utils::fnv1aHash(const char* data, size_t length, uint32_t hash /* = 2166136261u */)
+{
+    for (size_t i = 0; i < length; ++i) {
+        hash ^= static_cast<uint8_t>(data[i]);
+        hash *= 16777619u;
     }
-
-    return pathResolutionResult.first;
+    return hash;
 }
 
-template std::optional<float> Utils::getNumericValueFromMqttPayload(char const* client,
-        std::string const& src, char const* topic, char const* jsonPath);
-
-bool Utils::getEpoch(time_t* epoch, uint32_t ms /* = 20 */)
+uint64_t Utils::fnv1aHash64(const char* data, size_t length, uint64_t hash /* = 14695981039346656037ull */)
 {
-    uint32_t start = millis();
-    while((millis()-start) <= ms) {
-        time(epoch);
-        if (*epoch > 1577836800) { /* epoch 2020-01-01T00:00:00 */
-            return true;
-        }
-        delay(10);
+    for (size_t i = 0; i < length; ++i) {
+        hash ^= static_cast<uint8_t>(data[i]);
+        hash *= 1099511628211ull;
     }
-    return false;
+    return hash;
 }
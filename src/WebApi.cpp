@@ -62,8 +62,8 @@ void WebApiClass::reload()
 
 bool WebApiClass::checkCredentials(AsyncWebServerRequest* request)
 {
-    auto const& config = Configuration.get();
-    if (request->authenticate(AUTH_USERNAME, config.Security.Password)) {
+    auto const config = Configuration.get();
+    if (request->authenticate(AUTH_USERNAME, config->Security.Password)) {
         return true;
     }
 
@@ -80,8 +80,8 @@ bool WebApiClass::checkCredentials(AsyncWebServerRequest* request)
 
 bool WebApiClass::checkCredentialsReadonly(AsyncWebServerRequest* request)
 {
-    auto const& config = Configuration.get();
-    if (config.Security.AllowReadonly) {
+    auto const config = Configuration.get();
+    if (config->Security.AllowReadonly) {
         return true;
     } else {
         return checkCredentials(request);
@@ -6,12 +6,14 @@
 #include "ArduinoJson.h"
 #include "AsyncJson.h"
 #include <battery/Controller.h>
+#include <battery/CellVoltageHistory.h>
 #include "Configuration.h"
 #include "MqttHandlePowerLimiterHass.h"
 #include "WebApi.h"
 #include "WebApi_battery.h"
 #include "WebApi_errors.h"
 #include "helper.h"
+#include "Utils.h"
 
 void WebApiBatteryClass::init(AsyncWebServer& server, Scheduler& scheduler)
 {
@@ -22,6 +24,7 @@ void WebApiBatteryClass::init(AsyncWebServer& server, Scheduler& scheduler)
     _server->on("/api/battery/status", HTTP_GET, static_cast<ArRequestHandlerFunction>(std::bind(&WebApiBatteryClass::onStatus, this, _1)));
     _server->on("/api/battery/config", HTTP_GET, static_cast<ArRequestHandlerFunction>(std::bind(&WebApiBatteryClass::onAdminGet, this, _1)));
     _server->on("/api/battery/config", HTTP_POST, static_cast<ArRequestHandlerFunction>(std::bind(&WebApiBatteryClass::onAdminPost, this, _1)));
+    _server->on("/api/battery/cells", HTTP_GET, static_cast<ArRequestHandlerFunction>(std::bind(&WebApiBatteryClass::onCells, this, _1)));
 }
 
 void WebApiBatteryClass::onStatus(AsyncWebServerRequest* request)
@@ -32,18 +35,18 @@ void WebApiBatteryClass::onStatus(AsyncWebServerRequest* request)
 
     AsyncJsonResponse* response = new AsyncJsonResponse();
     auto root = response->getRoot().as<JsonObject>();
-    auto const& config = Configuration.get();
+    auto const config = Configuration.get();
 
-    ConfigurationClass::serializeBatteryConfig(config.Battery, root);
+    ConfigurationClass::serializeBatteryConfig(config->Battery, root);
 
     auto zendure = root["zendure"].to<JsonObject>();
-    ConfigurationClass::serializeBatteryZendureConfig(config.Battery.Zendure, zendure);
+    ConfigurationClass::serializeBatteryZendureConfig(config->Battery.Zendure, zendure);
 
     auto mqtt = root["mqtt"].to<JsonObject>();
-    ConfigurationClass::serializeBatteryMqttConfig(config.Battery.Mqtt, mqtt);
+    ConfigurationClass::serializeBatteryMqttConfig(config->Battery.Mqtt, mqtt);
 
     auto serial = root["serial"].to<JsonObject>();
-    ConfigurationClass::serializeBatterySerialConfig(config.Battery.Serial, serial);
+    ConfigurationClass::serializeBatterySerialConfig(config->Battery.Serial, serial);
 
     WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
 }
@@ -96,3 +99,132 @@ void WebApiBatteryClass::onAdminPost(AsyncWebServerRequest* request)
     // potentially make SoC thresholds auto-discoverable
     MqttHandlePowerLimiterHass.forceUpdate();
 }
+
+namespace {
+
+// renders the cell voltage history as JSON one item at a time, such that
+// the (potentially large) document is never held in memory as a whole.
+class CellHistoryWriter {
+public:
+    explicit CellHistoryWriter(std::shared_ptr<Batteries::CellVoltageHistory const> spHistory)
+        : _spHistory(std::move(spHistory))
+        , _now(Utils::getUptimeSeconds()) { }
+
+    size_t fill(uint8_t* buffer, size_t maxLen)
+    {
+        size_t written = 0;
+
+        while (written < maxLen) {
+            if (_itemPos == _itemLen && !nextItem()) { break; }
+
+            size_t len = std::min(_itemLen - _itemPos, maxLen - written);
+            memcpy(buffer + written, _item + _itemPos, len);
+            _itemPos += len;
+            written += len;
+        }
+
+        return written;
+    }
+
+private:
+    bool nextItem()
+    {
+        _itemPos = 0;
+        _itemLen = 0;
+
+        switch (_state) {
+            case State::Header: {
+                _summary = _spHistory->getSummary();
+                append("{\"interval\":%u,\"capacity\":%u,\"cells\":%u,\"summary\":{"
+                        "\"observations\":%u,\"spread\":%u,\"max_spread\":%u,\"avg_spread\":%u,\"cells\":[",
+                        static_cast<unsigned>(_spHistory->getIntervalSeconds()),
+                        static_cast<unsigned>(_spHistory->getSampleCapacity()),
+                        _summary.CellCount, static_cast<unsigned>(_summary.Observations),
+                        _summary.SpreadMilliVolt,
+                        _summary.MaxSpreadMilliVolt, _summary.AvgSpreadMilliVolt);
+                _state = State::CellStats;
+                return true;
+            }
+
+            case State::CellStats:
+                if (_cell < _summary.CellCount) {
+                    auto const& cell = _summary.Cells[_cell];
+                    append("%s{\"min\":%u,\"max\":%u,\"avg\":%u,\"imbalance\":%.1f}",
+                            (_cell > 0 ? "," : ""), cell.MinMilliVolt, cell.MaxMilliVolt,
+                            cell.AvgMilliVolt, cell.ImbalanceMilliVolt);
+                    ++_cell;
+                    return true;
+                }
+                append("]},\"samples\":[");
+                _state = State::Samples;
+                return true;
+
+            case State::Samples: {
+                Batteries::CellVoltageHistory::Sample sample;
+                if (_spHistory->read(_cursor, sample)) {
+                    // samples are reported by their age in seconds
+                    append("%s[%u", (_firstSample ? "" : ","),
+                            static_cast<unsigned>(_now - sample.Timestamp));
+                    for (uint8_t c = 0; c < sample.CellCount; ++c) {
+                        append(",%u", sample.MilliVolt[c]);
+                    }
+                    append("]");
+                    _firstSample = false;
+                    return true;
+                }
+                append("]}");
+                _state = State::Done;
+                return true;
+            }
+
+            case State::Done:
+                break;
+        }
+
+        return false;
+    }
+
+    template<typename... Args>
+    void append(char const* format, Args... args)
+    {
+        int len = snprintf(_item + _itemLen, sizeof(_item) - _itemLen, format, args...);
+        if (len > 0) { _itemLen = std::min(_itemLen + len, sizeof(_item) - 1); }
+    }
+
+    enum class State { Header, CellStats, Samples, Done };
+
+    std::shared_ptr<Batteries::CellVoltageHistory const> _spHistory;
+    uint32_t const _now;
+    State _state = State::Header;
+    Batteries::CellVoltageHistory::Summary _summary;
+    uint8_t _cell = 0;
+    Batteries::CellVoltageHistory::Cursor _cursor;
+    bool _firstSample = true;
+
+    // large enough for the summary header or one sample of 32 cells
+    char _item[320];
+    size_t _itemLen = 0;
+    size_t _itemPos = 0;
+};
+
+} // namespace
+
+void WebApiBatteryClass::onCells(AsyncWebServerRequest* request)
+{
+    if (!WebApi.checkCredentialsReadonly(request)) {
+        return;
+    }
+
+    auto spHistory = Battery.getStats()->getCellVoltageHistory();
+    if (!spHistory) {
+        request->send(404, asyncsrv::T_text_plain, "Battery does not provide cell voltages");
+        return;
+    }
+
+    auto spWriter = std::make_shared<CellHistoryWriter>(std::move(spHistory));
+    auto response = request->beginChunkedResponse("application/json",
+        [spWriter](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+            return spWriter->fill(buffer, maxLen);
+        });
+    request->send(response);
+}
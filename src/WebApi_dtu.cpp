@@ -27,14 +27,14 @@ void WebApiDtuClass::init(AsyncWebServer& server, Scheduler& scheduler)
 void WebApiDtuClass::applyDataTaskCb()
 {
     // Execute stuff in main thread to avoid busy SPI bus
-    auto const& config = Configuration.get();
-    Hoymiles.getRadioNrf()->setPALevel((rf24_pa_dbm_e)config.Dtu.Nrf.PaLevel);
-    Hoymiles.getRadioCmt()->setPALevel(config.Dtu.Cmt.PaLevel);
-    Hoymiles.getRadioNrf()->setDtuSerial(config.Dtu.Serial);
-    Hoymiles.getRadioCmt()->setDtuSerial(config.Dtu.Serial);
-    Hoymiles.getRadioCmt()->setCountryMode(static_cast<CountryModeId_t>(config.Dtu.Cmt.CountryMode));
-    Hoymiles.getRadioCmt()->setInverterTargetFrequency(config.Dtu.Cmt.Frequency);
-    Hoymiles.setPollInterval(config.Dtu.PollInterval);
+    auto const config = Configuration.get();
+    Hoymiles.getRadioNrf()->setPALevel((rf24_pa_dbm_e)config->Dtu.Nrf.PaLevel);
+    Hoymiles.getRadioCmt()->setPALevel(config->Dtu.Cmt.PaLevel);
+    Hoymiles.getRadioNrf()->setDtuSerial(config->Dtu.Serial);
+    Hoymiles.getRadioCmt()->setDtuSerial(config->Dtu.Serial);
+    Hoymiles.getRadioCmt()->setCountryMode(static_cast<CountryModeId_t>(config->Dtu.Cmt.CountryMode));
+    Hoymiles.getRadioCmt()->setInverterTargetFrequency(config->Dtu.Cmt.Frequency);
+    Hoymiles.setPollInterval(config->Dtu.PollInterval);
 }
 
 void WebApiDtuClass::onDtuAdminGet(AsyncWebServerRequest* request)
@@ -45,21 +45,21 @@ void WebApiDtuClass::onDtuAdminGet(AsyncWebServerRequest* request)
 
     AsyncJsonResponse* response = new AsyncJsonResponse();
     auto& root = response->getRoot();
-    const CONFIG_T& config = Configuration.get();
+    auto const config = Configuration.get();
 
     // DTU Serial is read as HEX
     char buffer[sizeof(uint64_t) * 8 + 1];
     snprintf(buffer, sizeof(buffer), "%0" PRIx32 "%08" PRIx32,
-        static_cast<uint32_t>((config.Dtu.Serial >> 32) & 0xFFFFFFFF),
-        static_cast<uint32_t>(config.Dtu.Serial & 0xFFFFFFFF));
+        static_cast<uint32_t>((config->Dtu.Serial >> 32) & 0xFFFFFFFF),
+        static_cast<uint32_t>(config->Dtu.Serial & 0xFFFFFFFF));
     root["serial"] = buffer;
-    root["pollinterval"] = config.Dtu.PollInterval;
+    root["pollinterval"] = config->Dtu.PollInterval;
     root["nrf_enabled"] = Hoymiles.getRadioNrf()->isInitialized();
-    root["nrf_palevel"] = config.Dtu.Nrf.PaLevel;
+    root["nrf_palevel"] = config->Dtu.Nrf.PaLevel;
     root["cmt_enabled"] = Hoymiles.getRadioCmt()->isInitialized();
-    root["cmt_palevel"] = config.Dtu.Cmt.PaLevel;
-    root["cmt_frequency"] = config.Dtu.Cmt.Frequency;
-    root["cmt_country"] = config.Dtu.Cmt.CountryMode;
+    root["cmt_palevel"] = config->Dtu.Cmt.PaLevel;
+    root["cmt_frequency"] = config->Dtu.Cmt.Frequency;
+    root["cmt_country"] = config->Dtu.Cmt.CountryMode;
     root["cmt_chan_width"] = Hoymiles.getRadioCmt()->getChannelWidth();
 
     auto data = root["country_def"].to<JsonArray>();
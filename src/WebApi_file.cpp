@@ -43,6 +43,7 @@ void WebApiFileClass::onFileListGet(AsyncWebServerRequest* request)
     File file = rootfs.openNextFile();
     while (file) {
         if (file.isDirectory()) {
+            file = rootfs.openNextFile();
             continue;
         }
         JsonObject obj = data.add<JsonObject>();
@@ -73,6 +74,11 @@ void WebApiFileClass::onFileGet(AsyncWebServerRequest* request)
         }
     }
 
+    // the config is saved in binary form, config.json is refreshed lazily
+    if (requestFile == CONFIG_FILENAME) {
+        Configuration.exportJson();
+    }
+
     request->send(LittleFS, requestFile, String(), true);
 }
 
@@ -146,6 +152,7 @@ void WebApiFileClass::onFileDeleteAll(AsyncWebServerRequest* request)
 
     WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
 
+    Configuration.discardStore();
     Utils::removeAllFiles();
     RestartHelper.triggerRestart();
 }
@@ -163,6 +170,10 @@ void WebApiFileClass::onFileUpload(AsyncWebServerRequest* request, String filena
             return;
         }
         const String name = "/" + request->getParam("file")->value();
+        if (name == CONFIG_FILENAME) {
+            // import the uploaded config at the next boot
+            Configuration.discardStore();
+        }
         request->_tempFile = LittleFS.open(name, "w");
     }
 
@@ -70,8 +70,8 @@ void WebApiGridChargerClass::onLimitPost(AsyncWebServerRequest* request)
         }
 
         // Only call Huawei-specific methods when Huawei provider is active
-        auto const& config = Configuration.get();
-        if (config.GridCharger.Provider == GridChargerProviderType::HUAWEI) {
+        auto const config = Configuration.get();
+        if (config->GridCharger.Provider == GridChargerProviderType::HUAWEI) {
             auto* huaweiProvider = GridCharger.getProvider<GridChargers::Huawei::Provider>();
             if (huaweiProvider) {
                 huaweiProvider->setParameter(value, setting);
@@ -134,8 +134,8 @@ void WebApiGridChargerClass::onPowerPost(AsyncWebServerRequest* request)
     bool power = root["power"].as<bool>();
 
     // Only call Huawei-specific methods when Huawei provider is active
-    auto const& config = Configuration.get();
-    if (config.GridCharger.Provider == GridChargerProviderType::HUAWEI) {
+    auto const config = Configuration.get();
+    if (config->GridCharger.Provider == GridChargerProviderType::HUAWEI) {
         auto* huaweiProvider = GridCharger.getProvider<GridChargers::Huawei::Provider>();
         if (huaweiProvider) {
             huaweiProvider->setProduction(power);
@@ -162,18 +162,18 @@ void WebApiGridChargerClass::onAdminGet(AsyncWebServerRequest* request)
 
     AsyncJsonResponse* response = new AsyncJsonResponse();
     auto root = response->getRoot().as<JsonObject>();
-    auto const& config = Configuration.get();
+    auto const config = Configuration.get();
 
-    ConfigurationClass::serializeGridChargerConfig(config.GridCharger, root);
+    ConfigurationClass::serializeGridChargerConfig(config->GridCharger, root);
 
     auto can = root["can"].to<JsonObject>();
-    ConfigurationClass::serializeGridChargerCanConfig(config.GridCharger.Can, can);
+    ConfigurationClass::serializeGridChargerCanConfig(config->GridCharger.Can, can);
 
     auto huawei = root["huawei"].to<JsonObject>();
-    ConfigurationClass::serializeGridChargerHuaweiConfig(config.GridCharger.Huawei, huawei);
+    ConfigurationClass::serializeGridChargerHuaweiConfig(config->GridCharger.Huawei, huawei);
 
     auto trucki = root["trucki"].to<JsonObject>();
-    ConfigurationClass::serializeGridChargerTruckiConfig(config.GridCharger.Trucki, trucki);
+    ConfigurationClass::serializeGridChargerTruckiConfig(config->GridCharger.Trucki, trucki);
 
     response->setLength();
     request->send(response);
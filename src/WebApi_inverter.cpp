@@ -35,32 +35,32 @@ void WebApiInverterClass::onInverterList(AsyncWebServerRequest* request)
     auto& root = response->getRoot();
     JsonArray data = root["inverter"].to<JsonArray>();
 
-    const CONFIG_T& config = Configuration.get();
+    auto const config = Configuration.get();
 
     for (uint8_t i = 0; i < INV_MAX_COUNT; i++) {
-        if (config.Inverter[i].Serial > 0) {
+        if (config->Inverter[i].Serial > 0) {
             JsonObject obj = data.add<JsonObject>();
             obj["id"] = i;
-            obj["name"] = String(config.Inverter[i].Name);
-            obj["order"] = config.Inverter[i].Order;
+            obj["name"] = String(config->Inverter[i].Name);
+            obj["order"] = config->Inverter[i].Order;
 
             // Inverter Serial is read as HEX
             char buffer[sizeof(uint64_t) * 8 + 1];
             snprintf(buffer, sizeof(buffer), "%0" PRIx32 "%08" PRIx32,
-                static_cast<uint32_t>((config.Inverter[i].Serial >> 32) & 0xFFFFFFFF),
-                static_cast<uint32_t>(config.Inverter[i].Serial & 0xFFFFFFFF));
+                static_cast<uint32_t>((config->Inverter[i].Serial >> 32) & 0xFFFFFFFF),
+                static_cast<uint32_t>(config->Inverter[i].Serial & 0xFFFFFFFF));
             obj["serial"] = buffer;
-            obj["poll_enable"] = config.Inverter[i].Poll_Enable;
-            obj["poll_enable_night"] = config.Inverter[i].Poll_Enable_Night;
-            obj["command_enable"] = config.Inverter[i].Command_Enable;
-            obj["command_enable_night"] = config.Inverter[i].Command_Enable_Night;
-            obj["reachable_threshold"] = config.Inverter[i].ReachableThreshold;
-            obj["zero_runtime"] = config.Inverter[i].ZeroRuntimeDataIfUnrechable;
-            obj["zero_day"] = config.Inverter[i].ZeroYieldDayOnMidnight;
-            obj["clear_eventlog"] = config.Inverter[i].ClearEventlogOnMidnight;
-            obj["yieldday_correction"] = config.Inverter[i].YieldDayCorrection;
-
-            auto inv = Hoymiles.getInverterBySerial(config.Inverter[i].Serial);
+            obj["poll_enable"] = config->Inverter[i].Poll_Enable;
+            obj["poll_enable_night"] = config->Inverter[i].Poll_Enable_Night;
+            obj["command_enable"] = config->Inverter[i].Command_Enable;
+            obj["command_enable_night"] = config->Inverter[i].Command_Enable_Night;
+            obj["reachable_threshold"] = config->Inverter[i].ReachableThreshold;
+            obj["zero_runtime"] = config->Inverter[i].ZeroRuntimeDataIfUnrechable;
+            obj["zero_day"] = config->Inverter[i].ZeroYieldDayOnMidnight;
+            obj["clear_eventlog"] = config->Inverter[i].ClearEventlogOnMidnight;
+            obj["yieldday_correction"] = config->Inverter[i].YieldDayCorrection;
+
+            auto inv = Hoymiles.getInverterBySerial(config->Inverter[i].Serial);
             uint8_t max_channels;
             if (inv == nullptr) {
                 obj["type"] = "Unknown";
@@ -73,9 +73,9 @@ void WebApiInverterClass::onInverterList(AsyncWebServerRequest* request)
             JsonArray channel = obj["channel"].to<JsonArray>();
             for (uint8_t c = 0; c < max_channels; c++) {
                 JsonObject chanData = channel.add<JsonObject>();
-                chanData["name"] = config.Inverter[i].channel[c].Name;
-                chanData["max_power"] = config.Inverter[i].channel[c].MaxChannelPower;
-                chanData["yield_total_offset"] = config.Inverter[i].channel[c].YieldTotalOffset;
+                chanData["name"] = config->Inverter[i].channel[c].Name;
+                chanData["max_power"] = config->Inverter[i].channel[c].MaxChannelPower;
+                chanData["yield_total_offset"] = config->Inverter[i].channel[c].YieldTotalOffset;
             }
         }
     }
@@ -123,25 +123,33 @@ void WebApiInverterClass::onInverterAdd(AsyncWebServerRequest* request)
         return;
     }
 
-    INVERTER_CONFIG_T* inverter = Configuration.getFreeInverterSlot();
-
-    if (!inverter) {
-        retMsg["message"] = "Only " STR_EXTRACT(INV_MAX_COUNT) " inverters are supported!";
-        retMsg["code"] = WebApiError::InverterCount;
-        retMsg["param"]["max"] = INV_MAX_COUNT;
-        WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
-        return;
-    }
+    {
+        auto guard = Configuration.getWriteGuard();
+        INVERTER_CONFIG_T* inverter = ConfigurationClass::getFreeInverterSlot(guard.getConfig());
+
+        if (!inverter) {
+            retMsg["message"] = "Only " STR_EXTRACT(INV_MAX_COUNT) " inverters are supported!";
+            retMsg["code"] = WebApiError::InverterCount;
+            retMsg["param"]["max"] = INV_MAX_COUNT;
+            WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
+            return;
+        }
 
-    // Interpret the string as a hex value and convert it to uint64_t
-    inverter->Serial = serial;
+        // Interpret the string as a hex value and convert it to uint64_t
+        inverter->Serial = serial;
 
-    strncpy(inverter->Name, root["name"].as<String>().c_str(), INV_MAX_NAME_STRLEN);
+        strncpy(inverter->Name, root["name"].as<String>().c_str(), INV_MAX_NAME_STRLEN);
+    }
 
     WebApi.writeConfig(retMsg, WebApiError::InverterAdded, "Inverter created!");
 
     WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
 
+    auto const inverter = Configuration.getInverterConfig(serial);
+    if (inverter == nullptr) {
+        return;
+    }
+
     auto inv = Hoymiles.addInverter(inverter->Name, inverter->Serial);
 
     if (inv != nullptr) {
@@ -247,7 +255,8 @@ void WebApiInverterClass::onInverterEdit(AsyncWebServerRequest* request)
 
     WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
 
-    INVERTER_CONFIG_T const& inverter = Configuration.get().Inverter[root["id"].as<uint8_t>()];
+    auto const spConfig = Configuration.get();
+    INVERTER_CONFIG_T const& inverter = spConfig->Inverter[root["id"].as<uint8_t>()];
     std::shared_ptr<InverterAbstract> inv = Hoymiles.getInverterBySerial(old_serial);
 
     if (inv != nullptr && new_serial != old_serial) {
@@ -310,11 +319,15 @@ void WebApiInverterClass::onInverterDelete(AsyncWebServerRequest* request)
     }
 
     uint8_t inverter_id = root["id"].as<uint8_t>();
-    INVERTER_CONFIG_T const& inverter = Configuration.get().Inverter[inverter_id];
+    auto const spConfig = Configuration.get();
+    INVERTER_CONFIG_T const& inverter = spConfig->Inverter[inverter_id];
 
     Hoymiles.removeInverterBySerial(inverter.Serial);
 
-    Configuration.deleteInverterById(inverter_id);
+    {
+        auto guard = Configuration.getWriteGuard();
+        ConfigurationClass::deleteInverterById(guard.getConfig(), inverter_id);
+    }
 
     WebApi.writeConfig(retMsg, WebApiError::InverterDeleted, "Inverter deleted!");
 
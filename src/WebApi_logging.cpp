@@ -28,12 +28,12 @@ void WebApiLoggingClass::onLoggingAdminGet(AsyncWebServerRequest* request)
 
     AsyncJsonResponse* response = new AsyncJsonResponse();
     auto& root = response->getRoot();
-    const CONFIG_T& config = Configuration.get();
+    auto const config = Configuration.get();
 
     auto& configurableModules = Logging.getConfigurableModules();
 
     JsonObject loglevel = root["loglevel"].to<JsonObject>();
-    loglevel["default"] = config.Logging.Default;
+    loglevel["default"] = config->Logging.Default;
 
     JsonArray logModules = loglevel["modules"].to<JsonArray>();
     for (const auto& availModule : configurableModules) {
@@ -42,7 +42,7 @@ void WebApiLoggingClass::onLoggingAdminGet(AsyncWebServerRequest* request)
 
         int8_t idx = Configuration.getIndexForLogModule(availModule);
         // Set to inherit if unknown
-        logModule["level"] = idx < 0 || idx >= LOG_MODULE_COUNT ? -1 : config.Logging.Modules[idx].Level;
+        logModule["level"] = idx < 0 || idx >= LOG_MODULE_COUNT ? -1 : config->Logging.Modules[idx].Level;
     }
 
     WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
@@ -36,28 +36,28 @@ void WebApiMqttClass::onMqttStatus(AsyncWebServerRequest* request)
 
     AsyncJsonResponse* response = new AsyncJsonResponse();
     auto& root = response->getRoot();
-    const CONFIG_T& config = Configuration.get();
+    auto const config = Configuration.get();
 
-    root["mqtt_enabled"] = config.Mqtt.Enabled;
-    root["mqtt_hostname"] = config.Mqtt.Hostname;
-    root["mqtt_port"] = config.Mqtt.Port;
+    root["mqtt_enabled"] = config->Mqtt.Enabled;
+    root["mqtt_hostname"] = config->Mqtt.Hostname;
+    root["mqtt_port"] = config->Mqtt.Port;
     root["mqtt_clientid"] = MqttSettings.getClientId();
-    root["mqtt_username"] = config.Mqtt.Username;
-    root["mqtt_topic"] = config.Mqtt.Topic;
+    root["mqtt_username"] = config->Mqtt.Username;
+    root["mqtt_topic"] = config->Mqtt.Topic;
     root["mqtt_connected"] = MqttSettings.getConnected();
-    root["mqtt_retain"] = config.Mqtt.Retain;
-    root["mqtt_tls"] = config.Mqtt.Tls.Enabled;
-    root["mqtt_root_ca_cert_info"] = getTlsCertInfo(config.Mqtt.Tls.RootCaCert);
-    root["mqtt_tls_cert_login"] = config.Mqtt.Tls.CertLogin;
-    root["mqtt_client_cert_info"] = getTlsCertInfo(config.Mqtt.Tls.ClientCert);
-    root["mqtt_lwt_topic"] = String(config.Mqtt.Topic) + config.Mqtt.Lwt.Topic;
-    root["mqtt_publish_interval"] = config.Mqtt.PublishInterval;
-    root["mqtt_clean_session"] = config.Mqtt.CleanSession;
-    root["mqtt_hass_enabled"] = config.Mqtt.Hass.Enabled;
-    root["mqtt_hass_expire"] = config.Mqtt.Hass.Expire;
-    root["mqtt_hass_retain"] = config.Mqtt.Hass.Retain;
-    root["mqtt_hass_topic"] = config.Mqtt.Hass.Topic;
-    root["mqtt_hass_individualpanels"] = config.Mqtt.Hass.IndividualPanels;
+    root["mqtt_retain"] = config->Mqtt.Retain;
+    root["mqtt_tls"] = config->Mqtt.Tls.Enabled;
+    root["mqtt_root_ca_cert_info"] = getTlsCertInfo(config->Mqtt.Tls.RootCaCert);
+    root["mqtt_tls_cert_login"] = config->Mqtt.Tls.CertLogin;
+    root["mqtt_client_cert_info"] = getTlsCertInfo(config->Mqtt.Tls.ClientCert);
+    root["mqtt_lwt_topic"] = String(config->Mqtt.Topic) + config->Mqtt.Lwt.Topic;
+    root["mqtt_publish_interval"] = config->Mqtt.PublishInterval;
+    root["mqtt_clean_session"] = config->Mqtt.CleanSession;
+    root["mqtt_hass_enabled"] = config->Mqtt.Hass.Enabled;
+    root["mqtt_hass_expire"] = config->Mqtt.Hass.Expire;
+    root["mqtt_hass_retain"] = config->Mqtt.Hass.Retain;
+    root["mqtt_hass_topic"] = config->Mqtt.Hass.Topic;
+    root["mqtt_hass_individualpanels"] = config->Mqtt.Hass.IndividualPanels;
 
     WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
 }
@@ -70,32 +70,36 @@ void WebApiMqttClass::onMqttAdminGet(AsyncWebServerRequest* request)
 
     AsyncJsonResponse* response = new AsyncJsonResponse();
     auto& root = response->getRoot();
-    const CONFIG_T& config = Configuration.get();
-
-    root["mqtt_enabled"] = config.Mqtt.Enabled;
-    root["mqtt_hostname"] = config.Mqtt.Hostname;
-    root["mqtt_port"] = config.Mqtt.Port;
-    root["mqtt_clientid"] = config.Mqtt.ClientId;
-    root["mqtt_username"] = config.Mqtt.Username;
-    root["mqtt_password"] = config.Mqtt.Password;
-    root["mqtt_topic"] = config.Mqtt.Topic;
-    root["mqtt_retain"] = config.Mqtt.Retain;
-    root["mqtt_tls"] = config.Mqtt.Tls.Enabled;
-    root["mqtt_root_ca_cert"] = config.Mqtt.Tls.RootCaCert;
-    root["mqtt_tls_cert_login"] = config.Mqtt.Tls.CertLogin;
-    root["mqtt_client_cert"] = config.Mqtt.Tls.ClientCert;
-    root["mqtt_client_key"] = config.Mqtt.Tls.ClientKey;
-    root["mqtt_lwt_topic"] = config.Mqtt.Lwt.Topic;
-    root["mqtt_lwt_online"] = config.Mqtt.Lwt.Value_Online;
-    root["mqtt_lwt_offline"] = config.Mqtt.Lwt.Value_Offline;
-    root["mqtt_lwt_qos"] = config.Mqtt.Lwt.Qos;
-    root["mqtt_publish_interval"] = config.Mqtt.PublishInterval;
-    root["mqtt_clean_session"] = config.Mqtt.CleanSession;
-    root["mqtt_hass_enabled"] = config.Mqtt.Hass.Enabled;
-    root["mqtt_hass_expire"] = config.Mqtt.Hass.Expire;
-    root["mqtt_hass_retain"] = config.Mqtt.Hass.Retain;
-    root["mqtt_hass_topic"] = config.Mqtt.Hass.Topic;
-    root["mqtt_hass_individualpanels"] = config.Mqtt.Hass.IndividualPanels;
+    auto const config = Configuration.get();
+
+    root["mqtt_enabled"] = config->Mqtt.Enabled;
+    root["mqtt_hostname"] = config->Mqtt.Hostname;
+    root["mqtt_port"] = config->Mqtt.Port;
+    root["mqtt_clientid"] = config->Mqtt.ClientId;
+    root["mqtt_username"] = config->Mqtt.Username;
+    root["mqtt_password"] = config->Mqtt.Password;
+    root["mqtt_topic"] = config->Mqtt.Topic;
+    root["mqtt_retain"] = config->Mqtt.Retain;
+    root["mqtt_tls"] = config->Mqtt.Tls.Enabled;
+    root["mqtt_root_ca_cert"] = config->Mqtt.Tls.RootCaCert;
+    root["mqtt_tls_cert_login"] = config->Mqtt.Tls.CertLogin;
+    root["mqtt_client_cert"] = config->Mqtt.Tls.ClientCert;
+    root["mqtt_client_key"] = config->Mqtt.Tls.ClientKey;
+    root["mqtt_lwt_topic"] = config->Mqtt.Lwt.Topic;
+    root["mqtt_lwt_online"] = config->Mqtt.Lwt.Value_Online;
+    root["mqtt_lwt_offline"] = config->Mqtt.Lwt.Value_Offline;
+    root["mqtt_lwt_qos"] = config->Mqtt.Lwt.Qos;
+    root["mqtt_publish_interval"] = config->Mqtt.PublishInterval;
+    root["mqtt_command_interval"] = config->Mqtt.CommandInterval;
+    root["mqtt_config_save_delay"] = config->Mqtt.ConfigSaveDelay;
+    root["mqtt_clean_session"] = config->Mqtt.CleanSession;
+    root["mqtt_publish_mode"] = config->Mqtt.PublishMode;
+    root["mqtt_batch_encoding"] = config->Mqtt.BatchEncoding;
+    root["mqtt_hass_enabled"] = config->Mqtt.Hass.Enabled;
+    root["mqtt_hass_expire"] = config->Mqtt.Hass.Expire;
+    root["mqtt_hass_retain"] = config->Mqtt.Hass.Retain;
+    root["mqtt_hass_topic"] = config->Mqtt.Hass.Topic;
+    root["mqtt_hass_individualpanels"] = config->Mqtt.Hass.IndividualPanels;
 
     WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
 }
@@ -131,7 +135,11 @@ void WebApiMqttClass::onMqttAdminPost(AsyncWebServerRequest* request)
             && root["mqtt_lwt_offline"].is<String>()
             && root["mqtt_lwt_qos"].is<uint8_t>()
             && root["mqtt_publish_interval"].is<uint32_t>()
+            && root["mqtt_command_interval"].is<uint32_t>()
+            && root["mqtt_config_save_delay"].is<uint32_t>()
             && root["mqtt_clean_session"].is<bool>()
+            && root["mqtt_publish_mode"].is<uint8_t>()
+            && root["mqtt_batch_encoding"].is<uint8_t>()
             && root["mqtt_hass_enabled"].is<bool>()
             && root["mqtt_hass_expire"].is<bool>()
             && root["mqtt_hass_retain"].is<bool>()
@@ -251,6 +259,29 @@ void WebApiMqttClass::onMqttAdminPost(AsyncWebServerRequest* request)
             return;
         }
 
+        if (root["mqtt_publish_mode"].as<uint8_t>() > MqttPublishModeType::PublishTopicsAndJson) {
+            retMsg["message"] = "Invalid publish mode!";
+            retMsg["code"] = WebApiError::MqttPublishMode;
+            WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
+            return;
+        }
+
+        if (root["mqtt_batch_encoding"].as<uint8_t>() > MqttBatchEncodingType::BatchMessagePack) {
+            retMsg["message"] = "Invalid payload encoding!";
+            retMsg["code"] = WebApiError::MqttBatchEncoding;
+            WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
+            return;
+        }
+
+        if (root["mqtt_hass_enabled"].as<bool>()
+                && root["mqtt_publish_mode"].as<uint8_t>() == MqttPublishModeType::PublishJson
+                && root["mqtt_batch_encoding"].as<uint8_t>() == MqttBatchEncodingType::BatchMessagePack) {
+            retMsg["message"] = "Home Assistant cannot decode MessagePack documents, values must be published as topics as well!";
+            retMsg["code"] = WebApiError::MqttBatchEncodingHass;
+            WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
+            return;
+        }
+
         if (root["mqtt_publish_interval"].as<uint32_t>() < 1 || root["mqtt_publish_interval"].as<uint32_t>() > 86400) {
             retMsg["message"] = "Publish interval must be a number between 1 and 86400!";
             retMsg["code"] = WebApiError::MqttPublishInterval;
@@ -260,6 +291,24 @@ void WebApiMqttClass::onMqttAdminPost(AsyncWebServerRequest* request)
             return;
         }
 
+        if (root["mqtt_command_interval"].as<uint32_t>() > 60000) {
+            retMsg["message"] = "Command interval must be a number between 0 and 60000!";
+            retMsg["code"] = WebApiError::MqttCommandInterval;
+            retMsg["param"]["min"] = 0;
+            retMsg["param"]["max"] = 60000;
+            WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
+            return;
+        }
+
+        if (root["mqtt_config_save_delay"].as<uint32_t>() > 3600) {
+            retMsg["message"] = "Config save delay must be a number between 0 and 3600!";
+            retMsg["code"] = WebApiError::MqttConfigSaveDelay;
+            retMsg["param"]["min"] = 0;
+            retMsg["param"]["max"] = 3600;
+            WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
+            return;
+        }
+
         if (root["mqtt_hass_enabled"].as<bool>()) {
             if (root["mqtt_hass_topic"].as<String>().length() > MQTT_MAX_TOPIC_STRLEN) {
                 retMsg["message"] = "Hass topic must not be longer than " STR_EXTRACT(MQTT_MAX_TOPIC_STRLEN) " characters!";
@@ -285,6 +334,7 @@ void WebApiMqttClass::onMqttAdminPost(AsyncWebServerRequest* request)
         }
     }
 
+    bool topicChanged = false;
     {
         auto guard = Configuration.getWriteGuard();
         auto& config = guard.getConfig();
@@ -306,7 +356,11 @@ void WebApiMqttClass::onMqttAdminPost(AsyncWebServerRequest* request)
         strlcpy(config.Mqtt.Lwt.Value_Offline, root["mqtt_lwt_offline"].as<String>().c_str(), sizeof(config.Mqtt.Lwt.Value_Offline));
         config.Mqtt.Lwt.Qos = root["mqtt_lwt_qos"].as<uint8_t>();
         config.Mqtt.PublishInterval = root["mqtt_publish_interval"].as<uint32_t>();
+        config.Mqtt.CommandInterval = root["mqtt_command_interval"].as<uint32_t>();
+        config.Mqtt.ConfigSaveDelay = root["mqtt_config_save_delay"].as<uint32_t>();
         config.Mqtt.CleanSession = root["mqtt_clean_session"].as<bool>();
+        config.Mqtt.PublishMode = static_cast<decltype(config.Mqtt.PublishMode)>(root["mqtt_publish_mode"].as<uint8_t>());
+        config.Mqtt.BatchEncoding = static_cast<decltype(config.Mqtt.BatchEncoding)>(root["mqtt_batch_encoding"].as<uint8_t>());
         config.Mqtt.Hass.Enabled = root["mqtt_hass_enabled"].as<bool>();
         config.Mqtt.Hass.Expire = root["mqtt_hass_expire"].as<bool>();
         config.Mqtt.Hass.Retain = root["mqtt_hass_retain"].as<bool>();
@@ -319,12 +373,16 @@ void WebApiMqttClass::onMqttAdminPost(AsyncWebServerRequest* request)
             MqttHandlePowerLimiter.unsubscribeTopics();
 
             strlcpy(config.Mqtt.Topic, root["mqtt_topic"].as<String>().c_str(), sizeof(config.Mqtt.Topic));
-
-            MqttHandleInverter.subscribeTopics();
-            MqttHandlePowerLimiter.subscribeTopics();
+            topicChanged = true;
         }
     }
 
+    // the new base topic is in effect once the write guard was released
+    if (topicChanged) {
+        MqttHandleInverter.subscribeTopics();
+        MqttHandlePowerLimiter.subscribeTopics();
+    }
+
     WebApi.writeConfig(retMsg);
 
     WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
@@ -64,22 +64,22 @@ void WebApiNetworkClass::onNetworkAdminGet(AsyncWebServerRequest* request)
 
     AsyncJsonResponse* response = new AsyncJsonResponse();
     auto& root = response->getRoot();
-    const CONFIG_T& config = Configuration.get();
-
-    root["hostname"] = config.WiFi.Hostname;
-    root["dhcp"] = config.WiFi.Dhcp;
-    root["ipaddress"] = IPAddress(config.WiFi.Ip).toString();
-    root["netmask"] = IPAddress(config.WiFi.Netmask).toString();
-    root["gateway"] = IPAddress(config.WiFi.Gateway).toString();
-    root["dns1"] = IPAddress(config.WiFi.Dns1).toString();
-    root["dns2"] = IPAddress(config.WiFi.Dns2).toString();
-    root["ssid"] = config.WiFi.Ssid;
-    root["password"] = config.WiFi.Password;
-    root["aptimeout"] = config.WiFi.ApTimeout;
-    root["mdnsenabled"] = config.Mdns.Enabled;
-    root["syslogenabled"] = config.Syslog.Enabled;
-    root["sysloghostname"] = config.Syslog.Hostname;
-    root["syslogport"] = config.Syslog.Port;
+    auto const config = Configuration.get();
+
+    root["hostname"] = config->WiFi.Hostname;
+    root["dhcp"] = config->WiFi.Dhcp;
+    root["ipaddress"] = IPAddress(config->WiFi.Ip).toString();
+    root["netmask"] = IPAddress(config->WiFi.Netmask).toString();
+    root["gateway"] = IPAddress(config->WiFi.Gateway).toString();
+    root["dns1"] = IPAddress(config->WiFi.Dns1).toString();
+    root["dns2"] = IPAddress(config->WiFi.Dns2).toString();
+    root["ssid"] = config->WiFi.Ssid;
+    root["password"] = config->WiFi.Password;
+    root["aptimeout"] = config->WiFi.ApTimeout;
+    root["mdnsenabled"] = config->Mdns.Enabled;
+    root["syslogenabled"] = config->Syslog.Enabled;
+    root["sysloghostname"] = config->Syslog.Hostname;
+    root["syslogport"] = config->Syslog.Port;
 
     WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
 }
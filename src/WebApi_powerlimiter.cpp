@@ -33,8 +33,8 @@ void WebApiPowerLimiterClass::onStatus(AsyncWebServerRequest* request)
 
     AsyncJsonResponse* response = new AsyncJsonResponse();
     auto root = response->getRoot().as<JsonObject>();
-    auto const& config = Configuration.get();
-    ConfigurationClass::serializePowerLimiterConfig(config.PowerLimiter, root);
+    auto const config = Configuration.get();
+    ConfigurationClass::serializePowerLimiterConfig(config->PowerLimiter, root);
     WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
 }
 
@@ -42,29 +42,29 @@ void WebApiPowerLimiterClass::onMetaData(AsyncWebServerRequest* request)
 {
     if (!WebApi.checkCredentials(request)) { return; }
 
-    auto const& config = Configuration.get();
+    auto const config = Configuration.get();
 
     AsyncJsonResponse* response = new AsyncJsonResponse();
     auto& root = response->getRoot();
 
-    root["power_meter_enabled"] = config.PowerMeter.Enabled;
-    root["battery_enabled"] = config.Battery.Enabled;
-    root["charge_controller_enabled"] = config.SolarCharger.Enabled;
+    root["power_meter_enabled"] = config->PowerMeter.Enabled;
+    root["battery_enabled"] = config->Battery.Enabled;
+    root["charge_controller_enabled"] = config->SolarCharger.Enabled;
 
     JsonArray inverters = root["inverters"].to<JsonArray>();
     for (uint8_t i = 0; i < INV_MAX_COUNT; i++) {
-        auto inv = Hoymiles.getInverterBySerial(config.Inverter[i].Serial);
+        auto inv = Hoymiles.getInverterBySerial(config->Inverter[i].Serial);
         if (!inv) { continue; }
 
         JsonObject obj = inverters.add<JsonObject>();
         obj["serial"] = inv->serialString();
         obj["pos"] = i;
-        obj["order"] = config.Inverter[i].Order;
-        obj["name"] = String(config.Inverter[i].Name);
-        obj["poll_enable"] = config.Inverter[i].Poll_Enable;
-        obj["poll_enable_night"] = config.Inverter[i].Poll_Enable_Night;
-        obj["command_enable"] = config.Inverter[i].Command_Enable;
-        obj["command_enable_night"] = config.Inverter[i].Command_Enable_Night;
+        obj["order"] = config->Inverter[i].Order;
+        obj["name"] = String(config->Inverter[i].Name);
+        obj["poll_enable"] = config->Inverter[i].Poll_Enable;
+        obj["poll_enable_night"] = config->Inverter[i].Poll_Enable_Night;
+        obj["command_enable"] = config->Inverter[i].Command_Enable;
+        obj["command_enable_night"] = config->Inverter[i].Command_Enable_Night;
         obj["max_power"] = inv->DevInfo()->getMaxPower(); // okay if zero/unknown
         obj["type"] = inv->typeName();
         auto channels = inv->Statistics()->getChannelsByType(TYPE_DC);
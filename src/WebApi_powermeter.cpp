@@ -36,25 +36,25 @@ void WebApiPowerMeterClass::onStatus(AsyncWebServerRequest* request)
 
     AsyncJsonResponse* response = new AsyncJsonResponse();
     auto& root = response->getRoot();
-    auto const& config = Configuration.get();
+    auto const config = Configuration.get();
 
-    root["enabled"] = config.PowerMeter.Enabled;
-    root["source"] = config.PowerMeter.Source;
+    root["enabled"] = config->PowerMeter.Enabled;
+    root["source"] = config->PowerMeter.Source;
 
     auto mqtt = root["mqtt"].to<JsonObject>();
-    Configuration.serializePowerMeterMqttConfig(config.PowerMeter.Mqtt, mqtt);
+    Configuration.serializePowerMeterMqttConfig(config->PowerMeter.Mqtt, mqtt);
 
     auto serialSdm = root["serial_sdm"].to<JsonObject>();
-    Configuration.serializePowerMeterSerialSdmConfig(config.PowerMeter.SerialSdm, serialSdm);
+    Configuration.serializePowerMeterSerialSdmConfig(config->PowerMeter.SerialSdm, serialSdm);
 
     auto httpJson = root["http_json"].to<JsonObject>();
-    Configuration.serializePowerMeterHttpJsonConfig(config.PowerMeter.HttpJson, httpJson);
+    Configuration.serializePowerMeterHttpJsonConfig(config->PowerMeter.HttpJson, httpJson);
 
     auto httpSml = root["http_sml"].to<JsonObject>();
-    Configuration.serializePowerMeterHttpSmlConfig(config.PowerMeter.HttpSml, httpSml);
+    Configuration.serializePowerMeterHttpSmlConfig(config->PowerMeter.HttpSml, httpSml);
 
     auto udpVictron = root["udp_victron"].to<JsonObject>();
-    Configuration.serializePowerMeterUdpVictronConfig(config.PowerMeter.UdpVictron, udpVictron);
+    Configuration.serializePowerMeterUdpVictronConfig(config->PowerMeter.UdpVictron, udpVictron);
 
     WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
 }
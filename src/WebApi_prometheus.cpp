@@ -1,4 +1,3 @@
-
 // SPDX-License-Identifier: GPL-2.0-or-later
 /*
  * Copyright (C) 2022-2026 Thomas Basler and others
@@ -6,9 +5,17 @@
 #include "WebApi_prometheus.h"
 #include "Configuration.h"
 #include "NetworkSettings.h"
+#include "PowerLimiter.h"
 #include "WebApi.h"
 #include "__compiled_constants.h"
 #include <Hoymiles.h>
+#include <battery/Controller.h>
+#include <gridcharger/Controller.h>
+#include <powermeter/Controller.h>
+#include <solarcharger/Controller.h>
+#include <algorithm>
+#include <cstdarg>
+#include <cstring>
 
 #undef TAG
 static const char* TAG = "webapi";
@@ -22,168 +29,630 @@ void WebApiPrometheusClass::init(AsyncWebServer& server, Scheduler& scheduler)
 
 void WebApiPrometheusClass::onPrometheusMetricsGet(AsyncWebServerRequest* request)
 {
-    static size_t initialResponseBufferSize = 1024;
-
     if (!WebApi.checkCredentialsReadonly(request)) {
         return;
     }
 
     try {
-        auto stream = request->beginResponseStream("text/plain; charset=utf-8", initialResponseBufferSize);
+        auto writer = std::make_shared<MetricsWriter>(getLayout());
 
-        stream->print("# HELP opendtu_build Build info\n");
-        stream->print("# TYPE opendtu_build gauge\n");
-        stream->printf("opendtu_build{name=\"%s\",id=\"%s\",version=\"%d.%d.%d\"} 1\n",
-            NetworkSettings.getHostname().c_str(), __COMPILED_GIT_HASH__, CONFIG_VERSION >> 24 & 0xff, CONFIG_VERSION >> 16 & 0xff, CONFIG_VERSION >> 8 & 0xff);
+        auto response = request->beginChunkedResponse("text/plain; charset=utf-8",
+            [writer](uint8_t* buffer, size_t maxLen, size_t /* index */) -> size_t {
+                return writer->fill(buffer, maxLen);
+            });
 
-        stream->print("# HELP opendtu_platform Platform info\n");
-        stream->print("# TYPE opendtu_platform gauge\n");
-        stream->printf("opendtu_platform{arch=\"%s\",mac=\"%s\"} 1\n", ESP.getChipModel(), NetworkSettings.macAddress().c_str());
+        response->addHeader(asyncsrv::T_Cache_Control, asyncsrv::T_no_cache);
+        request->send(response);
 
-        stream->print("# HELP opendtu_uptime Uptime in seconds\n");
-        stream->print("# TYPE opendtu_uptime counter\n");
-        stream->printf("opendtu_uptime %lld\n", esp_timer_get_time() / 1000000);
+    } catch (std::bad_alloc& bad_alloc) {
+        ESP_LOGE(TAG, "Call to /api/prometheus/metrics temporarely out of resources. Reason: \"%s\".", bad_alloc.what());
 
-        stream->print("# HELP opendtu_heap_size System memory size\n");
-        stream->print("# TYPE opendtu_heap_size gauge\n");
-        stream->printf("opendtu_heap_size %" PRIu32 "\n", ESP.getHeapSize());
+        WebApi.sendTooManyRequests(request);
+    }
+}
 
-        stream->print("# HELP opendtu_free_heap_size System free memory\n");
-        stream->print("# TYPE opendtu_free_heap_size gauge\n");
-        stream->printf("opendtu_free_heap_size %" PRIu32 "\n", ESP.getFreeHeap());
+static String escapeLabelValue(const char* value)
+{
+    String result;
+    for (const char* p = value; *p != '\0'; ++p) {
+        switch (*p) {
+        case '\\':
+            result += "\\\\";
+            break;
+        case '"':
+            result += "\\\"";
+            break;
+        case '\n':
+            result += "\\n";
+            break;
+        default:
+            result += *p;
+            break;
+        }
+    }
+    return result;
+}
 
-        stream->print("# HELP opendtu_biggest_heap_block Biggest free heap block\n");
-        stream->print("# TYPE opendtu_biggest_heap_block gauge\n");
-        stream->printf("opendtu_biggest_heap_block %" PRIu32 "\n", ESP.getMaxAllocHeap());
+uint32_t WebApiPrometheusClass::getLayoutKey()
+{
+    auto const config = Configuration.get();
+    uint32_t key = ConfigStore::crc32(config->Inverter, sizeof(config->Inverter));
 
-        stream->print("# HELP opendtu_heap_min_free Minimum free memory since boot\n");
-        stream->print("# TYPE opendtu_heap_min_free gauge\n");
-        stream->printf("opendtu_heap_min_free %" PRIu32 "\n", ESP.getMinFreeHeap());
+    for (uint8_t i = 0; i < Hoymiles.getNumInverters(); i++) {
+        auto inv = Hoymiles.getInverterByPos(i);
+        uint64_t serial = (inv != nullptr) ? inv->serial() : 0;
+        key = ConfigStore::crc32(&serial, sizeof(serial), key);
+    }
 
-        stream->print("# HELP wifi_rssi WiFi RSSI\n");
-        stream->print("# TYPE wifi_rssi gauge\n");
-        stream->printf("wifi_rssi %" PRId8 "\n", WiFi.RSSI());
+    return key;
+}
 
-        stream->print("# HELP wifi_station WiFi Station info\n");
-        stream->print("# TYPE wifi_station gauge\n");
-        stream->printf("wifi_station{bssid=\"%s\"} 1\n", WiFi.BSSIDstr().c_str());
+std::shared_ptr<WebApiPrometheusClass::Layout const> WebApiPrometheusClass::getLayout()
+{
+    std::lock_guard<std::mutex> lock(_layoutMutex);
 
-        for (uint8_t i = 0; i < Hoymiles.getNumInverters(); i++) {
-            auto inv = Hoymiles.getInverterByPos(i);
+    uint32_t key = getLayoutKey();
+    if (!_layout || _layout->Key != key) {
+        _layout = buildLayout(key);
+        ESP_LOGD(TAG, "Built Prometheus layout of %u metric families", static_cast<unsigned>(_layout->Families.size()));
+    }
 
-            String serial = inv->serialString();
-            const char* name = inv->name();
-            if (i == 0) {
-                stream->print("# HELP opendtu_last_update last update from inverter in s\n");
-                stream->print("# TYPE opendtu_last_update gauge\n");
-            }
-            stream->printf("opendtu_last_update{serial=\"%s\",unit=\"%" PRIu8 "\",name=\"%s\"} %" PRIu32 "\n",
-                serial.c_str(), i, name, inv->Statistics()->getLastUpdate() / 1000);
+    return _layout;
+}
 
-            if (i == 0) {
-                stream->print("# HELP opendtu_inverter_limit_relative current relative limit of the inverter\n");
-                stream->print("# TYPE opendtu_inverter_limit_relative gauge\n");
-            }
-            stream->printf("opendtu_inverter_limit_relative{serial=\"%s\",unit=\"%" PRIu8 "\",name=\"%s\"} %f\n",
-                serial.c_str(), i, name, inv->SystemConfigPara()->getLimitPercent() / 100.0);
+std::shared_ptr<WebApiPrometheusClass::Layout const> WebApiPrometheusClass::buildLayout(uint32_t key)
+{
+    auto layout = std::make_shared<Layout>();
+    layout->Key = key;
+
+    auto addLabels = [&layout](String&& labels) {
+        layout->Labels.push_back(std::move(labels));
+        return static_cast<uint16_t>(layout->Labels.size() - 1);
+    };
+
+    std::vector<Family> families = {
+        { "last_update", "last update from inverter in s", GAUGE, InverterMetric::LastUpdate, {} },
+        { "inverter_limit_relative", "current relative limit of the inverter", GAUGE, InverterMetric::LimitRelative, {} },
+        { "inverter_limit_absolute", "current absolute limit of the inverter", GAUGE, InverterMetric::LimitAbsolute, {} },
+        { "PanelInfo", "panel information", GAUGE, InverterMetric::PanelInfo, {} },
+        { "MaxPower", "panel maximum output power", GAUGE, InverterMetric::MaxPower, {} },
+        { "YieldTotalOffset", "panel yield offset (for used inverters)", GAUGE, InverterMetric::YieldTotalOffset, {} },
+    };
+    size_t const fieldFamiliesBegin = families.size();
+
+    for (uint8_t i = 0; i < Hoymiles.getNumInverters(); i++) {
+        auto inv = Hoymiles.getInverterByPos(i);
+        layout->Inverters.push_back((inv != nullptr) ? inv->serial() : 0);
+        if (inv == nullptr) {
+            continue;
+        }
+
+        auto const inv_cfg = Configuration.getInverterConfig(inv->serial());
+
+        String inverterLabels = String("serial=\"") + inv->serialString() + "\",unit=\"" + String(i) + "\",name=\"" + escapeLabelValue(inv->name()) + "\"";
+        uint16_t inverterIdx = addLabels(String(inverterLabels));
+
+        families[0].Samples.push_back({ i, TYPE_INV, CH0, FLD_PAC, inverterIdx });
+        families[1].Samples.push_back({ i, TYPE_INV, CH0, FLD_PAC, inverterIdx });
+        families[2].Samples.push_back({ i, TYPE_INV, CH0, FLD_PAC, inverterIdx });
+
+        for (auto& t : inv->Statistics()->getChannelTypes()) {
+            for (auto& c : inv->Statistics()->getChannelsByType(t)) {
+                String channel = String(",channel=\"") + String(c) + "\"";
 
-            if (inv->DevInfo()->getMaxPower() > 0) {
-                if (i == 0) {
-                    stream->print("# HELP opendtu_inverter_limit_absolute current relative limit of the inverter\n");
-                    stream->print("# TYPE opendtu_inverter_limit_absolute gauge\n");
+                if (t == TYPE_DC && inv_cfg != nullptr) {
+                    uint16_t panelIdx = addLabels(inverterLabels + channel + ",panelname=\"" + escapeLabelValue(inv_cfg->channel[c].Name) + "\"");
+                    uint16_t channelIdx = addLabels(inverterLabels + channel);
+                    families[3].Samples.push_back({ i, t, c, FLD_PAC, panelIdx });
+                    families[4].Samples.push_back({ i, t, c, FLD_PAC, channelIdx });
+                    families[5].Samples.push_back({ i, t, c, FLD_PAC, channelIdx });
                 }
-                stream->printf("opendtu_inverter_limit_absolute{serial=\"%s\",unit=\"%" PRIu8 "\",name=\"%s\"} %f\n",
-                    serial.c_str(), i, name, inv->SystemConfigPara()->getLimitPercent() * inv->DevInfo()->getMaxPower() / 100.0);
-            }
 
-            // Loop all channels if Statistics have been updated at least once since DTU boot
-            if (inv->Statistics()->getLastUpdate() > 0) {
-                for (auto& t : inv->Statistics()->getChannelTypes()) {
-                    for (auto& c : inv->Statistics()->getChannelsByType(t)) {
-                        addPanelInfo(stream, serial, i, inv, t, c);
-                        for (uint8_t f = 0; f < sizeof(_publishFields) / sizeof(_publishFields[0]); f++) {
-                            if (t == TYPE_INV && _publishFields[f].field == FLD_PDC) {
-                                addField(stream, serial, i, inv, t, c, _publishFields[f].field, _metricTypes[_publishFields[f].type], "PowerDC");
-                            } else {
-                                addField(stream, serial, i, inv, t, c, _publishFields[f].field, _metricTypes[_publishFields[f].type]);
-                            }
-                        }
+                uint16_t fieldIdx = addLabels(inverterLabels + ",type=\"" + inv->Statistics()->getChannelTypeName(t) + "\"" + channel);
+
+                for (auto const& publish : _publishFields) {
+                    if (!inv->Statistics()->hasChannelFieldValue(t, c, publish.field)) {
+                        continue;
+                    }
+
+                    const char* name = (t == TYPE_INV && publish.field == FLD_PDC) ? "PowerDC" : inv->Statistics()->getChannelFieldName(t, c, publish.field);
+
+                    // samples of all inverters and channel types sharing a
+                    // name form one family
+                    auto family = std::find_if(families.begin() + fieldFamiliesBegin, families.end(),
+                        [name](Family const& f) { return f.Name == name; });
+                    if (family == families.end()) {
+                        String help = String("in ") + inv->Statistics()->getChannelFieldUnit(t, c, publish.field);
+                        families.push_back({ name, help, publish.type, InverterMetric::Field, {} });
+                        family = families.end() - 1;
                     }
+
+                    family->Samples.push_back({ i, t, c, publish.field, fieldIdx });
                 }
             }
         }
-        stream->addHeader(asyncsrv::T_Cache_Control, asyncsrv::T_no_cache);
-        if (stream->available() > initialResponseBufferSize) {
-            initialResponseBufferSize = stream->available();
-            ESP_LOGI(TAG, "Increased /api/prometheus/metrics initialResponseBufferSize to %" PRIu32 " bytes", initialResponseBufferSize);
+    }
+
+    layout->Families = std::move(families);
+    return layout;
+}
+
+const WebApiPrometheusClass::ScalarMetric WebApiPrometheusClass::_scalarMetrics[] = {
+    { "battery_soc", "battery state of charge in %", GAUGE, 1, []() -> std::optional<float> {
+        auto spStats = Battery.getStats();
+        if (!Configuration.get()->Battery.Enabled || !spStats->isSoCValid()) { return std::nullopt; }
+        return spStats->getSoC();
+    } },
+    { "battery_voltage", "battery voltage in V", GAUGE, 3, []() -> std::optional<float> {
+        auto spStats = Battery.getStats();
+        if (!Configuration.get()->Battery.Enabled || !spStats->isVoltageValid()) { return std::nullopt; }
+        return spStats->getVoltage();
+    } },
+    { "battery_current", "battery charge current in A", GAUGE, 3, []() -> std::optional<float> {
+        auto spStats = Battery.getStats();
+        if (!Configuration.get()->Battery.Enabled || !spStats->isCurrentValid()) { return std::nullopt; }
+        return spStats->getChargeCurrent();
+    } },
+    { "battery_power", "battery charge power in W", GAUGE, 1, []() -> std::optional<float> {
+        auto spStats = Battery.getStats();
+        if (!Configuration.get()->Battery.Enabled || !spStats->isVoltageValid() || !spStats->isCurrentValid()) { return std::nullopt; }
+        return spStats->getVoltage() * spStats->getChargeCurrent();
+    } },
+    { "battery_charge_current_limit", "battery charge current limit in A", GAUGE, 1, []() -> std::optional<float> {
+        auto spStats = Battery.getStats();
+        if (!Configuration.get()->Battery.Enabled || !spStats->isChargeCurrentLimitValid()) { return std::nullopt; }
+        return spStats->getChargeCurrentLimit();
+    } },
+    { "battery_discharge_current_limit", "battery discharge current limit in A", GAUGE, 1, []() -> std::optional<float> {
+        auto spStats = Battery.getStats();
+        if (!Configuration.get()->Battery.Enabled || !spStats->isDischargeCurrentLimitValid()) { return std::nullopt; }
+        return spStats->getDischargeCurrentLimit();
+    } },
+    { "battery_data_age", "age of the battery data in s", GAUGE, 0, []() -> std::optional<float> {
+        if (!Configuration.get()->Battery.Enabled) { return std::nullopt; }
+        return Battery.getStats()->getAgeSeconds();
+    } },
+    { "powermeter_power", "total power at the power meter in W", GAUGE, 1, []() -> std::optional<float> {
+        if (!Configuration.get()->PowerMeter.Enabled) { return std::nullopt; }
+        return PowerMeter.getPowerTotal();
+    } },
+    { "powermeter_data_age", "age of the power meter reading in s", GAUGE, 0, []() -> std::optional<float> {
+        auto lastUpdate = PowerMeter.getLastUpdate();
+        if (!Configuration.get()->PowerMeter.Enabled || lastUpdate == 0) { return std::nullopt; }
+        return (millis() - lastUpdate) / 1000;
+    } },
+    { "solarcharger_output_power", "solar charger output power in W", GAUGE, 1, []() -> std::optional<float> {
+        if (!Configuration.get()->SolarCharger.Enabled) { return std::nullopt; }
+        return SolarCharger.getStats()->getOutputPowerWatts();
+    } },
+    { "solarcharger_output_voltage", "solar charger output voltage in V", GAUGE, 2, []() -> std::optional<float> {
+        if (!Configuration.get()->SolarCharger.Enabled) { return std::nullopt; }
+        return SolarCharger.getStats()->getOutputVoltage();
+    } },
+    { "solarcharger_panel_power", "solar charger panel power in W", GAUGE, 0, []() -> std::optional<float> {
+        if (!Configuration.get()->SolarCharger.Enabled) { return std::nullopt; }
+        auto power = SolarCharger.getStats()->getPanelPowerWatts();
+        if (!power) { return std::nullopt; }
+        return *power;
+    } },
+    { "solarcharger_yield_day", "solar charger yield of the day in Wh", COUNTER, 0, []() -> std::optional<float> {
+        if (!Configuration.get()->SolarCharger.Enabled) { return std::nullopt; }
+        return SolarCharger.getStats()->getYieldDay();
+    } },
+    { "solarcharger_yield_total", "solar charger total yield in kWh", COUNTER, 2, []() -> std::optional<float> {
+        if (!Configuration.get()->SolarCharger.Enabled) { return std::nullopt; }
+        return SolarCharger.getStats()->getYieldTotal();
+    } },
+    { "gridcharger_input_power", "grid charger input power in W", GAUGE, 1, []() -> std::optional<float> {
+        if (!Configuration.get()->GridCharger.Enabled) { return std::nullopt; }
+        return GridCharger.getStats()->getInputPower();
+    } },
+    { "gridcharger_data_age", "age of the grid charger data in s", GAUGE, 0, []() -> std::optional<float> {
+        auto lastUpdate = GridCharger.getStats()->getLastUpdate();
+        if (!Configuration.get()->GridCharger.Enabled || lastUpdate == 0) { return std::nullopt; }
+        return (millis() - lastUpdate) / 1000;
+    } },
+    { "powerlimiter_mode", "dynamic power limiter mode (0: normal, 1: disabled, 2: full solar passthrough)", GAUGE, 0, []() -> std::optional<float> {
+        if (!Configuration.get()->PowerLimiter.Enabled) { return std::nullopt; }
+        return static_cast<unsigned>(PowerLimiter.getMode());
+    } },
+    { "powerlimiter_inverter_output", "expected output of the governed inverters in W", GAUGE, 0, []() -> std::optional<float> {
+        if (!Configuration.get()->PowerLimiter.Enabled) { return std::nullopt; }
+        return PowerLimiter.getInverterOutput();
+    } },
+    { "powerlimiter_full_solar_passthrough", "full solar passthrough active", GAUGE, 0, []() -> std::optional<float> {
+        if (!Configuration.get()->PowerLimiter.Enabled) { return std::nullopt; }
+        return PowerLimiter.isFullSolarPassthroughActive() ? 1 : 0;
+    } },
+};
+
+const size_t WebApiPrometheusClass::_scalarMetricCount = sizeof(_scalarMetrics) / sizeof(_scalarMetrics[0]);
+
+WebApiPrometheusClass::MetricsWriter::MetricsWriter(std::shared_ptr<Layout const> layout)
+    : _layout(std::move(layout))
+    , _entries(MetricsRegistry.getEntries())
+{
+}
+
+size_t WebApiPrometheusClass::MetricsWriter::fill(uint8_t* buffer, size_t maxLen)
+{
+    size_t written = 0;
+
+    while (written < maxLen) {
+        if (_linePos == _lineLen) {
+            _linePos = _lineLen = 0;
+            if (!nextLine()) {
+                break;
+            }
         }
-        request->send(stream);
 
-    } catch (std::bad_alloc& bad_alloc) {
-        ESP_LOGE(TAG, "Call to /api/prometheus/metrics temporarely out of resources. Reason: \"%s\".", bad_alloc.what());
+        size_t count = std::min(maxLen - written, _lineLen - _linePos);
+        memcpy(buffer + written, _line + _linePos, count);
+        written += count;
+        _linePos += count;
+    }
 
-        WebApi.sendTooManyRequests(request);
+    return written;
+}
+
+bool WebApiPrometheusClass::MetricsWriter::nextLine()
+{
+    while (_section != Section::Done) {
+        bool produced = false;
+        switch (_section) {
+        case Section::Info:
+            produced = nextInfoLine();
+            break;
+        case Section::Scalar:
+            produced = nextScalarLine();
+            break;
+        case Section::Registry:
+            produced = nextRegistryLine();
+            break;
+        case Section::Inverter:
+            produced = nextInverterLine();
+            break;
+        case Section::Done:
+            break;
+        }
+
+        if (produced) {
+            return true;
+        }
+
+        _section = static_cast<Section>(static_cast<uint8_t>(_section) + 1);
+        _family = 0;
+        _sample = 0;
+        _headerLine = 0;
+    }
+
+    return false;
+}
+
+static size_t printLine(char* line, size_t size, const char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(line, size, format, args);
+    va_end(args);
+
+    if (len < 0) { return 0; }
+    return std::min(static_cast<size_t>(len), size - 1);
+}
+
+bool WebApiPrometheusClass::MetricsWriter::header(const char* name, const char* help, MetricType_t type)
+{
+    if (_headerLine == 0) {
+        _lineLen = printLine(_line, sizeof(_line), "# HELP opendtu_%s %s\n", name, help);
+    } else if (_headerLine == 1) {
+        _lineLen = printLine(_line, sizeof(_line), "# TYPE opendtu_%s %s\n", name, _metricTypes[type]);
+    } else {
+        return false;
     }
+
+    ++_headerLine;
+    return true;
 }
 
-void WebApiPrometheusClass::addField(AsyncResponseStream* stream, const String& serial, const uint8_t idx, std::shared_ptr<InverterAbstract> inv, const ChannelType_t type, const ChannelNum_t channel, const FieldId_t fieldId, const char* metricName, const char* channelName)
+bool WebApiPrometheusClass::MetricsWriter::nextInfoLine()
 {
-    if (inv->Statistics()->hasChannelFieldValue(type, channel, fieldId)) {
-        const char* chanName = (channelName == nullptr) ? inv->Statistics()->getChannelFieldName(type, channel, fieldId) : channelName;
-        if (idx == 0 && type == TYPE_AC && channel == 0) {
-            stream->printf("# HELP opendtu_%s in %s\n", chanName, inv->Statistics()->getChannelFieldUnit(type, channel, fieldId));
-            stream->printf("# TYPE opendtu_%s %s\n", chanName, metricName);
+    struct InfoMetric {
+        const char* Name;
+        const char* Help;
+        MetricType_t Type;
+    };
+
+    static const InfoMetric infoMetrics[] = {
+        { "build", "Build info", GAUGE },
+        { "platform", "Platform info", GAUGE },
+        { "uptime", "Uptime in seconds", COUNTER },
+        { "heap_size", "System memory size", GAUGE },
+        { "free_heap_size", "System free memory", GAUGE },
+        { "biggest_heap_block", "Biggest free heap block", GAUGE },
+        { "heap_min_free", "Minimum free memory since boot", GAUGE },
+    };
+    static constexpr size_t infoMetricCount = sizeof(infoMetrics) / sizeof(infoMetrics[0]);
+
+    // the WiFi metrics traditionally lack the prefix
+    size_t const wifiRssi = infoMetricCount;
+    size_t const wifiStation = infoMetricCount + 1;
+
+    while (_family <= wifiStation) {
+        if (_family < infoMetricCount) {
+            auto const& m = infoMetrics[_family];
+            if (header(m.Name, m.Help, m.Type)) {
+                return true;
+            }
+        } else if (_headerLine < 2) {
+            const char* name = (_family == wifiRssi) ? "wifi_rssi" : "wifi_station";
+            const char* help = (_family == wifiRssi) ? "WiFi RSSI" : "WiFi Station info";
+            const char* format = (_headerLine == 0) ? "# HELP %s %s\n" : "# TYPE %s %s\n";
+            _lineLen = printLine(_line, sizeof(_line), format, name, (_headerLine == 0) ? help : "gauge");
+            ++_headerLine;
+            return true;
+        }
+
+        if (_sample > 0) {
+            ++_family;
+            _sample = 0;
+            _headerLine = 0;
+            continue;
         }
-        stream->printf("opendtu_%s{serial=\"%s\",unit=\"%" PRIu8 "\",name=\"%s\",type=\"%s\",channel=\"%d\"} %s\n",
-            chanName,
-            serial.c_str(),
-            idx,
-            inv->name(),
-            inv->Statistics()->getChannelTypeName(type),
-            channel,
-            inv->Statistics()->getChannelFieldValueString(type, channel, fieldId).c_str());
+        _sample = 1;
+
+        switch (_family) {
+        case 0:
+            _lineLen = printLine(_line, sizeof(_line), "opendtu_build{name=\"%s\",id=\"%s\",version=\"%d.%d.%d\"} 1\n",
+                NetworkSettings.getHostname().c_str(), __COMPILED_GIT_HASH__, CONFIG_VERSION >> 24 & 0xff, CONFIG_VERSION >> 16 & 0xff, CONFIG_VERSION >> 8 & 0xff);
+            break;
+        case 1:
+            _lineLen = printLine(_line, sizeof(_line), "opendtu_platform{arch=\"%s\",mac=\"%s\"} 1\n", ESP.getChipModel(), NetworkSettings.macAddress().c_str());
+            break;
+        case 2:
+            _lineLen = printLine(_line, sizeof(_line), "opendtu_uptime %lld\n", esp_timer_get_time() / 1000000);
+            break;
+        case 3:
+            _lineLen = printLine(_line, sizeof(_line), "opendtu_heap_size %" PRIu32 "\n", ESP.getHeapSize());
+            break;
+        case 4:
+            _lineLen = printLine(_line, sizeof(_line), "opendtu_free_heap_size %" PRIu32 "\n", ESP.getFreeHeap());
+            break;
+        case 5:
+            _lineLen = printLine(_line, sizeof(_line), "opendtu_biggest_heap_block %" PRIu32 "\n", ESP.getMaxAllocHeap());
+            break;
+        case 6:
+            _lineLen = printLine(_line, sizeof(_line), "opendtu_heap_min_free %" PRIu32 "\n", ESP.getMinFreeHeap());
+            break;
+        default:
+            if (_family == wifiRssi) {
+                _lineLen = printLine(_line, sizeof(_line), "wifi_rssi %" PRId8 "\n", WiFi.RSSI());
+            } else {
+                _lineLen = printLine(_line, sizeof(_line), "wifi_station{bssid=\"%s\"} 1\n", WiFi.BSSIDstr().c_str());
+            }
+            break;
+        }
+
+        return true;
     }
+
+    return false;
 }
 
-void WebApiPrometheusClass::addPanelInfo(AsyncResponseStream* stream, const String& serial, const uint8_t idx, std::shared_ptr<InverterAbstract> inv, const ChannelType_t type, const ChannelNum_t channel)
+bool WebApiPrometheusClass::MetricsWriter::nextScalarLine()
 {
-    if (type != TYPE_DC) {
-        return;
+    while (_family < _scalarMetricCount) {
+        auto const& m = _scalarMetrics[_family];
+
+        if (_headerLine == 0) {
+            auto value = m.Read();
+            if (!value) {
+                ++_family;
+                continue;
+            }
+            snprintf(_value, sizeof(_value), "%.*f", m.Digits, *value);
+        }
+
+        if (header(m.Name, m.Help, m.Type)) {
+            return true;
+        }
+
+        if (_sample == 0) {
+            _sample = 1;
+            _lineLen = printLine(_line, sizeof(_line), "opendtu_%s %s\n", m.Name, _value);
+            return true;
+        }
+
+        ++_family;
+        _sample = 0;
+        _headerLine = 0;
+    }
+
+    return false;
+}
+
+bool WebApiPrometheusClass::MetricsWriter::nextRegistryLine()
+{
+    while (_family < _entries.size()) {
+        auto const& entry = _entries[_family];
+
+        // a family spans the consecutive entries of the same name
+        bool first = _family == 0 || strcmp(_entries[_family - 1].Name, entry.Name) != 0;
+        if (first) {
+            MetricType_t type = GAUGE;
+            switch (entry.Value->getType()) {
+            case Metrics::Type::Counter:
+                type = COUNTER;
+                break;
+            case Metrics::Type::Gauge:
+                type = GAUGE;
+                break;
+            case Metrics::Type::Histogram:
+                type = HISTOGRAM;
+                break;
+            }
+
+            if (header(entry.Name, entry.Help, type)) {
+                return true;
+            }
+        }
+
+        if (formatEntry(entry)) {
+            ++_sample;
+            return true;
+        }
+
+        ++_family;
+        _sample = 0;
+        _headerLine = 0;
+    }
+
+    return false;
+}
+
+bool WebApiPrometheusClass::MetricsWriter::formatEntry(const Metrics::Registry::Entry& entry)
+{
+    char label[80] = "";
+    if (entry.Instance.Name != nullptr) {
+        snprintf(label, sizeof(label), "%s=\"%s\"", entry.Instance.Name, escapeLabelValue(entry.Instance.Value.c_str()).c_str());
+    }
+    const char* open = (label[0] != '\0') ? "{" : "";
+    const char* close = (label[0] != '\0') ? "}" : "";
+    const char* name = entry.Name;
+
+    switch (entry.Value->getType()) {
+    case Metrics::Type::Counter:
+        if (_sample > 0) { return false; }
+        _lineLen = printLine(_line, sizeof(_line), "opendtu_%s%s%s%s %" PRIu32 "\n", name, open, label, close,
+            static_cast<Metrics::Counter const&>(*entry.Value).get());
+        return true;
+
+    case Metrics::Type::Gauge:
+        if (_sample > 0) { return false; }
+        _lineLen = printLine(_line, sizeof(_line), "opendtu_%s%s%s%s %f\n", name, open, label, close,
+            static_cast<Metrics::Gauge const&>(*entry.Value).get());
+        return true;
+
+    case Metrics::Type::Histogram: {
+        auto const& histogram = static_cast<Metrics::Histogram const&>(*entry.Value);
+        size_t const bounds = histogram.getBoundCount();
+        const char* separator = (label[0] != '\0') ? "," : "";
+
+        if (_sample == 0) {
+            uint32_t cumulative = 0;
+            for (size_t b = 0; b <= bounds; ++b) {
+                cumulative += histogram.getBucket(b);
+                _buckets[b] = cumulative;
+            }
+        }
+
+        if (_sample < bounds) {
+            _lineLen = printLine(_line, sizeof(_line), "opendtu_%s_bucket{%s%sle=\"%" PRIu32 "\"} %" PRIu32 "\n",
+                name, label, separator, histogram.getBound(_sample), _buckets[_sample]);
+        } else if (_sample == bounds) {
+            _lineLen = printLine(_line, sizeof(_line), "opendtu_%s_bucket{%s%sle=\"+Inf\"} %" PRIu32 "\n",
+                name, label, separator, _buckets[bounds]);
+        } else if (_sample == bounds + 1) {
+            _lineLen = printLine(_line, sizeof(_line), "opendtu_%s_sum%s%s%s %" PRIu64 "\n", name, open, label, close,
+                histogram.getSum());
+        } else if (_sample == bounds + 2) {
+            _lineLen = printLine(_line, sizeof(_line), "opendtu_%s_count%s%s%s %" PRIu32 "\n", name, open, label, close,
+                _buckets[bounds]);
+        } else {
+            return false;
+        }
+        return true;
+    }
+    }
+
+    return false;
+}
+
+bool WebApiPrometheusClass::MetricsWriter::nextInverterLine()
+{
+    while (_family < _layout->Families.size()) {
+        auto const& family = _layout->Families[_family];
+
+        // skips samples which are not available
+        while (_sample < family.Samples.size() && !formatSample(family, family.Samples[_sample])) {
+            ++_sample;
+        }
+
+        if (_sample == family.Samples.size()) {
+            ++_family;
+            _sample = 0;
+            _headerLine = 0;
+            continue;
+        }
+
+        // the header is only written if the family has a sample, which is
+        // formatted again once the header was written
+        if (header(family.Name.c_str(), family.Help.c_str(), family.Type)) {
+            return true;
+        }
+
+        ++_sample;
+        return true;
+    }
+
+    return false;
+}
+
+bool WebApiPrometheusClass::MetricsWriter::formatSample(const Family& family, const Sample& sample)
+{
+    auto inv = Hoymiles.getInverterByPos(sample.Inverter);
+    if (inv == nullptr || inv->serial() != _layout->Inverters[sample.Inverter]) {
+        return false;
+    }
+
+    const char* name = family.Name.c_str();
+    const char* labels = _layout->Labels[sample.Labels].c_str();
+    auto stats = inv->Statistics();
+
+    switch (family.Metric) {
+    case InverterMetric::LastUpdate:
+        _lineLen = printLine(_line, sizeof(_line), "opendtu_%s{%s} %" PRIu32 "\n", name, labels, stats->getLastUpdate() / 1000);
+        return true;
+
+    case InverterMetric::LimitRelative:
+        _lineLen = printLine(_line, sizeof(_line), "opendtu_%s{%s} %f\n", name, labels, inv->SystemConfigPara()->getLimitPercent() / 100.0);
+        return true;
+
+    case InverterMetric::LimitAbsolute:
+        if (inv->DevInfo()->getMaxPower() == 0) {
+            return false;
+        }
+        _lineLen = printLine(_line, sizeof(_line), "opendtu_%s{%s} %f\n", name, labels, inv->SystemConfigPara()->getLimitPercent() * inv->DevInfo()->getMaxPower() / 100.0);
+        return true;
+
+    case InverterMetric::PanelInfo:
+    case InverterMetric::MaxPower:
+    case InverterMetric::YieldTotalOffset: {
+        auto const inv_cfg = Configuration.getInverterConfig(inv->serial());
+        if (stats->getLastUpdate() == 0 || inv_cfg == nullptr) {
+            return false;
+        }
+
+        auto const& channel = inv_cfg->channel[sample.Channel];
+        if (family.Metric == InverterMetric::PanelInfo) {
+            _lineLen = printLine(_line, sizeof(_line), "opendtu_%s{%s} 1\n", name, labels);
+        } else if (family.Metric == InverterMetric::MaxPower) {
+            _lineLen = printLine(_line, sizeof(_line), "opendtu_%s{%s} %" PRIu16 "\n", name, labels, channel.MaxChannelPower);
+        } else {
+            _lineLen = printLine(_line, sizeof(_line), "opendtu_%s{%s} %f\n", name, labels, channel.YieldTotalOffset);
+        }
+        return true;
+    }
+
+    case InverterMetric::Field:
+        // only if Statistics have been updated at least once since DTU boot
+        if (stats->getLastUpdate() == 0) {
+            return false;
+        }
+        _lineLen = printLine(_line, sizeof(_line), "opendtu_%s{%s} %.*f\n", name, labels,
+            stats->getChannelFieldDigits(sample.Type, sample.Channel, sample.Field),
+            stats->getChannelFieldValue(sample.Type, sample.Channel, sample.Field));
+        return true;
     }
 
-    const auto& config = Configuration.getInverterConfig(inv->serial());
-
-    const bool printHelp = (idx == 0 && channel == 0);
-    if (printHelp) {
-        stream->print("# HELP opendtu_PanelInfo panel information\n");
-        stream->print("# TYPE opendtu_PanelInfo gauge\n");
-    }
-    stream->printf("opendtu_PanelInfo{serial=\"%s\",unit=\"%" PRIu8 "\",name=\"%s\",channel=\"%" PRIu8 "\",panelname=\"%s\"} 1\n",
-        serial.c_str(),
-        idx,
-        inv->name(),
-        channel,
-        config->channel[channel].Name);
-
-    if (printHelp) {
-        stream->print("# HELP opendtu_MaxPower panel maximum output power\n");
-        stream->print("# TYPE opendtu_MaxPower gauge\n");
-    }
-    stream->printf("opendtu_MaxPower{serial=\"%s\",unit=\"%" PRIu8 "\",name=\"%s\",channel=\"%" PRIu8 "\"} %" PRIu16 "\n",
-        serial.c_str(),
-        idx,
-        inv->name(),
-        channel,
-        config->channel[channel].MaxChannelPower);
-
-    if (printHelp) {
-        stream->print("# HELP opendtu_YieldTotalOffset panel yield offset (for used inverters)\n");
-        stream->print("# TYPE opendtu_YieldTotalOffset gauge\n");
-    }
-    stream->printf("opendtu_YieldTotalOffset{serial=\"%s\",unit=\"%" PRIu8 "\",name=\"%s\",channel=\"%" PRIu16 "\"} %f\n",
-        serial.c_str(),
-        idx,
-        inv->name(),
-        channel,
-        config->channel[channel].YieldTotalOffset);
+    return false;
 }
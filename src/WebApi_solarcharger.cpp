@@ -27,12 +27,12 @@ void WebApiSolarChargerlass::onAdminGet(AsyncWebServerRequest* request)
 
     AsyncJsonResponse* response = new AsyncJsonResponse();
     auto root = response->getRoot().as<JsonObject>();
-    auto const& config = Configuration.get();
+    auto const config = Configuration.get();
 
-    ConfigurationClass::serializeSolarChargerConfig(config.SolarCharger, root);
+    ConfigurationClass::serializeSolarChargerConfig(config->SolarCharger, root);
 
     auto mqtt = root["mqtt"].to<JsonObject>();
-    ConfigurationClass::serializeSolarChargerMqttConfig(config.SolarCharger.Mqtt, mqtt);
+    ConfigurationClass::serializeSolarChargerMqttConfig(config->SolarCharger.Mqtt, mqtt);
 
     WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
 }
@@ -4,9 +4,14 @@
  */
 #include "WebApi_sysstatus.h"
 #include "Configuration.h"
+#include "MetricsRegistry.h"
+#include "MqttHandleInverter.h"
+#include "MqttHandlePowerLimiter.h"
+#include "MqttSettings.h"
 #include "NetworkSettings.h"
 #include "PinMapping.h"
 #include "SerialPortManager.h"
+#include "TaskProfiler.h"
 #include "WebApi.h"
 #include "__compiled_constants.h"
 #include <AsyncJson.h>
@@ -20,6 +25,28 @@ void WebApiSysstatusClass::init(AsyncWebServer& server, Scheduler& scheduler)
     using std::placeholders::_1;
 
     server.on("/api/system/status", HTTP_GET, static_cast<ArRequestHandlerFunction>(std::bind(&WebApiSysstatusClass::onSystemStatus, this, _1)));
+    server.on("/api/system/tasks", HTTP_GET, static_cast<ArRequestHandlerFunction>(std::bind(&WebApiSysstatusClass::onSystemTasks, this, _1)));
+}
+
+static void addTaskDetails(JsonArray taskDetails)
+{
+    static std::array<char const*, 19> constexpr task_names = {
+        "IDLE0", "IDLE1", "wifi", "tiT", "loopTask", "async_tcp", "mqttclient", "mqttPublisher",
+        "configWriter", "HoyRadio", "BatteryCAN",
+        "HuaweiHwIfc", "HuaweiTwai", "HuaweiMCP2515",
+        "TruckiPolling",
+        "PM:SDM", "PM:HTTP+JSON", "PM:SML", "PM:HTTP+SML",
+    };
+    for (char const* task_name : task_names) {
+        TaskHandle_t const handle = xTaskGetHandle(task_name);
+        if (!handle) {
+            continue;
+        }
+        JsonObject task = taskDetails.add<JsonObject>();
+        task["name"] = task_name;
+        task["stack_watermark"] = uxTaskGetStackHighWaterMark(handle);
+        task["priority"] = uxTaskPriorityGet(handle);
+    }
 }
 
 void WebApiSysstatusClass::onSystemStatus(AsyncWebServerRequest* request)
@@ -53,22 +80,61 @@ void WebApiSysstatusClass::onSystemStatus(AsyncWebServerRequest* request)
     root["chipcores"] = ESP.getChipCores();
     root["flashsize"] = ESP.getFlashChipSize();
 
-    JsonArray taskDetails = root["task_details"].to<JsonArray>();
-    static std::array<char const*, 15> constexpr task_names = {
-        "IDLE0", "IDLE1", "wifi", "tiT", "loopTask", "async_tcp", "mqttclient",
-        "HuaweiHwIfc", "HuaweiTwai", "HuaweiMCP2515",
-        "TruckiPolling",
-        "PM:SDM", "PM:HTTP+JSON", "PM:SML", "PM:HTTP+SML",
+    addTaskDetails(root["task_details"].to<JsonArray>());
+
+    auto const queueStats = MqttSettings.getPublishQueueStats();
+    JsonObject mqttQueue = root["mqtt_publish_queue"].to<JsonObject>();
+    mqttQueue["queued"] = queueStats.Queued;
+    mqttQueue["coalesced"] = queueStats.Coalesced;
+    mqttQueue["dropped"] = queueStats.Dropped;
+    mqttQueue["depth"] = queueStats.Depth;
+    mqttQueue["high_water"] = queueStats.HighWater;
+    mqttQueue["capacity"] = queueStats.Capacity;
+
+    JsonObject mqttCommands = root["mqtt_commands"].to<JsonObject>();
+    auto addCommandStats = [&mqttCommands](char const* name, MqttCommandCoalescer::Stats const& stats) {
+        JsonObject obj = mqttCommands[name].to<JsonObject>();
+        obj["received"] = stats.Received;
+        obj["applied"] = stats.Applied;
+        obj["coalesced"] = stats.Coalesced;
+        obj["dropped"] = stats.Dropped;
     };
-    for (char const* task_name : task_names) {
-        TaskHandle_t const handle = xTaskGetHandle(task_name);
-        if (!handle) {
-            continue;
+    addCommandStats("inverter", MqttHandleInverter.getCommandStats());
+    addCommandStats("powerlimiter", MqttHandlePowerLimiter.getCommandStats());
+
+    JsonArray metrics = root["metrics"].to<JsonArray>();
+    for (auto const& entry : MetricsRegistry.getEntries()) {
+        JsonObject metric = metrics.add<JsonObject>();
+        metric["name"] = entry.Name;
+        if (entry.Instance.Name != nullptr) {
+            metric[entry.Instance.Name] = entry.Instance.Value;
+        }
+
+        switch (entry.Value->getType()) {
+        case Metrics::Type::Counter:
+            metric["value"] = static_cast<Metrics::Counter const&>(*entry.Value).get();
+            break;
+        case Metrics::Type::Gauge:
+            metric["value"] = static_cast<Metrics::Gauge const&>(*entry.Value).get();
+            break;
+        case Metrics::Type::Histogram: {
+            auto const& histogram = static_cast<Metrics::Histogram const&>(*entry.Value);
+            metric["count"] = histogram.getCount();
+            metric["sum"] = histogram.getSum();
+            metric["max"] = histogram.getMax();
+            JsonArray buckets = metric["buckets"].to<JsonArray>();
+            for (size_t b = 0; b <= histogram.getBoundCount(); ++b) {
+                JsonArray bucket = buckets.add<JsonArray>();
+                if (b < histogram.getBoundCount()) {
+                    bucket.add(histogram.getBound(b));
+                } else {
+                    bucket.add(nullptr);
+                }
+                bucket.add(histogram.getBucket(b));
+            }
+            break;
+        }
         }
-        JsonObject task = taskDetails.add<JsonObject>();
-        task["name"] = task_name;
-        task["stack_watermark"] = uxTaskGetStackHighWaterMark(handle);
-        task["priority"] = uxTaskPriorityGet(handle);
     }
 
     String reason;
@@ -78,7 +144,15 @@ void WebApiSysstatusClass::onSystemStatus(AsyncWebServerRequest* request)
     reason = ResetReason::get_reset_reason_verbose(1);
     root["resetreason_1"] = reason;
 
-    root["cfgsavecount"] = Configuration.get().Cfg.SaveCount;
+    root["cfgsavecount"] = Configuration.getSaveCount();
+
+    auto const persistenceStats = Configuration.getPersistenceStats();
+    JsonObject cfgPersistence = root["cfg_persistence"].to<JsonObject>();
+    cfgPersistence["saves_since_boot"] = persistenceStats.SavesSinceBoot;
+    cfgPersistence["saves_per_hour"] = persistenceStats.SavesSinceBoot * 3600.0f / std::max<int64_t>(esp_timer_get_time() / 1000000, 1);
+    cfgPersistence["write_requests"] = persistenceStats.WriteRequests;
+    cfgPersistence["coalesced"] = persistenceStats.Coalesced;
+    cfgPersistence["pending"] = persistenceStats.Pending;
 
     char version[16];
     snprintf(version, sizeof(version), "%d.%d.%d", CONFIG_VERSION >> 24 & 0xff, CONFIG_VERSION >> 16 & 0xff, CONFIG_VERSION >> 8 & 0xff);
@@ -106,3 +180,30 @@ void WebApiSysstatusClass::onSystemStatus(AsyncWebServerRequest* request)
 
     WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
 }
+
+void WebApiSysstatusClass::onSystemTasks(AsyncWebServerRequest* request)
+{
+    if (!WebApi.checkCredentialsReadonly(request)) {
+        return;
+    }
+
+    AsyncJsonResponse* response = new AsyncJsonResponse();
+    auto& root = response->getRoot();
+
+    JsonArray scheduler = root["scheduler"].to<JsonArray>();
+    for (auto const& stats : TaskProfiler.getStats()) {
+        JsonObject task = scheduler.add<JsonObject>();
+        task["name"] = stats.Name;
+        task["runs"] = stats.Runs;
+        task["total_us"] = stats.TotalUs;
+        task["avg_us"] = (stats.Runs > 0) ? static_cast<uint32_t>(stats.TotalUs / stats.Runs) : 0;
+        task["max_us"] = stats.MaxUs;
+        task["interval_ms"] = stats.IntervalMs;
+        task["lateness_avg_ms"] = (stats.Runs > 0) ? static_cast<uint32_t>(stats.TotalLatenessMs / stats.Runs) : 0;
+        task["lateness_max_ms"] = stats.MaxLatenessMs;
+    }
+
+    addTaskDetails(root["freertos"].to<JsonArray>());
+
+    WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
+}
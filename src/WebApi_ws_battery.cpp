@@ -7,6 +7,7 @@
 #include "Configuration.h"
 #include <battery/Controller.h>
 #include <battery/Stats.h>
+#include "TaskProfiler.h"
 #include "WebApi.h"
 #include "defaults.h"
 #include "Utils.h"
@@ -41,7 +42,7 @@ void WebApiWsBatteryLiveClass::init(AsyncWebServer& server, Scheduler& scheduler
     _wsCleanupTask.enable();
 
     scheduler.addTask(_sendDataTask);
-    _sendDataTask.setCallback(std::bind(&WebApiWsBatteryLiveClass::sendDataTaskCb, this));
+    _sendDataTask.setCallback(TaskProfiler.wrap("WS:Battery", std::bind(&WebApiWsBatteryLiveClass::sendDataTaskCb, this)));
     _sendDataTask.setIterations(TASK_FOREVER);
     _sendDataTask.setInterval(1 * TASK_SECOND);
     _sendDataTask.enable();
@@ -57,12 +58,12 @@ void WebApiWsBatteryLiveClass::reload()
 {
     _ws.removeMiddleware(&_simpleDigestAuth);
 
-    auto const& config = Configuration.get();
+    auto const config = Configuration.get();
 
-    if (config.Security.AllowReadonly) { return; }
+    if (config->Security.AllowReadonly) { return; }
 
     _ws.enable(false);
-    _simpleDigestAuth.setPassword(config.Security.Password);
+    _simpleDigestAuth.setPassword(config->Security.Password);
     _ws.addMiddleware(&_simpleDigestAuth);
     _ws.closeAll();
     _ws.enable(true);
@@ -99,10 +100,10 @@ void WebApiWsBatteryLiveClass::sendDataTaskCb()
             String buffer;
             serializeJson(root, buffer);
 
-            if (Configuration.get().Security.AllowReadonly) {
+            if (Configuration.get()->Security.AllowReadonly) {
                 _ws.setAuthentication("", "");
             } else {
-                _ws.setAuthentication(AUTH_USERNAME, Configuration.get().Security.Password);
+                _ws.setAuthentication(AUTH_USERNAME, Configuration.get()->Security.Password);
             }
 
             _ws.textAll(buffer);
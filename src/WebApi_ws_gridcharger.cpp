@@ -6,6 +6,7 @@
 #include "AsyncJson.h"
 #include "Configuration.h"
 #include <gridcharger/Controller.h>
+#include "TaskProfiler.h"
 #include "Utils.h"
 #include "WebApi.h"
 #include "defaults.h"
@@ -40,7 +41,7 @@ void WebApiWsGridChargerLiveClass::init(AsyncWebServer& server, Scheduler& sched
     _wsCleanupTask.enable();
 
     scheduler.addTask(_sendDataTask);
-    _sendDataTask.setCallback(std::bind(&WebApiWsGridChargerLiveClass::sendDataTaskCb, this));
+    _sendDataTask.setCallback(TaskProfiler.wrap("WS:GridCharger", std::bind(&WebApiWsGridChargerLiveClass::sendDataTaskCb, this)));
     _sendDataTask.setIterations(TASK_FOREVER);
     _sendDataTask.setInterval(1 * TASK_SECOND);
     _sendDataTask.enable();
@@ -56,12 +57,12 @@ void WebApiWsGridChargerLiveClass::reload()
 {
     _ws.removeMiddleware(&_simpleDigestAuth);
 
-    auto const& config = Configuration.get();
+    auto const config = Configuration.get();
 
-    if (config.Security.AllowReadonly) { return; }
+    if (config->Security.AllowReadonly) { return; }
 
     _ws.enable(false);
-    _simpleDigestAuth.setPassword(config.Security.Password);
+    _simpleDigestAuth.setPassword(config->Security.Password);
     _ws.addMiddleware(&_simpleDigestAuth);
     _ws.closeAll();
     _ws.enable(true);
@@ -4,6 +4,7 @@
  */
 #include "WebApi_ws_live.h"
 #include "Datastore.h"
+#include "TaskProfiler.h"
 #include "Utils.h"
 #include "WebApi.h"
 #include <battery/Controller.h>
@@ -14,6 +15,7 @@
 #include "defaults.h"
 #include <solarcharger/Controller.h>
 #include <AsyncJson.h>
+#include <algorithm>
 
 #undef TAG
 static const char* TAG = "webapi";
@@ -25,7 +27,7 @@ static const char* TAG = "webapi";
 WebApiWsLiveClass::WebApiWsLiveClass()
     : _ws("/livedata")
     , _wsCleanupTask(1 * TASK_SECOND, TASK_FOREVER, std::bind(&WebApiWsLiveClass::wsCleanupTaskCb, this))
-    , _sendDataTask(1 * TASK_SECOND, TASK_FOREVER, std::bind(&WebApiWsLiveClass::sendDataTaskCb, this))
+    , _sendDataTask(1 * TASK_SECOND, TASK_FOREVER)
 {
 }
 
@@ -47,7 +49,10 @@ void WebApiWsLiveClass::init(AsyncWebServer& server, Scheduler& scheduler)
     _wsCleanupTask.enable();
 
     scheduler.addTask(_sendDataTask);
+    _sendDataTask.setCallback(TaskProfiler.wrap("WS:Live", std::bind(&WebApiWsLiveClass::sendDataTaskCb, this)));
     _sendDataTask.enable();
+    _spSendDataDuration = MetricsRegistry.addHistogram("websocket_live_send_duration_us",
+        "Duration of building and queueing the live data frames", Metrics::DurationBoundsUs);
     _simpleDigestAuth.setUsername(AUTH_USERNAME);
     _simpleDigestAuth.setRealm("live websocket");
     _simpleDigestAuth.setAuthType(AsyncAuthType::AUTH_DIGEST);
@@ -59,14 +64,14 @@ void WebApiWsLiveClass::reload()
 {
     _ws.removeMiddleware(&_simpleDigestAuth);
 
-    auto const& config = Configuration.get();
+    auto const config = Configuration.get();
 
-    if (config.Security.AllowReadonly) {
+    if (config->Security.AllowReadonly) {
         return;
     }
 
     _ws.enable(false);
-    _simpleDigestAuth.setPassword(config.Security.Password);
+    _simpleDigestAuth.setPassword(config->Security.Password);
     _ws.addMiddleware(&_simpleDigestAuth);
     _ws.closeAll();
     _ws.enable(true);
@@ -80,15 +85,15 @@ void WebApiWsLiveClass::wsCleanupTaskCb()
 
 void WebApiWsLiveClass::generateOnBatteryJsonResponse(JsonVariant& root, bool all)
 {
-    auto const& config = Configuration.get();
+    auto const config = Configuration.get();
     auto constexpr halfOfAllMillis = std::numeric_limits<uint32_t>::max() / 2;
 
     auto solarChargerAge = SolarCharger.getStats()->getAgeMillis();
     if (all || (solarChargerAge > 0 && (millis() - _lastPublishSolarCharger) > solarChargerAge)) {
         auto solarchargerObj = root["solarcharger"].to<JsonObject>();
-        solarchargerObj["enabled"] = config.SolarCharger.Enabled;
+        solarchargerObj["enabled"] = config->SolarCharger.Enabled;
 
-        if (config.SolarCharger.Enabled) {
+        if (config->SolarCharger.Enabled) {
             float power = 0;
             auto outputPower = SolarCharger.getStats()->getOutputPowerWatts();
             auto panelPower = SolarCharger.getStats()->getPanelPowerWatts();
@@ -120,9 +125,9 @@ void WebApiWsLiveClass::generateOnBatteryJsonResponse(JsonVariant& root, bool al
     auto gridChargerStats = GridCharger.getStats();
     if (all || (gridChargerStats->getLastUpdate() - _lastPublishGridCharger) < halfOfAllMillis ) {
         auto gridChargerObj = root["gridcharger"].to<JsonObject>();
-        gridChargerObj["enabled"] = config.GridCharger.Enabled;
+        gridChargerObj["enabled"] = config->GridCharger.Enabled;
 
-        if (config.GridCharger.Enabled) {
+        if (config->GridCharger.Enabled) {
             auto oInputPower = gridChargerStats->getInputPower();
             float pwr = oInputPower.value_or(0.0f);
             addTotalField(gridChargerObj, "Power", pwr, "W", 2);
@@ -134,9 +139,9 @@ void WebApiWsLiveClass::generateOnBatteryJsonResponse(JsonVariant& root, bool al
     auto spStats = Battery.getStats();
     if (all || spStats->updateAvailable(_lastPublishBattery)) {
         auto batteryObj = root["battery"].to<JsonObject>();
-        batteryObj["enabled"] = config.Battery.Enabled;
+        batteryObj["enabled"] = config->Battery.Enabled;
 
-        if (config.Battery.Enabled) {
+        if (config->Battery.Enabled) {
             if (spStats->isSoCValid()) {
                 addTotalField(batteryObj, "soc", spStats->getSoC(), "%", spStats->getSoCPrecision());
             }
@@ -159,9 +164,9 @@ void WebApiWsLiveClass::generateOnBatteryJsonResponse(JsonVariant& root, bool al
 
     if (all || (PowerMeter.getLastUpdate() - _lastPublishPowerMeter) < halfOfAllMillis) {
         auto powerMeterObj = root["power_meter"].to<JsonObject>();
-        powerMeterObj["enabled"] = config.PowerMeter.Enabled;
+        powerMeterObj["enabled"] = config->PowerMeter.Enabled;
 
-        if (config.PowerMeter.Enabled) {
+        if (config->PowerMeter.Enabled) {
             addTotalField(powerMeterObj, "Power", PowerMeter.getPowerTotal(), "W", 1);
         }
 
@@ -181,10 +186,7 @@ void WebApiWsLiveClass::sendOnBatteryStats()
     if (root.isNull()) { return; }
 
     if (Utils::checkJsonAlloc(root, __FUNCTION__, __LINE__)) {
-        String buffer;
-        serializeJson(root, buffer);
-
-        _ws.textAll(buffer);;
+        sendFrame(root);
     }
 }
 
@@ -192,52 +194,276 @@ void WebApiWsLiveClass::sendDataTaskCb()
 {
     // do nothing if no WS client is connected
     if (_ws.count() == 0) {
+        resetFrames();
         return;
     }
 
+    Metrics::ScopedTimer timer(*_spSendDataDuration);
+
     sendOnBatteryStats();
 
-    // Loop all inverters
+    try {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        std::vector<uint32_t> pendingClients;
+        {
+            std::lock_guard<std::mutex> pendingLock(_clientsMutex);
+            pendingClients.swap(_pendingClients);
+        }
+
+        // new clients first learn the state the deltas below build upon
+        if (!pendingClients.empty()) {
+            sendFullFrame(pendingClients);
+        }
+
+        // clients learn about removed inverters from the next keyframe
+        for (uint8_t i = Hoymiles.getNumInverters(); i < INV_MAX_COUNT; i++) {
+            if (!_lastInverters[i].isNull()) {
+                _lastInverters[i].clear();
+                _keyframeRequested = true;
+            }
+        }
+
+        bool keyframe = _keyframeRequested || (millis() - _lastKeyframe) > KeyframeIntervalMillis;
+        if (keyframe) {
+            _lastKeyframe = millis();
+            _keyframeRequested = false;
+        }
+
+        JsonDocument fullFrame;
+        auto fullInverters = fullFrame["inverters"].to<JsonArray>();
+        bool complete = keyframe;
+
+        JsonDocument deltaFrame;
+        deltaFrame["delta"] = true;
+        auto deltaInverters = deltaFrame["inverters"].to<JsonArray>();
+
+        // Loop all inverters
+        for (uint8_t i = 0; i < Hoymiles.getNumInverters(); i++) {
+            auto inv = Hoymiles.getInverterByPos(i);
+            if (inv == nullptr) {
+                continue;
+            }
+
+            auto& last = _lastInverters[i];
+
+            const uint32_t lastUpdateInternal = inv->Statistics()->getLastUpdateFromInternal();
+            if (!keyframe && !last.isNull() && !((lastUpdateInternal > 0 && lastUpdateInternal > _lastPublishStats[i]) || (millis() - _lastPublishStats[i] > (10 * 1000)))) {
+                continue;
+            }
+
+            _lastPublishStats[i] = millis();
+
+            JsonDocument current;
+            auto invObject = current.to<JsonObject>();
+            generateInverterCommonJsonResponse(invObject, inv);
+            generateInverterChannelJsonResponse(invObject, inv);
+
+            if (!Utils::checkJsonAlloc(current, __FUNCTION__, __LINE__)) {
+                complete = false;
+                continue;
+            }
+
+            auto delta = deltaInverters.add<JsonObject>();
+            if (keyframe || last["serial"] != current["serial"]
+                    || !diffJson(last.as<JsonObjectConst>(), current.as<JsonObjectConst>(), delta)) {
+                deltaInverters.remove(deltaInverters.size() - 1);
+                fullInverters.add(current.as<JsonObjectConst>());
+            } else if (delta.size() > 0) {
+                // identifies the inverter to the client
+                delta["serial"] = current["serial"];
+            } else {
+                deltaInverters.remove(deltaInverters.size() - 1);
+            }
+
+            last = std::move(current);
+        }
+
+        JsonDocument common;
+        JsonVariant commonVar = common;
+        generateCommonJsonResponse(commonVar);
+
+        bool sendFull = keyframe || fullInverters.size() > 0;
+        if (sendFull || !diffJson(_lastCommon.as<JsonObjectConst>(), common.as<JsonObjectConst>(), deltaFrame.as<JsonObject>())) {
+            deltaFrame.remove("total");
+            deltaFrame.remove("hints");
+            fullFrame["total"] = common["total"];
+            fullFrame["hints"] = common["hints"];
+            sendFull = true;
+        }
+        _lastCommon = std::move(common);
+
+        if (deltaInverters.size() == 0) {
+            deltaFrame.remove("inverters");
+        }
+
+        // the state was updated already, so the clients must catch up with
+        // a full frame if a frame could not be sent
+        if (sendFull) {
+            if (complete) {
+                fullFrame["complete"] = true;
+            }
+
+            if (Utils::checkJsonAlloc(fullFrame, __FUNCTION__, __LINE__)) {
+                sendFrame(fullFrame);
+            } else {
+                _keyframeRequested = true;
+            }
+        }
+
+        // a delta frame always holds the "delta" marker
+        if (deltaFrame.size() > 1) {
+            if (Utils::checkJsonAlloc(deltaFrame, __FUNCTION__, __LINE__)) {
+                sendFrame(deltaFrame);
+            } else {
+                _keyframeRequested = true;
+            }
+        }
+
+    } catch (const std::bad_alloc& bad_alloc) {
+        ESP_LOGE(TAG, "Call to /api/livedata/status temporarely out of resources. Reason: \"%s\".", bad_alloc.what());
+        resetFrames();
+    } catch (const std::exception& exc) {
+        ESP_LOGE(TAG, "Unknown exception in /api/livedata/status. Reason: \"%s\".", exc.what());
+        resetFrames();
+    }
+}
+
+void WebApiWsLiveClass::sendFullFrame(const std::vector<uint32_t>& clientIds)
+{
+    JsonDocument root;
+
+    if (!_lastCommon.isNull()) {
+        root["total"] = _lastCommon["total"];
+        root["hints"] = _lastCommon["hints"];
+    }
+
+    auto invArray = root["inverters"].to<JsonArray>();
+    bool complete = true;
     for (uint8_t i = 0; i < Hoymiles.getNumInverters(); i++) {
         auto inv = Hoymiles.getInverterByPos(i);
         if (inv == nullptr) {
             continue;
         }
 
-        const uint32_t lastUpdateInternal = inv->Statistics()->getLastUpdateFromInternal();
-        if (!((lastUpdateInternal > 0 && lastUpdateInternal > _lastPublishStats[i]) || (millis() - _lastPublishStats[i] > (10 * 1000)))) {
+        if (_lastInverters[i].isNull()) {
+            complete = false;
             continue;
         }
 
-        _lastPublishStats[i] = millis();
+        auto invObject = invArray.add<JsonObject>();
+        invObject.set(_lastInverters[i].as<JsonObjectConst>());
 
-        try {
-            std::lock_guard<std::mutex> lock(_mutex);
-            JsonDocument root;
-            JsonVariant var = root;
+        // the data aged since the state was generated
+        invObject["data_age"] = (millis() - inv->Statistics()->getLastUpdate()) / 1000;
+        invObject["data_age_ms"] = millis() - inv->Statistics()->getLastUpdate();
+    }
 
-            auto invArray = var["inverters"].to<JsonArray>();
-            auto invObject = invArray.add<JsonObject>();
+    // without a state, the next frame is a full frame for all clients
+    if (_lastCommon.isNull() && invArray.size() == 0) {
+        return;
+    }
 
-            generateCommonJsonResponse(var);
-            generateInverterCommonJsonResponse(invObject, inv);
-            generateInverterChannelJsonResponse(invObject, inv);
+    if (complete) {
+        root["complete"] = true;
+    }
 
-            if (!Utils::checkJsonAlloc(root, __FUNCTION__, __LINE__)) {
-                continue;
-            }
+    if (!Utils::checkJsonAlloc(root, __FUNCTION__, __LINE__)) {
+        return;
+    }
+
+    sendFrame(root, &clientIds);
+}
+
+void WebApiWsLiveClass::sendFrame(const JsonDocument& root, const std::vector<uint32_t>* clientIds)
+{
+    std::vector<uint32_t> msgPackClients;
+    {
+        std::lock_guard<std::mutex> lock(_clientsMutex);
+        msgPackClients = _msgPackClients;
+    }
+
+    auto contains = [](const std::vector<uint32_t>& ids, uint32_t id) {
+        return std::find(ids.begin(), ids.end(), id) != ids.end();
+    };
+
+    // each format is serialized at most once and shared by all clients
+    AsyncWebSocketSharedBuffer json;
+    AsyncWebSocketSharedBuffer msgPack;
+
+    for (auto& client : _ws.getClients()) {
+        if (client.status() != WS_CONNECTED) {
+            continue;
+        }
+
+        if (clientIds != nullptr && !contains(*clientIds, client.id())) {
+            continue;
+        }
+
+        if (contains(msgPackClients, client.id())) {
+            if (!msgPack) { msgPack = serializeFrame(root, true); }
+            client.binary(msgPack);
+        } else {
+            if (!json) { json = serializeFrame(root, false); }
+            client.text(json);
+        }
+    }
+}
+
+void WebApiWsLiveClass::resetFrames()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
 
-            String buffer;
-            serializeJson(root, buffer);
+    // the next frame is a full frame for all clients
+    _lastCommon.clear();
+    for (auto& last : _lastInverters) {
+        last.clear();
+    }
 
-            _ws.textAll(buffer);
+    std::lock_guard<std::mutex> pendingLock(_clientsMutex);
+    _pendingClients.clear();
+}
 
-        } catch (const std::bad_alloc& bad_alloc) {
-            ESP_LOGE(TAG, "Call to /api/livedata/status temporarely out of resources. Reason: \"%s\".", bad_alloc.what());
-        } catch (const std::exception& exc) {
-            ESP_LOGE(TAG, "Unknown exception in /api/livedata/status. Reason: \"%s\".", exc.what());
+bool WebApiWsLiveClass::diffJson(JsonObjectConst prev, JsonObjectConst curr, JsonObject delta)
+{
+    bool complete = true;
+    for (JsonPairConst kv : prev) {
+        if (curr[kv.key()].isNull()) {
+            complete = false;
         }
     }
+
+    for (JsonPairConst kv : curr) {
+        JsonVariantConst before = prev[kv.key()];
+
+        if (kv.value().is<JsonObjectConst>() && before.is<JsonObjectConst>()) {
+            auto nested = delta[kv.key()].to<JsonObject>();
+            if (!diffJson(before, kv.value(), nested)) {
+                complete = false;
+            }
+            if (nested.size() == 0) {
+                delta.remove(kv.key());
+            }
+            continue;
+        }
+
+        if (kv.value() != before) {
+            delta[kv.key()] = kv.value();
+        }
+    }
+
+    return complete;
+}
+
+AsyncWebSocketSharedBuffer WebApiWsLiveClass::serializeFrame(const JsonDocument& root, bool msgPack)
+{
+    // one spare byte for the null terminator written if there is room
+    size_t size = (msgPack ? measureMsgPack(root) : measureJson(root)) + 1;
+    auto buffer = std::make_shared<std::vector<uint8_t>>(size);
+    auto data = reinterpret_cast<char*>(buffer->data());
+    size_t len = msgPack ? serializeMsgPack(root, data, size) : serializeJson(root, data, size);
+    buffer->resize(len);
+    return buffer;
 }
 
 void WebApiWsLiveClass::generateCommonJsonResponse(JsonVariant& root)
@@ -251,14 +477,14 @@ void WebApiWsLiveClass::generateCommonJsonResponse(JsonVariant& root)
     struct tm timeinfo;
     hintObj["time_sync"] = !getLocalTime(&timeinfo, 5);
     hintObj["radio_problem"] = (Hoymiles.getRadioNrf()->isInitialized() && (!Hoymiles.getRadioNrf()->isConnected() || !Hoymiles.getRadioNrf()->isPVariant())) || (Hoymiles.getRadioCmt()->isInitialized() && (!Hoymiles.getRadioCmt()->isConnected()));
-    hintObj["default_password"] = strcmp(Configuration.get().Security.Password, ACCESS_POINT_PASSWORD) == 0;
+    hintObj["default_password"] = strcmp(Configuration.get()->Security.Password, ACCESS_POINT_PASSWORD) == 0;
 
     hintObj["pin_mapping_issue"] = PIN_MAPPING_REQUIRED && !PinMapping.isMappingSelected();
 }
 
 void WebApiWsLiveClass::generateInverterCommonJsonResponse(JsonObject& root, std::shared_ptr<InverterAbstract> inv)
 {
-    const INVERTER_CONFIG_T* inv_cfg = Configuration.getInverterConfig(inv->serial());
+    auto const inv_cfg = Configuration.getInverterConfig(inv->serial());
     if (inv_cfg == nullptr) {
         return;
     }
@@ -288,7 +514,7 @@ void WebApiWsLiveClass::generateInverterCommonJsonResponse(JsonObject& root, std
 
 void WebApiWsLiveClass::generateInverterChannelJsonResponse(JsonObject& root, std::shared_ptr<InverterAbstract> inv)
 {
-    const INVERTER_CONFIG_T* inv_cfg = Configuration.getInverterConfig(inv->serial());
+    auto const inv_cfg = Configuration.getInverterConfig(inv->serial());
     if (inv_cfg == nullptr) {
         return;
     }
@@ -359,8 +585,38 @@ void WebApiWsLiveClass::onWebsocketEvent(AsyncWebSocket* server, AsyncWebSocketC
 {
     if (type == WS_EVT_CONNECT) {
         ESP_LOGD(TAG, "Websocket: [%s][%" PRIu32 "] connect", server->url(), client->id());
+
+        std::lock_guard<std::mutex> lock(_clientsMutex);
+        _pendingClients.push_back(client->id());
     } else if (type == WS_EVT_DISCONNECT) {
         ESP_LOGD(TAG, "Websocket: [%s][%" PRIu32 "] disconnect", server->url(), client->id());
+
+        std::lock_guard<std::mutex> lock(_clientsMutex);
+        _msgPackClients.erase(std::remove(_msgPackClients.begin(), _msgPackClients.end(), client->id()), _msgPackClients.end());
+    } else if (type == WS_EVT_DATA) {
+        // the format request is a small text message in a single frame
+        auto info = static_cast<AwsFrameInfo*>(arg);
+        if (!info->final || info->index != 0 || info->len != len || info->opcode != WS_TEXT) {
+            return;
+        }
+
+        JsonDocument request;
+        if (deserializeJson(request, reinterpret_cast<const char*>(data), len) != DeserializationError::Ok
+                || !request["format"].is<const char*>()) {
+            return;
+        }
+
+        bool msgPack = request["format"] == "msgpack";
+        ESP_LOGD(TAG, "Websocket: [%s][%" PRIu32 "] format %s", server->url(), client->id(), msgPack ? "msgpack" : "json");
+
+        std::lock_guard<std::mutex> lock(_clientsMutex);
+        _msgPackClients.erase(std::remove(_msgPackClients.begin(), _msgPackClients.end(), client->id()), _msgPackClients.end());
+        if (msgPack) {
+            _msgPackClients.push_back(client->id());
+        }
+
+        // the state is sent again in the requested format
+        _pendingClients.push_back(client->id());
     }
 }
 
@@ -5,6 +5,7 @@
 #include "WebApi_ws_solarcharger_live.h"
 #include "AsyncJson.h"
 #include "Configuration.h"
+#include "TaskProfiler.h"
 #include "Utils.h"
 #include "WebApi.h"
 #include "defaults.h"
@@ -42,7 +43,7 @@ void WebApiWsSolarChargerLiveClass::init(AsyncWebServer& server, Scheduler& sche
     _wsCleanupTask.enable();
 
     scheduler.addTask(_sendDataTask);
-    _sendDataTask.setCallback(std::bind(&WebApiWsSolarChargerLiveClass::sendDataTaskCb, this));
+    _sendDataTask.setCallback(TaskProfiler.wrap("WS:SolarCharger", std::bind(&WebApiWsSolarChargerLiveClass::sendDataTaskCb, this)));
     _sendDataTask.setIterations(TASK_FOREVER);
     _sendDataTask.setInterval(500 * TASK_MILLISECOND);
     _sendDataTask.enable();
@@ -58,12 +59,12 @@ void WebApiWsSolarChargerLiveClass::reload()
 {
     _ws.removeMiddleware(&_simpleDigestAuth);
 
-    auto const& config = Configuration.get();
+    auto const config = Configuration.get();
 
-    if (config.Security.AllowReadonly) { return; }
+    if (config->Security.AllowReadonly) { return; }
 
     _ws.enable(false);
-    _simpleDigestAuth.setPassword(config.Security.Password);
+    _simpleDigestAuth.setPassword(config->Security.Password);
     _ws.addMiddleware(&_simpleDigestAuth);
     _ws.closeAll();
     _ws.enable(true);
@@ -0,0 +1,61 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#include "WorkerTask.h"
+#include <Arduino.h>
+#include <esp_log.h>
+
+#undef TAG
+static const char* TAG = "CORE";
+
+WorkerTask::WorkerTask(char const* name, uint32_t stackSize, UBaseType_t priority, BaseType_t core)
+    : _name(name)
+    , _stackSize(stackSize)
+    , _priority(priority)
+    , _core(core)
+{
+}
+
+WorkerTask::~WorkerTask()
+{
+    stop();
+}
+
+bool WorkerTask::start(Function function)
+{
+    if (_taskHandle != nullptr) { return false; }
+
+    _function = std::move(function);
+    _stop = false;
+    _taskDone = false;
+
+    if (pdPASS != xTaskCreatePinnedToCore(WorkerTask::loopHelper, _name,
+            _stackSize, this, _priority, &_taskHandle, _core)) {
+        ESP_LOGE(TAG, "Failed to create worker task %s", _name);
+        _taskHandle = nullptr;
+        return false;
+    }
+
+    return true;
+}
+
+void WorkerTask::stop()
+{
+    if (_taskHandle == nullptr) { return; }
+
+    _stop = true;
+
+    while (!_taskDone) { delay(10); }
+    _taskHandle = nullptr;
+}
+
+void WorkerTask::loopHelper(void* context)
+{
+    auto pInstance = static_cast<WorkerTask*>(context);
+
+    while (!pInstance->_stop) {
+        pInstance->_function();
+    }
+
+    pInstance->_taskDone = true;
+
+    vTaskDelete(nullptr);
+}
@@ -71,11 +71,17 @@ bool CanReceiver::init(char const* providerName)
             break;
     }
 
-    return true;
+    return _receiver.start(std::bind(&CanReceiver::receiveLoop, this));
 }
 
 void CanReceiver::deinit()
 {
+    _receiver.stop();
+
+    // frames received until now must not reach a provider started later
+    _rxQueue.clear();
+    _reportedDrops = 0;
+
     // Stop TWAI driver
     esp_err_t twaiLastResult = twai_stop();
     switch (twaiLastResult) {
@@ -99,38 +105,39 @@ void CanReceiver::deinit()
     }
 }
 
-void CanReceiver::loop()
+void CanReceiver::receiveLoop()
 {
-    // Check for messages. twai_receive is blocking when there is no data so we return if there are no frames in the buffer
-    twai_status_info_t status_info;
-    esp_err_t twaiLastResult = twai_get_status_info(&status_info);
+    // the timeout allows the worker to be stopped
+    twai_message_t rx_message;
+    esp_err_t twaiLastResult = twai_receive(&rx_message, pdMS_TO_TICKS(100));
+    if (twaiLastResult == ESP_ERR_TIMEOUT) { return; }
+
     if (twaiLastResult != ESP_OK) {
-        switch (twaiLastResult) {
-            case ESP_ERR_INVALID_ARG:
-                DTU_LOGE("TWAI driver get status - invalid arg");
-                break;
-            case ESP_ERR_INVALID_STATE:
-                DTU_LOGE("TWAI driver get status - invalid state");
-                break;
-        }
-        return;
-    }
-    if (status_info.msgs_to_rx == 0) {
+        DTU_LOGE("Failed to receive message");
+        vTaskDelay(pdMS_TO_TICKS(100));
         return;
     }
 
-    // Wait for message to be received, function is blocking
-    twai_message_t rx_message;
-    if (twai_receive(&rx_message, pdMS_TO_TICKS(100)) != ESP_OK) {
-        DTU_LOGE("Failed to receive message");
-        return;
+    _rxQueue.push(rx_message);
+}
+
+void CanReceiver::loop()
+{
+    uint32_t dropped = _rxQueue.getDropped();
+    if (dropped != _reportedDrops) {
+        DTU_LOGW("Receive queue full, dropped %" PRIu32 " message(s)", dropped - _reportedDrops);
+        _reportedDrops = dropped;
     }
 
-    DTU_LOGD("Received CAN message: 0x%04X (%d bytes)",
-            rx_message.identifier, rx_message.data_length_code);
-    LogHelper::dumpBytes(TAG, _providerName, rx_message.data, rx_message.data_length_code);
+    while (auto oRxMessage = _rxQueue.pop()) {
+        twai_message_t& rx_message = *oRxMessage;
 
-    onMessage(rx_message);
+        DTU_LOGD("Received CAN message: 0x%04X (%d bytes)",
+                rx_message.identifier, rx_message.data_length_code);
+        LogHelper::dumpBytes(TAG, _providerName, rx_message.data, rx_message.data_length_code);
+
+        onMessage(rx_message);
+    }
 }
 
 uint8_t CanReceiver::readUnsignedInt8(uint8_t *data)
@@ -0,0 +1,285 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#include <battery/CellVoltageHistory.h>
+#include <algorithm>
+
+namespace Batteries {
+
+CellVoltageHistory::CellVoltageHistory(size_t capacityBytes, uint32_t intervalSeconds)
+    : _capacityBytes(capacityBytes)
+    , _intervalSeconds(std::max<uint32_t>(intervalSeconds, 1))
+{
+}
+
+void CellVoltageHistory::configure(uint8_t cellCount)
+{
+    _cellCount = cellCount;
+    ++_generation;
+    _oldest = 0;
+    _used = 0;
+    _lastSpread = 0;
+
+    size_t perBlock = sizeof(BlockHeader)
+        + cellCount * (sizeof(uint16_t) * 3 + sizeof(uint32_t) + sizeof(int32_t))
+        + cellCount * (SamplesPerBlock - 1);
+
+    _blockCount = std::max<size_t>(_capacityBytes / perBlock, 2);
+
+    _headers.reset(new BlockHeader[_blockCount]);
+    _bases.reset(new uint16_t[_blockCount * cellCount]);
+    _deltas.reset(new int8_t[_blockCount * cellCount * (SamplesPerBlock - 1)]);
+    _mins.reset(new uint16_t[_blockCount * cellCount]);
+    _maxs.reset(new uint16_t[_blockCount * cellCount]);
+    _sums.reset(new uint32_t[_blockCount * cellCount]);
+    _imbalanceSums.reset(new int32_t[_blockCount * cellCount]);
+}
+
+void CellVoltageHistory::clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _oldest = 0;
+    _used = 0;
+    _lastSpread = 0;
+}
+
+size_t CellVoltageHistory::blockIndex(size_t age) const
+{
+    return (_oldest + age) % _blockCount;
+}
+
+void CellVoltageHistory::startBlock(uint32_t timestamp, CellVoltages const& cells)
+{
+    if (_used == _blockCount) {
+        _oldest = (_oldest + 1) % _blockCount;
+        --_used;
+    }
+
+    size_t idx = blockIndex(_used++);
+    _headers[idx] = { _nextSequence++, timestamp, 0, 0, 0, 1 };
+
+    size_t offset = idx * _cellCount;
+    for (uint8_t c = 0; c < _cellCount; ++c) {
+        _bases[offset + c] = cells.MilliVolt[c];
+        _mins[offset + c] = cells.MilliVolt[c];
+        _maxs[offset + c] = cells.MilliVolt[c];
+        _sums[offset + c] = 0;
+        _imbalanceSums[offset + c] = 0;
+    }
+}
+
+bool CellVoltageHistory::appendSample(CellVoltages const& cells)
+{
+    if (_used == 0) { return false; }
+
+    size_t idx = blockIndex(_used - 1);
+    auto& header = _headers[idx];
+    if (header.Samples >= SamplesPerBlock) { return false; }
+
+    for (uint8_t c = 0; c < _cellCount; ++c) {
+        int delta = cells.MilliVolt[c] - _lastMilliVolt[c];
+        if (delta < INT8_MIN || delta > INT8_MAX) { return false; }
+    }
+
+    int8_t* deltas = &_deltas[(idx * (SamplesPerBlock - 1) + header.Samples - 1) * _cellCount];
+    for (uint8_t c = 0; c < _cellCount; ++c) {
+        deltas[c] = static_cast<int8_t>(cells.MilliVolt[c] - _lastMilliVolt[c]);
+    }
+
+    ++header.Samples;
+    return true;
+}
+
+void CellVoltageHistory::observe(CellVoltages const& cells)
+{
+    size_t idx = blockIndex(_used - 1);
+    auto& header = _headers[idx];
+    size_t offset = idx * _cellCount;
+
+    int32_t avg = cells.getAvg();
+    uint16_t spread = cells.getMax() - cells.getMin();
+
+    for (uint8_t c = 0; c < _cellCount; ++c) {
+        uint16_t mv = cells.MilliVolt[c];
+        _mins[offset + c] = std::min(_mins[offset + c], mv);
+        _maxs[offset + c] = std::max(_maxs[offset + c], mv);
+        _sums[offset + c] += mv;
+        _imbalanceSums[offset + c] += mv - avg;
+    }
+
+    ++header.Observations;
+    header.SpreadSum += spread;
+    header.MaxSpread = std::max(header.MaxSpread, spread);
+    _lastSpread = spread;
+}
+
+bool CellVoltageHistory::add(uint32_t timestamp, CellVoltages const& cells)
+{
+    if (cells.Count == 0) { return false; }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (cells.Count != _cellCount) { configure(cells.Count); }
+
+    bool store = _used == 0 || timestamp - _lastStored >= _intervalSeconds;
+
+    if (store) {
+        // the timestamp of a sample is implied by its position within the
+        // block, hence gaps in the sequence of samples start a new block.
+        bool gap = _used > 0 && timestamp - _lastStored >= 2 * _intervalSeconds;
+        if (gap || !appendSample(cells)) {
+            startBlock(timestamp, cells);
+            _lastStored = timestamp;
+        } else {
+            // keep to the grid implied by the block's start, otherwise the
+            // reported timestamps drift by the lateness of every sample.
+            _lastStored += _intervalSeconds;
+        }
+
+        std::copy(cells.begin(), cells.end(), _lastMilliVolt.begin());
+    }
+
+    observe(cells);
+
+    return store;
+}
+
+uint8_t CellVoltageHistory::getCellCount() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _cellCount;
+}
+
+size_t CellVoltageHistory::getSampleCount() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    size_t res = 0;
+    for (size_t age = 0; age < _used; ++age) {
+        res += _headers[blockIndex(age)].Samples;
+    }
+    return res;
+}
+
+size_t CellVoltageHistory::getSampleCapacity() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _blockCount * SamplesPerBlock;
+}
+
+CellVoltageHistory::Summary CellVoltageHistory::getSummary() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    Summary res;
+    if (_used == 0) { return res; }
+
+    res.CellCount = _cellCount;
+    res.SpreadMilliVolt = _lastSpread;
+
+    uint64_t spreadSum = 0;
+    std::array<uint64_t, MaxCells> sums = {};
+    std::array<int64_t, MaxCells> imbalanceSums = {};
+
+    for (size_t age = 0; age < _used; ++age) {
+        size_t idx = blockIndex(age);
+        auto const& header = _headers[idx];
+        if (header.Observations == 0) { continue; }
+
+        bool first = res.Observations == 0;
+        res.Observations += header.Observations;
+        spreadSum += header.SpreadSum;
+        res.MaxSpreadMilliVolt = std::max(res.MaxSpreadMilliVolt, header.MaxSpread);
+
+        size_t offset = idx * _cellCount;
+        for (uint8_t c = 0; c < _cellCount; ++c) {
+            auto& cell = res.Cells[c];
+            cell.MinMilliVolt = first ? _mins[offset + c] : std::min(cell.MinMilliVolt, _mins[offset + c]);
+            cell.MaxMilliVolt = std::max(cell.MaxMilliVolt, _maxs[offset + c]);
+            sums[c] += _sums[offset + c];
+            imbalanceSums[c] += _imbalanceSums[offset + c];
+        }
+    }
+
+    if (res.Observations == 0) { return res; }
+
+    res.AvgSpreadMilliVolt = static_cast<uint16_t>(spreadSum / res.Observations);
+    for (uint8_t c = 0; c < _cellCount; ++c) {
+        res.Cells[c].AvgMilliVolt = static_cast<uint16_t>(sums[c] / res.Observations);
+        res.Cells[c].ImbalanceMilliVolt = static_cast<float>(imbalanceSums[c]) / res.Observations;
+    }
+
+    return res;
+}
+
+bool CellVoltageHistory::read(Cursor& cursor, Sample& sample) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (cursor.Generation == 0) {
+        cursor.Generation = _generation;
+    } else if (cursor.Generation != _generation) {
+        // the amount of cells changed, samples of the previous series are gone
+        return false;
+    }
+
+    if (_used == 0) { return false; }
+
+    uint32_t oldestSequence = _headers[_oldest].Sequence;
+    if (cursor.Block < oldestSequence) {
+        // not started yet or the block was evicted in the meantime
+        cursor.Block = oldestSequence;
+        cursor.Index = 0;
+        cursor.HasPrevious = false;
+    }
+
+    while (true) {
+        size_t age = cursor.Block - oldestSequence;
+        if (age >= _used) { return false; }
+
+        size_t idx = blockIndex(age);
+        auto const& header = _headers[idx];
+
+        if (cursor.Index < header.Samples) {
+            size_t offset = idx * _cellCount;
+
+            if (cursor.Index > 0 && !cursor.HasPrevious) {
+                // reconstruct the previous sample from the block's base
+                cursor.Previous.CellCount = _cellCount;
+                for (uint8_t c = 0; c < _cellCount; ++c) {
+                    cursor.Previous.MilliVolt[c] = _bases[offset + c];
+                }
+                for (uint8_t s = 1; s < cursor.Index; ++s) {
+                    int8_t const* deltas = &_deltas[(idx * (SamplesPerBlock - 1) + s - 1) * _cellCount];
+                    for (uint8_t c = 0; c < _cellCount; ++c) {
+                        cursor.Previous.MilliVolt[c] += deltas[c];
+                    }
+                }
+            }
+
+            sample.CellCount = _cellCount;
+            sample.Timestamp = header.Start + cursor.Index * _intervalSeconds;
+
+            if (cursor.Index == 0) {
+                for (uint8_t c = 0; c < _cellCount; ++c) {
+                    sample.MilliVolt[c] = _bases[offset + c];
+                }
+            } else {
+                int8_t const* deltas = &_deltas[(idx * (SamplesPerBlock - 1) + cursor.Index - 1) * _cellCount];
+                for (uint8_t c = 0; c < _cellCount; ++c) {
+                    sample.MilliVolt[c] = cursor.Previous.MilliVolt[c] + deltas[c];
+                }
+            }
+
+            cursor.Previous = sample;
+            cursor.HasPrevious = true;
+            ++cursor.Index;
+            return true;
+        }
+
+        if (age + 1 >= _used) { return false; }
+
+        ++cursor.Block;
+        cursor.Index = 0;
+        cursor.HasPrevious = false;
+    }
+}
+
+} // namespace Batteries
@@ -9,6 +9,7 @@
 #include <battery/victronsmartshunt/Provider.h>
 #include <battery/zendure/Provider.h>
 #include <Configuration.h>
+#include <TaskProfiler.h>
 #include <LogHelper.h>
 
 #undef TAG
@@ -34,7 +35,7 @@ std::shared_ptr<Stats const> Controller::getStats() const
 void Controller::init(Scheduler& scheduler)
 {
     scheduler.addTask(_loopTask);
-    _loopTask.setCallback(std::bind(&Controller::loop, this));
+    _loopTask.setCallback(TaskProfiler.wrap("Battery", std::bind(&Controller::loop, this)));
     _loopTask.setIterations(TASK_FOREVER);
     _loopTask.enable();
 
@@ -50,10 +51,10 @@ void Controller::updateSettings()
         _upProvider = nullptr;
     }
 
-    auto const& config = Configuration.get();
-    if (!config.Battery.Enabled) { return; }
+    auto const config = Configuration.get();
+    if (!config->Battery.Enabled) { return; }
 
-    switch (config.Battery.Provider) {
+    switch (config->Battery.Provider) {
         case 0:
             _upProvider = std::make_unique<Pylontech::Provider>();
             break;
@@ -79,7 +80,7 @@ void Controller::updateSettings()
             _upProvider = std::make_unique<Zendure::Provider>();
             break;
         default:
-            DTU_LOGE("Unknown provider: %d", config.Battery.Provider);
+            DTU_LOGE("Unknown provider: %d", config->Battery.Provider);
             return;
     }
 
@@ -102,9 +103,9 @@ void Controller::loop()
 
 float Controller::getDischargeCurrentLimit()
 {
-    auto const& config = Configuration.get();
+    auto const config = Configuration.get();
 
-    if (!config.Battery.EnableDischargeCurrentLimit) { return FLT_MAX; }
+    if (!config->Battery.EnableDischargeCurrentLimit) { return FLT_MAX; }
 
     /**
      * we are looking at two limits: (1) the static discharge current limit
@@ -120,13 +121,13 @@ float Controller::getDischargeCurrentLimit()
     auto spStats = getStats();
 
     auto getConfiguredLimit = [&config,&spStats]() -> float {
-        auto configuredLimit = config.Battery.DischargeCurrentLimit;
+        auto configuredLimit = config->Battery.DischargeCurrentLimit;
         if (configuredLimit <= 0.0f) { return FLT_MAX; } // invalid setting
 
-        bool useSoC = spStats->getSoCAgeSeconds() <= 60 && !config.PowerLimiter.IgnoreSoc;
+        bool useSoC = spStats->getSoCAgeSeconds() <= 60 && !config->PowerLimiter.IgnoreSoc;
 
         if (useSoC) {
-            auto threshold = config.Battery.DischargeCurrentLimitBelowSoc;
+            auto threshold = config->Battery.DischargeCurrentLimitBelowSoc;
             if (spStats->getSoC() >= threshold) { return FLT_MAX; }
 
             return configuredLimit;
@@ -134,7 +135,7 @@ float Controller::getDischargeCurrentLimit()
 
         bool voltageValid = spStats->getVoltageAgeSeconds() <= 60;
         if (voltageValid) {
-            auto threshold = config.Battery.DischargeCurrentLimitBelowVoltage;
+            auto threshold = config->Battery.DischargeCurrentLimitBelowVoltage;
             if (spStats->getVoltage() >= threshold) { return FLT_MAX; }
         }
 
@@ -142,7 +143,7 @@ float Controller::getDischargeCurrentLimit()
     };
 
     auto getBatteryLimit = [&config,&spStats]() -> float {
-        if (!config.Battery.UseBatteryReportedDischargeCurrentLimit) { return FLT_MAX; }
+        if (!config->Battery.UseBatteryReportedDischargeCurrentLimit) { return FLT_MAX; }
 
         if (spStats->getDischargeCurrentLimitAgeSeconds() > 60) { return FLT_MAX; } // unusable
 
@@ -4,6 +4,7 @@
 #include <battery/Stats.h>
 #include <battery/HassIntegration.h>
 #include <Configuration.h>
+#include <MqttHassPublisher.h>
 #include <MqttSettings.h>
 #include <MqttHandleHass.h>
 #include <Utils.h>
@@ -16,8 +17,8 @@ HassIntegration::HassIntegration(std::shared_ptr<Stats> spStats)
 
 void HassIntegration::hassLoop()
 {
-    auto const& config = Configuration.get();
-    if (!config.Mqtt.Hass.Enabled) { return; }
+    auto const config = Configuration.get();
+    if (!config->Mqtt.Hass.Enabled) { return; }
 
     // TODO(schlimmchen): this cannot make sure that transient
     // connection problems are actually always noticed.
@@ -26,13 +27,14 @@ void HassIntegration::hassLoop()
         return;
     }
 
-    if (!_publishSensors ||
-        !_spStats->getManufacturer().has_value() ||
-        !_spStats->getHassDeviceName().has_value()) { return; }
-
-    publishSensors();
+    if (_publishSensors &&
+        _spStats->getManufacturer().has_value() &&
+        _spStats->getHassDeviceName().has_value()) {
+        _pass.restart();
+        _publishSensors = false;
+    }
 
-    _publishSensors = false;
+    _pass.step([this]() { publishSensors(); });
 }
 
 void HassIntegration::publishSensors() const
@@ -49,21 +51,18 @@ void HassIntegration::publishSensor(const char* caption, const char* icon,
         const char* stateClass, const char* unitOfMeasurement,
         const bool enabled) const
 {
+    if (!_pass.claim()) { return; }
+
     String sensorId = sanitizeUniqueId(caption);
 
     String configTopic = "sensor/dtu_battery_" + _serial
         + "/" + sensorId
         + "/config";
 
-    String statTopic = MqttSettings.getPrefix() + "battery/";
-    // omit serial to avoid a breaking change
-    // statTopic.concat(_serial);
-    // statTopic.concat("/");
-    statTopic.concat(subTopic);
-
     JsonDocument root;
     root["name"] = caption;
-    root["stat_t"] = statTopic;
+    // omit serial to avoid a breaking change
+    MqttSettings.setHassStateTopic(root, "battery/", subTopic);
     root["uniq_id"] = _serial + "_" + sensorId;
 
     if (icon != NULL) {
@@ -81,7 +80,7 @@ void HassIntegration::publishSensor(const char* caption, const char* icon,
     JsonObject deviceObj = root["dev"].to<JsonObject>();
     createDeviceInfo(deviceObj);
 
-    if (Configuration.get().Mqtt.Hass.Expire) {
+    if (Configuration.get()->Mqtt.Hass.Expire) {
         root["exp_aft"] = _spStats->getMqttFullPublishIntervalMs() / 1000 * 3;
     }
     if (deviceClass != NULL) {
@@ -95,7 +94,7 @@ void HassIntegration::publishSensor(const char* caption, const char* icon,
         return;
     }
 
-    char buffer[512];
+    String buffer;
     serializeJson(root, buffer);
     publish(configTopic, buffer);
 
@@ -106,23 +105,20 @@ void HassIntegration::publishBinarySensor(const char* caption,
         const char* payload_on, const char* payload_off,
         const bool enabled) const
 {
+    if (!_pass.claim()) { return; }
+
     String sensorId = sanitizeUniqueId(caption);
 
     String configTopic = "binary_sensor/dtu_battery_" + _serial
         + "/" + sensorId
         + "/config";
 
-    String statTopic = MqttSettings.getPrefix() + "battery/";
-    // omit serial to avoid a breaking change
-    // statTopic.concat(_serial);
-    // statTopic.concat("/");
-    statTopic.concat(subTopic);
-
     JsonDocument root;
 
     root["name"] = caption;
     root["uniq_id"] = _serial + "_" + sensorId;
-    root["stat_t"] = statTopic;
+    // omit serial to avoid a breaking change
+    MqttSettings.setHassStateTopic(root, "battery/", subTopic);
     root["pl_on"] = payload_on;
     root["pl_off"] = payload_off;
 
@@ -141,7 +137,7 @@ void HassIntegration::publishBinarySensor(const char* caption,
         return;
     }
 
-    char buffer[512];
+    String buffer;
     serializeJson(root, buffer);
     publish(configTopic, buffer);
 }
@@ -159,9 +155,7 @@ void HassIntegration::createDeviceInfo(JsonObject& object) const
 
 void HassIntegration::publish(const String& subtopic, const String& payload) const
 {
-    String topic = Configuration.get().Mqtt.Hass.Topic;
-    topic += subtopic;
-    MqttSettings.publishGeneric(topic.c_str(), payload.c_str(), Configuration.get().Mqtt.Hass.Retain);
+    MqttHassPublisher.publish(subtopic, payload);
 }
 
 String HassIntegration::sanitizeUniqueId(const char* value) {
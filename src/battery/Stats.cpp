@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 #include <limits>
 #include <battery/Stats.h>
+#include <battery/CellVoltageHistory.h>
 #include <Configuration.h>
 #include <MqttSettings.h>
 
@@ -19,6 +20,14 @@ void Stats::setManufacturer(const String& m)
     _oManufacturer = std::move(sanitized);
 }
 
+std::shared_ptr<CellVoltageHistory> Stats::createCellVoltageHistory()
+{
+    // one sample every five minutes. without PSRAM, this covers roughly
+    // three and a half days of a 16 cell battery.
+    size_t capacity = psramFound() ? 128 * 1024 : 24 * 1024;
+    return std::make_shared<CellVoltageHistory>(capacity, 5 * 60);
+}
+
 bool Stats::updateAvailable(uint32_t since) const
 {
     if (_lastUpdate == 0) { return false; } // no data at all processed yet
@@ -69,55 +78,63 @@ void Stats::getLiveViewData(JsonVariant& root) const
 
 void Stats::mqttLoop()
 {
-    auto& config = Configuration.get();
+    auto const config = Configuration.get();
 
     if (!MqttSettings.getConnected()
-            || (millis() - _lastMqttPublish) < (config.Mqtt.PublishInterval * 1000)) {
+            || (millis() - _lastMqttPublish) < (config->Mqtt.PublishInterval * 1000)) {
         return;
     }
 
-    mqttPublish();
+    {
+        MqttBatch batch("battery/");
+        mqttPublish();
+    }
 
     _lastMqttPublish = millis();
 }
 
 uint32_t Stats::getMqttFullPublishIntervalMs() const
 {
-    auto& config = Configuration.get();
+    auto const config = Configuration.get();
 
     // this is the default interval, see mqttLoop(). mqttPublish()
     // implementations in derived classes may choose to publish some values
     // with a lower frequency and hence implement this method with a different
     // return value.
-    return config.Mqtt.PublishInterval * 1000;
+    return config->Mqtt.PublishInterval * 1000;
 }
 
 void Stats::mqttPublish() const
 {
+    auto publish = [](const char* subtopic, const MqttValue& value) {
+        MqttTopic topic;
+        MqttSettings.publish(topic.append("battery/").append(subtopic), value);
+    };
+
     if (_oManufacturer.has_value()) {
-        MqttSettings.publish("battery/manufacturer", *_oManufacturer);
+        publish("manufacturer", *_oManufacturer);
     }
 
-    MqttSettings.publish("battery/dataAge", String(getAgeSeconds()));
+    publish("dataAge", getAgeSeconds());
 
     if (isSoCValid()) {
-        MqttSettings.publish("battery/stateOfCharge", String(_soc));
+        publish("stateOfCharge", _soc);
     }
 
     if (isVoltageValid()) {
-        MqttSettings.publish("battery/voltage", String(_voltage));
+        publish("voltage", _voltage);
     }
 
     if (isCurrentValid()) {
-        MqttSettings.publish("battery/current", String(_current));
+        publish("current", _current);
     }
 
     if (isDischargeCurrentLimitValid()) {
-        MqttSettings.publish("battery/settings/dischargeCurrentLimitation", String(_dischargeCurrentLimit));
+        publish("settings/dischargeCurrentLimitation", _dischargeCurrentLimit);
     }
 
     if (isChargeCurrentLimitValid()) {
-        MqttSettings.publish("battery/settings/chargeCurrentLimitation", String(_chargeCurrentLimit));
+        publish("settings/chargeCurrentLimitation", _chargeCurrentLimit);
     }
 }
 
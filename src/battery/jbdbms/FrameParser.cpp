@@ -0,0 +1,189 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <battery/jbdbms/FrameParser.h>
+
+namespace Batteries::JbdBms {
+
+namespace {
+
+/**
+ * reads consecutive values from a frame. reading beyond the end of the frame
+ * yields zeroes, which only happens for frames that are too short for the
+ * respective command.
+ */
+class FrameReader {
+public:
+    FrameReader(tFrameBuffer const& frame, size_t pos)
+        : _frame(frame), _pos(pos) { }
+
+    template<typename T>
+    T get()
+    {
+        T res = _frame.template get<T>(_pos);
+        _pos += sizeof(T);
+        return res;
+    }
+
+    int16_t getTemperature()
+    {
+        // raw in 0.1K
+        uint16_t raw = get<uint16_t>();
+        return static_cast<int16_t>(raw - 2731) / 10;
+    }
+
+    void getProductionDate(FixedString<10>& dst)
+    {
+        // E.g. 0x2068 = 08.03.2016
+        // the date is the lowest 5: 0x2028 & 0x1f = 8 means the date;
+        // month (0x2068>>5) & 0x0f = 0x03 means March;
+        // the year is 2000+ (0x2068>>9) = 2000 + 0x10 =2016;
+        uint16_t raw = get<uint16_t>();
+
+        unsigned day = raw & 0x1f;
+        unsigned month = (raw>>5) & 0x0f;
+        unsigned year = 2000 + (raw>>9);
+        snprintf(dst.buffer(), dst.capacity() + 1, "%02u.%02u.%04u", day, month, year);
+        dst.resize(strlen(dst.buffer()));
+    }
+
+    void getSoftwareVersion(FixedString<5>& dst)
+    {
+        uint8_t softwareVersion = get<uint8_t>();
+        uint8_t digitOne = softwareVersion & 0x0F;
+        uint8_t digitTwo = softwareVersion >> 4;
+        snprintf(dst.buffer(), dst.capacity() + 1, "%d.%d", digitOne, digitTwo);
+        dst.resize(strlen(dst.buffer()));
+    }
+
+    template<size_t N>
+    void getString(FixedString<N>& dst, size_t len)
+    {
+        size_t avail = (_pos < _frame.size()) ? _frame.size() - _pos : 0;
+        len = std::min(len, avail);
+
+        dst.resize(len);
+        char* out = dst.buffer();
+        for (size_t i = 0; i < dst.size(); ++i) {
+            out[i] = static_cast<char>(_frame[_pos + i]);
+        }
+
+        _pos += len;
+    }
+
+private:
+    tFrameBuffer const& _frame;
+    size_t _pos;
+};
+
+uint16_t calcChecksum(tFrameBuffer const& frame)
+{
+    uint16_t sum = 0;
+    for (size_t i = 2; i < frame.size() - 3; ++i) { sum += frame[i]; }
+    return ~sum + 0x01;
+}
+
+} // namespace
+
+char const* FrameParser::getResultText(Result result)
+{
+    switch (result) {
+        case Result::Ok: return "ok";
+        case Result::InvalidStartMarker: return "invalid start marker";
+        case Result::InvalidDataLength: return "unexpected data length";
+        case Result::InvalidEndMarker: return "invalid end marker";
+        case Result::InvalidChecksum: return "invalid checksum";
+        case Result::InvalidStatus: return "invalid status";
+    }
+    return "programmer error: missing result text";
+}
+
+FrameParser::Result FrameParser::validate(tFrameBuffer const& frame)
+{
+    if (frame.size() < SerialMessage::overhead) { return Result::InvalidDataLength; }
+
+    if (frame[0] != SerialMessage::startMarker) { return Result::InvalidStartMarker; }
+
+    if (frame[3] != frame.size() - SerialMessage::overhead) { return Result::InvalidDataLength; }
+
+    if (frame[frame.size() - 1] != SerialMessage::endMarker) { return Result::InvalidEndMarker; }
+
+    uint16_t actualChecksum = frame.get<uint16_t>(frame.size() - 3);
+    if (actualChecksum != calcChecksum(frame)) { return Result::InvalidChecksum; }
+
+    if (frame[2] != static_cast<uint8_t>(Status::Ok)) { return Result::InvalidStatus; }
+
+    return Result::Ok;
+}
+
+FrameParser::Result FrameParser::parse(tFrameBuffer const& frame, Snapshot& snapshot)
+{
+    using Label = JbdBms::DataPointLabel;
+    using Command = SerialMessage::Command;
+
+    snapshot.clear();
+
+    auto result = validate(frame);
+    if (result != Result::Ok) { return result; }
+
+    uint8_t dataLength = frame[3];
+    if (dataLength == 0) { return result; }
+
+    FrameReader in(frame, 4); // start of data content
+
+    switch (getCommand(frame)) {
+        case Command::ReadBasicInformation:
+        {
+            snapshot.set<Label::BatteryVoltageMilliVolt>(static_cast<uint32_t>(in.get<uint16_t>()) * 10); // Total voltage
+            snapshot.set<Label::BatteryCurrentMilliAmps>(static_cast<int32_t>(in.get<int16_t>()) * 10); // Current
+            snapshot.set<Label::ActualBatteryCapacityAmpHours>(static_cast<uint32_t>(in.get<uint16_t>()) * 10 / 1000); // remaining capacity
+            snapshot.set<Label::BatteryCapacitySettingAmpHours>(static_cast<uint32_t>(in.get<uint16_t>()) * 10 / 1000); // nominal capacity
+            snapshot.set<Label::BatteryCycles>(in.get<uint16_t>());
+            in.getProductionDate(snapshot.emplace<Label::DateOfManufacturing>());
+
+            bool balancingEnabled = false;
+            balancingEnabled |= static_cast<bool>(in.get<uint16_t>()); // Equilibrium
+            balancingEnabled |= static_cast<bool>(in.get<uint16_t>()); // Equilibrium_High
+            snapshot.set<Label::BalancingEnabled>(balancingEnabled);
+
+            snapshot.set<Label::AlarmsBitmask>(in.get<uint16_t>()); // Protection status
+
+            in.getSoftwareVersion(snapshot.emplace<Label::BmsSoftwareVersion>());
+
+            snapshot.set<Label::BatterySoCPercent>(in.get<uint8_t>()); // RSOC
+
+            uint8_t fetControl = in.get<uint8_t>(); // FET control status
+            const uint8_t chargingMask = (1 << 0);
+            const uint8_t dischargingMask = (1 << 1);
+            snapshot.set<Label::BatteryChargeEnabled>(static_cast<bool>(fetControl & chargingMask));
+            snapshot.set<Label::BatteryDischargeEnabled>(static_cast<bool>(fetControl & dischargingMask));
+
+            snapshot.set<Label::BatteryCellAmount>(static_cast<uint16_t>(in.get<uint8_t>())); // number of battery strings
+            snapshot.set<Label::BatteryTemperatureSensorAmount>(in.get<uint8_t>()); // number of ntc
+            snapshot.set<Label::BatteryTempOneCelsius>(in.getTemperature()); // ntc temperature one
+            snapshot.set<Label::BatteryTempTwoCelsius>(in.getTemperature()); // ntc temperature two
+            break;
+        }
+        case Command::ReadCellVoltages:
+        {
+            uint8_t cellAmount = dataLength / 2;
+            auto& voltages = snapshot.emplace<Label::CellsMilliVolt>();
+            voltages.clear();
+            for (size_t cellCounter = 0; cellCounter < cellAmount; ++cellCounter) {
+                voltages.add(in.get<uint16_t>());
+            }
+            break;
+        }
+        case Command::ReadHardwareVersionNumber:
+            in.getString(snapshot.emplace<Label::BmsHardwareVersion>(), dataLength);
+            break;
+        default:
+            /* ControlMosInstruction response doesn't contain any data content */
+            break;
+    }
+
+    return result;
+}
+
+} // namespace Batteries::JbdBms
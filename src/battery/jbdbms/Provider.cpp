@@ -76,9 +76,9 @@ void Provider::deinit()
 
 Provider::Interface Provider::getInterface() const
 {
-    auto const& config = Configuration.get();
-    if (0x00 == config.Battery.Serial.Interface) { return Interface::Uart; }
-    if (0x01 == config.Battery.Serial.Interface) { return Interface::Transceiver; }
+    auto const config = Configuration.get();
+    if (0x00 == config->Battery.Serial.Interface) { return Interface::Uart; }
+    if (0x01 == config->Battery.Serial.Interface) { return Interface::Transceiver; }
     return Interface::Invalid;
 }
 
@@ -164,8 +164,8 @@ void Provider::sendRequest(uint8_t pollInterval)
 
 void Provider::loop()
 {
-    auto const& config = Configuration.get();
-    uint8_t pollInterval = config.Battery.Serial.PollingInterval;
+    auto const config = Configuration.get();
+    uint8_t pollInterval = config->Battery.Serial.PollingInterval;
 
     while (_upSerial->available()) {
         rxData(_upSerial->read());
@@ -181,7 +181,10 @@ void Provider::loop()
 
 void Provider::rxData(uint8_t inbyte)
 {
-    _buffer.push_back(inbyte);
+    if (!_buffer.push(inbyte)) {
+        DTU_LOGW("frame exceeds %d bytes, discarding it", _buffer.capacity());
+        return reset();
+    }
 
     switch(_readState) {
         case ReadState::Idle: // unsolicited message from BMS
@@ -238,31 +241,37 @@ void Provider::frameComplete()
     announceStatus(Status::FrameCompleted);
 
     DTU_LOGD("received message with %d bytes", _buffer.size());
-    LogHelper::dumpBytes(TAG, SUBTAG, _buffer.data(), _buffer.size());
+    _buffer.forEachSegment([](uint8_t const* data, size_t len) {
+        LogHelper::dumpBytes(TAG, SUBTAG, data, len);
+    });
 
-    auto pResponse = std::make_unique<SerialResponse>(std::move(_buffer));
-    if (pResponse->isValid()) {
-        processDataPoints(pResponse->getDataPoints());
-    } // if invalid, error message has been produced by SerialResponse c'tor
+    auto result = FrameParser::parse(_buffer, _snapshot);
+    if (result != FrameParser::Result::Ok) {
+        DTU_LOGE("%s", FrameParser::getResultText(result));
+    }
+    else if (!_snapshot.empty()) {
+        processDataPoints();
+    }
 
     reset();
 }
 
-void Provider::processDataPoints(DataPointContainer const& dataPoints)
+void Provider::processDataPoints()
 {
-    _stats->updateFrom(dataPoints);
+    _stats->updateFrom(_snapshot);
 
     if (!DTU_LOG_IS_DEBUG) { return; }
 
-    auto iter = dataPoints.cbegin();
-    while ( iter != dataPoints.cend() ) {
-        DTU_LOGD("[%11.3f] %s: %s%s",
-            static_cast<double>(iter->second.getTimestamp())/1000,
-            iter->second.getLabelText().c_str(),
-            iter->second.getValueText().c_str(),
-            iter->second.getUnitText().c_str());
-        ++iter;
+    using Label = JbdBms::DataPointLabel;
+    char value[256];
+
+#define LOG_DATA_POINT(n, t, u) \
+    if (_snapshot.has<Label::n>()) { \
+        formatDataPointValue(value, sizeof(value), _snapshot.ref<Label::n>()); \
+        DTU_LOGD("%s: %s%s", #n, value, u); \
     }
+    JBDBMS_DATA_POINTS(LOG_DATA_POINT)
+#undef LOG_DATA_POINT
 }
 
 } // namespace Batteries::JbdBms
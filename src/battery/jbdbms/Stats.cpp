@@ -1,8 +1,7 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 #include <algorithm>
-#include <string>
-#include <vector>
 #include <MqttSettings.h>
+#include <Utils.h>
 #include <battery/jbdbms/Stats.h>
 #include <battery/jbdbms/DataPoints.h>
 
@@ -14,30 +13,30 @@ void Stats::getJsonData(JsonVariant& root, bool verbose) const
 
     using Label = JbdBms::DataPointLabel;
 
-    auto oCurrent = _dataPoints.get<Label::BatteryCurrentMilliAmps>();
-    auto oVoltage = _dataPoints.get<Label::BatteryVoltageMilliVolt>();
+    auto oCurrent = _snapshot.get<Label::BatteryCurrentMilliAmps>();
+    auto oVoltage = _snapshot.get<Label::BatteryVoltageMilliVolt>();
     if (oVoltage.has_value() && oCurrent.has_value()) {
         auto current = static_cast<float>(*oCurrent) / 1000;
         auto voltage = static_cast<float>(*oVoltage) / 1000;
         addLiveViewValue(root, "power", current * voltage , "W", 2);
     }
 
-    auto oBatteryChargeEnabled = _dataPoints.get<Label::BatteryChargeEnabled>();
+    auto oBatteryChargeEnabled = _snapshot.get<Label::BatteryChargeEnabled>();
     if (oBatteryChargeEnabled.has_value()) {
         addLiveViewTextValue(root, "chargeEnabled", (*oBatteryChargeEnabled?"yes":"no"));
     }
 
-    auto oBatteryDischargeEnabled = _dataPoints.get<Label::BatteryDischargeEnabled>();
+    auto oBatteryDischargeEnabled = _snapshot.get<Label::BatteryDischargeEnabled>();
     if (oBatteryDischargeEnabled.has_value()) {
         addLiveViewTextValue(root, "dischargeEnabled", (*oBatteryDischargeEnabled?"yes":"no"));
     }
 
-    auto oTemperatureOne = _dataPoints.get<Label::BatteryTempOneCelsius>();
+    auto oTemperatureOne = _snapshot.get<Label::BatteryTempOneCelsius>();
     if (oTemperatureOne.has_value()) {
         addLiveViewInSection(root, "cells", "batOneTemp", *oTemperatureOne, "°C", 0);
     }
 
-    auto oTemperatureTwo = _dataPoints.get<Label::BatteryTempTwoCelsius>();
+    auto oTemperatureTwo = _snapshot.get<Label::BatteryTempTwoCelsius>();
     if (oTemperatureTwo.has_value()) {
         addLiveViewInSection(root, "cells", "batTwoTemp", *oTemperatureTwo, "°C", 0);
     }
@@ -49,12 +48,12 @@ void Stats::getJsonData(JsonVariant& root, bool verbose) const
         addLiveViewInSection(root, "cells", "cellDiffVoltage", (_cellMaxMilliVolt - _cellMinMilliVolt), "mV", 0);
     }
 
-    auto oBalancingEnabled = _dataPoints.get<Label::BalancingEnabled>();
+    auto oBalancingEnabled = _snapshot.get<Label::BalancingEnabled>();
     if (oBalancingEnabled.has_value()) {
         addLiveViewTextInSection(root, "cells", "balancingActive", (*oBalancingEnabled?"yes":"no"));
     }
 
-    auto oAlarms = _dataPoints.get<Label::AlarmsBitmask>();
+    auto oAlarms = _snapshot.get<Label::AlarmsBitmask>();
     if (oAlarms.has_value()) {
 #define ISSUE(t, x) \
         auto x = *oAlarms & static_cast<uint16_t>(JbdBms::AlarmBits::x); \
@@ -81,43 +80,54 @@ void Stats::getJsonData(JsonVariant& root, bool verbose) const
     }
 }
 
-void Stats::mqttPublish() const
+template<DataPointLabel L>
+void Stats::publishDataPoint(bool fullPublish) const
 {
-    ::Batteries::Stats::mqttPublish();
-
     using Label = JbdBms::DataPointLabel;
 
-    static std::vector<Label> mqttSkip = {
+    static constexpr std::array<Label, 3> mqttSkip = {
         Label::CellsMilliVolt, // complex data format
         Label::BatteryVoltageMilliVolt, // already published by base class
         Label::BatterySoCPercent // already published by base class
     };
 
+    if (!_snapshot.has<L>()) { return; }
+
+    // skip data points that did not change since last published
+    using Traits = DataPointLabelTraits<L>;
+    if (!fullPublish && _timestamps[Traits::index] < _lastMqttPublish) { return; }
+
+    if (std::find(mqttSkip.begin(), mqttSkip.end(), L) != mqttSkip.end()) { return; }
+
+    char value[32];
+    formatDataPointValue(value, sizeof(value), _snapshot.ref<L>());
+    MqttSettings.publish(String("battery/") + Traits::name, value);
+}
+
+void Stats::mqttPublish() const
+{
+    ::Batteries::Stats::mqttPublish();
+
+    using Label = JbdBms::DataPointLabel;
+
     // regularly publish all topics regardless of whether or not their value changed
     bool neverFullyPublished = _lastFullMqttPublish == 0;
     bool intervalElapsed = _lastFullMqttPublish + getMqttFullPublishIntervalMs() < millis();
     bool fullPublish = neverFullyPublished || intervalElapsed;
 
-    for (auto iter = _dataPoints.cbegin(); iter != _dataPoints.cend(); ++iter) {
-        // skip data points that did not change since last published
-        if (!fullPublish && iter->second.getTimestamp() < _lastMqttPublish) { continue; }
+#define PUBLISH_DATA_POINT(n, t, u) publishDataPoint<Label::n>(fullPublish);
+    JBDBMS_DATA_POINTS(PUBLISH_DATA_POINT)
+#undef PUBLISH_DATA_POINT
 
-        auto skipMatch = std::find(mqttSkip.begin(), mqttSkip.end(), iter->first);
-        if (skipMatch != mqttSkip.end()) { continue; }
-
-        String topic((std::string("battery/") + iter->second.getLabelText()).c_str());
-        MqttSettings.publish(topic, iter->second.getValueText().c_str());
-    }
-
-    auto oCellVoltages = _dataPoints.get<Label::CellsMilliVolt>();
-    if (oCellVoltages.has_value() && (fullPublish || _cellVoltageTimestamp > _lastMqttPublish)) {
+    auto const& cellVoltages = _snapshot.ref<Label::CellsMilliVolt>();
+    if (_snapshot.has<Label::CellsMilliVolt>() && (fullPublish || _cellVoltageTimestamp > _lastMqttPublish)) {
         unsigned idx = 1;
-        for (auto iter = oCellVoltages->cbegin(); iter != oCellVoltages->cend(); ++iter) {
+        for (auto cellMilliVolt : cellVoltages) {
             String topic("battery/Cell");
             topic += String(idx);
             topic += "MilliVolt";
 
-            MqttSettings.publish(topic, String(iter->second));
+            MqttSettings.publish(topic, String(cellMilliVolt));
 
             ++idx;
         }
@@ -128,7 +138,7 @@ void Stats::mqttPublish() const
         MqttSettings.publish("battery/CellDiffMilliVolt", String(_cellMaxMilliVolt - _cellMinMilliVolt));
     }
 
-    auto oAlarms = _dataPoints.get<Label::AlarmsBitmask>();
+    auto oAlarms = _snapshot.get<Label::AlarmsBitmask>();
     if (oAlarms.has_value()) {
         for (auto iter = JbdBms::AlarmBitTexts.begin(); iter != JbdBms::AlarmBitTexts.end(); ++iter) {
             auto bit = iter->first;
@@ -141,60 +151,63 @@ void Stats::mqttPublish() const
     if (fullPublish) { _lastFullMqttPublish = _lastMqttPublish; }
 }
 
-void Stats::updateFrom(JbdBms::DataPointContainer const& dp)
+template<DataPointLabel L>
+bool Stats::merge(Snapshot const& snapshot, uint32_t timestamp)
+{
+    if (!_snapshot.mergeFrom<L>(snapshot)) { return false; }
+    _timestamps[DataPointLabelTraits<L>::index] = timestamp;
+    return true;
+}
+
+void Stats::updateFrom(Snapshot const& snapshot)
 {
     using Label = JbdBms::DataPointLabel;
 
-    setManufacturer("JBDBMS");
+    uint32_t now = millis();
+    if (now == 0) { now = 1; } // zero means "never updated"
+
+    if (!getManufacturer().has_value()) { setManufacturer("JBDBMS"); }
 
-    auto oSoCValue = dp.get<Label::BatterySoCPercent>();
+    auto oSoCValue = snapshot.get<Label::BatterySoCPercent>();
     if (oSoCValue.has_value()) {
-        auto oSoCDataPoint = dp.getDataPointFor<Label::BatterySoCPercent>();
-        ::Batteries::Stats::setSoC(*oSoCValue, 0/*precision*/,
-                oSoCDataPoint->getTimestamp());
+        ::Batteries::Stats::setSoC(*oSoCValue, 0/*precision*/, now);
     }
 
-    auto oVoltage = dp.get<Label::BatteryVoltageMilliVolt>();
+    auto oVoltage = snapshot.get<Label::BatteryVoltageMilliVolt>();
     if (oVoltage.has_value()) {
-        auto oVoltageDataPoint = dp.getDataPointFor<Label::BatteryVoltageMilliVolt>();
-        ::Batteries::Stats::setVoltage(static_cast<float>(*oVoltage) / 1000,
-                oVoltageDataPoint->getTimestamp());
+        ::Batteries::Stats::setVoltage(static_cast<float>(*oVoltage) / 1000, now);
     }
 
-    auto oCurrent = dp.get<Label::BatteryCurrentMilliAmps>();
+    auto oCurrent = snapshot.get<Label::BatteryCurrentMilliAmps>();
     if (oCurrent.has_value()) {
-        auto oCurrentDataPoint = dp.getDataPointFor<Label::BatteryCurrentMilliAmps>();
-        ::Batteries::Stats::setCurrent(static_cast<float>(*oCurrent) / 1000, 2/*precision*/,
-                oCurrentDataPoint->getTimestamp());
-    }
-
-    _dataPoints.updateFrom(dp);
-
-    auto oCellVoltages = _dataPoints.get<Label::CellsMilliVolt>();
-    if (oCellVoltages.has_value()) {
-        for (auto iter = oCellVoltages->cbegin(); iter != oCellVoltages->cend(); ++iter) {
-            if (iter == oCellVoltages->cbegin()) {
-                _cellMinMilliVolt = _cellAvgMilliVolt = _cellMaxMilliVolt = iter->second;
-                continue;
-            }
-            _cellMinMilliVolt = std::min(_cellMinMilliVolt, iter->second);
-            _cellAvgMilliVolt = (_cellAvgMilliVolt + iter->second) / 2;
-            _cellMaxMilliVolt = std::max(_cellMaxMilliVolt, iter->second);
-        }
-        _cellVoltageTimestamp = millis();
+        ::Batteries::Stats::setCurrent(static_cast<float>(*oCurrent) / 1000, 2/*precision*/, now);
+    }
+
+    if (merge<Label::BmsSoftwareVersion>(snapshot, now)) {
+        _fwversion = _snapshot.BmsSoftwareVersion.c_str();
     }
 
-    auto oSoftwareVersion = _dataPoints.get<Label::BmsSoftwareVersion>();
-    if (oSoftwareVersion.has_value()) {
-        _fwversion = oSoftwareVersion->c_str();
+    if (merge<Label::BmsHardwareVersion>(snapshot, now)) {
+        _hwversion = _snapshot.BmsHardwareVersion.c_str();
+    }
+
+#define MERGE_DATA_POINT(n, t, u) merge<Label::n>(snapshot, now);
+    JBDBMS_DATA_POINTS(MERGE_DATA_POINT)
+#undef MERGE_DATA_POINT
+
+    if (_snapshot.has<Label::CellsMilliVolt>()) {
+        auto const& cellVoltages = _snapshot.ref<Label::CellsMilliVolt>();
+        _cellMinMilliVolt = cellVoltages.getMin();
+        _cellAvgMilliVolt = cellVoltages.getAvg();
+        _cellMaxMilliVolt = cellVoltages.getMax();
+        _cellVoltageTimestamp = now;
     }
 
-    auto oHardwareVersion = _dataPoints.get<Label::BmsHardwareVersion>();
-    if (oHardwareVersion.has_value()) {
-        _hwversion = oHardwareVersion->c_str();
+    if (snapshot.has<Label::CellsMilliVolt>()) {
+        _spCellHistory->add(Utils::getUptimeSeconds(), snapshot.ref<Label::CellsMilliVolt>());
     }
 
-    _lastUpdate = millis();
+    _lastUpdate = now;
 }
 
 } // namespace Batteries::JbdBms
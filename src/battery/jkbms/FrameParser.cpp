@@ -0,0 +1,346 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#include <algorithm>
+#include <battery/jkbms/FrameParser.h>
+#include <battery/jkbms/SerialMessage.h>
+
+namespace Batteries::JkBms {
+
+namespace {
+
+/**
+ * reads consecutive values from a frame. reading beyond the end of the frame
+ * yields zeroes, as the frame was validated before and the field lengths are
+ * fixed, this only happens for truncated frames.
+ */
+class FrameReader {
+public:
+    FrameReader(tFrameBuffer const& frame, size_t pos)
+        : _frame(frame), _pos(pos) { }
+
+    size_t position() const { return _pos; }
+
+    void skip(size_t len) { _pos += len; }
+
+    template<typename T>
+    T get()
+    {
+        T res = _frame.template get<T>(_pos);
+        _pos += sizeof(T);
+        return res;
+    }
+
+    bool getBool() { return get<uint8_t>() > 0; }
+
+    int16_t getTemperature()
+    {
+        uint16_t raw = get<uint16_t>();
+        if (raw <= 100) { return static_cast<int16_t>(raw); }
+        return static_cast<int16_t>(raw - 100) * (-1);
+    }
+
+    template<size_t N>
+    void getString(FixedString<N>& dst, size_t len, bool replaceZeroes = false)
+    {
+        size_t avail = (_pos < _frame.size()) ? _frame.size() - _pos : 0;
+        len = std::min(len, avail);
+
+        dst.resize(len);
+        char* out = dst.buffer();
+        for (size_t i = 0; i < dst.size(); ++i) {
+            char c = static_cast<char>(_frame[_pos + i]);
+            if (replaceZeroes && c == 0) { c = 0x20; } // replace by ASCII space
+            out[i] = c;
+        }
+
+        _pos += len;
+    }
+
+private:
+    tFrameBuffer const& _frame;
+    size_t _pos;
+};
+
+void processBatteryCurrent(uint16_t raw, uint8_t protocolVersion, Snapshot& snapshot)
+{
+    using Label = JkBms::DataPointLabel;
+
+    if (0x00 == protocolVersion) {
+        // untested!
+        snapshot.set<Label::BatteryCurrentMilliAmps>((static_cast<int32_t>(10000) - raw) * 10);
+        return;
+    }
+
+    if (0x01 == protocolVersion) {
+        bool charging = (raw & 0x8000) > 0;
+        snapshot.set<Label::BatteryCurrentMilliAmps>(static_cast<int32_t>(raw & 0x7FFF) * (charging ? 10 : -10));
+    }
+
+    // cannot decode battery current field without knowing the protocol version
+}
+
+} // namespace
+
+char const* FrameParser::getResultText(Result result)
+{
+    switch (result) {
+        case Result::Ok: return "ok";
+        case Result::InvalidStartMarker: return "invalid start marker";
+        case Result::InvalidFrameLength: return "unexpected frame length";
+        case Result::InvalidEndMarker: return "invalid end marker";
+        case Result::InvalidChecksum: return "invalid checksum";
+        case Result::UnknownFieldType: return "unknown field type";
+    }
+    return "programmer error: missing result text";
+}
+
+FrameParser::Result FrameParser::validate(tFrameBuffer const& frame) const
+{
+    if (frame.size() < SerialMessage::overhead) { return Result::InvalidFrameLength; }
+
+    if (frame.get<uint16_t>(0) != SerialMessage::startMarker) {
+        return Result::InvalidStartMarker;
+    }
+
+    if (frame.get<uint16_t>(2) != frame.size() - 2) {
+        return Result::InvalidFrameLength;
+    }
+
+    if (frame[frame.size() - 5] != SerialMessage::endMarker) {
+        return Result::InvalidEndMarker;
+    }
+
+    uint16_t expectedChecksum = 0;
+    for (size_t i = 0; i < frame.size() - 4; ++i) { expectedChecksum += frame[i]; }
+    if (frame.get<uint16_t>(frame.size() - 2) != expectedChecksum) {
+        return Result::InvalidChecksum;
+    }
+
+    return Result::Ok;
+}
+
+FrameParser::Result FrameParser::parse(tFrameBuffer const& frame, Snapshot& snapshot)
+{
+    using Label = JkBms::DataPointLabel;
+
+    snapshot.clear();
+
+    auto result = validate(frame);
+    if (result != Result::Ok) { return result; }
+
+    // the variable field starts after the command, source and type bytes,
+    // and ends before the record number, end marker and checksum.
+    FrameReader in(frame, 11);
+    size_t end = frame.size() - 9;
+
+    while (in.position() < end) {
+        uint8_t fieldType = in.get<uint8_t>();
+
+        /**
+         * there seems to be no way to make this more generic. the main reason
+         * is that a non-constexpr value (fieldType cast as Label) cannot be
+         * used as a template parameter.
+         */
+        switch (fieldType) {
+            case 0x79:
+            {
+                uint8_t cellAmount = in.get<uint8_t>() / 3;
+                auto& voltages = snapshot.emplace<Label::CellsMilliVolt>();
+                voltages.clear();
+                for (size_t cellCounter = 0; cellCounter < cellAmount; ++cellCounter) {
+                    in.skip(1); // cell index
+                    voltages.add(in.get<uint16_t>());
+                }
+                break;
+            }
+            case 0x80:
+                snapshot.set<Label::BmsTempCelsius>(in.getTemperature());
+                break;
+            case 0x81:
+                snapshot.set<Label::BatteryTempOneCelsius>(in.getTemperature());
+                break;
+            case 0x82:
+                snapshot.set<Label::BatteryTempTwoCelsius>(in.getTemperature());
+                break;
+            case 0x83:
+                snapshot.set<Label::BatteryVoltageMilliVolt>(static_cast<uint32_t>(in.get<uint16_t>()) * 10);
+                break;
+            case 0x84:
+                processBatteryCurrent(in.get<uint16_t>(), _protocolVersion, snapshot);
+                break;
+            case 0x85:
+                snapshot.set<Label::BatterySoCPercent>(in.get<uint8_t>());
+                break;
+            case 0x86:
+                snapshot.set<Label::BatteryTemperatureSensorAmount>(in.get<uint8_t>());
+                break;
+            case 0x87:
+                snapshot.set<Label::BatteryCycles>(in.get<uint16_t>());
+                break;
+            case 0x89:
+                snapshot.set<Label::BatteryCycleCapacity>(in.get<uint32_t>());
+                break;
+            case 0x8a:
+                snapshot.set<Label::BatteryCellAmount>(in.get<uint16_t>());
+                break;
+            case 0x8b:
+                snapshot.set<Label::AlarmsBitmask>(in.get<uint16_t>());
+                break;
+            case 0x8c:
+                snapshot.set<Label::StatusBitmask>(in.get<uint16_t>());
+                break;
+            case 0x8e:
+                snapshot.set<Label::TotalOvervoltageThresholdMilliVolt>(static_cast<uint32_t>(in.get<uint16_t>()) * 10);
+                break;
+            case 0x8f:
+                snapshot.set<Label::TotalUndervoltageThresholdMilliVolt>(static_cast<uint32_t>(in.get<uint16_t>()) * 10);
+                break;
+            case 0x90:
+                snapshot.set<Label::CellOvervoltageThresholdMilliVolt>(in.get<uint16_t>());
+                break;
+            case 0x91:
+                snapshot.set<Label::CellOvervoltageRecoveryMilliVolt>(in.get<uint16_t>());
+                break;
+            case 0x92:
+                snapshot.set<Label::CellOvervoltageProtectionDelaySeconds>(in.get<uint16_t>());
+                break;
+            case 0x93:
+                snapshot.set<Label::CellUndervoltageThresholdMilliVolt>(in.get<uint16_t>());
+                break;
+            case 0x94:
+                snapshot.set<Label::CellUndervoltageRecoveryMilliVolt>(in.get<uint16_t>());
+                break;
+            case 0x95:
+                snapshot.set<Label::CellUndervoltageProtectionDelaySeconds>(in.get<uint16_t>());
+                break;
+            case 0x96:
+                snapshot.set<Label::CellVoltageDiffThresholdMilliVolt>(in.get<uint16_t>());
+                break;
+            case 0x97:
+                snapshot.set<Label::DischargeOvercurrentThresholdAmperes>(in.get<uint16_t>());
+                break;
+            case 0x98:
+                snapshot.set<Label::DischargeOvercurrentDelaySeconds>(in.get<uint16_t>());
+                break;
+            case 0x99:
+                snapshot.set<Label::ChargeOvercurrentThresholdAmps>(in.get<uint16_t>());
+                break;
+            case 0x9a:
+                snapshot.set<Label::ChargeOvercurrentDelaySeconds>(in.get<uint16_t>());
+                break;
+            case 0x9b:
+                snapshot.set<Label::BalanceCellVoltageThresholdMilliVolt>(in.get<uint16_t>());
+                break;
+            case 0x9c:
+                snapshot.set<Label::BalanceVoltageDiffThresholdMilliVolt>(in.get<uint16_t>());
+                break;
+            case 0x9d:
+                snapshot.set<Label::BalancingEnabled>(in.getBool());
+                break;
+            case 0x9e:
+                snapshot.set<Label::BmsTempProtectionThresholdCelsius>(in.get<uint16_t>());
+                break;
+            case 0x9f:
+                snapshot.set<Label::BmsTempRecoveryThresholdCelsius>(in.get<uint16_t>());
+                break;
+            case 0xa0:
+                snapshot.set<Label::BatteryTempProtectionThresholdCelsius>(in.get<uint16_t>());
+                break;
+            case 0xa1:
+                snapshot.set<Label::BatteryTempRecoveryThresholdCelsius>(in.get<uint16_t>());
+                break;
+            case 0xa2:
+                snapshot.set<Label::BatteryTempDiffThresholdCelsius>(in.get<uint16_t>());
+                break;
+            case 0xa3:
+                snapshot.set<Label::ChargeHighTempThresholdCelsius>(in.get<uint16_t>());
+                break;
+            case 0xa4:
+                snapshot.set<Label::DischargeHighTempThresholdCelsius>(in.get<uint16_t>());
+                break;
+            case 0xa5:
+                snapshot.set<Label::ChargeLowTempThresholdCelsius>(in.get<int16_t>());
+                break;
+            case 0xa6:
+                snapshot.set<Label::ChargeLowTempRecoveryCelsius>(in.get<int16_t>());
+                break;
+            case 0xa7:
+                snapshot.set<Label::DischargeLowTempThresholdCelsius>(in.get<int16_t>());
+                break;
+            case 0xa8:
+                snapshot.set<Label::DischargeLowTempRecoveryCelsius>(in.get<int16_t>());
+                break;
+            case 0xa9:
+                snapshot.set<Label::CellAmountSetting>(in.get<uint8_t>());
+                break;
+            case 0xaa:
+                snapshot.set<Label::BatteryCapacitySettingAmpHours>(in.get<uint32_t>());
+                break;
+            case 0xab:
+                snapshot.set<Label::BatteryChargeEnabled>(in.getBool());
+                break;
+            case 0xac:
+                snapshot.set<Label::BatteryDischargeEnabled>(in.getBool());
+                break;
+            case 0xad:
+                snapshot.set<Label::CurrentCalibrationMilliAmps>(in.get<uint16_t>());
+                break;
+            case 0xae:
+                snapshot.set<Label::BmsAddress>(in.get<uint8_t>());
+                break;
+            case 0xaf:
+                snapshot.set<Label::BatteryType>(in.get<uint8_t>());
+                break;
+            case 0xb0:
+                snapshot.set<Label::SleepWaitTime>(in.get<uint16_t>());
+                break;
+            case 0xb1:
+                snapshot.set<Label::LowCapacityAlarmThresholdPercent>(in.get<uint8_t>());
+                break;
+            case 0xb2:
+                in.getString(snapshot.emplace<Label::ModificationPassword>(), 10);
+                break;
+            case 0xb3:
+                snapshot.set<Label::DedicatedChargerSwitch>(in.getBool());
+                break;
+            case 0xb4:
+                in.getString(snapshot.emplace<Label::EquipmentId>(), 8);
+                break;
+            case 0xb5:
+                in.getString(snapshot.emplace<Label::DateOfManufacturing>(), 4);
+                break;
+            case 0xb6:
+                snapshot.set<Label::BmsHourMeterMinutes>(in.get<uint32_t>());
+                break;
+            case 0xb7:
+                in.getString(snapshot.emplace<Label::BmsSoftwareVersion>(), 15);
+                break;
+            case 0xb8:
+                snapshot.set<Label::CurrentCalibration>(in.getBool());
+                break;
+            case 0xb9:
+                snapshot.set<Label::ActualBatteryCapacityAmpHours>(in.get<uint32_t>());
+                break;
+            case 0xba:
+                in.getString(snapshot.emplace<Label::ProductId>(), 24, true);
+                break;
+            case 0xc0:
+                snapshot.set<Label::ProtocolVersion>(in.get<uint8_t>());
+                break;
+            default:
+                // the length of an unknown field is unknown as well, so
+                // decoding the remainder of the frame is not possible.
+                _unknownFieldType = fieldType;
+                result = Result::UnknownFieldType;
+                break;
+        }
+
+        if (result != Result::Ok) { break; }
+    }
+
+    auto oProtocolVersion = snapshot.get<Label::ProtocolVersion>();
+    if (oProtocolVersion.has_value()) { _protocolVersion = *oProtocolVersion; }
+
+    return result;
+}
+
+} // namespace Batteries::JkBms
@@ -74,9 +74,9 @@ void Provider::deinit()
 
 Provider::Interface Provider::getInterface() const
 {
-    auto const& config = Configuration.get();
-    if (0x00 == config.Battery.Serial.Interface) { return Interface::Uart; }
-    if (0x01 == config.Battery.Serial.Interface) { return Interface::Transceiver; }
+    auto const config = Configuration.get();
+    if (0x00 == config->Battery.Serial.Interface) { return Interface::Uart; }
+    if (0x01 == config->Battery.Serial.Interface) { return Interface::Transceiver; }
     return Interface::Invalid;
 }
 
@@ -146,8 +146,8 @@ void Provider::sendRequest(uint8_t pollInterval)
 
 void Provider::loop()
 {
-    auto const& config = Configuration.get();
-    uint8_t pollInterval = config.Battery.Serial.PollingInterval;
+    auto const config = Configuration.get();
+    uint8_t pollInterval = config->Battery.Serial.PollingInterval;
 
     while (_upSerial->available()) {
         rxData(_upSerial->read());
@@ -163,7 +163,10 @@ void Provider::loop()
 
 void Provider::rxData(uint8_t inbyte)
 {
-    _buffer.push_back(inbyte);
+    if (!_buffer.push(inbyte)) {
+        DTU_LOGW("frame exceeds %d bytes, discarding it", _buffer.capacity());
+        return reset();
+    }
 
     switch(_readState) {
         case ReadState::Idle: // unsolicited message from BMS
@@ -209,36 +212,43 @@ void Provider::frameComplete()
     announceStatus(Status::FrameCompleted);
 
     DTU_LOGD("received message with %d bytes", _buffer.size());
-    LogHelper::dumpBytes(TAG, SUBTAG, _buffer.data(), _buffer.size());
+    _buffer.forEachSegment([](uint8_t const* data, size_t len) {
+        LogHelper::dumpBytes(TAG, SUBTAG, data, len);
+    });
+
+    auto result = _parser.parse(_buffer, _snapshot);
+    switch (result) {
+        case FrameParser::Result::Ok:
+            break;
+        case FrameParser::Result::UnknownFieldType:
+            DTU_LOGW("unknown field type 0x%02x", _parser.getUnknownFieldType());
+            break;
+        default:
+            DTU_LOGE("%s", FrameParser::getResultText(result));
+            break;
+    }
 
-    auto pResponse = std::make_unique<SerialResponse>(std::move(_buffer), _protocolVersion);
-    if (pResponse->isValid()) {
-        processDataPoints(pResponse->getDataPoints());
-    } // if invalid, error message has been produced by SerialResponse c'tor
+    if (!_snapshot.empty()) { processDataPoints(); }
 
     reset();
 }
 
-void Provider::processDataPoints(DataPointContainer const& dataPoints)
+void Provider::processDataPoints()
 {
-    _stats->updateFrom(dataPoints);
-
-    using Label = JkBms::DataPointLabel;
-
-    auto oProtocolVersion = dataPoints.get<Label::ProtocolVersion>();
-    if (oProtocolVersion.has_value()) { _protocolVersion = *oProtocolVersion; }
+    _stats->updateFrom(_snapshot);
 
     if (!DTU_LOG_IS_DEBUG) { return; }
 
-    auto iter = dataPoints.cbegin();
-    while ( iter != dataPoints.cend() ) {
-        DTU_LOGD("[%11.3f] %s: %s%s",
-            static_cast<double>(iter->second.getTimestamp())/1000,
-            iter->second.getLabelText().c_str(),
-            iter->second.getValueText().c_str(),
-            iter->second.getUnitText().c_str());
-        ++iter;
+    using Label = JkBms::DataPointLabel;
+    char value[256];
+
+#define LOG_DATA_POINT(n, id, t, u) \
+    if (_snapshot.has<Label::n>()) { \
+        formatDataPointValue(value, sizeof(value), _snapshot.ref<Label::n>()); \
+        DTU_LOGD("%s: %s%s", #n, value, u); \
     }
+    JKBMS_DATA_POINTS(LOG_DATA_POINT)
+#undef LOG_DATA_POINT
 }
 
 } // namespace Batteries::JkBms
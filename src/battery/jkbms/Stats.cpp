@@ -1,8 +1,9 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 #include <algorithm>
-#include <string>
-#include <vector>
+#include <cstring>
+#include <string_view>
 #include <MqttSettings.h>
+#include <Utils.h>
 #include <battery/jkbms/Stats.h>
 #include <battery/jkbms/DataPoints.h>
 
@@ -14,15 +15,15 @@ void Stats::getJsonData(JsonVariant& root, bool verbose) const
 
     using Label = JkBms::DataPointLabel;
 
-    auto oCurrent = _dataPoints.get<Label::BatteryCurrentMilliAmps>();
-    auto oVoltage = _dataPoints.get<Label::BatteryVoltageMilliVolt>();
+    auto oCurrent = _snapshot.get<Label::BatteryCurrentMilliAmps>();
+    auto oVoltage = _snapshot.get<Label::BatteryVoltageMilliVolt>();
     if (oVoltage.has_value() && oCurrent.has_value()) {
         auto current = static_cast<float>(*oCurrent) / 1000;
         auto voltage = static_cast<float>(*oVoltage) / 1000;
         addLiveViewValue(root, "power", current * voltage , "W", 2);
     }
 
-    auto oTemperatureBms = _dataPoints.get<Label::BmsTempCelsius>();
+    auto oTemperatureBms = _snapshot.get<Label::BmsTempCelsius>();
     if (oTemperatureBms.has_value()) {
         addLiveViewValue(root, "bmsTemp", *oTemperatureBms, "°C", 0);
     }
@@ -31,7 +32,7 @@ void Stats::getJsonData(JsonVariant& root, bool verbose) const
     // BalancingEnabled refer to the user setting. we want to show the
     // actual MOSFETs' state which control whether charging and discharging
     // is possible and whether the BMS is currently balancing cells.
-    auto oStatus = _dataPoints.get<Label::StatusBitmask>();
+    auto oStatus = _snapshot.get<Label::StatusBitmask>();
     if (oStatus.has_value()) {
         using Bits = JkBms::StatusBits;
         auto chargeEnabled = *oStatus & static_cast<uint16_t>(Bits::ChargingActive);
@@ -40,12 +41,12 @@ void Stats::getJsonData(JsonVariant& root, bool verbose) const
         addLiveViewTextValue(root, "dischargeEnabled", (dischargeEnabled?"yes":"no"));
     }
 
-    auto oTemperatureOne = _dataPoints.get<Label::BatteryTempOneCelsius>();
+    auto oTemperatureOne = _snapshot.get<Label::BatteryTempOneCelsius>();
     if (oTemperatureOne.has_value()) {
         addLiveViewInSection(root, "cells", "batOneTemp", *oTemperatureOne, "°C", 0);
     }
 
-    auto oTemperatureTwo = _dataPoints.get<Label::BatteryTempTwoCelsius>();
+    auto oTemperatureTwo = _snapshot.get<Label::BatteryTempTwoCelsius>();
     if (oTemperatureTwo.has_value()) {
         addLiveViewInSection(root, "cells", "batTwoTemp", *oTemperatureTwo, "°C", 0);
     }
@@ -63,7 +64,7 @@ void Stats::getJsonData(JsonVariant& root, bool verbose) const
         addLiveViewTextInSection(root, "cells", "balancingActive", (balancingActive?"yes":"no"));
     }
 
-    auto oAlarms = _dataPoints.get<Label::AlarmsBitmask>();
+    auto oAlarms = _snapshot.get<Label::AlarmsBitmask>();
     if (oAlarms.has_value()) {
 #define ISSUE(t, x) \
         auto x = *oAlarms & static_cast<uint16_t>(JkBms::AlarmBits::x); \
@@ -87,13 +88,12 @@ void Stats::getJsonData(JsonVariant& root, bool verbose) const
     }
 }
 
-void Stats::mqttPublish() const
+template<DataPointLabel L>
+void Stats::publishDataPoint(bool fullPublish) const
 {
-    ::Batteries::Stats::mqttPublish();
-
     using Label = JkBms::DataPointLabel;
 
-    static std::vector<Label> mqttSkip = {
+    static constexpr std::array<Label, 3> mqttSkip = {
         Label::CellsMilliVolt, // complex data format
         Label::ModificationPassword, // sensitive data
         Label::BatterySoCPercent // already published by base class
@@ -103,31 +103,43 @@ void Stats::mqttPublish() const
         // "old" topic.
     };
 
+    if (!_snapshot.has<L>()) { return; }
+
+    // skip data points that did not change since last published
+    using Traits = DataPointLabelTraits<L>;
+    if (!fullPublish && _timestamps[Traits::index] < _lastMqttPublish) { return; }
+
+    if (std::find(mqttSkip.begin(), mqttSkip.end(), L) != mqttSkip.end()) { return; }
+
+    char value[32];
+    formatDataPointValue(value, sizeof(value), _snapshot.ref<L>());
+    MqttSettings.publish(String("battery/") + Traits::name, value);
+}
+
+void Stats::mqttPublish() const
+{
+    ::Batteries::Stats::mqttPublish();
+
+    using Label = JkBms::DataPointLabel;
+
     // regularly publish all topics regardless of whether or not their value changed
     bool neverFullyPublished = _lastFullMqttPublish == 0;
     bool intervalElapsed = _lastFullMqttPublish + getMqttFullPublishIntervalMs() < millis();
     bool fullPublish = neverFullyPublished || intervalElapsed;
 
-    for (auto iter = _dataPoints.cbegin(); iter != _dataPoints.cend(); ++iter) {
-        // skip data points that did not change since last published
-        if (!fullPublish && iter->second.getTimestamp() < _lastMqttPublish) { continue; }
+#define PUBLISH_DATA_POINT(n, id, t, u) publishDataPoint<Label::n>(fullPublish);
+    JKBMS_DATA_POINTS(PUBLISH_DATA_POINT)
+#undef PUBLISH_DATA_POINT
 
-        auto skipMatch = std::find(mqttSkip.begin(), mqttSkip.end(), iter->first);
-        if (skipMatch != mqttSkip.end()) { continue; }
-
-        String topic((std::string("battery/") + iter->second.getLabelText()).c_str());
-        MqttSettings.publish(topic, iter->second.getValueText().c_str());
-    }
-
-    auto oCellVoltages = _dataPoints.get<Label::CellsMilliVolt>();
-    if (oCellVoltages.has_value() && (fullPublish || _cellVoltageTimestamp > _lastMqttPublish)) {
+    auto const& cellVoltages = _snapshot.ref<Label::CellsMilliVolt>();
+    if (_snapshot.has<Label::CellsMilliVolt>() && (fullPublish || _cellVoltageTimestamp > _lastMqttPublish)) {
         unsigned idx = 1;
-        for (auto iter = oCellVoltages->cbegin(); iter != oCellVoltages->cend(); ++iter) {
+        for (auto cellMilliVolt : cellVoltages) {
             String topic("battery/Cell");
             topic += String(idx);
             topic += "MilliVolt";
 
-            MqttSettings.publish(topic, String(iter->second));
+            MqttSettings.publish(topic, String(cellMilliVolt));
 
             ++idx;
         }
@@ -138,7 +150,7 @@ void Stats::mqttPublish() const
         MqttSettings.publish("battery/CellDiffMilliVolt", String(_cellMaxMilliVolt - _cellMinMilliVolt));
     }
 
-    auto oAlarms = _dataPoints.get<Label::AlarmsBitmask>();
+    auto oAlarms = _snapshot.get<Label::AlarmsBitmask>();
     if (oAlarms.has_value()) {
         for (auto iter = JkBms::AlarmBitTexts.begin(); iter != JkBms::AlarmBitTexts.end(); ++iter) {
             auto bit = iter->first;
@@ -147,7 +159,7 @@ void Stats::mqttPublish() const
         }
     }
 
-    auto oStatus = _dataPoints.get<Label::StatusBitmask>();
+    auto oStatus = _snapshot.get<Label::StatusBitmask>();
     if (oStatus.has_value()) {
         for (auto iter = JkBms::StatusBitTexts.begin(); iter != JkBms::StatusBitTexts.end(); ++iter) {
             auto bit = iter->first;
@@ -167,81 +179,89 @@ std::optional<String> Stats::getHassDeviceName() const
     return String("JK BMS (") + *oManufacturer + ")";
 }
 
-void Stats::updateFrom(JkBms::DataPointContainer const& dp)
+template<DataPointLabel L>
+bool Stats::merge(Snapshot const& snapshot, uint32_t timestamp)
+{
+    if (!_snapshot.mergeFrom<L>(snapshot)) { return false; }
+    _timestamps[DataPointLabelTraits<L>::index] = timestamp;
+    return true;
+}
+
+void Stats::updateFrom(Snapshot const& snapshot)
 {
     using Label = JkBms::DataPointLabel;
 
-    setManufacturer("JKBMS");
-    auto oProductId = dp.get<Label::ProductId>();
-    if (oProductId.has_value()) {
+    uint32_t now = millis();
+    if (now == 0) { now = 1; } // zero means "never updated"
+
+    if (!getManufacturer().has_value()) { setManufacturer("JKBMS"); }
+    if (merge<Label::ProductId>(snapshot, now)) {
         // the first twelve chars are expected to be the "User Private Data"
         // setting (see smartphone app). the remainder is expected be the BMS
         // name, which can be changed at will using the smartphone app. so
         // there is not always a "JK" in this string. if there is, we still cut
         // the string there to avoid possible regressions.
-        setManufacturer(String(oProductId->substr(12).c_str()));
-        auto pos = oProductId->rfind("JK");
-        if (pos != std::string::npos) {
-            setManufacturer(String(oProductId->substr(pos).c_str()));
+        std::string_view productId(_snapshot.ProductId.c_str());
+        if (productId.size() > 12) {
+            setManufacturer(String(productId.data() + 12));
+        }
+        auto pos = productId.rfind("JK");
+        if (pos != std::string_view::npos) {
+            setManufacturer(String(productId.data() + pos));
         }
     }
 
-    auto oSoCValue = dp.get<Label::BatterySoCPercent>();
+    auto oSoCValue = snapshot.get<Label::BatterySoCPercent>();
     if (oSoCValue.has_value()) {
-        auto oSoCDataPoint = dp.getDataPointFor<Label::BatterySoCPercent>();
-        ::Batteries::Stats::setSoC(*oSoCValue, 0/*precision*/,
-                oSoCDataPoint->getTimestamp());
+        ::Batteries::Stats::setSoC(*oSoCValue, 0/*precision*/, now);
     }
 
-    auto oVoltage = dp.get<Label::BatteryVoltageMilliVolt>();
+    auto oVoltage = snapshot.get<Label::BatteryVoltageMilliVolt>();
     if (oVoltage.has_value()) {
-        auto oVoltageDataPoint = dp.getDataPointFor<Label::BatteryVoltageMilliVolt>();
-        ::Batteries::Stats::setVoltage(static_cast<float>(*oVoltage) / 1000,
-                oVoltageDataPoint->getTimestamp());
+        ::Batteries::Stats::setVoltage(static_cast<float>(*oVoltage) / 1000, now);
     }
 
-    auto oCurrent = dp.get<Label::BatteryCurrentMilliAmps>();
+    auto oCurrent = snapshot.get<Label::BatteryCurrentMilliAmps>();
     if (oCurrent.has_value()) {
-        auto oCurrentDataPoint = dp.getDataPointFor<Label::BatteryCurrentMilliAmps>();
-        ::Batteries::Stats::setCurrent(static_cast<float>(*oCurrent) / 1000, 2/*precision*/,
-                oCurrentDataPoint->getTimestamp());
-    }
-
-    _dataPoints.updateFrom(dp);
-
-    auto oCellVoltages = _dataPoints.get<Label::CellsMilliVolt>();
-    if (oCellVoltages.has_value()) {
-        for (auto iter = oCellVoltages->cbegin(); iter != oCellVoltages->cend(); ++iter) {
-            if (iter == oCellVoltages->cbegin()) {
-                _cellMinMilliVolt = _cellAvgMilliVolt = _cellMaxMilliVolt = iter->second;
-                continue;
-            }
-            _cellMinMilliVolt = std::min(_cellMinMilliVolt, iter->second);
-            _cellAvgMilliVolt = (_cellAvgMilliVolt + iter->second) / 2;
-            _cellMaxMilliVolt = std::max(_cellMaxMilliVolt, iter->second);
-        }
-        _cellVoltageTimestamp = millis();
+        ::Batteries::Stats::setCurrent(static_cast<float>(*oCurrent) / 1000, 2/*precision*/, now);
     }
 
-    auto oVersion = _dataPoints.get<Label::BmsSoftwareVersion>();
-    if (oVersion.has_value()) {
+    if (merge<Label::BmsSoftwareVersion>(snapshot, now)) {
         // raw: "11.XW_S11.262H_"
         //   => Hardware "V11.XW" (displayed in Android app)
         //   => Software "V11.262H" (displayed in Android app)
-        auto first = oVersion->find('_');
-        if (first != std::string::npos) {
-            _hwversion = oVersion->substr(0, first).c_str();
+        std::string_view version(_snapshot.BmsSoftwareVersion.c_str());
+        auto first = version.find('_');
+        if (first != std::string_view::npos) {
+            _hwversion = String(version.substr(0, first).data(), first);
 
-            auto second = oVersion->find('_', first + 1);
+            auto second = version.find('_', first + 1);
 
             // the 'S' seems to be merely an indicator for "software"?
-            if (oVersion->at(first + 1) == 'S') { first++; }
+            if (first + 1 < version.size() && version[first + 1] == 'S') { first++; }
 
-            _fwversion = oVersion->substr(first + 1, second - first - 1).c_str();
+            auto fw = version.substr(first + 1, second - first - 1);
+            _fwversion = String(fw.data(), fw.size());
         }
     }
 
-    _lastUpdate = millis();
+#define MERGE_DATA_POINT(n, id, t, u) merge<Label::n>(snapshot, now);
+    JKBMS_DATA_POINTS(MERGE_DATA_POINT)
+#undef MERGE_DATA_POINT
+
+    if (_snapshot.has<Label::CellsMilliVolt>()) {
+        auto const& cellVoltages = _snapshot.ref<Label::CellsMilliVolt>();
+        _cellMinMilliVolt = cellVoltages.getMin();
+        _cellAvgMilliVolt = cellVoltages.getAvg();
+        _cellMaxMilliVolt = cellVoltages.getMax();
+        _cellVoltageTimestamp = now;
+    }
+
+    if (snapshot.has<Label::CellsMilliVolt>()) {
+        _spCellHistory->add(Utils::getUptimeSeconds(), snapshot.ref<Label::CellsMilliVolt>());
+    }
+
+    _lastUpdate = now;
 }
 
 } // namespace Batteries::JkBms
@@ -15,53 +15,58 @@ bool Provider::init()
 {
     _stats->setManufacturer("MQTT");
 
-    auto const& config = Configuration.get();
+    auto const config = Configuration.get();
 
-    _socTopic = config.Battery.Mqtt.SocTopic;
+    _socTopic = config->Battery.Mqtt.SocTopic;
     if (!_socTopic.isEmpty()) {
+        _socExtractor = JsonPathExtractor(config->Battery.Mqtt.SocJsonPath);
         MqttSettings.subscribe(_socTopic, 0/*QoS*/,
                 std::bind(&Provider::onMqttMessageSoC,
                     this, std::placeholders::_1, std::placeholders::_2,
                     std::placeholders::_3, std::placeholders::_4,
-                    config.Battery.Mqtt.SocJsonPath)
+                    &_socExtractor)
                 );
 
         DTU_LOGD("Subscribed to '%s' for SoC readings", _socTopic.c_str());
     }
 
-    _voltageTopic = config.Battery.Mqtt.VoltageTopic;
+    _voltageTopic = config->Battery.Mqtt.VoltageTopic;
     if (!_voltageTopic.isEmpty()) {
+        _voltageExtractor = JsonPathExtractor(config->Battery.Mqtt.VoltageJsonPath);
         MqttSettings.subscribe(_voltageTopic, 0/*QoS*/,
                 std::bind(&Provider::onMqttMessageVoltage,
                     this, std::placeholders::_1, std::placeholders::_2,
                     std::placeholders::_3, std::placeholders::_4,
-                    config.Battery.Mqtt.VoltageJsonPath)
+                    &_voltageExtractor)
                 );
 
         DTU_LOGD("Subscribed to '%s' for voltage readings", _voltageTopic.c_str());
     }
 
-    _currentTopic = config.Battery.Mqtt.CurrentTopic;
+    _currentTopic = config->Battery.Mqtt.CurrentTopic;
     if (!_currentTopic.isEmpty()) {
+        _currentExtractor = JsonPathExtractor(config->Battery.Mqtt.CurrentJsonPath);
         MqttSettings.subscribe(_currentTopic, 0/*QoS*/,
                 std::bind(&Provider::onMqttMessageCurrent,
                     this, std::placeholders::_1, std::placeholders::_2,
                     std::placeholders::_3, std::placeholders::_4,
-                    config.Battery.Mqtt.CurrentJsonPath)
+                    &_currentExtractor)
                 );
 
         DTU_LOGD("Subscribed to '%s' for current readings", _currentTopic.c_str());
     }
 
-    if (config.Battery.EnableDischargeCurrentLimit && config.Battery.UseBatteryReportedDischargeCurrentLimit) {
-        _dischargeCurrentLimitTopic = config.Battery.Mqtt.DischargeCurrentLimitTopic;
+    if (config->Battery.EnableDischargeCurrentLimit && config->Battery.UseBatteryReportedDischargeCurrentLimit) {
+        _dischargeCurrentLimitTopic = config->Battery.Mqtt.DischargeCurrentLimitTopic;
 
         if (!_dischargeCurrentLimitTopic.isEmpty()) {
+            _dischargeCurrentLimitExtractor = JsonPathExtractor(config->Battery.Mqtt.DischargeCurrentLimitJsonPath);
+
             MqttSettings.subscribe(_dischargeCurrentLimitTopic, 0/*QoS*/,
                     std::bind(&Provider::onMqttMessageDischargeCurrentLimit,
                         this, std::placeholders::_1, std::placeholders::_2,
                         std::placeholders::_3, std::placeholders::_4,
-                        config.Battery.Mqtt.DischargeCurrentLimitJsonPath)
+                        &_dischargeCurrentLimitExtractor)
                     );
 
             DTU_LOGD("Subscribed to '%s' for discharge current limit readings",
@@ -93,11 +98,10 @@ void Provider::deinit()
 
 void Provider::onMqttMessageSoC(espMqttClientTypes::MessageProperties const& properties,
         char const* topic, uint8_t const* payload, size_t len,
-        char const* jsonPath)
+        JsonPathExtractor const* extractor)
 {
-    auto soc = Utils::getNumericValueFromMqttPayload<float>("MqttBattery",
-            std::string(reinterpret_cast<const char*>(payload), len), topic,
-            jsonPath);
+    auto soc = extractor->extract<float>("MqttBattery",
+            std::string_view(reinterpret_cast<const char*>(payload), len), topic);
 
     if (!soc.has_value()) { return; }
 
@@ -115,18 +119,17 @@ void Provider::onMqttMessageSoC(espMqttClientTypes::MessageProperties const& pro
 
 void Provider::onMqttMessageVoltage(espMqttClientTypes::MessageProperties const& properties,
         char const* topic, uint8_t const* payload, size_t len,
-        char const* jsonPath)
+        JsonPathExtractor const* extractor)
 {
-    auto voltage = Utils::getNumericValueFromMqttPayload<float>("MqttBattery",
-            std::string(reinterpret_cast<const char*>(payload), len), topic,
-            jsonPath);
+    auto voltage = extractor->extract<float>("MqttBattery",
+            std::string_view(reinterpret_cast<const char*>(payload), len), topic);
 
 
     if (!voltage.has_value()) { return; }
 
-    auto const& config = Configuration.get();
+    auto const config = Configuration.get();
     using Unit_t = BatteryVoltageUnit;
-    switch (config.Battery.Mqtt.VoltageUnit) {
+    switch (config->Battery.Mqtt.VoltageUnit) {
         case Unit_t::DeciVolts:
             *voltage /= 10;
             break;
@@ -155,18 +158,17 @@ void Provider::onMqttMessageVoltage(espMqttClientTypes::MessageProperties const&
 
 void Provider::onMqttMessageCurrent(espMqttClientTypes::MessageProperties const& properties,
         char const* topic, uint8_t const* payload, size_t len,
-        char const* jsonPath)
+        JsonPathExtractor const* extractor)
 {
-    auto amperage = Utils::getNumericValueFromMqttPayload<float>("MqttBattery",
-            std::string(reinterpret_cast<const char*>(payload), len), topic,
-            jsonPath);
+    auto amperage = extractor->extract<float>("MqttBattery",
+            std::string_view(reinterpret_cast<const char*>(payload), len), topic);
 
 
     if (!amperage.has_value()) { return; }
 
-    auto const& config = Configuration.get();
+    auto const config = Configuration.get();
     using Unit_t = BatteryAmperageUnit;
-    switch (config.Battery.Mqtt.CurrentUnit) {
+    switch (config->Battery.Mqtt.CurrentUnit) {
         case Unit_t::MilliAmps:
             *amperage /= 1000;
             break;
@@ -183,18 +185,17 @@ void Provider::onMqttMessageCurrent(espMqttClientTypes::MessageProperties const&
 
 void Provider::onMqttMessageDischargeCurrentLimit(espMqttClientTypes::MessageProperties const& properties,
         char const* topic, uint8_t const* payload, size_t len,
-        char const* jsonPath)
+        JsonPathExtractor const* extractor)
 {
-    auto amperage = Utils::getNumericValueFromMqttPayload<float>("MqttBattery",
-            std::string(reinterpret_cast<const char*>(payload), len), topic,
-            jsonPath);
+    auto amperage = extractor->extract<float>("MqttBattery",
+            std::string_view(reinterpret_cast<const char*>(payload), len), topic);
 
 
     if (!amperage.has_value()) { return; }
 
-    auto const& config = Configuration.get();
+    auto const config = Configuration.get();
     using Unit_t = BatteryAmperageUnit;
-    switch (config.Battery.Mqtt.DischargeCurrentLimitUnit) {
+    switch (config->Battery.Mqtt.DischargeCurrentLimitUnit) {
         case Unit_t::MilliAmps:
             *amperage /= 1000;
             break;
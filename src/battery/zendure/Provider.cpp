@@ -18,13 +18,13 @@ Provider::Provider()
 
 bool Provider::init()
 {
-    auto const& config = Configuration.get();
+    auto const config = Configuration.get();
     String deviceType = String();
 
-    DTU_LOGD("Settings %" PRIu8, config.Battery.Zendure.DeviceType);
+    DTU_LOGD("Settings %" PRIu8, config->Battery.Zendure.DeviceType);
     {
         String deviceName = String();
-        switch (config.Battery.Zendure.DeviceType) {
+        switch (config->Battery.Zendure.DeviceType) {
             case 0:
                 deviceType = ZENDURE_HUB1200;
                 deviceName = String("SolarFlow HUB 1200");
@@ -56,8 +56,8 @@ bool Provider::init()
                 return false;
         }
 
-        if (strlen(config.Battery.Zendure.DeviceId) != 8) {
-            DTU_LOGE("Invalid device id '%s'!", config.Battery.Zendure.DeviceId);
+        if (strlen(config->Battery.Zendure.DeviceId) != 8) {
+            DTU_LOGE("Invalid device id '%s'!", config->Battery.Zendure.DeviceId);
             return false;
         }
 
@@ -69,7 +69,7 @@ bool Provider::init()
     }
 
     // store device ID as we will need them for checking when receiving messages
-    setTopics(deviceType, config.Battery.Zendure.DeviceId);
+    setTopics(deviceType, config->Battery.Zendure.DeviceId);
 
     _topicPersistentSettings = MqttSettings.getPrefix() + "battery/persistent/";
 
@@ -105,7 +105,7 @@ bool Provider::init()
             );
     DTU_LOGD("Subscribed to '%s' for timesync requests", _topicTimesync.c_str());
 
-    _rateFullUpdateMs   = config.Battery.Zendure.PollingInterval * 1000;
+    _rateFullUpdateMs   = config->Battery.Zendure.PollingInterval * 1000;
     _nextFullUpdate     = millis() + _rateFullUpdateMs / 2;
     _rateTimesyncMs     = ZENDURE_SECONDS_TIMESYNC * 1000;
     _nextTimesync       = _nextFullUpdate;
@@ -121,12 +121,12 @@ bool Provider::init()
     serializeJson(root, _payloadFullUpdate);
 
     // disable charge through cycle if disable by config
-    if (!config.Battery.Zendure.ChargeThroughEnable) {
+    if (!config->Battery.Zendure.ChargeThroughEnable) {
         setChargeThroughState(ChargeThroughState::Disabled);
     }
 
     // check if we are allowed to write stuff
-    if (config.Battery.Zendure.ControlMode == BatteryZendureConfig::ControlMode::ControlModeReadOnly) {
+    if (config->Battery.Zendure.ControlMode == BatteryZendureConfig::ControlMode::ControlModeReadOnly) {
         DTU_LOGI("Running in READ-ONLY mode");
 
         // forget about write topic to prevent it will ever be written
@@ -172,12 +172,12 @@ void Provider::deinit()
 void Provider::loop()
 {
     auto ms = millis();
-    auto const& config = Configuration.get();
+    auto const config = Configuration.get();
     const bool isDayPeriod = SunPosition.isSunsetAvailable() ? SunPosition.isDayPeriod() : true;
     auto const chargeThroughState = _stats->_charge_through_state.value_or(ChargeThroughState::Disabled);
 
     // if auto shutdown is enabled and battery switches to idle at night, turn off status requests to prevent keeping battery awake
-    if (config.Battery.Zendure.AutoShutdown && !isDayPeriod && _stats->_state == State::Idle) {
+    if (config->Battery.Zendure.AutoShutdown && !isDayPeriod && _stats->_state == State::Idle) {
         return;
     }
 
@@ -196,11 +196,11 @@ void Provider::loop()
             std::time_t sunset = 0;
 
             if (SunPosition.sunriseTime(&timeinfo_sun)) {
-                sunrise = std::mktime(&timeinfo_sun) + config.Battery.Zendure.SunriseOffset * 60;
+                sunrise = std::mktime(&timeinfo_sun) + config->Battery.Zendure.SunriseOffset * 60;
             }
 
             if (SunPosition.sunsetTime(&timeinfo_sun)) {
-                sunset = std::mktime(&timeinfo_sun) + config.Battery.Zendure.SunsetOffset * 60;
+                sunset = std::mktime(&timeinfo_sun) + config->Battery.Zendure.SunsetOffset * 60;
             }
 
             if (sunrise && sunset) {
@@ -214,11 +214,11 @@ void Provider::loop()
                 }
 
                 // running in appointment mode - set outputlimit accordingly
-                if (config.Battery.Zendure.OutputControl == BatteryZendureConfig::OutputControl_t::ControlSchedule && chargeThroughState != ChargeThroughState::Hard) {
+                if (config->Battery.Zendure.OutputControl == BatteryZendureConfig::OutputControl_t::ControlSchedule && chargeThroughState != ChargeThroughState::Hard) {
                     if (current >= sunrise && current < sunset) {
-                        setOutputLimit(min(config.Battery.Zendure.MaxOutput, config.Battery.Zendure.OutputLimitDay));
+                        setOutputLimit(min(config->Battery.Zendure.MaxOutput, config->Battery.Zendure.OutputLimitDay));
                     } else if (current >= sunset || current < sunrise) {
-                        setOutputLimit(min(config.Battery.Zendure.MaxOutput, config.Battery.Zendure.OutputLimitNight));
+                        setOutputLimit(min(config->Battery.Zendure.MaxOutput, config->Battery.Zendure.OutputLimitNight));
                     }
                 }
             }
@@ -230,19 +230,19 @@ void Provider::loop()
         switch (chargeThroughState) {
             case ChargeThroughState::Soft:
             case ChargeThroughState::Keep:
-                setTargetSoCs(config.Battery.Zendure.MinSoC, 100);
+                setTargetSoCs(config->Battery.Zendure.MinSoC, 100);
                 setBypassMode(BatteryZendureConfig::BypassMode_t::AlwaysOff);
-                setOutputLimit(config.Battery.Zendure.OutputLimit);
+                setOutputLimit(config->Battery.Zendure.OutputLimit);
                 break;
             case ChargeThroughState::Hard:
-                setTargetSoCs(config.Battery.Zendure.MinSoC, 100);
+                setTargetSoCs(config->Battery.Zendure.MinSoC, 100);
                 setBypassMode(BatteryZendureConfig::BypassMode_t::AlwaysOff);
                 setOutputLimit(0);
                 break;
             default:
-                setTargetSoCs(config.Battery.Zendure.MinSoC, config.Battery.Zendure.MaxSoC);
-                setBypassMode(config.Battery.Zendure.BypassMode);
-                setOutputLimit(config.Battery.Zendure.OutputLimit);
+                setTargetSoCs(config->Battery.Zendure.MinSoC, config->Battery.Zendure.MaxSoC);
+                setBypassMode(config->Battery.Zendure.BypassMode);
+                setOutputLimit(config->Battery.Zendure.OutputLimit);
                 break;
         }
 
@@ -260,7 +260,7 @@ void Provider::loop()
         timesync();
 
         // update settings (will be skipped if unchanged)
-        setInverterMax(config.Battery.Zendure.MaxOutput);
+        setInverterMax(config->Battery.Zendure.MaxOutput);
 
         // republish settings - just to be sure
         writeSettings();
@@ -272,10 +272,10 @@ void Provider::writeSettings() {
         return;
     }
 
-    auto const& config = Configuration.get();
+    auto const config = Configuration.get();
 
-    setBuzzer(config.Battery.Zendure.BuzzerEnable);
-    setAutoshutdown(config.Battery.Zendure.AutoShutdown);
+    setBuzzer(config->Battery.Zendure.BuzzerEnable);
+    setAutoshutdown(config->Battery.Zendure.AutoShutdown);
 
     publishProperties(_topicWrite,
         ZENDURE_REPORT_PV_BRAND,        "1",    // means Hoymiles
@@ -284,7 +284,7 @@ void Provider::writeSettings() {
     );
 
     // if running in OnlyOnce mode, forget about write topic to prevent it will ever be written again
-    if (config.Battery.Zendure.ControlMode == BatteryZendureConfig::ControlMode::ControlModeOnce) {
+    if (config->Battery.Zendure.ControlMode == BatteryZendureConfig::ControlMode::ControlModeOnce) {
         _topicWrite.clear();
     }
 }
@@ -320,13 +320,13 @@ void Provider::calculateFullChargeAge()
 
 void Provider::checkChargeThrough(uint32_t predictHours /* = 0 */)
 {
-    auto const& config = Configuration.get();
-    if (!config.Battery.Zendure.ChargeThroughEnable) {
+    auto const config = Configuration.get();
+    if (!config->Battery.Zendure.ChargeThroughEnable) {
         return;
     }
 
     // hard charge through will start after configured interval (given in hours)
-    auto hardChargeThrough = config.Battery.Zendure.ChargeThroughInterval;
+    auto hardChargeThrough = config->Battery.Zendure.ChargeThroughInterval;
 
     // soft charge through will be triggered one day (aka. 24 hours) before hard charge through
     auto softChargeThrough = hardChargeThrough - 24;
@@ -372,15 +372,15 @@ uint16_t Provider::calcOutputLimit(uint16_t limit) const
 
 uint16_t Provider::setOutputLimit(uint16_t limit) const
 {
-    auto const& config = Configuration.get();
+    auto const config = Configuration.get();
 
-    if (config.Battery.Zendure.OutputControl == BatteryZendureConfig::OutputControl_t::ControlNone ||
+    if (config->Battery.Zendure.OutputControl == BatteryZendureConfig::OutputControl_t::ControlNone ||
         _topicWrite.isEmpty() || !alive() ) {
         return _stats->_output_limit;
     }
 
     // keep limit below MaxOutput
-    limit = min(config.Battery.Zendure.MaxOutput, limit);
+    limit = min(config->Battery.Zendure.MaxOutput, limit);
 
     if (_stats->_output_limit != limit) {
         limit = calcOutputLimit(limit);
@@ -552,15 +552,15 @@ void Provider::onMqttMessageReport(espMqttClientTypes::MessageProperties const&
 {
     auto ms = millis();
 
-    std::string const src = std::string(reinterpret_cast<const char*>(payload), len);
-    std::string logValue = src.substr(0, 64);
-    if (src.length() > logValue.length()) { logValue += "..."; }
+    std::string_view const src(reinterpret_cast<const char*>(payload), len);
+    char logValue[68];
+    Utils::getLogExcerpt(logValue, src);
 
     JsonDocument json;
 
-    const DeserializationError error = deserializeJson(json, src);
+    const DeserializationError error = deserializeJson(json, src.data(), src.length());
     if (error) {
-        DTU_LOGE("cannot parse payload '%s' as JSON", logValue.c_str());
+        DTU_LOGE("cannot parse payload '%s' as JSON", logValue);
         return;
     }
 
@@ -575,11 +575,11 @@ void Provider::onMqttMessageReport(espMqttClientTypes::MessageProperties const&
     // messageId has to be set to "123"
     // deviceId has to be set to the configured deviceId
     if (!json["messageId"].as<String>().equals("123")) {
-        DTU_LOGE("Invalid or missing 'messageId' in '%s'", logValue.c_str());
+        DTU_LOGE("Invalid or missing 'messageId' in '%s'", logValue);
         return;
     }
-    if (!json["deviceId"].as<String>().equals(Configuration.get().Battery.Zendure.DeviceId)) {
-        DTU_LOGE("Invalid or missing 'deviceId' in '%s'", logValue.c_str());
+    if (!json["deviceId"].as<String>().equals(Configuration.get()->Battery.Zendure.DeviceId)) {
+        DTU_LOGE("Invalid or missing 'deviceId' in '%s'", logValue);
         return;
     }
 
@@ -694,11 +694,11 @@ void Provider::onMqttMessageReport(espMqttClientTypes::MessageProperties const&
         for (size_t i = 0 ; i < _stats->_num_batteries ; i++) {
             auto serial = Utils::getJsonElement<String>((*packData)[i], ZENDURE_REPORT_PACK_SERIAL);
             if (!serial.has_value()) {
-                DTU_LOGW("Missing serial of battery pack in '%s'", logValue.c_str());
+                DTU_LOGW("Missing serial of battery pack in '%s'", logValue);
                 continue;
             }
             if (_stats->addPackData(i+1, *serial) == nullptr) {
-                DTU_LOGW("Invalid or unknown serial '%s' in '%s'", (*serial).c_str(), logValue.c_str());
+                DTU_LOGW("Invalid or unknown serial '%s' in '%s'", (*serial).c_str(), logValue);
             }
         }
     }
@@ -768,15 +768,15 @@ void Provider::onMqttMessageLog(espMqttClientTypes::MessageProperties const& pro
 
     DTU_LOGD("Logging Frame received!");
 
-    std::string const src = std::string(reinterpret_cast<const char*>(payload), len);
-    std::string logValue = src.substr(0, 64);
-    if (src.length() > logValue.length()) { logValue += "..."; }
+    std::string_view const src(reinterpret_cast<const char*>(payload), len);
+    char logValue[68];
+    Utils::getLogExcerpt(logValue, src);
 
     JsonDocument json;
 
-    const DeserializationError error = deserializeJson(json, src);
+    const DeserializationError error = deserializeJson(json, src.data(), src.length());
     if (error) {
-        DTU_LOGE("cannot parse payload '%s' as JSON", logValue.c_str());
+        DTU_LOGE("cannot parse payload '%s' as JSON", logValue);
         return;
     }
 
@@ -790,18 +790,18 @@ void Provider::onMqttMessageLog(espMqttClientTypes::MessageProperties const& pro
     // validate input data
     // deviceId has to be set to the configured deviceId
     // logType has to be set to "2"
-    if (!json["deviceId"].as<String>().equals(Configuration.get().Battery.Zendure.DeviceId)) {
-        DTU_LOGE("Invalid or missing 'deviceId' in '%s'", logValue.c_str());
+    if (!json["deviceId"].as<String>().equals(Configuration.get()->Battery.Zendure.DeviceId)) {
+        DTU_LOGE("Invalid or missing 'deviceId' in '%s'", logValue);
         return;
     }
     if (!json["logType"].as<String>().equals("2")) {
-        DTU_LOGE("Invalid or missing 'v' in '%s'", logValue.c_str());
+        DTU_LOGE("Invalid or missing 'v' in '%s'", logValue);
         return;
     }
 
     auto data = Utils::getJsonElement<JsonObjectConst>(obj, ZENDURE_LOG_ROOT, 2);
     if (!data.has_value()) {
-        DTU_LOGE("Unable to find 'log' in '%s'", logValue.c_str());
+        DTU_LOGE("Unable to find 'log' in '%s'", logValue);
         return;
     }
 
@@ -809,7 +809,7 @@ void Provider::onMqttMessageLog(espMqttClientTypes::MessageProperties const& pro
 
     auto params = Utils::getJsonElement<JsonArrayConst>(*data, ZENDURE_LOG_PARAMS, 1);
     if (!params.has_value()) {
-        DTU_LOGE("Unable to find 'params' in '%s'", logValue.c_str());
+        DTU_LOGE("Unable to find 'params' in '%s'", logValue);
         return;
     }
 
@@ -947,7 +947,7 @@ void Provider::calculateEfficiency()
 void Provider::setSoC(const float soc, const uint32_t timestamp /* = 0 */, const uint8_t precision /* = 2 */)
 {
     time_t now;
-    auto const& config = Configuration.get();
+    auto const config = Configuration.get();
     auto const chargeThroughState = _stats->_charge_through_state.value_or(ChargeThroughState::Disabled);
 
     if (Utils::getEpoch(&now)) {
@@ -959,7 +959,7 @@ void Provider::setSoC(const float soc, const uint32_t timestamp /* = 0 */, const
                 setChargeThroughState(ChargeThroughState::Keep);
             }
         }
-        if (soc < static_cast<float>(config.Battery.Zendure.ChargeThroughResetLevel) && chargeThroughState == ChargeThroughState::Keep) {
+        if (soc < static_cast<float>(config->Battery.Zendure.ChargeThroughResetLevel) && chargeThroughState == ChargeThroughState::Keep) {
             setChargeThroughState(ChargeThroughState::Idle);
         }
         if (soc <= 0.0) {
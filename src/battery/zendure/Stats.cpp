@@ -9,7 +9,7 @@ void Stats::getLiveViewData(JsonVariant& root) const
 {
     ::Batteries::Stats::getLiveViewData(root);
 
-    auto const& config = Configuration.get();
+    auto const config = Configuration.get();
 
     // values go into the "Status" card of the web application
     std::string section("status");
@@ -33,7 +33,7 @@ void Stats::getLiveViewData(JsonVariant& root) const
 
     // values go into the "Settings" card of the web application
     section = "settings";
-    addLiveViewTextInSection(root, section, "controlMode", std::string(controlModeToString(config.Battery.Zendure.ControlMode)));
+    addLiveViewTextInSection(root, section, "controlMode", std::string(controlModeToString(config->Battery.Zendure.ControlMode)));
     addLiveViewInSection(root, section, "maxInversePower", _inverse_max, "W", 0);
     addLiveViewInSection(root, section, "outputLimit", _output_limit, "W", 0);
     addLiveViewInSection(root, section, "inputLimit", _output_limit, "W", 0);
@@ -75,7 +75,7 @@ void Stats::mqttPublish() const
 {
     ::Batteries::Stats::mqttPublish();
 
-    auto const& config = Configuration.get();
+    auto const config = Configuration.get();
 
     publish("battery/cellMinMilliVolt", _cellMinMilliVolt);
     publish("battery/cellAvgMilliVolt", _cellAvgMilliVolt);
@@ -118,7 +118,7 @@ void Stats::mqttPublish() const
 
     publish("battery/chargeThroughState", String(chargeThroughStateToString(_charge_through_state)));
 
-    publish("battery/settings/controlMode", String(controlModeToString(config.Battery.Zendure.ControlMode)));
+    publish("battery/settings/controlMode", String(controlModeToString(config->Battery.Zendure.ControlMode)));
     publish("battery/settings/outputLimitPower", _output_limit);
     publish("battery/settings/inputLimitPower", _input_limit);
     publish("battery/settings/stateOfChargeMin", _soc_min, 1);
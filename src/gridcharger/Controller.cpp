@@ -5,6 +5,7 @@
 #include <gridcharger/huawei/Provider.h>
 #include <gridcharger/trucki/Provider.h>
 #include <Configuration.h>
+#include <TaskProfiler.h>
 #include <MqttSettings.h>
 #include <LogHelper.h>
 
@@ -19,7 +20,7 @@ namespace GridChargers {
 void Controller::init(Scheduler& scheduler)
 {
     scheduler.addTask(_loopTask);
-    _loopTask.setCallback(std::bind(&Controller::loop, this));
+    _loopTask.setCallback(TaskProfiler.wrap("GridCharger", std::bind(&Controller::loop, this)));
     _loopTask.setIterations(TASK_FOREVER);
     _loopTask.enable();
 
@@ -35,10 +36,10 @@ void Controller::updateSettings()
         _upProvider = nullptr;
     }
 
-    auto const& config = Configuration.get();
-    if (!config.GridCharger.Enabled) { return; }
+    auto const config = Configuration.get();
+    if (!config->GridCharger.Enabled) { return; }
 
-    switch (config.GridCharger.Provider) {
+    switch (config->GridCharger.Provider) {
         case GridChargerProviderType::HUAWEI:
             _upProvider = std::make_unique<::GridChargers::Huawei::Provider>();
             break;
@@ -46,7 +47,7 @@ void Controller::updateSettings()
             _upProvider = std::make_unique<::GridChargers::Trucki::Provider>();
             break;
         default:
-            DTU_LOGW("Unknown provider: %d\r\n", config.GridCharger.Provider);
+            DTU_LOGW("Unknown provider: %d\r\n", config->GridCharger.Provider);
             return;
     }
 
@@ -7,10 +7,10 @@ namespace GridChargers {
 
 void Stats::mqttLoop()
 {
-    auto& config = Configuration.get();
+    auto const config = Configuration.get();
 
     if (!MqttSettings.getConnected()
-            || (millis() - _lastMqttPublish) < (config.Mqtt.PublishInterval * 1000)) {
+            || (millis() - _lastMqttPublish) < (config->Mqtt.PublishInterval * 1000)) {
         return;
     }
 
@@ -21,13 +21,13 @@ void Stats::mqttLoop()
 
 uint32_t Stats::getMqttFullPublishIntervalMs()
 {
-    auto& config = Configuration.get();
+    auto const config = Configuration.get();
 
     // this is the default interval, see mqttLoop(). mqttPublish()
     // implementations in derived classes may choose to publish some values
     // with a lower frequency and hence implement this method with a different
     // return value.
-    return config.Mqtt.PublishInterval * 1000;
+    return config->Mqtt.PublishInterval * 1000;
 }
 
 void Stats::mqttPublish() const
@@ -0,0 +1,75 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#include <algorithm>
+#include <gridcharger/SurplusController.h>
+
+namespace GridChargers {
+
+void SurplusController::reset()
+{
+    _integral = 0;
+    _output = 0;
+    _oLastUpdateMillis = std::nullopt;
+}
+
+float SurplusController::update(PowerActuator& actuator, float targetGridPower,
+        float gridPower, uint32_t nowMillis)
+{
+    uint32_t stepMillis = MaxTimeStepMillis;
+    if (_oLastUpdateMillis) {
+        stepMillis = std::min(nowMillis - *_oLastUpdateMillis, MaxTimeStepMillis);
+    }
+    _oLastUpdateMillis = nowMillis;
+    float dt = static_cast<float>(stepMillis) / 1000;
+
+    float maxPower = std::max(actuator.getMaxInputPower(), 0.0f);
+    float minPower = std::min(std::max(actuator.getMinInputPower(), 0.0f), maxPower);
+
+    // positive if there is surplus power available
+    float error = targetGridPower - gridPower;
+
+    if (_output <= 0) {
+        // the charger is off, hence the error equals the surplus
+        _integral = std::clamp(error, 0.0f, maxPower);
+        _output = 0;
+        if (_integral > 0 && _integral >= minPower) {
+            _output = std::max(minPower, std::min(_integral, _parameters.RampUpWattsPerSecond * dt));
+        }
+        actuator.setInputPower(_output);
+        return _output;
+    }
+
+    _integral += _parameters.IntegralGain * error * dt;
+    _integral = std::clamp(_integral, 0.0f, maxPower);
+
+    float output = _parameters.ProportionalGain * error + _integral;
+
+    float upperBound = maxPower;
+    auto oInputPower = actuator.getInputPower();
+    if (oInputPower && _parameters.TrackingHeadroomWatts > 0) {
+        upperBound = std::min(upperBound, *oInputPower + _parameters.TrackingHeadroomWatts);
+        upperBound = std::max(upperBound, minPower);
+    }
+    upperBound = std::min(upperBound, _output + _parameters.RampUpWattsPerSecond * dt);
+    float lowerBound = std::max(0.0f, _output - _parameters.RampDownWattsPerSecond * dt);
+
+    // upper bound wins as the device or battery limit may drop sharply
+    output = std::min(std::max(output, lowerBound), upperBound);
+
+    if (output < minPower) {
+        // switching off is not subject to the ramp rate
+        _integral = 0;
+        _output = 0;
+        actuator.setInputPower(_output);
+        return _output;
+    }
+
+    // back-calculation: keep the integrator consistent with the output
+    // that was actually commanded.
+    _integral = std::clamp(output - _parameters.ProportionalGain * error, 0.0f, maxPower);
+
+    _output = output;
+    actuator.setInputPower(_output);
+    return _output;
+}
+
+} // namespace GridChargers
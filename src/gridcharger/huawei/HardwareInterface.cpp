@@ -309,7 +309,7 @@ bool HardwareInterface::readRectifierState(can_message_t const& msg) const
     return true;
 }
 
-bool HardwareInterface::readAcks(can_message_t const& msg) const
+bool HardwareInterface::readAcks(can_message_t const& msg)
 {
     if (msg.canId != 0x1081807e) { return false; }
 
@@ -331,6 +331,18 @@ bool HardwareInterface::readAcks(can_message_t const& msg) const
 
     float value = static_cast<float>(msg.value)/divisor;
 
+    auto oIndex = getSettingIndex(setting);
+    if (oIndex && _registers[*oIndex].awaitingAck) {
+        auto& reg = _registers[*oIndex];
+        reg.awaitingAck = false;
+        reg.lastRoundTripMillis = millis() - reg.sentMillis;
+        reg.maxRoundTripMillis = std::max(reg.maxRoundTripMillis, reg.lastRoundTripMillis);
+        ++reg.acks;
+        DTU_LOGD("setting 0x%04x acknowledged after %u ms (max %u ms, %u acks, %u writes coalesced)",
+                static_cast<uint16_t>(setting), reg.lastRoundTripMillis,
+                reg.maxRoundTripMillis, reg.acks, reg.coalesced);
+    }
+
     switch (setting) {
         case Setting::OnlineVoltage:
             _upData->add<DataPointLabel::OnlineVoltage>(value);
@@ -363,7 +375,9 @@ bool HardwareInterface::readAcks(can_message_t const& msg) const
 
 void HardwareInterface::sendSettings()
 {
-    auto const& config = Configuration.get().GridCharger;
+    // runs in the hardware interface task
+    auto spConfig = Configuration.get();
+    auto const& config = spConfig->GridCharger;
 
     using Setting = HardwareInterface::Setting;
     enqueueParameter(Setting::OfflineVoltage, config.Huawei.OfflineVoltage);
@@ -461,10 +475,10 @@ void HardwareInterface::loop()
         return; // restart by re-requesting device config in next iteration
     }
 
-    if (!_lastSettingsUpdateMillis) {
-        sendSettings();
-        return processQueue();
-    }
+    if (!_lastSettingsUpdateMillis) { sendSettings(); }
+
+    // parameter writes are not bound to the data request interval
+    processWrites();
 
     if (StringState::Complete != _boardPropertiesState) {
         // stand by while processing the board properties replies and not timed out
@@ -544,7 +558,26 @@ void HardwareInterface::processQueue()
     }
 }
 
+std::optional<size_t> HardwareInterface::getSettingIndex(HardwareInterface::Setting setting)
+{
+    for (size_t i = 0; i < Settings.size(); ++i) {
+        if (Settings[i] == setting) { return i; }
+    }
+    return std::nullopt;
+}
+
 void HardwareInterface::enqueueParameter(HardwareInterface::Setting setting, float val)
+{
+    auto oIndex = getSettingIndex(setting);
+    if (!oIndex) { return; }
+
+    auto& reg = _registers[*oIndex];
+    if (reg.pending) { ++reg.coalesced; }
+    reg.pending = val;
+    reg.tries = 3;
+}
+
+bool HardwareInterface::encodeParameter(HardwareInterface::Setting setting, float val, command_t& cmd) const
 {
     uint16_t flags = 0;
 
@@ -555,10 +588,7 @@ void HardwareInterface::enqueueParameter(HardwareInterface::Setting setting, flo
             break;
         case Setting::OfflineCurrent:
         case Setting::OnlineCurrent:
-            if (_maxCurrentMultiplier == 0) {
-                DTU_LOGW("max current multiplier unknown, cannot send current setting");
-                return;
-            }
+            if (_maxCurrentMultiplier == 0) { return false; }
             val *= _maxCurrentMultiplier;
             break;
         case Setting::InputCurrentLimit:
@@ -577,14 +607,71 @@ void HardwareInterface::enqueueParameter(HardwareInterface::Setting setting, flo
             break;
     }
 
-    _sendQueue.push(command_t {
-        .tries = 3,
+    cmd = command_t {
+        .tries = 1,
         .deviceAddress = 1,
         .registerAddress = 0x80FE,
         .command = static_cast<uint16_t>(setting),
         .flags = flags,
         .value = static_cast<uint32_t>(val)
-    });
+    };
+
+    return true;
+}
+
+void HardwareInterface::processWrites()
+{
+    uint32_t now = millis();
+
+    for (size_t i = 0; i < Settings.size(); ++i) {
+        auto& reg = _registers[i];
+        auto setting = Settings[i];
+
+        if (reg.awaitingAck) {
+            if ((now - reg.sentMillis) < AckTimeoutMillis) { continue; }
+            DTU_LOGW("no ACK for setting 0x%04x within %u ms",
+                    static_cast<uint16_t>(setting), AckTimeoutMillis);
+            reg.awaitingAck = false;
+        }
+
+        if (!reg.pending) { continue; }
+
+        command_t cmd;
+        if (!encodeParameter(setting, *reg.pending, cmd)) {
+            // keep the value until the max current multiplier is known
+            continue;
+        }
+
+        uint32_t addr = 0x10800000 | (cmd.deviceAddress << 16) | cmd.registerAddress;
+        uint32_t valueId = (static_cast<uint32_t>(cmd.command) << 16) | cmd.flags;
+        logMessage("sending", addr, valueId, cmd.value);
+
+        std::array<uint8_t, 8> data = {
+            static_cast<uint8_t>((cmd.command >> 8) & 0xFF),
+            static_cast<uint8_t>((cmd.command >> 0) & 0xFF),
+            static_cast<uint8_t>((cmd.flags >>  8) & 0xFF),
+            static_cast<uint8_t>((cmd.flags >>  0) & 0xFF),
+            static_cast<uint8_t>((cmd.value >> 24) & 0xFF),
+            static_cast<uint8_t>((cmd.value >> 16) & 0xFF),
+            static_cast<uint8_t>((cmd.value >>  8) & 0xFF),
+            static_cast<uint8_t>((cmd.value >>  0) & 0xFF)
+        };
+
+        if (sendMessage(addr, data)) {
+            reg.pending = std::nullopt;
+            reg.awaitingAck = true;
+            reg.sentMillis = now;
+            continue;
+        }
+
+        if (reg.tries > 0) { --reg.tries; }
+
+        DTU_LOGE("Sending to 0x%08x failed (no CAN ACK), command 0x%04x, "
+                "flags 0x%04x, value 0x%08x, %d tries remaining",
+                addr, cmd.command, cmd.flags, cmd.value, reg.tries);
+
+        if (reg.tries == 0) { reg.pending = std::nullopt; }
+    }
 }
 
 void HardwareInterface::setParameter(HardwareInterface::Setting setting, float val, bool pollFeedback)
@@ -8,6 +8,7 @@
 #include <gridcharger/huawei/TWAI.h>
 #include <powermeter/Controller.h>
 #include <PowerLimiter.h>
+#include <PowerArbiter.h>
 #include <Configuration.h>
 #include <LogHelper.h>
 #include <MqttSettings.h>
@@ -32,9 +33,9 @@ bool Provider::init()
 
     _upHardwareInterface.reset(nullptr);
 
-    auto const& config = Configuration.get();
+    auto const config = Configuration.get();
 
-    switch (config.GridCharger.Can.HardwareInterface) {
+    switch (config->GridCharger.Can.HardwareInterface) {
         case GridChargerHardwareInterface::MCP2515:
             _upHardwareInterface = std::make_unique<MCP2515>();
             break;
@@ -42,7 +43,7 @@ bool Provider::init()
             _upHardwareInterface = std::make_unique<TWAI>();
             break;
         default:
-            DTU_LOGE("Unknown hardware interface setting %d", config.GridCharger.Can.HardwareInterface);
+            DTU_LOGE("Unknown hardware interface setting %d", config->GridCharger.Can.HardwareInterface);
             return false;
             break;
     }
@@ -61,7 +62,7 @@ bool Provider::init()
     }
 
     _mode = HUAWEI_MODE_AUTO_EXT;
-    if (config.GridCharger.AutoPowerEnabled) {
+    if (config->GridCharger.AutoPowerEnabled) {
         _mode = HUAWEI_MODE_AUTO_INT;
     }
 
@@ -80,6 +81,7 @@ void Provider::deinit()
 
     _upHardwareInterface.reset(nullptr);
     unsubscribeTopics();
+    PowerArbiter.setChargerInputPower(0, false);
 }
 
 void Provider::enableOutput()
@@ -135,9 +137,9 @@ void Provider::loop()
 
     if (!_upHardwareInterface) { return; }
 
-    auto const& config = Configuration.get();
+    auto const config = Configuration.get();
 
-    if (!config.GridCharger.Enabled) {
+    if (!config->GridCharger.Enabled) {
         return;
     }
 
@@ -147,11 +149,16 @@ void Provider::loop()
         _stats->updateFrom(*upNewData);
     }
 
+    // report the power the PSU actually draws, which includes emergency
+    // charging and limits not set by the automatic power control
+    auto oInputPower = getInputPower();
+    bool inputPowerValid = oInputPower && millis() - _dataPoints.getLastUpdate() < 4 * HardwareInterface::DataRequestIntervalMillis;
+    PowerArbiter.setChargerInputPower(inputPowerValid ? *oInputPower : 0,
+            _mode == HUAWEI_MODE_AUTO_INT && !_batteryEmergencyCharging);
+
     auto oOutputCurrent = _dataPoints.get<DataPointLabel::OutputCurrent>();
     auto oOutputVoltage = _dataPoints.get<DataPointLabel::OutputVoltage>();
     auto oOutputPower = _dataPoints.get<DataPointLabel::OutputPower>();
-    auto oEfficiency = _dataPoints.get<DataPointLabel::Efficiency>();
-    auto efficiency = oEfficiency ? (*oEfficiency > 50 ? *oEfficiency / 100 : 1.0) : 1.0;
 
     // Internal PSU power pin (slot detect) control
     if (oOutputCurrent && *oOutputCurrent > HUAWEI_AUTO_MODE_SHUTDOWN_CURRENT) {
@@ -169,8 +176,8 @@ void Provider::loop()
 
         // Set voltage limit in periodic intervals if we're in auto mode or if emergency battery charge is requested.
         if ( _nextAutoModePeriodicIntMillis < millis()) {
-            DTU_LOGI("Periodically setting voltage limit: %f", config.GridCharger.AutoPowerVoltageLimit);
-            _setParameter(config.GridCharger.AutoPowerVoltageLimit, Setting::OnlineVoltage);
+            DTU_LOGI("Periodically setting voltage limit: %f", config->GridCharger.AutoPowerVoltageLimit);
+            _setParameter(config->GridCharger.AutoPowerVoltageLimit, Setting::OnlineVoltage);
             _nextAutoModePeriodicIntMillis = millis() + 60000;
         }
     }
@@ -179,7 +186,7 @@ void Provider::loop()
     // Emergency charge
     // ***********************
     auto stats = Battery.getStats();
-    if (!_batteryEmergencyCharging && config.GridCharger.EmergencyChargeEnabled && stats->getImmediateChargingRequest()) {
+    if (!_batteryEmergencyCharging && config->GridCharger.EmergencyChargeEnabled && stats->getImmediateChargingRequest()) {
         if (!oOutputVoltage) {
             // TODO(schlimmchen): if this situation actually occurs, this message
             // will be printed with high frequency for a prolonged time. how can
@@ -189,9 +196,10 @@ void Provider::loop()
         }
 
         _batteryEmergencyCharging = true;
+        _surplusController.reset();
 
         // Set output current
-        float outputCurrent = config.GridCharger.AutoPowerUpperPowerLimit / *oOutputVoltage;
+        float outputCurrent = config->GridCharger.AutoPowerUpperPowerLimit / *oOutputVoltage;
         DTU_LOGI("Emergency Charge Output current %.02f", outputCurrent);
         _setParameter(outputCurrent, Setting::OnlineCurrent);
         return;
@@ -213,7 +221,6 @@ void Provider::loop()
     // ***********************
     if (_mode == HUAWEI_MODE_AUTO_INT ) {
         // Check if we should run automatic power calculation at all.
-        // We may have set a value recently and still wait for output stabilization
         if (_autoModeBlockedTillMillis > millis()) {
             return;
         }
@@ -225,11 +232,16 @@ void Provider::loop()
         }
 
         // Re-enable automatic power control if the output voltage has dropped below threshold
-        if (oOutputVoltage && *oOutputVoltage < config.GridCharger.AutoPowerEnableVoltageLimit ) {
+        if (oOutputVoltage && *oOutputVoltage < config->GridCharger.AutoPowerEnableVoltageLimit ) {
             _autoPowerEnabledCounter = 10;
         }
 
-        if (PowerLimiter.isGovernedBatteryPoweredInverterProducing()) {
+        auto const& allocation = PowerArbiter.getAllocation();
+
+        // the battery-powered inverters did not yet shed all of their output
+        // for the current power meter reading, so we must not charge.
+        if (!allocation.InverterYields && PowerLimiter.isGovernedBatteryPoweredInverterProducing()) {
+            _surplusController.reset();
             _setParameter(0.0, Setting::OnlineCurrent);
             // Don't run auto mode for a second now. Otherwise we may send too much over the CAN bus
             _autoModeBlockedTillMillis = millis() + 1000;
@@ -237,76 +249,99 @@ void Provider::loop()
             return;
         }
 
-        if (PowerMeter.getLastUpdate() > _lastPowerMeterUpdateReceivedMillis &&
+        if (allocation.Valid && allocation.Timestamp > _lastPowerMeterUpdateReceivedMillis &&
                 _autoPowerEnabledCounter > 0) {
             // We have received a new PowerMeter value. Also we're _autoPowerEnabled
             // So we're good to calculate a new limit
 
-            _lastPowerMeterUpdateReceivedMillis = PowerMeter.getLastUpdate();
-
-            // input power diff will be (close to) zero if the power meter value
-            // reads what the user specified as the target power consumption.
-            float inputPowerDiff = -1 * round(PowerMeter.getPowerTotal());
-            inputPowerDiff += config.GridCharger.AutoPowerTargetPowerConsumption;
-
-            // target output power is current output adjusted for difference to desired input power
-            float newOutputPowerTarget = *oOutputPower + (inputPowerDiff * efficiency);
+            _lastPowerMeterUpdateReceivedMillis = allocation.Timestamp;
 
-            DTU_LOGD("input diff: %.0f, new output target: %.0f, current output: %.01f",
-                inputPowerDiff, newOutputPowerTarget, *oOutputPower);
-
-            // Check whether the battery SoC limit setting is enabled
-            if (config.Battery.Enabled && config.GridCharger.AutoPowerBatterySoCLimitsEnabled) {
-                uint8_t _batterySoC = Battery.getStats()->getSoC();
-                // Sets power limit to 0 if the BMS reported SoC reaches or exceeds the user configured value
-                if (_batterySoC >= config.GridCharger.AutoPowerStopBatterySoCThreshold) {
-                    newOutputPowerTarget = 0;
-                    DTU_LOGD("Current battery SoC %i reached stop threshold %i, so new output target is %f",
-                            _batterySoC, config.GridCharger.AutoPowerStopBatterySoCThreshold, newOutputPowerTarget);
-                }
-            }
-
-            if (newOutputPowerTarget > config.GridCharger.AutoPowerLowerPowerLimit) {
-                // Check if the output power has dropped below the lower limit (i.e. the battery is full)
-                // and if the PSU should be turned off. Also we use a simple counter mechanism here to be able
-                // to ramp up from zero output power when starting up
-                if (*oOutputPower < config.GridCharger.AutoPowerLowerPowerLimit) {
+            // Check if the output power stays below the lower limit while
+            // charging (i.e. the battery is full) and if the PSU should be
+            // turned off. The counter is decremented at most every couple
+            // of seconds to allow for ramping up from zero output power.
+            if (_surplusController.isActive() && *oOutputPower < config->GridCharger.AutoPowerLowerPowerLimit) {
+                if (millis() - _lastAutoPowerCounterMillis >= 2 * HardwareInterface::DataRequestIntervalMillis) {
                     DTU_LOGI("Power and voltage limit reached. Disabling automatic power control.");
-                    _autoPowerEnabledCounter--;
-                    if (_autoPowerEnabledCounter == 0) {
+                    _lastAutoPowerCounterMillis = millis();
+                    if (--_autoPowerEnabledCounter == 0) {
                         _autoPowerEnabled = false;
+                        _surplusController.reset();
                         _setParameter(0.0, Setting::OnlineCurrent);
                         return;
                     }
-                } else {
-                    _autoPowerEnabledCounter = 10;
                 }
+            } else {
+                _autoPowerEnabledCounter = 10;
+            }
 
-                newOutputPowerTarget = std::min(newOutputPowerTarget, config.GridCharger.AutoPowerUpperPowerLimit);
+            auto parameters = _surplusController.getParameters();
+            parameters.RampUpWattsPerSecond = config->GridCharger.AutoPowerRampUpRate;
+            parameters.RampDownWattsPerSecond = config->GridCharger.AutoPowerRampDownRate;
+            _surplusController.setParameters(parameters);
 
-                float calculatedCurrent = newOutputPowerTarget / *oOutputVoltage;
+            _surplusController.update(*this, config->GridCharger.AutoPowerTargetPowerConsumption,
+                    round(allocation.ChargerGridPower), millis());
 
-                // Limit output current to value requested by BMS
-                float permissibleCurrent = stats->getChargeCurrentLimit() - (stats->getChargeCurrent() - *oOutputCurrent); // BMS current limit - current from other sources, e.g. Victron MPPT charger
-                float outputCurrent = std::min(calculatedCurrent, permissibleCurrent);
-                outputCurrent = outputCurrent > 0 ? outputCurrent : 0;
+            _autoPowerEnabled = _surplusController.isActive();
+        }
+    }
+}
 
-                DTU_LOGD("Setting output current to %.2fA. This is the lower value of "
-                        "calculated %.2fA and BMS permissible %.2fA currents",
-                        outputCurrent, calculatedCurrent, permissibleCurrent);
+float Provider::getEfficiency() const
+{
+    auto oEfficiency = _dataPoints.get<DataPointLabel::Efficiency>();
+    return oEfficiency ? (*oEfficiency > 50 ? *oEfficiency / 100 : 1.0) : 1.0;
+}
+
+std::optional<float> Provider::getInputPower() const
+{
+    return _dataPoints.get<DataPointLabel::InputPower>();
+}
 
-                _autoPowerEnabled = true;
-                _setParameter(outputCurrent, Setting::OnlineCurrent);
+float Provider::getMinInputPower() const
+{
+    return Configuration.get()->GridCharger.AutoPowerLowerPowerLimit / getEfficiency();
+}
 
-                // Don't run auto mode some time to allow for output stabilization after issuing a new value
-                _autoModeBlockedTillMillis = millis() + 2 * HardwareInterface::DataRequestIntervalMillis;
-            } else {
-                // requested PL is below minium. Set current to 0
-                _autoPowerEnabled = false;
-                _setParameter(0.0, Setting::OnlineCurrent);
-            }
+float Provider::getMaxInputPower() const
+{
+    auto const config = Configuration.get();
+
+    // Check whether the battery SoC limit setting is enabled
+    if (config->Battery.Enabled && config->GridCharger.AutoPowerBatterySoCLimitsEnabled) {
+        uint8_t _batterySoC = Battery.getStats()->getSoC();
+        // Sets power limit to 0 if the BMS reported SoC reaches or exceeds the user configured value
+        if (_batterySoC >= config->GridCharger.AutoPowerStopBatterySoCThreshold) {
+            DTU_LOGD("Current battery SoC %i reached stop threshold %i",
+                    _batterySoC, config->GridCharger.AutoPowerStopBatterySoCThreshold);
+            return 0;
         }
     }
+
+    auto oOutputVoltage = _dataPoints.get<DataPointLabel::OutputVoltage>();
+    auto oOutputCurrent = _dataPoints.get<DataPointLabel::OutputCurrent>();
+    if (!oOutputVoltage || !oOutputCurrent) { return 0; }
+
+    // Limit output current to value requested by BMS
+    auto stats = Battery.getStats();
+    float permissibleCurrent = stats->getChargeCurrentLimit() - (stats->getChargeCurrent() - *oOutputCurrent); // BMS current limit - current from other sources, e.g. Victron MPPT charger
+    float maxOutputPower = std::min(config->GridCharger.AutoPowerUpperPowerLimit,
+            std::max(permissibleCurrent, 0.0f) * *oOutputVoltage);
+
+    return maxOutputPower / getEfficiency();
+}
+
+void Provider::setInputPower(float watts)
+{
+    auto oOutputVoltage = _dataPoints.get<DataPointLabel::OutputVoltage>();
+    if (!oOutputVoltage || *oOutputVoltage <= 0) { return; }
+
+    float outputCurrent = watts * getEfficiency() / *oOutputVoltage;
+
+    DTU_LOGD("Setting output current to %.2fA (%.0fW input power)", outputCurrent, watts);
+
+    _setParameter(outputCurrent, HardwareInterface::Setting::OnlineCurrent);
 }
 
 void Provider::setFan(bool online, bool fullSpeed)
@@ -389,9 +424,9 @@ void Provider::setMode(uint8_t mode) {
     // Update mode in datapoints
     _dataPoints.add<DataPointLabel::Mode>(_mode, true);
 
-    auto const& config = Configuration.get();
+    auto const config = Configuration.get();
 
-    if (mode == HUAWEI_MODE_AUTO_INT && !config.GridCharger.AutoPowerEnabled ) {
+    if (mode == HUAWEI_MODE_AUTO_INT && !config->GridCharger.AutoPowerEnabled ) {
         DTU_LOGW("Trying to set mode to internal automatic power control "
                 "without being enabled in the UI. Ignoring command.");
         return;
@@ -399,6 +434,7 @@ void Provider::setMode(uint8_t mode) {
 
     if (_mode == HUAWEI_MODE_AUTO_INT && mode != HUAWEI_MODE_AUTO_INT) {
         _autoPowerEnabled = false;
+        _surplusController.reset();
         _setParameter(0, HardwareInterface::Setting::OnlineCurrent);
     }
 
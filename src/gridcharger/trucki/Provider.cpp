@@ -5,6 +5,7 @@
 #include <battery/Controller.h>
 #include <powermeter/Controller.h>
 #include <PowerLimiter.h>
+#include <PowerArbiter.h>
 #include <Utils.h>
 #include <WiFiUdp.h>
 #include <LogHelper.h>
@@ -22,8 +23,8 @@ bool Provider::init()
 {
     DTU_LOGI("Initialize Trucki AC charger interface...");
 
-    auto const& config = Configuration.get();
-    auto const& ipAddress = IPAddress(config.GridCharger.Trucki.IpAddress);
+    auto const config = Configuration.get();
+    auto const& ipAddress = IPAddress(config->GridCharger.Trucki.IpAddress);
 
     if (ipAddress.toString() == "0.0.0.0") {
         DTU_LOGE("Invalid IP address: %s", ipAddress.toString().c_str());
@@ -41,7 +42,7 @@ bool Provider::init()
     strlcpy(_httpRequestConfig->HeaderKey, "", sizeof(_httpRequestConfig->HeaderKey));
     strlcpy(_httpRequestConfig->HeaderValue, "", sizeof(_httpRequestConfig->HeaderValue));
     strlcpy(_httpRequestConfig->Username, "admin", sizeof(_httpRequestConfig->Username)); // default username
-    strlcpy(_httpRequestConfig->Password, config.GridCharger.Trucki.Password, sizeof(_httpRequestConfig->Password));
+    strlcpy(_httpRequestConfig->Password, config->GridCharger.Trucki.Password, sizeof(_httpRequestConfig->Password));
 
     if (strlen(_httpRequestConfig->Password) > 0) {
         _httpRequestConfig->AuthType = HttpRequestConfig::Auth::Basic;
@@ -66,6 +67,7 @@ bool Provider::init()
 void Provider::deinit()
 {
     TruckiUdp.stop();
+    PowerArbiter.setChargerInputPower(0, false);
 
     _dataPollingTaskDone = false;
 
@@ -86,6 +88,13 @@ void Provider::deinit()
 
 void Provider::loop()
 {
+    // report the power the PSU actually draws, which includes emergency
+    // charging and limits not set by the automatic power control
+    auto oInputPower = getInputPower();
+    bool inputPowerValid = oInputPower && millis() - _dataCurrent.getLastUpdate() < 4u * DATA_POLLING_INTERVAL_MS;
+    PowerArbiter.setChargerInputPower(inputPowerValid ? *oInputPower : 0,
+            Configuration.get()->GridCharger.AutoPowerEnabled && !_batteryEmergencyCharging);
+
     powerControlLoop();
 
     sendControlCommandRequest();
@@ -104,7 +113,7 @@ void Provider::loop()
 
 void Provider::powerControlLoop()
 {
-    auto& config = Configuration.get();
+    auto const config = Configuration.get();
 
     auto oMaxAcPower = _dataCurrent.get<DataPointLabel::MaxAcPower>();
     auto oOutputPower = _dataCurrent.get<DataPointLabel::DcPower>();
@@ -113,7 +122,7 @@ void Provider::powerControlLoop()
     // Emergency charge
     // ***********************
     auto stats = Battery.getStats();
-    if (!_batteryEmergencyCharging && config.GridCharger.EmergencyChargeEnabled && stats->getImmediateChargingRequest()) {
+    if (!_batteryEmergencyCharging && config->GridCharger.EmergencyChargeEnabled && stats->getImmediateChargingRequest()) {
         if (!oMaxAcPower) {
             // TODO(andreasboehm): if this situation actually occurs, this message
             // will be printed with high frequency for a prolonged time. how can
@@ -123,6 +132,7 @@ void Provider::powerControlLoop()
         }
 
         _batteryEmergencyCharging = true;
+        _surplusController.reset();
 
         DTU_LOGI("Emergency Charge AC Power %.02f", *oMaxAcPower);
         setRequestedPowerAc(*oMaxAcPower);
@@ -141,14 +151,18 @@ void Provider::powerControlLoop()
     // ***********************
     // Automatic power control
     // ***********************
-    if (config.GridCharger.AutoPowerEnabled) {
+    if (config->GridCharger.AutoPowerEnabled) {
         // Check if we should run automatic power calculation at all.
-        // We may have set a value recently and still wait for output stabilization
         if (_autoModeBlockedTillMillis > millis()) {
             return;
         }
 
-        if (PowerLimiter.isGovernedBatteryPoweredInverterProducing()) {
+        auto const& allocation = PowerArbiter.getAllocation();
+
+        // the battery-powered inverters did not yet shed all of their output
+        // for the current power meter reading, so we must not charge.
+        if (!allocation.InverterYields && PowerLimiter.isGovernedBatteryPoweredInverterProducing()) {
+            _surplusController.reset();
             setRequestedPowerAc(0);
             _autoPowerEnabled = false;
             DTU_LOGI("Inverter is active, disable PSU");
@@ -180,62 +194,75 @@ void Provider::powerControlLoop()
 
         // We have received a new PowerMeter value. Also we're _autoPowerEnabled
         // So we're good to calculate a new limit
-        if (PowerMeter.getLastUpdate() > _lastPowerMeterUpdateReceivedMillis && _autoPowerEnabled) {
-            _lastPowerMeterUpdateReceivedMillis = PowerMeter.getLastUpdate();
+        if (allocation.Valid && allocation.Timestamp > _lastPowerMeterUpdateReceivedMillis && _autoPowerEnabled) {
+            _lastPowerMeterUpdateReceivedMillis = allocation.Timestamp;
 
-            float powerTotal = round(PowerMeter.getPowerTotal());
+            auto parameters = _surplusController.getParameters();
+            parameters.RampUpWattsPerSecond = config->GridCharger.AutoPowerRampUpRate;
+            parameters.RampDownWattsPerSecond = config->GridCharger.AutoPowerRampDownRate;
+            _surplusController.setParameters(parameters);
 
-            // Calculate new power limit
-            float newPowerLimit = -1 * powerTotal;
+            float powerTotal = round(allocation.ChargerGridPower);
+            float newPowerLimit = _surplusController.update(*this,
+                    config->GridCharger.AutoPowerTargetPowerConsumption, powerTotal, millis());
 
-            // Powerlimit is the current output power + permissable Grid consumption
-            newPowerLimit += *oOutputPower + config.GridCharger.AutoPowerTargetPowerConsumption;
+            // requested PL is below minimum, the PSU was switched off
+            if (newPowerLimit <= 0) {
+                _autoPowerEnabled = false;
+            }
 
             DTU_LOGV("powerTotal: %.0f, outputPower: %.01f, newPowerLimit: %.0f", powerTotal, *oOutputPower, newPowerLimit);
+        }
+    }
+}
 
-            // Check whether the battery SoC limit setting is enabled
-            if (config.Battery.Enabled && config.GridCharger.AutoPowerBatterySoCLimitsEnabled) {
-                uint8_t _batterySoC = Battery.getStats()->getSoC();
-                // Sets power limit to 0 if the BMS reported SoC reaches or exceeds the user configured value
-                if (_batterySoC >= config.GridCharger.AutoPowerStopBatterySoCThreshold) {
-                    newPowerLimit = 0;
-                    DTU_LOGV("Current battery SoC %i reached stop threshold %i, set newPowerLimit to %f",
-                            _batterySoC, config.GridCharger.AutoPowerStopBatterySoCThreshold, newPowerLimit);
-                }
-            }
+float Provider::getEfficiency() const
+{
+    auto efficiency = _dataCurrent.get<DataPointLabel::Efficiency>().value_or(90) / 100.0f;
+    return efficiency > 0.5f ? efficiency : 0.9f;
+}
 
-            if (newPowerLimit >= *oMinAcPower) {
-                // Limit power to maximum
-                if (newPowerLimit > *oMaxAcPower) {
-                    newPowerLimit = *oMaxAcPower;
-                }
+std::optional<float> Provider::getInputPower() const
+{
+    return _dataCurrent.get<DataPointLabel::AcPower>();
+}
 
-                auto efficiency = _dataCurrent.get<DataPointLabel::Efficiency>().value_or(90) / 100.0f;
-                efficiency = efficiency > 0.5f ? efficiency : 0.9f;
+float Provider::getMinInputPower() const
+{
+    return _dataCurrent.get<DataPointLabel::MinAcPower>().value_or(0);
+}
 
-                // Calculate output current
-                float calculatedCurrent = efficiency * (newPowerLimit / *oOutputVoltage);
+float Provider::getMaxInputPower() const
+{
+    auto const config = Configuration.get();
+
+    // Check whether the battery SoC limit setting is enabled
+    if (config->Battery.Enabled && config->GridCharger.AutoPowerBatterySoCLimitsEnabled) {
+        uint8_t _batterySoC = Battery.getStats()->getSoC();
+        // Sets power limit to 0 if the BMS reported SoC reaches or exceeds the user configured value
+        if (_batterySoC >= config->GridCharger.AutoPowerStopBatterySoCThreshold) {
+            DTU_LOGV("Current battery SoC %i reached stop threshold %i",
+                    _batterySoC, config->GridCharger.AutoPowerStopBatterySoCThreshold);
+            return 0;
+        }
+    }
 
-                // Limit output current to value requested by BMS
-                float permissibleCurrent = stats->getChargeCurrentLimit() - (stats->getChargeCurrent() - *oOutputCurrent); // BMS current limit - current from other sources, e.g. Victron MPPT charger
-                float outputCurrent = std::min(calculatedCurrent, permissibleCurrent);
-                outputCurrent = outputCurrent > 0 ? outputCurrent : 0;
+    auto oMaxAcPower = _dataCurrent.get<DataPointLabel::MaxAcPower>();
+    auto oOutputVoltage = _dataCurrent.get<DataPointLabel::DcVoltage>();
+    auto oOutputCurrent = _dataCurrent.get<DataPointLabel::DcCurrent>();
+    if (!oMaxAcPower || !oOutputVoltage || !oOutputCurrent) { return 0; }
 
-                // calculate new power limit based on output current
-                newPowerLimit = (outputCurrent * *oOutputVoltage) / efficiency;
+    // Limit output current to value requested by BMS
+    auto stats = Battery.getStats();
+    float permissibleCurrent = stats->getChargeCurrentLimit() - (stats->getChargeCurrent() - *oOutputCurrent); // BMS current limit - current from other sources, e.g. Victron MPPT charger
+    float permissiblePower = std::max(permissibleCurrent, 0.0f) * *oOutputVoltage / getEfficiency();
 
-                _autoPowerEnabled = true;
-                setRequestedPowerAc(newPowerLimit);
+    return std::min(*oMaxAcPower, permissiblePower);
+}
 
-                // Don't run auto mode some time to allow for output stabilization after issuing a new value
-                _autoModeBlockedTillMillis = millis() + 4 * DATA_POLLING_INTERVAL_MS;
-            } else {
-                // requested PL is below minium. Set power to 0
-                _autoPowerEnabled = false;
-                setRequestedPowerAc(0);
-            }
-        }
-    }
+void Provider::setInputPower(float watts)
+{
+    setRequestedPowerAc(watts);
 }
 
 void Provider::setRequestedPowerAc(float power)
@@ -245,9 +272,9 @@ void Provider::setRequestedPowerAc(float power)
 
 void Provider::sendControlCommandRequest()
 {
-    auto& config = Configuration.get();
+    auto const config = Configuration.get();
 
-    if (!config.GridCharger.AutoPowerEnabled && !config.GridCharger.EmergencyChargeEnabled) {
+    if (!config->GridCharger.AutoPowerEnabled && !config->GridCharger.EmergencyChargeEnabled) {
         return;
     }
 
@@ -257,7 +284,7 @@ void Provider::sendControlCommandRequest()
 
     uint16_t acPowerSetpoint = _requestedPowerAc * 10; // ac power in W*10
 
-    TruckiUdp.beginPacket(config.GridCharger.Trucki.IpAddress, udpPort);
+    TruckiUdp.beginPacket(config->GridCharger.Trucki.IpAddress, udpPort);
     TruckiUdp.print(String(acPowerSetpoint));
     TruckiUdp.endPacket();
 
@@ -26,6 +26,7 @@
 #include "RestartHelper.h"
 #include "Scheduler.h"
 #include "SunPosition.h"
+#include "TaskProfiler.h"
 #include "Utils.h"
 #include "WebApi.h"
 #include <powermeter/Controller.h>
@@ -53,6 +54,7 @@ void setup()
         yield();
 #endif
     MessageOutput.init(scheduler);
+    TaskProfiler.init(scheduler);
 
     // For now, the log levels are just hard coded
     esp_log_level_set("*", ESP_LOG_VERBOSE);
@@ -70,20 +72,20 @@ void setup()
 
     // Read configuration values
     ESP_LOGI(TAG, "Reading configuration...");
-    Configuration.init(scheduler);
+    Configuration.init();
     if (!Configuration.read()) {
         bool success = Configuration.write();
         ESP_LOG_LEVEL_LOCAL((success ? ESP_LOG_INFO : ESP_LOG_WARN), TAG, "Failed to read configuration. New default configuration written %s",
             success ? "successful" : "failed");
     }
-    if (Configuration.get().Cfg.Version != CONFIG_VERSION) {
+    if (Configuration.get()->Cfg.Version != CONFIG_VERSION) {
         ESP_LOGI(TAG, "Performing configuration migration from %" PRIX32 " to %" PRIX32 "",
-            Configuration.get().Cfg.Version, CONFIG_VERSION);
+            Configuration.get()->Cfg.Version, CONFIG_VERSION);
         Configuration.migrate();
     }
-    if (Configuration.get().Cfg.VersionOnBattery != CONFIG_VERSION_ONBATTERY) {
+    if (Configuration.get()->Cfg.VersionOnBattery != CONFIG_VERSION_ONBATTERY) {
         ESP_LOGI(TAG, "Migrating OpenDTU-OnBattery-specific config from %d to %d",
-            Configuration.get().Cfg.VersionOnBattery, CONFIG_VERSION_ONBATTERY);
+            Configuration.get()->Cfg.VersionOnBattery, CONFIG_VERSION_ONBATTERY);
         Configuration.migrateOnBattery();
     }
 
@@ -97,7 +99,7 @@ void setup()
 
     // Load PinMapping
     ESP_LOGI(TAG, "Reading PinMapping...");
-    if (PinMapping.init(Configuration.get().Dev_PinMapping)) {
+    if (PinMapping.init(Configuration.get()->Dev_PinMapping)) {
         ESP_LOGI(TAG, "Found valid mapping");
     } else {
         ESP_LOGW(TAG, "Didn't found valid mapping. Using default.");
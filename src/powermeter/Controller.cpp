@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 #include <powermeter/Controller.h>
 #include <Configuration.h>
+#include <TaskProfiler.h>
 #include <powermeter/json/http/Provider.h>
 #include <powermeter/json/mqtt/Provider.h>
 #include <powermeter/sdm/serial/Provider.h>
@@ -16,7 +17,7 @@ namespace PowerMeters {
 void Controller::init(Scheduler& scheduler)
 {
     scheduler.addTask(_loopTask);
-    _loopTask.setCallback(std::bind(&Controller::loop, this));
+    _loopTask.setCallback(TaskProfiler.wrap("PowerMeter", std::bind(&Controller::loop, this)));
     _loopTask.setIterations(TASK_FOREVER);
     _loopTask.enable();
 
@@ -29,7 +30,8 @@ void Controller::updateSettings()
 
     if (_upProvider) { _upProvider.reset(); }
 
-    auto const& pmcfg = Configuration.get().PowerMeter;
+    auto const spConfig = Configuration.get();
+    auto const& pmcfg = spConfig->PowerMeter;
 
     if (!pmcfg.Enabled) { return; }
 
@@ -88,13 +90,32 @@ bool Controller::isDataValid() const
     return _upProvider->isDataValid();
 }
 
+Controller::Sample Controller::getSample() const
+{
+    std::lock_guard<std::mutex> l(_mutex);
+    if (!_upProvider) { return {}; }
+
+    // the provider may receive a new reading while we are reading the
+    // power value, in which case we read it again.
+    Sample sample;
+    for (int attempt = 0; attempt < 3; ++attempt) {
+        sample.Timestamp = _upProvider->getLastUpdate();
+        sample.PowerTotal = _upProvider->getPowerTotal();
+        if (sample.Timestamp == _upProvider->getLastUpdate()) { break; }
+    }
+    sample.Valid = _upProvider->isDataValid();
+
+    return sample;
+}
+
 void Controller::loop()
 {
     std::lock_guard<std::mutex> lock(_mutex);
     if (!_upProvider) { return; }
     _upProvider->loop();
 
-    auto const& pmcfg = Configuration.get().PowerMeter;
+    auto const spConfig = Configuration.get();
+    auto const& pmcfg = spConfig->PowerMeter;
     // we don't need to republish data received from MQTT
     if (pmcfg.Source == static_cast<uint8_t>(Provider::Type::MQTT)) { return; }
     _upProvider->mqttLoop();
@@ -28,14 +28,20 @@ void Provider::mqttLoop() const
     auto constexpr halfOfAllMillis = std::numeric_limits<uint32_t>::max() / 2;
     if ((getLastUpdate() - _lastMqttPublish) > halfOfAllMillis) { return; }
 
+    MqttBatch batch("powermeter/");
+
+    MqttTopic topic;
+    topic.append("powermeter/");
+    const size_t base = topic.length();
+
     // based on getPowerTotal() as we can not be sure that the PowerTotal value is set for all providers
-    MqttSettings.publish("powermeter/powertotal", String(getPowerTotal()));
+    MqttSettings.publish(topic.append("powertotal"), getPowerTotal());
 
 #define PUB(l, t) \
     { \
         auto oDataPoint = _dataCurrent.get<DataPointLabel::l>(); \
         if (oDataPoint) { \
-            MqttSettings.publish("powermeter/" t, String(*oDataPoint)); \
+            MqttSettings.publish(topic.truncate(base).append(t), *oDataPoint); \
         } \
     }
 
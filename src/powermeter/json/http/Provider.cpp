@@ -1,5 +1,4 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
-#include <Utils.h>
 #include <powermeter/json/http/Provider.h>
 #include <WiFiClientSecure.h>
 #include <ArduinoJson.h>
@@ -35,6 +34,7 @@ bool Provider::init()
     for (uint8_t i = 0; i < POWERMETER_HTTP_JSON_MAX_VALUES; i++) {
         auto const& valueConfig = _cfg.Values[i];
 
+        _extractors[i] = JsonPathExtractor(valueConfig.JsonPath);
         _httpGetters[i] = nullptr;
 
         if (i == 0 || (_cfg.IndividualRequests && valueConfig.Enabled)) {
@@ -144,7 +144,7 @@ Provider::poll_result_t Provider::poll()
             }
         }
 
-        auto pathResolutionResult = Utils::getJsonValueByPath<float>(jsonResponse, cfg.JsonPath);
+        auto pathResolutionResult = _extractors[i].resolve<float>(jsonResponse.as<JsonVariantConst>());
         if (!pathResolutionResult.second.isEmpty()) {
             return prefixedError(i, pathResolutionResult.second.c_str());
         }
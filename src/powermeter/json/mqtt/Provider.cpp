@@ -16,6 +16,7 @@ bool Provider::init()
     auto subscribe = [this](PowerMeterMqttValue const& val, uint8_t phaseIndex) {
         char const* topic = val.Topic;
         if (strlen(topic) == 0) { return; }
+        _extractors[phaseIndex] = JsonPathExtractor(val.JsonPath);
         MqttSettings.subscribe(topic, 0,
                 std::bind(&Provider::onMessage,
                     this, std::placeholders::_1, std::placeholders::_2,
@@ -42,9 +43,8 @@ void Provider::onMessage(Provider::MsgProperties const& properties,
         char const* topic, uint8_t const* payload, size_t len,
         uint8_t const phaseIndex, PowerMeterMqttValue const* cfg)
 {
-    auto extracted = Utils::getNumericValueFromMqttPayload<float>("PowerMeters::Json::Mqtt",
-            std::string(reinterpret_cast<const char*>(payload), len), topic,
-            cfg->JsonPath);
+    auto extracted = _extractors[phaseIndex].extract<float>("PowerMeters::Json::Mqtt",
+            std::string_view(reinterpret_cast<const char*>(payload), len), topic);
 
     if (!extracted.has_value()) { return; }
 
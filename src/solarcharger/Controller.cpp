@@ -1,5 +1,6 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 #include <Configuration.h>
+#include <TaskProfiler.h>
 #include <MqttSettings.h>
 #include <solarcharger/Controller.h>
 #include <solarcharger/DummyStats.h>
@@ -18,7 +19,7 @@ namespace SolarChargers {
 void Controller::init(Scheduler& scheduler)
 {
     scheduler.addTask(_loopTask);
-    _loopTask.setCallback(std::bind(&Controller::loop, this));
+    _loopTask.setCallback(TaskProfiler.wrap("SolarCharger", std::bind(&Controller::loop, this)));
     _loopTask.setIterations(TASK_FOREVER);
     _loopTask.enable();
 
@@ -34,10 +35,10 @@ void Controller::updateSettings()
         _upProvider = nullptr;
     }
 
-    auto const& config = Configuration.get();
-    if (!config.SolarCharger.Enabled) { return; }
+    auto const config = Configuration.get();
+    if (!config->SolarCharger.Enabled) { return; }
 
-    switch (config.SolarCharger.Provider) {
+    switch (config->SolarCharger.Provider) {
         case SolarChargerProviderType::VEDIRECT:
             _upProvider = std::make_unique<::SolarChargers::Victron::Provider>();
             break;
@@ -45,7 +46,7 @@ void Controller::updateSettings()
             _upProvider = std::make_unique<::SolarChargers::Mqtt::Provider>();
             break;
         default:
-            DTU_LOGE("Unknown provider: %d", config.SolarCharger.Provider);
+            DTU_LOGE("Unknown provider: %d", config->SolarCharger.Provider);
             return;
     }
 
@@ -83,8 +84,8 @@ void Controller::loop()
 
     _upProvider->getStats()->mqttLoop();
 
-    auto const& config = Configuration.get();
-    if (!config.Mqtt.Hass.Enabled) { return; }
+    auto const config = Configuration.get();
+    if (!config->Mqtt.Hass.Enabled) { return; }
 
     _upProvider->getStats()->mqttPublishSensors(_forcePublishSensors);
 
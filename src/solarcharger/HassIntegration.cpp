@@ -2,7 +2,7 @@
 
 #include <solarcharger/HassIntegration.h>
 #include <Configuration.h>
-#include <MqttSettings.h>
+#include <MqttHassPublisher.h>
 #include <MqttHandleHass.h>
 #include <Utils.h>
 #include <__compiled_constants.h>
@@ -11,9 +11,7 @@ namespace SolarChargers {
 
 void HassIntegration::publish(const String& subtopic, const String& payload) const
 {
-    String topic = Configuration.get().Mqtt.Hass.Topic;
-    topic += subtopic;
-    MqttSettings.publishGeneric(topic.c_str(), payload.c_str(), Configuration.get().Mqtt.Hass.Retain);
+    MqttHassPublisher.publish(subtopic, payload);
 }
 
 } // namespace SolarChargers
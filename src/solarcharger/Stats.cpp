@@ -10,7 +10,7 @@ void Stats::getLiveViewData(JsonVariant& root, boolean fullUpdate, uint32_t last
 {
     // power limiter state
     root["dpl"]["PLSTATE"] = -1;
-    if (Configuration.get().PowerLimiter.Enabled) {
+    if (Configuration.get()->PowerLimiter.Enabled) {
         root["dpl"]["PLSTATE"] = PowerLimiter.getPowerLimiterState();
     }
     root["dpl"]["PLLIMIT"] = PowerLimiter.getInverterOutput();
@@ -20,10 +20,10 @@ void Stats::getLiveViewData(JsonVariant& root, boolean fullUpdate, uint32_t last
 
 void Stats::mqttLoop()
 {
-    auto& config = Configuration.get();
+    auto const config = Configuration.get();
 
     if (!MqttSettings.getConnected()
-            || (millis() - _lastMqttPublish) < (config.Mqtt.PublishInterval * 1000)) {
+            || (millis() - _lastMqttPublish) < (config->Mqtt.PublishInterval * 1000)) {
         return;
     }
 
@@ -34,13 +34,13 @@ void Stats::mqttLoop()
 
 uint32_t Stats::getMqttFullPublishIntervalMs() const
 {
-    auto& config = Configuration.get();
+    auto const config = Configuration.get();
 
     // this is the default interval, see mqttLoop(). mqttPublish()
     // implementations in derived classes may choose to publish some values
     // with a lower frequency and hence implement this method with a different
     // return value.
-    return config.Mqtt.PublishInterval * 1000;
+    return config->Mqtt.PublishInterval * 1000;
 }
 
 void Stats::mqttPublish() const
@@ -13,11 +13,15 @@ namespace SolarChargers::Mqtt {
 
 bool Provider::init()
 {
-    auto const& config = Configuration.get().SolarCharger.Mqtt;
+    auto const spConfig = Configuration.get();
+    auto const& config = spConfig->SolarCharger.Mqtt;
 
     _outputPowerTopic = config.PowerTopic;
     _outputCurrentTopic = config.CurrentTopic;
     _outputVoltageTopic = config.VoltageTopic;
+    _outputPowerExtractor = JsonPathExtractor(config.PowerJsonPath);
+    _outputCurrentExtractor = JsonPathExtractor(config.CurrentJsonPath);
+    _outputVoltageExtractor = JsonPathExtractor(config.VoltageJsonPath);
 
     bool configValid = !config.CalculateOutputPower && !_outputPowerTopic.isEmpty();
     if (config.CalculateOutputPower) {
@@ -44,7 +48,7 @@ bool Provider::init()
                 std::bind(&Provider::onMqttMessageOutputPower,
                     this, std::placeholders::_1, std::placeholders::_2,
                     std::placeholders::_3, std::placeholders::_4,
-                    config.PowerJsonPath)
+                    &_outputPowerExtractor)
                 );
 
         DTU_LOGI("Subscribed to '%s' for ouput_power readings", _outputPowerTopic.c_str());
@@ -57,7 +61,7 @@ bool Provider::init()
                 std::bind(&Provider::onMqttMessageOutputCurrent,
                     this, std::placeholders::_1, std::placeholders::_2,
                     std::placeholders::_3, std::placeholders::_4,
-                    config.CurrentJsonPath)
+                    &_outputCurrentExtractor)
                 );
 
         DTU_LOGI("Subscribed to '%s' for output_current readings", _outputCurrentTopic.c_str());
@@ -70,7 +74,7 @@ bool Provider::init()
                 std::bind(&Provider::onMqttMessageOutputVoltage,
                     this, std::placeholders::_1, std::placeholders::_2,
                     std::placeholders::_3, std::placeholders::_4,
-                    config.VoltageJsonPath)
+                    &_outputVoltageExtractor)
                 );
 
         DTU_LOGI("Subscribed to '%s' for ouput_voltage readings", _outputVoltageTopic.c_str());
@@ -89,15 +93,15 @@ void Provider::deinit()
 
 void Provider::onMqttMessageOutputPower(espMqttClientTypes::MessageProperties const& properties,
             char const* topic, uint8_t const* payload, size_t len,
-            char const* jsonPath) const
+            JsonPathExtractor const* extractor) const
 {
-    auto outputPower = Utils::getNumericValueFromMqttPayload<float>("SolarChargers::Mqtt",
-            std::string(reinterpret_cast<const char*>(payload), len), topic,
-            jsonPath);
+    auto outputPower = extractor->extract<float>("SolarChargers::Mqtt",
+            std::string_view(reinterpret_cast<const char*>(payload), len), topic);
 
     if (!outputPower.has_value()) { return; }
 
-    auto const& config = Configuration.get().SolarCharger.Mqtt;
+    auto const spConfig = Configuration.get();
+    auto const& config = spConfig->SolarCharger.Mqtt;
     using Unit_t = SolarChargerMqttConfig::WattageUnit;
     switch (config.PowerUnit) {
         case Unit_t::MilliWatts:
@@ -117,15 +121,15 @@ void Provider::onMqttMessageOutputPower(espMqttClientTypes::MessageProperties co
 
 void Provider::onMqttMessageOutputVoltage(espMqttClientTypes::MessageProperties const& properties,
             char const* topic, uint8_t const* payload, size_t len,
-            char const* jsonPath) const
+            JsonPathExtractor const* extractor) const
 {
-    auto outputVoltage = Utils::getNumericValueFromMqttPayload<float>("SolarChargers::Mqtt",
-            std::string(reinterpret_cast<const char*>(payload), len), topic,
-            jsonPath);
+    auto outputVoltage = extractor->extract<float>("SolarChargers::Mqtt",
+            std::string_view(reinterpret_cast<const char*>(payload), len), topic);
 
     if (!outputVoltage.has_value()) { return; }
 
-    auto const& config = Configuration.get().SolarCharger.Mqtt;
+    auto const spConfig = Configuration.get();
+    auto const& config = spConfig->SolarCharger.Mqtt;
     using Unit_t = SolarChargerMqttConfig::VoltageUnit;
     switch (config.VoltageTopicUnit) {
         case Unit_t::DeciVolts:
@@ -156,15 +160,15 @@ void Provider::onMqttMessageOutputVoltage(espMqttClientTypes::MessageProperties
 
 void Provider::onMqttMessageOutputCurrent(espMqttClientTypes::MessageProperties const& properties,
             char const* topic, uint8_t const* payload, size_t len,
-            char const* jsonPath) const
+            JsonPathExtractor const* extractor) const
 {
-    auto outputCurrent = Utils::getNumericValueFromMqttPayload<float>("SolarChargers::Mqtt",
-            std::string(reinterpret_cast<const char*>(payload), len), topic,
-            jsonPath);
+    auto outputCurrent = extractor->extract<float>("SolarChargers::Mqtt",
+            std::string_view(reinterpret_cast<const char*>(payload), len), topic);
 
     if (!outputCurrent.has_value()) { return; }
 
-    auto const& config = Configuration.get().SolarCharger.Mqtt;
+    auto const spConfig = Configuration.get();
+    auto const& config = spConfig->SolarCharger.Mqtt;
     using Unit_t = SolarChargerMqttConfig::AmperageUnit;
     switch (config.CurrentUnit) {
         case Unit_t::MilliAmps:
@@ -23,7 +23,7 @@ void Stats::setOutputVoltage(const float voltage) {
     _lastUpdateOutputVoltage = _lastUpdate =  millis();
 
     auto outputCurrent = getOutputCurrent();
-    if (Configuration.get().SolarCharger.Mqtt.CalculateOutputPower
+    if (Configuration.get()->SolarCharger.Mqtt.CalculateOutputPower
         && outputCurrent) {
         setOutputPowerWatts(voltage * *outputCurrent);
     }
@@ -34,7 +34,7 @@ void Stats::setOutputCurrent(const float current) {
     _lastUpdateOutputCurrent = _lastUpdate =  millis();
 
     auto outputVoltage = getOutputVoltage();
-    if (Configuration.get().SolarCharger.Mqtt.CalculateOutputPower
+    if (Configuration.get()->SolarCharger.Mqtt.CalculateOutputPower
         && outputVoltage) {
         setOutputPowerWatts(*outputVoltage * current);
     }
@@ -66,7 +66,7 @@ void Stats::getLiveViewData(JsonVariant& root, const boolean fullUpdate, const u
 
     const JsonObject output = instance["values"]["output"].to<JsonObject>();
 
-    if (Configuration.get().SolarCharger.Mqtt.CalculateOutputPower) {
+    if (Configuration.get()->SolarCharger.Mqtt.CalculateOutputPower) {
         output["P"]["v"] = _outputPowerWatts;
         output["P"]["u"] = "W";
         output["P"]["d"] = 1;
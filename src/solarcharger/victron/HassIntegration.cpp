@@ -74,6 +74,8 @@ void HassIntegration::publishSensor(const char *caption, const char *icon, const
                                                 const char *unitOfMeasurement,
                                                 const VeDirectMpptController::data_t &mpptData) const
 {
+    if (!_pass.claim()) { return; }
+
     String serial = mpptData.serialNr_SER;
 
     String sensorId = caption;
@@ -87,15 +89,12 @@ void HassIntegration::publishSensor(const char *caption, const char *icon, const
         + "/" + sensorId
         + "/config";
 
-    String statTopic = MqttSettings.getPrefix() + "victron/";
-    statTopic.concat(serial);
-    statTopic.concat("/");
-    statTopic.concat(subTopic);
+    const String base = "victron/" + serial + "/";
 
     JsonDocument root;
 
     root["name"] = caption;
-    root["stat_t"] = statTopic;
+    MqttSettings.setHassStateTopic(root, std::string_view(base.c_str(), base.length()), subTopic);
     root["uniq_id"] = serial + "_" + sensorId;
 
     if (icon != NULL) {
@@ -109,8 +108,8 @@ void HassIntegration::publishSensor(const char *caption, const char *icon, const
     JsonObject deviceObj = root["dev"].to<JsonObject>();
     createDeviceInfo(deviceObj, mpptData);
 
-    if (Configuration.get().Mqtt.Hass.Expire) {
-        root["exp_aft"] = Configuration.get().Mqtt.PublishInterval * 3;
+    if (Configuration.get()->Mqtt.Hass.Expire) {
+        root["exp_aft"] = Configuration.get()->Mqtt.PublishInterval * 3;
     }
     if (deviceClass != NULL) {
         root["dev_cla"] = deviceClass;
@@ -123,7 +122,7 @@ void HassIntegration::publishSensor(const char *caption, const char *icon, const
         return;
     }
 
-    char buffer[512];
+    String buffer;
     serializeJson(root, buffer);
     publish(configTopic, buffer);
 
@@ -133,6 +132,8 @@ void HassIntegration::publishBinarySensor(const char *caption, const char *icon,
                                                       const char *payload_on, const char *payload_off,
                                                       const VeDirectMpptController::data_t &mpptData) const
 {
+    if (!_pass.claim()) { return; }
+
     String serial = mpptData.serialNr_SER;
 
     String sensorId = caption;
@@ -146,15 +147,12 @@ void HassIntegration::publishBinarySensor(const char *caption, const char *icon,
         + "/" + sensorId
         + "/config";
 
-    String statTopic = MqttSettings.getPrefix() + "victron/";
-    statTopic.concat(serial);
-    statTopic.concat("/");
-    statTopic.concat(subTopic);
+    const String base = "victron/" + serial + "/";
 
     JsonDocument root;
     root["name"] = caption;
     root["uniq_id"] = serial + "_" + sensorId;
-    root["stat_t"] = statTopic;
+    MqttSettings.setHassStateTopic(root, std::string_view(base.c_str(), base.length()), subTopic);
     root["pl_on"] = payload_on;
     root["pl_off"] = payload_off;
 
@@ -169,7 +167,7 @@ void HassIntegration::publishBinarySensor(const char *caption, const char *icon,
         return;
     }
 
-    char buffer[512];
+    String buffer;
     serializeJson(root, buffer);
     publish(configTopic, buffer);
 }
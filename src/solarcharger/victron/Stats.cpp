@@ -331,13 +331,13 @@ void Stats::populateJsonWithInstanceStats(const JsonObject &root, const VeDirect
 void Stats::mqttPublish() const
 {
     if ((millis() >= _nextPublishFull) || (millis() >= _nextPublishUpdatesOnly)) {
-        auto const& config = Configuration.get();
+        auto const config = Configuration.get();
 
         // determine if this cycle should publish full values or updates only
         if (_nextPublishFull <= _nextPublishUpdatesOnly) {
             _PublishFull = true;
         } else {
-            _PublishFull = !config.SolarCharger.PublishUpdatesOnly;
+            _PublishFull = !config->SolarCharger.PublishUpdatesOnly;
         }
 
         for (auto const& entry : _data) {
@@ -359,8 +359,8 @@ void Stats::mqttPublish() const
             // when Home Assistant MQTT-Auto-Discovery is active,
             // and "enable expiration" is active, all values must be published at
             // least once before the announced expiry interval is reached
-            if ((config.SolarCharger.PublishUpdatesOnly) && (config.Mqtt.Hass.Enabled) && (config.Mqtt.Hass.Expire)) {
-                _nextPublishFull = millis() + (((config.Mqtt.PublishInterval * 3) - 1) * 1000);
+            if ((config->SolarCharger.PublishUpdatesOnly) && (config->Mqtt.Hass.Enabled) && (config->Mqtt.Hass.Expire)) {
+                _nextPublishFull = millis() + (((config->Mqtt.PublishInterval * 3) - 1) * 1000);
 
             } else {
                 // no future publish full needed
@@ -371,14 +371,15 @@ void Stats::mqttPublish() const
 }
 
 void Stats::publishMpptData(const VeDirectMpptController::data_t &currentData, const VeDirectMpptController::data_t &previousData) const {
-    String value;
-    String topic = "victron/";
-    topic.concat(currentData.serialNr_SER);
-    topic.concat("/");
+    MqttTopic topic;
+    topic.append("victron/").append(currentData.serialNr_SER).append("/");
+    const size_t base = topic.length();
+
+    MqttBatch batch(std::string_view(topic.c_str() + topic.prefixLength(), base - topic.prefixLength()));
 
 #define PUBLISH(sm, t, val) \
     if (_PublishFull || currentData.sm != previousData.sm) { \
-        MqttSettings.publish(topic + t, String(val)); \
+        MqttSettings.publish(topic.truncate(base).append(t), val); \
     }
 
     PUBLISH(productID_PID,           "PID",  currentData.getPidAsString().data());
@@ -408,7 +409,7 @@ void Stats::publishMpptData(const VeDirectMpptController::data_t &currentData, c
 
 #define PUBLISH_OPT(sm, t, val) \
     if (currentData.sm.first != 0 && (_PublishFull || currentData.sm.second != previousData.sm.second)) { \
-        MqttSettings.publish(topic + t, String(val)); \
+        MqttSettings.publish(topic.truncate(base).append(t), val); \
     }
 
     PUBLISH_OPT(relayState_RELAY,                         "RELAY",                        currentData.relayState_RELAY.second ? "ON" : "OFF");
@@ -428,11 +429,14 @@ void Stats::mqttPublishSensors(const boolean forcePublish) const
     // This matches the old implementation, but is not ideal. We should publish
     // sensors whenever a new controller is discovered, or when the amount of available
     // datapoints for a controller changed.
-    if (!forcePublish) { return; }
+    auto& pass = _hassIntegration.getPass();
+    if (forcePublish) { pass.restart(); }
 
-    for (auto entry : _data) {
-        _hassIntegration.publishSensors(entry.second);
-    }
+    pass.step([this]() {
+        for (auto const& entry : _data) {
+            _hassIntegration.publishSensors(entry.second);
+        }
+    });
 }
 
 }; // namespace SolarChargers::Victron
@@ -0,0 +1,175 @@
+// Host benchmark comparing the fixed-buffer JK BMS frame parser against a
+// model of the previous data flow (byte-wise std::vector assembly, one
+// heap-allocated data point per field including its texts, std::map of
+// cell voltages, and merging into the stats container).
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <new>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../include/battery/jkbms/FrameParser.h"
+
+static size_t allocations = 0;
+
+void* operator new(size_t size) {
+    ++allocations;
+    if (void* p = std::malloc(size)) { return p; }
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+using namespace Batteries::JkBms;
+
+// 16 cell "read all" response, same as used by the dummy serial
+static const uint8_t frame[] = {
+    0x4e, 0x57, 0x01, 0x21, 0x00, 0x00, 0x00, 0x00, 0x06, 0x00, 0x01, 0x79,
+    0x30, 0x01, 0x0c, 0xfb, 0x02, 0x0c, 0xfb, 0x03, 0x0c, 0xfb, 0x04, 0x0c,
+    0xfb, 0x05, 0x0c, 0xfb, 0x06, 0x0c, 0xfb, 0x07, 0x0c, 0xfb, 0x08, 0x0c,
+    0xf7, 0x09, 0x0d, 0x01, 0x0a, 0x0c, 0xf9, 0x0b, 0x0c, 0xfb, 0x0c, 0x0c,
+    0xfb, 0x0d, 0x0c, 0xfb, 0x0e, 0x0c, 0xf8, 0x0f, 0x0c, 0xf9, 0x10, 0x0c,
+    0xfb, 0x80, 0x00, 0x1a, 0x81, 0x00, 0x12, 0x82, 0x00, 0x12, 0x83, 0x14,
+    0xc3, 0x84, 0x83, 0xf4, 0x85, 0x2e, 0x86, 0x02, 0x87, 0x00, 0x15, 0x89,
+    0x00, 0x00, 0x13, 0x52, 0x8a, 0x00, 0x10, 0x8b, 0x00, 0x00, 0x8c, 0x00,
+    0x03, 0x8e, 0x16, 0x80, 0x8f, 0x12, 0xc0, 0x90, 0x0e, 0x10, 0x91, 0x0c,
+    0xda, 0x92, 0x00, 0x05, 0x93, 0x0b, 0xb8, 0x94, 0x0c, 0x80, 0x95, 0x00,
+    0x05, 0x96, 0x01, 0x2c, 0x97, 0x00, 0x28, 0x98, 0x01, 0x2c, 0x99, 0x00,
+    0x28, 0x9a, 0x00, 0x1e, 0x9b, 0x0b, 0xb8, 0x9c, 0x00, 0x0a, 0x9d, 0x01,
+    0x9e, 0x00, 0x64, 0x9f, 0x00, 0x50, 0xa0, 0x00, 0x64, 0xa1, 0x00, 0x64,
+    0xa2, 0x00, 0x14, 0xa3, 0x00, 0x46, 0xa4, 0x00, 0x46, 0xa5, 0x00, 0x00,
+    0xa6, 0x00, 0x02, 0xa7, 0xff, 0xec, 0xa8, 0xff, 0xf6, 0xa9, 0x10, 0xaa,
+    0x00, 0x00, 0x00, 0xe6, 0xab, 0x01, 0xac, 0x01, 0xad, 0x04, 0x4d, 0xae,
+    0x01, 0xaf, 0x00, 0xb0, 0x00, 0x0a, 0xb1, 0x14, 0xb2, 0x32, 0x32, 0x31,
+    0x31, 0x38, 0x37, 0x00, 0x00, 0x00, 0x00, 0xb3, 0x00, 0xb4, 0x62, 0x65,
+    0x6b, 0x69, 0x00, 0x00, 0x00, 0x00, 0xb5, 0x32, 0x33, 0x30, 0x36, 0xb6,
+    0x00, 0x01, 0x4a, 0xc3, 0xb7, 0x31, 0x31, 0x2e, 0x58, 0x57, 0x5f, 0x53,
+    0x31, 0x31, 0x2e, 0x32, 0x36, 0x32, 0x48, 0x5f, 0xb8, 0x00, 0xb9, 0x00,
+    0x00, 0x00, 0xe6, 0xba, 0x62, 0x65, 0x6b, 0x69, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x4a, 0x4b, 0x5f, 0x42, 0x31, 0x41, 0x32, 0x34,
+    0x53, 0x31, 0x35, 0x50, 0xc0, 0x01, 0x00, 0x00, 0x00, 0x00, 0x68, 0x00,
+    0x00, 0x53, 0xbb
+};
+
+namespace Legacy {
+
+struct DataPoint {
+    std::string label;
+    std::string value;
+    std::string unit;
+    uint32_t raw;
+    std::map<uint8_t, uint16_t> cells;
+    bool operator==(DataPoint const& o) const { return raw == o.raw && value == o.value && cells == o.cells; }
+};
+
+using Container = std::unordered_map<uint8_t, DataPoint const>;
+
+char const* name(uint8_t id) {
+    switch (id) {
+#define NAME(n, i, t, u) case i: return #n;
+        JKBMS_DATA_POINTS(NAME)
+#undef NAME
+    }
+    return "";
+}
+
+size_t fieldLength(uint8_t id) {
+    switch (id) {
+        case 0x85: case 0x86: case 0x9d: case 0xa9: case 0xab: case 0xac:
+        case 0xae: case 0xaf: case 0xb1: case 0xb3: case 0xb8: case 0xc0:
+            return 1;
+        case 0x89: case 0xaa: case 0xb6: case 0xb9: return 4;
+        case 0xb2: return 10;
+        case 0xb4: return 8;
+        case 0xb5: return 4;
+        case 0xb7: return 15;
+        case 0xba: return 24;
+    }
+    return 2;
+}
+
+void decode(std::vector<uint8_t> const& raw, Container& dp) {
+    char buf[16];
+    size_t pos = 11;
+    size_t end = raw.size() - 9;
+    while (pos < end) {
+        uint8_t id = raw[pos++];
+        DataPoint p{ name(id), "", "", 0, {} };
+        if (id == 0x79) {
+            uint8_t cellAmount = raw[pos++] / 3;
+            for (size_t i = 0; i < cellAmount; ++i, pos += 3) {
+                p.cells[raw[pos]] = raw[pos + 1] << 8 | raw[pos + 2];
+            }
+        } else {
+            size_t len = fieldLength(id);
+            if (len > 4) {
+                p.value = std::string(raw.begin() + pos, raw.begin() + pos + len);
+            } else {
+                for (size_t i = 0; i < len; ++i) { p.raw = p.raw << 8 | raw[pos + i]; }
+                snprintf(buf, sizeof(buf), "%u", p.raw);
+                p.value = buf;
+            }
+            pos += len;
+        }
+        dp.erase(id);
+        dp.emplace(id, p);
+    }
+}
+
+void updateFrom(Container& target, Container const& source) {
+    for (auto const& entry : source) {
+        auto it = target.find(entry.first);
+        if (it != target.end()) {
+            if (it->second == entry.second) { continue; }
+            target.erase(it);
+        }
+        target.insert(entry);
+    }
+}
+
+} // namespace Legacy
+
+template<typename F>
+static void run(char const* caption, size_t iterations, F&& fnc) {
+    size_t allocationsBefore = allocations;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) { fnc(); }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    double us = std::chrono::duration<double, std::micro>(elapsed).count() / iterations;
+    double allocs = static_cast<double>(allocations - allocationsBefore) / iterations;
+    printf("%-28s %8.2f us/frame %8.1f allocations/frame\n", caption, us, allocs);
+}
+
+int main() {
+    constexpr size_t iterations = 20000;
+
+    printf("=== JK BMS frame decoding, %zu bytes, %zu iterations ===\n",
+            sizeof(frame), iterations);
+
+    Legacy::Container stats;
+    run("vector + data points", iterations, [&stats]() {
+        std::vector<uint8_t> raw;
+        for (auto b : frame) { raw.push_back(b); }
+        Legacy::Container dp;
+        Legacy::decode(raw, dp);
+        Legacy::updateFrom(stats, dp);
+    });
+
+    tFrameBuffer buffer;
+    FrameParser parser;
+    Snapshot snapshot;
+    Snapshot statsSnapshot;
+    run("ring buffer + snapshot", iterations, [&]() {
+        buffer.clear();
+        for (auto b : frame) { buffer.push(b); }
+        parser.parse(buffer, snapshot);
+#define MERGE(n, i, t, u) statsSnapshot.mergeFrom<DataPointLabel::n>(snapshot);
+        JKBMS_DATA_POINTS(MERGE)
+#undef MERGE
+    });
+
+    return 0;
+}
@@ -0,0 +1,115 @@
+// Host benchmark comparing the cost of serializing the frames of the live
+// data websocket as JSON and as MessagePack, using the ArduinoJson version
+// the firmware is built with. The frames mimic WebApiWsLiveClass: a full
+// frame of ten inverters with four strings each, and a delta frame holding
+// the values which changed in one cycle.
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <ArduinoJson.h>
+
+static void addField(JsonObject channel, char const* name, float value, char const* unit, int digits, bool full)
+{
+    auto field = channel[name].to<JsonObject>();
+    field["v"] = value;
+    if (!full) { return; }
+    field["u"] = unit;
+    field["d"] = digits;
+}
+
+static void addInverter(JsonArray inverters, int index, bool full)
+{
+    auto inv = inverters.add<JsonObject>();
+    inv["serial"] = std::to_string(114182000000ULL + index);
+    inv["data_age"] = 0;
+    inv["data_age_ms"] = 312 + index;
+    if (!full) {
+        auto ac = inv["AC"].to<JsonObject>()["0"].to<JsonObject>();
+        addField(ac, "Power", 612.4f + index, "W", 1, false);
+        addField(ac, "Current", 2.66f, "A", 2, false);
+        return;
+    }
+
+    inv["name"] = "Inverter " + std::to_string(index);
+    inv["order"] = index;
+    inv["poll_enabled"] = true;
+    inv["reachable"] = true;
+    inv["producing"] = true;
+    inv["limit_relative"] = 100;
+    inv["limit_absolute"] = 1600;
+    auto radio = inv["radio_stats"].to<JsonObject>();
+    for (char const* key : { "tx_request", "tx_re_request", "rx_success", "rx_fail_nothing", "rx_fail_partial", "rx_fail_corrupt" }) {
+        radio[key] = 1234;
+    }
+    radio["rssi"] = -62;
+
+    auto ac = inv["AC"].to<JsonObject>()["0"].to<JsonObject>();
+    addField(ac, "Power", 612.4f + index, "W", 1, true);
+    addField(ac, "Voltage", 231.2f, "V", 1, true);
+    addField(ac, "Current", 2.66f, "A", 2, true);
+    addField(ac, "Frequency", 50.01f, "Hz", 2, true);
+    addField(ac, "PowerFactor", 1.0f, "", 3, true);
+    addField(ac, "ReactivePower", 0.2f, "var", 1, true);
+
+    auto dc = inv["DC"].to<JsonObject>();
+    for (int s = 0; s < 4; ++s) {
+        auto string = dc[std::to_string(s)].to<JsonObject>();
+        string["name"]["u"] = "String " + std::to_string(s);
+        addField(string, "Power", 160.3f, "W", 1, true);
+        addField(string, "Voltage", 34.6f, "V", 1, true);
+        addField(string, "Current", 4.63f, "A", 2, true);
+        addField(string, "YieldDay", 812, "Wh", 0, true);
+        addField(string, "YieldTotal", 1234.567f, "kWh", 3, true);
+        addField(string, "Irradiation", 36.4f, "%", 3, true);
+        string["Irradiation"]["max"] = 440;
+    }
+
+    auto in = inv["INV"].to<JsonObject>()["0"].to<JsonObject>();
+    addField(in, "Power DC", 641.2f, "W", 1, true);
+    addField(in, "YieldDay", 3248, "Wh", 0, true);
+    addField(in, "YieldTotal", 4938.268f, "kWh", 3, true);
+    addField(in, "Temperature", 41.3f, "°C", 1, true);
+    addField(in, "Efficiency", 95.51f, "%", 3, true);
+    inv["events"] = 7;
+}
+
+template<typename F>
+static void run(char const* caption, size_t iterations, F&& fnc) {
+    size_t bytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) { bytes = fnc(); }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    double us = std::chrono::duration<double, std::micro>(elapsed).count() / iterations;
+    printf("%-24s %8.3f us/frame %6zu bytes\n", caption, us, bytes);
+}
+
+int main() {
+    JsonDocument full;
+    auto fullInverters = full["inverters"].to<JsonArray>();
+    for (int i = 0; i < 10; ++i) { addInverter(fullInverters, i, true); }
+
+    JsonDocument delta;
+    delta["delta"] = true;
+    auto deltaInverters = delta["inverters"].to<JsonArray>();
+    for (int i = 0; i < 10; ++i) { addInverter(deltaInverters, i, false); }
+
+    size_t const iterations = 20000;
+    std::vector<char> buffer(measureJson(full) + 1);
+
+    for (auto const& frame : { std::make_pair("full", &full), std::make_pair("delta", &delta) }) {
+        JsonDocument const& doc = *frame.second;
+        printf("%s frame:\n", frame.first);
+
+        run("  JSON", iterations, [&]() {
+            return serializeJson(doc, buffer.data(), buffer.size());
+        });
+
+        run("  MessagePack", iterations, [&]() {
+            return serializeMsgPack(doc, buffer.data(), buffer.size());
+        });
+    }
+
+    return 0;
+}
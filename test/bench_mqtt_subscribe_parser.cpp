@@ -0,0 +1,115 @@
+// Host benchmark comparing the topic trie dispatch of MqttSubscribeParser
+// against the previous approach, i.e., running the mosquitto topic matcher
+// against every registered subscription for each incoming message.
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "MqttSubscribeParser.h"
+
+template<typename F>
+static void run(char const* caption, size_t iterations, F&& fnc) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) { fnc(i); }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    double us = std::chrono::duration<double, std::micro>(elapsed).count() / iterations;
+    printf("%-28s %8.3f us/message\n", caption, us);
+}
+
+int main() {
+    std::vector<std::string> subscriptions;
+
+    // command topics of the inverters, the DPL and the grid charger
+    for (char const* cmd : { "limit_persistent_relative", "limit_persistent_absolute",
+            "limit_nonpersistent_relative", "limit_nonpersistent_absolute",
+            "power", "restart", "reset_rf_stats" }) {
+        subscriptions.push_back(std::string("solar/+/cmd/") + cmd);
+    }
+    for (char const* cmd : { "threshold/soc/start", "threshold/soc/stop",
+            "threshold/soc/full_solar_passthrough", "threshold/voltage/start",
+            "threshold/voltage/stop", "threshold/voltage/full_solar_passthrough",
+            "mode", "upper_power_limit", "target_power_consumption" }) {
+        subscriptions.push_back(std::string("solar/powerlimiter/cmd/") + cmd);
+    }
+    for (char const* cmd : { "limit_online_voltage", "limit_online_current",
+            "limit_offline_voltage", "limit_offline_current", "mode", "production" }) {
+        subscriptions.push_back(std::string("solar/huawei/cmd/") + cmd);
+    }
+
+    // Zendure battery
+    subscriptions.push_back("solar/battery/persistent/#");
+    subscriptions.push_back("iot/73bkTV/1A2B3C4D/log");
+    subscriptions.push_back("iot/73bkTV/1A2B3C4D/properties/report");
+    subscriptions.push_back("iot/73bkTV/1A2B3C4D/time-sync");
+
+    // MQTT battery, power meter and solar charger values published by a
+    // home automation system, e.g., one topic per sensor.
+    while (subscriptions.size() < 300) {
+        size_t n = subscriptions.size();
+        subscriptions.push_back("homeassistant/sensor/device" + std::to_string(n % 37)
+                + "/value" + std::to_string(n) + "/state");
+    }
+
+    std::vector<std::string> messages;
+    for (size_t i = 0; i < 1000; ++i) {
+        switch (i % 10) {
+            case 0: case 1: case 2: case 3: case 4: case 5:
+                // sensor values dominate the traffic
+                messages.push_back("homeassistant/sensor/device" + std::to_string((i * 7) % 37)
+                        + "/value" + std::to_string(50 + (i * 13) % 250) + "/state");
+                break;
+            case 6:
+                messages.push_back("iot/73bkTV/1A2B3C4D/properties/report");
+                break;
+            case 7:
+                messages.push_back("solar/battery/persistent/settings");
+                break;
+            case 8:
+                messages.push_back("solar/116491234567/cmd/limit_nonpersistent_absolute");
+                break;
+            default:
+                // no subscriber
+                messages.push_back("zigbee2mqtt/livingroom/switch" + std::to_string(i % 5));
+                break;
+        }
+    }
+
+    constexpr size_t iterations = 200000;
+    printf("=== MQTT dispatch, %zu subscriptions, %zu iterations ===\n",
+            subscriptions.size(), iterations);
+
+    volatile size_t hits = 0;
+    espMqttClientTypes::MessageProperties properties = {};
+
+    run("mosquitto matcher per sub", iterations, [&](size_t i) {
+        char const* topic = messages[i % messages.size()].c_str();
+        for (auto const& sub : subscriptions) {
+            bool result = false;
+            if (MqttSubscribeParser::mosquitto_topic_matches_sub(sub.c_str(), topic, &result) == MqttSubscribeParser::MOSQ_ERR_SUCCESS && result) {
+                hits = hits + 1;
+            }
+        }
+    });
+    size_t linearHits = hits;
+
+    MqttSubscribeParser parser;
+    for (auto const& sub : subscriptions) {
+        parser.register_callback(sub, 0,
+            [&hits](const espMqttClientTypes::MessageProperties&, const char*, const uint8_t*, size_t) {
+                hits = hits + 1;
+            });
+    }
+
+    hits = 0;
+    run("topic trie", iterations, [&](size_t i) {
+        parser.handle_message(properties, messages[i % messages.size()].c_str(), nullptr, 0);
+    });
+
+    if (hits != linearHits) {
+        printf("dispatch mismatch: %zu vs. %zu callbacks\n", static_cast<size_t>(hits), linearHits);
+        return 1;
+    }
+
+    return 0;
+}
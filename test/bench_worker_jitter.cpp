@@ -0,0 +1,95 @@
+// Host benchmark of the start jitter of a periodic task (the DPL) run by a
+// cooperative loop which also polls blocking I/O, e.g., the radios or the
+// battery CAN bus. the I/O is either polled inline (previous approach) or
+// by a worker thread, which hands its results to the loop through an
+// SpscQueue such that only the decision logic remains cooperative.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "SpscQueue.h"
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr auto DplInterval = std::chrono::milliseconds(10);
+static constexpr auto Duration = std::chrono::seconds(2);
+
+// a fixed pattern of the time an I/O poll blocks: mostly nothing to do, but
+// now and then a transfer or a receive waiting for the rest of a frame
+static std::chrono::microseconds ioBlockingTime(uint32_t poll) {
+    if (poll % 50 == 0) { return std::chrono::microseconds(8000); }
+    if (poll % 7 == 0) { return std::chrono::microseconds(2000); }
+    return std::chrono::microseconds(50);
+}
+
+struct Result {
+    std::vector<double> LatenessUs;
+    uint32_t Frames = 0;
+};
+
+// the cooperative loop: runs the DPL when due and the given I/O poll
+template<typename F>
+static Result runLoop(F&& poll) {
+    Result result;
+    auto const start = Clock::now();
+    auto nextDpl = start + DplInterval;
+
+    while (Clock::now() - start < Duration) {
+        auto now = Clock::now();
+        if (now >= nextDpl) {
+            result.LatenessUs.push_back(std::chrono::duration<double, std::micro>(now - nextDpl).count());
+            nextDpl += DplInterval;
+        }
+
+        result.Frames += poll();
+    }
+
+    return result;
+}
+
+static void report(char const* caption, Result& result) {
+    auto& l = result.LatenessUs;
+    std::sort(l.begin(), l.end());
+    double sum = 0;
+    for (double v : l) { sum += v; }
+    printf("%-24s %6zu runs, lateness avg %8.1f us, p99 %8.1f us, max %8.1f us, %u frames\n",
+        caption, l.size(), sum / l.size(), l[l.size() * 99 / 100], l.back(), result.Frames);
+}
+
+int main() {
+    printf("=== DPL start jitter, %lld ms interval, %lld s per run ===\n",
+        static_cast<long long>(DplInterval.count()),
+        static_cast<long long>(std::chrono::duration_cast<std::chrono::seconds>(Duration).count()));
+
+    uint32_t inlinePoll = 0;
+    auto inlineResult = runLoop([&inlinePoll]() -> uint32_t {
+        std::this_thread::sleep_for(ioBlockingTime(inlinePoll++));
+        return 1;
+    });
+    report("inline I/O", inlineResult);
+
+    SpscQueue<uint32_t, 64> queue;
+    std::atomic<bool> stop { false };
+    std::thread worker([&queue, &stop]() {
+        uint32_t workerPoll = 0;
+        while (!stop) {
+            std::this_thread::sleep_for(ioBlockingTime(workerPoll));
+            queue.push(workerPoll++);
+        }
+    });
+
+    auto workerResult = runLoop([&queue]() -> uint32_t {
+        uint32_t frames = 0;
+        while (queue.pop()) { ++frames; }
+        if (frames == 0) { std::this_thread::yield(); }
+        return frames;
+    });
+    stop = true;
+    worker.join();
+    report("worker + SpscQueue", workerResult);
+
+    return 0;
+}
@@ -0,0 +1,18 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Minimal stand-in for the espMqttClient library, providing the types used by
+// host-tested code only.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace espMqttClientTypes {
+
+struct MessageProperties {
+    uint8_t qos;
+    bool dup;
+    bool retain;
+    uint16_t packetId;
+};
+
+} // namespace espMqttClientTypes
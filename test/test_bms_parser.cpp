@@ -0,0 +1,211 @@
+#include <iostream>
+#include <cassert>
+#include <cstring>
+#include <vector>
+
+#include "../include/battery/jkbms/FrameParser.h"
+#include "../include/battery/jbdbms/FrameParser.h"
+
+// "read all" response of a 16 cell JK BMS, same as used by the dummy serial
+static const std::vector<uint8_t> jkReadAllResponse = {
+    0x4e, 0x57, 0x01, 0x21, 0x00, 0x00, 0x00, 0x00, 0x06, 0x00, 0x01, 0x79,
+    0x30, 0x01, 0x0c, 0xfb, 0x02, 0x0c, 0xfb, 0x03, 0x0c, 0xfb, 0x04, 0x0c,
+    0xfb, 0x05, 0x0c, 0xfb, 0x06, 0x0c, 0xfb, 0x07, 0x0c, 0xfb, 0x08, 0x0c,
+    0xf7, 0x09, 0x0d, 0x01, 0x0a, 0x0c, 0xf9, 0x0b, 0x0c, 0xfb, 0x0c, 0x0c,
+    0xfb, 0x0d, 0x0c, 0xfb, 0x0e, 0x0c, 0xf8, 0x0f, 0x0c, 0xf9, 0x10, 0x0c,
+    0xfb, 0x80, 0x00, 0x1a, 0x81, 0x00, 0x12, 0x82, 0x00, 0x12, 0x83, 0x14,
+    0xc3, 0x84, 0x83, 0xf4, 0x85, 0x2e, 0x86, 0x02, 0x87, 0x00, 0x15, 0x89,
+    0x00, 0x00, 0x13, 0x52, 0x8a, 0x00, 0x10, 0x8b, 0x00, 0x00, 0x8c, 0x00,
+    0x03, 0x8e, 0x16, 0x80, 0x8f, 0x12, 0xc0, 0x90, 0x0e, 0x10, 0x91, 0x0c,
+    0xda, 0x92, 0x00, 0x05, 0x93, 0x0b, 0xb8, 0x94, 0x0c, 0x80, 0x95, 0x00,
+    0x05, 0x96, 0x01, 0x2c, 0x97, 0x00, 0x28, 0x98, 0x01, 0x2c, 0x99, 0x00,
+    0x28, 0x9a, 0x00, 0x1e, 0x9b, 0x0b, 0xb8, 0x9c, 0x00, 0x0a, 0x9d, 0x01,
+    0x9e, 0x00, 0x64, 0x9f, 0x00, 0x50, 0xa0, 0x00, 0x64, 0xa1, 0x00, 0x64,
+    0xa2, 0x00, 0x14, 0xa3, 0x00, 0x46, 0xa4, 0x00, 0x46, 0xa5, 0x00, 0x00,
+    0xa6, 0x00, 0x02, 0xa7, 0xff, 0xec, 0xa8, 0xff, 0xf6, 0xa9, 0x10, 0xaa,
+    0x00, 0x00, 0x00, 0xe6, 0xab, 0x01, 0xac, 0x01, 0xad, 0x04, 0x4d, 0xae,
+    0x01, 0xaf, 0x00, 0xb0, 0x00, 0x0a, 0xb1, 0x14, 0xb2, 0x32, 0x32, 0x31,
+    0x31, 0x38, 0x37, 0x00, 0x00, 0x00, 0x00, 0xb3, 0x00, 0xb4, 0x62, 0x65,
+    0x6b, 0x69, 0x00, 0x00, 0x00, 0x00, 0xb5, 0x32, 0x33, 0x30, 0x36, 0xb6,
+    0x00, 0x01, 0x4a, 0xc3, 0xb7, 0x31, 0x31, 0x2e, 0x58, 0x57, 0x5f, 0x53,
+    0x31, 0x31, 0x2e, 0x32, 0x36, 0x32, 0x48, 0x5f, 0xb8, 0x00, 0xb9, 0x00,
+    0x00, 0x00, 0xe6, 0xba, 0x62, 0x65, 0x6b, 0x69, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x4a, 0x4b, 0x5f, 0x42, 0x31, 0x41, 0x32, 0x34,
+    0x53, 0x31, 0x35, 0x50, 0xc0, 0x01, 0x00, 0x00, 0x00, 0x00, 0x68, 0x00,
+    0x00, 0x53, 0xbb,
+};
+
+template<typename Buffer>
+static void fill(Buffer& buffer, std::vector<uint8_t> const& bytes) {
+    buffer.clear();
+    for (auto b : bytes) { assert(buffer.push(b)); }
+}
+
+static std::vector<uint8_t> jbdFrame(uint8_t cmd, std::vector<uint8_t> const& data) {
+    std::vector<uint8_t> frame = { 0xDD, cmd, 0x00, static_cast<uint8_t>(data.size()) };
+    frame.insert(frame.end(), data.begin(), data.end());
+    uint16_t sum = 0;
+    for (size_t i = 2; i < frame.size(); ++i) { sum += frame[i]; }
+    uint16_t checksum = ~sum + 1;
+    frame.push_back(checksum >> 8);
+    frame.push_back(checksum & 0xFF);
+    frame.push_back(0x77);
+    return frame;
+}
+
+void testFrameBufferWrapAround() {
+    std::cout << "Testing: Frame buffer wraps around without losing order" << std::endl;
+
+    Batteries::FrameBuffer<8> buffer;
+    for (uint8_t i = 0; i < 6; ++i) { assert(buffer.push(i)); }
+    buffer.discard(4);
+    for (uint8_t i = 6; i < 12; ++i) { assert(buffer.push(i)); }
+    assert(buffer.full());
+    assert(!buffer.push(0xFF));
+
+    assert(buffer.size() == 8);
+    assert(buffer[0] == 4 && buffer[7] == 11);
+    assert(buffer.get<uint16_t>(3) == 0x0708);
+    assert(buffer.get<uint32_t>(6) == 0); // out of bounds
+
+    std::vector<uint8_t> visited;
+    buffer.forEachSegment([&visited](uint8_t const* data, size_t len) {
+        visited.insert(visited.end(), data, data + len);
+    });
+    assert((visited == std::vector<uint8_t>{ 4, 5, 6, 7, 8, 9, 10, 11 }));
+
+    std::cout << "✓ PASSED: Frame buffer keeps byte order across the wrap" << std::endl;
+}
+
+void testJkBmsReadAll() {
+    std::cout << "Testing: JK BMS read all response is decoded into the snapshot" << std::endl;
+
+    using namespace Batteries::JkBms;
+    using Label = DataPointLabel;
+
+    tFrameBuffer buffer;
+    fill(buffer, jkReadAllResponse);
+
+    FrameParser parser;
+    Snapshot snapshot;
+    assert(parser.parse(buffer, snapshot) == FrameParser::Result::Ok);
+
+    auto const& cells = snapshot.ref<Label::CellsMilliVolt>();
+    assert(cells.Count == 16);
+    assert(cells.MilliVolt[0] == 3323);
+    assert(cells.getMin() == 3319);
+    assert(cells.getMax() == 3329);
+
+    assert(*snapshot.get<Label::BmsTempCelsius>() == 26);
+    assert(*snapshot.get<Label::BatteryVoltageMilliVolt>() == 53150);
+    assert(*snapshot.get<Label::BatterySoCPercent>() == 46);
+    assert(*snapshot.get<Label::ChargeLowTempRecoveryCelsius>() == 2);
+    assert(*snapshot.get<Label::DischargeLowTempThresholdCelsius>() == -20);
+    assert(*snapshot.get<Label::BalancingEnabled>() == true);
+    assert(std::strcmp(snapshot.ref<Label::BmsSoftwareVersion>().c_str(), "11.XW_S11.262H_") == 0);
+    assert(*snapshot.get<Label::ProtocolVersion>() == 0x01);
+
+    // the current cannot be decoded before the protocol version is known
+    assert(!snapshot.has<Label::BatteryCurrentMilliAmps>());
+
+    assert(parser.parse(buffer, snapshot) == FrameParser::Result::Ok);
+    assert(*snapshot.get<Label::BatteryCurrentMilliAmps>() == 10120);
+
+    std::cout << "✓ PASSED: JK BMS data points decoded correctly" << std::endl;
+}
+
+void testJkBmsInvalidFrames() {
+    std::cout << "Testing: JK BMS frame validation" << std::endl;
+
+    using namespace Batteries::JkBms;
+
+    tFrameBuffer buffer;
+    FrameParser parser;
+    Snapshot snapshot;
+
+    auto corrupted = jkReadAllResponse;
+    corrupted[20] ^= 0x01;
+    fill(buffer, corrupted);
+    assert(parser.parse(buffer, snapshot) == FrameParser::Result::InvalidChecksum);
+    assert(snapshot.empty());
+
+    auto truncated = jkReadAllResponse;
+    truncated.pop_back();
+    fill(buffer, truncated);
+    assert(parser.parse(buffer, snapshot) == FrameParser::Result::InvalidFrameLength);
+
+    fill(buffer, { 0x4e, 0x57, 0x00 });
+    assert(parser.parse(buffer, snapshot) == FrameParser::Result::InvalidFrameLength);
+
+    std::cout << "✓ PASSED: Invalid JK BMS frames are rejected" << std::endl;
+}
+
+void testJbdBmsResponses() {
+    std::cout << "Testing: JBD BMS responses are decoded into the snapshot" << std::endl;
+
+    using namespace Batteries::JbdBms;
+    using Label = DataPointLabel;
+
+    tFrameBuffer buffer;
+    Snapshot snapshot;
+
+    fill(buffer, jbdFrame(0x04, { 0x0c, 0xfb, 0x0c, 0xf7, 0x0d, 0x01, 0x0c, 0xf9 }));
+    assert(FrameParser::parse(buffer, snapshot) == FrameParser::Result::Ok);
+    auto const& cells = snapshot.ref<Label::CellsMilliVolt>();
+    assert(cells.Count == 4);
+    assert(cells.getAvg() == 3323);
+
+    fill(buffer, jbdFrame(0x03, {
+        0x14, 0xc3, // voltage
+        0xff, 0x9c, // current (-1A)
+        0x27, 0x10, 0x4e, 0x20, // remaining and nominal capacity
+        0x00, 0x15, // cycles
+        0x20, 0x68, // production date
+        0x00, 0x00, 0x00, 0x01, // balancing
+        0x00, 0x02, // protection status
+        0x21, // software version
+        0x2e, // RSOC
+        0x03, // FET control
+        0x10, 0x02, // cells and ntc amount
+        0x0b, 0xa5, 0x0b, 0x9b // temperatures
+    }));
+    assert(FrameParser::parse(buffer, snapshot) == FrameParser::Result::Ok);
+    assert(*snapshot.get<Label::BatteryVoltageMilliVolt>() == 53150);
+    assert(*snapshot.get<Label::BatteryCurrentMilliAmps>() == -1000);
+    assert(*snapshot.get<Label::BatteryCapacitySettingAmpHours>() == 200);
+    assert(std::strcmp(snapshot.ref<Label::DateOfManufacturing>().c_str(), "08.03.2016") == 0);
+    assert(std::strcmp(snapshot.ref<Label::BmsSoftwareVersion>().c_str(), "1.2") == 0);
+    assert(*snapshot.get<Label::BalancingEnabled>() == true);
+    assert(*snapshot.get<Label::BatteryTempOneCelsius>() == 25);
+    assert(!snapshot.has<Label::CellsMilliVolt>());
+
+    auto invalid = jbdFrame(0x04, { 0x0c, 0xfb });
+    invalid[2] = 0x80; // error status
+    fill(buffer, invalid);
+    assert(FrameParser::parse(buffer, snapshot) != FrameParser::Result::Ok);
+
+    std::cout << "✓ PASSED: JBD BMS data points decoded correctly" << std::endl;
+}
+
+int main() {
+    std::cout << "=== OpenDTU-OnBattery Serial BMS Frame Parser Tests ===" << std::endl;
+    std::cout << std::endl;
+
+    try {
+        testFrameBufferWrapAround();
+        testJkBmsReadAll();
+        testJkBmsInvalidFrames();
+        testJbdBmsResponses();
+
+        std::cout << std::endl;
+        std::cout << "✓ ALL TESTS PASSED!" << std::endl;
+
+        return 0;
+    } catch (const std::exception& e) {
+        std::cout << "❌ TEST FAILED: " << e.what() << std::endl;
+        return 1;
+    } catch (...) {
+        std::cout << "❌ TEST FAILED: Unknown error" << std::endl;
+        return 1;
+    }
+}
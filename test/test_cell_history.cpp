@@ -0,0 +1,237 @@
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "../include/battery/CellVoltageHistory.h"
+
+using Batteries::CellVoltageHistory;
+using Batteries::CellVoltages;
+
+static CellVoltages makeCells(std::vector<uint16_t> const& milliVolts) {
+    CellVoltages cells;
+    for (auto mv : milliVolts) { assert(cells.add(mv)); }
+    return cells;
+}
+
+static std::vector<CellVoltageHistory::Sample> readAll(CellVoltageHistory const& history) {
+    std::vector<CellVoltageHistory::Sample> res;
+    CellVoltageHistory::Cursor cursor;
+    CellVoltageHistory::Sample sample;
+    while (history.read(cursor, sample)) { res.push_back(sample); }
+    return res;
+}
+
+void testRoundTrip() {
+    std::cout << "Testing: Delta-encoded samples decode to the original voltages" << std::endl;
+
+    CellVoltageHistory history(16 * 1024, 60);
+
+    std::vector<CellVoltages> expected;
+    uint16_t base = 3300;
+    for (uint32_t i = 0; i < 100; ++i) {
+        // mostly small steps, with an occasional jump exceeding a byte
+        int step = (i % 17 == 0) ? 400 : static_cast<int>(i % 7) - 3;
+        base = static_cast<uint16_t>(base + step);
+        auto cells = makeCells({ base, static_cast<uint16_t>(base + 5), static_cast<uint16_t>(base - 7), base });
+        assert(history.add(i * 60, cells));
+        expected.push_back(cells);
+    }
+
+    // observations between the intervals are not stored as samples
+    assert(!history.add(99 * 60 + 10, expected.back()));
+
+    auto samples = readAll(history);
+    assert(samples.size() == expected.size());
+    assert(history.getSampleCount() == expected.size());
+    for (size_t i = 0; i < samples.size(); ++i) {
+        assert(samples[i].Timestamp == i * 60);
+        assert(samples[i].CellCount == 4);
+        for (uint8_t c = 0; c < 4; ++c) {
+            assert(samples[i].MilliVolt[c] == expected[i].MilliVolt[c]);
+        }
+    }
+
+    std::cout << "✓ PASSED: 100 samples round-trip, including out-of-range deltas" << std::endl;
+}
+
+void testEviction() {
+    std::cout << "Testing: Oldest blocks are evicted once the capacity is exhausted" << std::endl;
+
+    CellVoltageHistory history(2048, 10);
+    auto cells = makeCells({ 3400, 3401, 3402, 3403, 3404, 3405, 3406, 3407 });
+
+    CellVoltageHistory::Cursor cursor;
+    CellVoltageHistory::Sample sample;
+    history.add(0, cells);
+    assert(history.read(cursor, sample) && sample.Timestamp == 0);
+
+    uint32_t const count = 1000;
+    for (uint32_t i = 1; i < count; ++i) { history.add(i * 10, cells); }
+
+    size_t capacity = history.getSampleCapacity();
+    assert(capacity < count);
+    assert(history.getSampleCount() <= capacity);
+
+    // the cursor's block was evicted, reading continues at the oldest sample
+    assert(history.read(cursor, sample));
+    auto samples = readAll(history);
+    assert(sample.Timestamp == samples.front().Timestamp);
+    assert(samples.back().Timestamp == (count - 1) * 10);
+    for (size_t i = 1; i < samples.size(); ++i) {
+        assert(samples[i].Timestamp == samples[i - 1].Timestamp + 10);
+    }
+
+    std::cout << "✓ PASSED: " << samples.size() << " of " << count
+              << " samples retained, in order" << std::endl;
+}
+
+void testGapsAndCellCount() {
+    std::cout << "Testing: Gaps keep timestamps, changing cell count restarts" << std::endl;
+
+    CellVoltageHistory history(4096, 10);
+    history.add(0, makeCells({ 3300, 3310 }));
+    history.add(10, makeCells({ 3301, 3311 }));
+    history.add(100, makeCells({ 3302, 3312 })); // samples missing
+
+    auto samples = readAll(history);
+    assert(samples.size() == 3);
+    assert(samples[1].Timestamp == 10);
+    assert(samples[2].Timestamp == 100);
+    assert(samples[2].MilliVolt[1] == 3312);
+
+    history.add(110, makeCells({ 3300, 3310, 3320 }));
+    samples = readAll(history);
+    assert(samples.size() == 1);
+    assert(samples[0].CellCount == 3);
+    assert(history.getCellCount() == 3);
+
+    std::cout << "✓ PASSED: Gap and reconfiguration handled" << std::endl;
+}
+
+void testLateObservations() {
+    std::cout << "Testing: Late observations do not make timestamps drift" << std::endl;
+
+    // observations every 7 s, i.e., the first one due after each interval
+    // is late by up to 6 s
+    CellVoltageHistory history(16 * 1024, 60);
+    auto cells = makeCells({ 3300, 3301 });
+
+    std::vector<uint32_t> stored;
+    for (uint32_t t = 0; t < 60 * 60; t += 7) {
+        if (history.add(t, cells)) { stored.push_back(t); }
+    }
+
+    auto samples = readAll(history);
+    assert(samples.size() == stored.size());
+    for (size_t i = 0; i < samples.size(); ++i) {
+        assert(samples[i].Timestamp <= stored[i]);
+        assert(stored[i] - samples[i].Timestamp < 7);
+    }
+
+    std::cout << "✓ PASSED: " << samples.size() << " samples within one observation period" << std::endl;
+}
+
+void testTimestampWrap() {
+    std::cout << "Testing: Timestamps wrapping around at 2^32" << std::endl;
+
+    CellVoltageHistory history(16 * 1024, 10);
+    auto cells = makeCells({ 3300, 3301 });
+
+    uint32_t const start = UINT32_MAX - 45;
+    for (uint32_t i = 0; i < 10; ++i) {
+        assert(history.add(start + i * 10, cells));
+    }
+
+    auto samples = readAll(history);
+    assert(samples.size() == 10);
+    for (size_t i = 0; i < samples.size(); ++i) {
+        assert(samples[i].Timestamp == static_cast<uint32_t>(start + i * 10));
+    }
+    assert(samples.back().Timestamp == 44);
+
+    // the wrap is neither mistaken for a gap nor for a step back in time
+    assert(!history.add(50, cells));
+    assert(history.getSummary().Observations == 11);
+
+    std::cout << "✓ PASSED: Samples continue across the wrap" << std::endl;
+}
+
+void testCursorAfterCellCountChange() {
+    std::cout << "Testing: Changing the cell count ends reading with old cursors" << std::endl;
+
+    CellVoltageHistory history(4096, 10);
+    history.add(0, makeCells({ 3300, 3310 }));
+    history.add(10, makeCells({ 3301, 3311 }));
+
+    CellVoltageHistory::Cursor cursor;
+    CellVoltageHistory::Sample sample;
+    assert(history.read(cursor, sample) && sample.CellCount == 2);
+
+    history.add(20, makeCells({ 3300, 3310, 3320 }));
+    history.add(30, makeCells({ 3301, 3311, 3321 }));
+
+    // no samples of the new series are mixed into the old one
+    assert(!history.read(cursor, sample));
+    assert(!history.read(cursor, sample));
+
+    auto samples = readAll(history);
+    assert(samples.size() == 2);
+    assert(samples[0].CellCount == 3 && samples[0].Timestamp == 20);
+
+    std::cout << "✓ PASSED: Old cursor invalidated, new cursor reads new series" << std::endl;
+}
+
+void testSummary() {
+    std::cout << "Testing: Statistics account for all observations" << std::endl;
+
+    CellVoltageHistory history(4096, 300);
+    history.add(0, makeCells({ 3300, 3320, 3310 }));
+    history.add(1, makeCells({ 3290, 3340, 3300 })); // not stored as sample
+    history.add(300, makeCells({ 3310, 3310, 3310 }));
+
+    auto summary = history.getSummary();
+    assert(summary.Observations == 3);
+    assert(summary.CellCount == 3);
+    assert(summary.SpreadMilliVolt == 0);
+    assert(summary.MaxSpreadMilliVolt == 50);
+    assert(summary.AvgSpreadMilliVolt == 23); // (20 + 50 + 0) / 3
+
+    assert(summary.Cells[0].MinMilliVolt == 3290);
+    assert(summary.Cells[0].MaxMilliVolt == 3310);
+    assert(summary.Cells[0].AvgMilliVolt == 3300);
+    assert(summary.Cells[1].MaxMilliVolt == 3340);
+
+    // cell 1 is above the pack average by 10, 30 and 0 millivolts
+    assert(std::fabs(summary.Cells[1].ImbalanceMilliVolt - 40.0f / 3) < 0.01f);
+    assert(std::fabs(summary.Cells[0].ImbalanceMilliVolt + 10.0f) < 0.01f);
+
+    std::cout << "✓ PASSED: Min, max, average, spread and imbalance" << std::endl;
+}
+
+int main() {
+    std::cout << "=== OpenDTU-OnBattery Cell Voltage History Tests ===" << std::endl;
+    std::cout << std::endl;
+
+    try {
+        testRoundTrip();
+        testEviction();
+        testGapsAndCellCount();
+        testLateObservations();
+        testTimestampWrap();
+        testCursorAfterCellCountChange();
+        testSummary();
+
+        std::cout << std::endl;
+        std::cout << "✓ ALL TESTS PASSED!" << std::endl;
+
+        return 0;
+    } catch (const std::exception& e) {
+        std::cout << "❌ TEST FAILED: " << e.what() << std::endl;
+        return 1;
+    } catch (...) {
+        std::cout << "❌ TEST FAILED: Unknown error" << std::endl;
+        return 1;
+    }
+}
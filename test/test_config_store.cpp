@@ -0,0 +1,303 @@
+#include <iostream>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ConfigStore.h"
+
+using Header = ConfigStore::Header;
+
+struct TestConfig {
+    struct {
+        uint32_t Version;
+        uint32_t SaveCount;
+    } Cfg;
+
+    struct {
+        char Hostname[32];
+        uint16_t Port;
+    } Mqtt;
+
+    struct {
+        uint64_t Serial;
+        char Name[32];
+    } Inverter[4];
+};
+
+// models the files of the store
+struct Flash {
+    std::map<std::string, std::vector<uint8_t>> Files;
+    std::vector<std::string> Written;
+    bool Fail = false;
+
+    ConfigStore::Reader reader()
+    {
+        return [this](char const* name, Header& header, void* data, size_t size) {
+            auto it = Files.find(name);
+            if (it == Files.end() || it->second.size() != sizeof(header) + size) {
+                return false;
+            }
+            memcpy(&header, it->second.data(), sizeof(header));
+            memcpy(data, it->second.data() + sizeof(header), size);
+            return true;
+        };
+    }
+
+    ConfigStore::Writer writer()
+    {
+        return [this](char const* name, Header const& header, void const* data, size_t size) {
+            if (Fail) { return false; }
+            auto& file = Files[name];
+            file.resize(sizeof(header) + size);
+            memcpy(file.data(), &header, sizeof(header));
+            memcpy(file.data() + sizeof(header), data, size);
+            Written.push_back(name);
+            return true;
+        };
+    }
+};
+
+static ConfigStore makeStore(uint32_t mqttVersion = 1)
+{
+    return ConfigStore({
+        { "cfg", 1, offsetof(TestConfig, Cfg), sizeof(TestConfig::Cfg) },
+        { "mqtt", mqttVersion, offsetof(TestConfig, Mqtt), sizeof(TestConfig::Mqtt) },
+        { "inverter", 1, offsetof(TestConfig, Inverter), sizeof(TestConfig::Inverter) },
+    });
+}
+
+static bool save(ConfigStore& store, TestConfig const& config, Flash& flash)
+{
+    return store.commit(store.collect(&config), flash.writer());
+}
+
+void testCrc() {
+    std::cout << "Testing: CRC32 matches the IEEE 802.3 check value" << std::endl;
+
+    assert(ConfigStore::crc32("123456789", 9) == 0xCBF43926);
+    assert(ConfigStore::crc32("", 0) == 0);
+
+    // incremental computation
+    uint32_t crc = ConfigStore::crc32("1234", 4);
+    assert(ConfigStore::crc32("56789", 5, crc) == 0xCBF43926);
+
+    std::cout << "✓ PASSED: CRC32 check value" << std::endl;
+}
+
+void testRoundTrip() {
+    std::cout << "Testing: Sections are restored from the store" << std::endl;
+
+    Flash flash;
+
+    TestConfig config = {};
+    config.Cfg.Version = 42;
+    strcpy(config.Mqtt.Hostname, "broker.local");
+    config.Mqtt.Port = 1883;
+    config.Inverter[2].Serial = 0x114172218901ULL;
+    strcpy(config.Inverter[2].Name, "Garage");
+
+    auto store = makeStore();
+    assert(save(store, config, flash));
+    assert(flash.Written.size() == 3);
+
+    TestConfig loaded = {};
+    auto reloaded = makeStore();
+    assert(reloaded.load(&loaded, flash.reader()));
+    assert(memcmp(&config, &loaded, sizeof(config)) == 0);
+
+    // nothing changed since loading
+    assert(reloaded.collect(&loaded).empty());
+
+    std::cout << "✓ PASSED: Round trip of 3 sections" << std::endl;
+}
+
+void testDirtySections() {
+    std::cout << "Testing: Only changed sections are written" << std::endl;
+
+    Flash flash;
+    TestConfig config = {};
+    auto store = makeStore();
+    assert(save(store, config, flash));
+    flash.Written.clear();
+
+    assert(save(store, config, flash));
+    assert(flash.Written.empty());
+
+    config.Mqtt.Port = 8883;
+    config.Cfg.SaveCount++;
+    assert(save(store, config, flash));
+    assert(flash.Written.size() == 2);
+    assert(flash.Written[0] == "cfg" && flash.Written[1] == "mqtt");
+    flash.Written.clear();
+
+    // a change which is reverted before saving does not cause a write
+    config.Inverter[0].Serial = 1;
+    config.Inverter[0].Serial = 0;
+    assert(save(store, config, flash));
+    assert(flash.Written.empty());
+
+    store.invalidate();
+    assert(save(store, config, flash));
+    assert(flash.Written.size() == 3);
+
+    std::cout << "✓ PASSED: Dirty sections written" << std::endl;
+}
+
+void testDiffers() {
+    std::cout << "Testing: Sections are compared between two structs" << std::endl;
+
+    TestConfig before = {};
+    strcpy(before.Mqtt.Hostname, "broker");
+    auto store = makeStore();
+
+    TestConfig after = before;
+    assert(!store.differs(&before, &after));
+
+    after.Inverter[3].Name[31] = 'x';
+    assert(store.differs(&before, &after));
+    after.Inverter[3].Name[31] = '\0';
+    assert(!store.differs(&before, &after));
+
+    after.Mqtt.Port = 1883;
+    assert(store.differs(&before, &after));
+
+    std::cout << "✓ PASSED: Changed sections detected" << std::endl;
+}
+
+void testInvalidRecords() {
+    std::cout << "Testing: Invalid records are rejected" << std::endl;
+
+    Flash flash;
+    TestConfig config = {};
+    config.Mqtt.Port = 1883;
+    auto store = makeStore();
+    assert(save(store, config, flash));
+
+    TestConfig loaded = {};
+
+    // section of another layout version
+    auto other = makeStore(2);
+    assert(!other.load(&loaded, flash.reader()));
+
+    // corrupted payload
+    auto corrupted = flash;
+    corrupted.Files["mqtt"].back() ^= 0x01;
+    auto store2 = makeStore();
+    assert(!store2.load(&loaded, corrupted.reader()));
+
+    // missing section
+    auto missing = flash;
+    missing.Files.erase("inverter");
+    auto store3 = makeStore();
+    assert(!store3.load(&loaded, missing.reader()));
+
+    // the valid sections are still known to be persisted, the others are
+    // written again
+    missing.Written.clear();
+    assert(store3.commit(store3.collect(&loaded), missing.writer()));
+    assert(missing.Written.size() == 1 && missing.Written[0] == "inverter");
+
+    std::cout << "✓ PASSED: Version, CRC and missing sections checked" << std::endl;
+}
+
+void testPartialLoad() {
+    std::cout << "Testing: Sections of another version are imported, others kept" << std::endl;
+
+    Flash flash;
+    TestConfig config = {};
+    config.Cfg.Version = 7;
+    config.Mqtt.Port = 1883;
+    config.Inverter[1].Serial = 0x114172218901ULL;
+    auto store = makeStore();
+    assert(save(store, config, flash));
+
+    // the layout of the MQTT section changed
+    TestConfig loaded = {};
+    auto upgraded = makeStore(2);
+    assert(!upgraded.load(&loaded, flash.reader()));
+
+    // what the firmware imports from config.json
+    TestConfig imported = {};
+    imported.Cfg.Version = 6;
+    imported.Mqtt.Port = 8883;
+    assert(upgraded.copyLoaded(&loaded, &imported) == 2);
+    assert(imported.Cfg.Version == 7);
+    assert(imported.Inverter[1].Serial == 0x114172218901ULL);
+    assert(imported.Mqtt.Port == 8883);
+
+    // only the imported section is written with its new version
+    flash.Written.clear();
+    assert(save(upgraded, imported, flash));
+    assert(flash.Written.size() == 1 && flash.Written[0] == "mqtt");
+
+    TestConfig reloaded = {};
+    auto again = makeStore(2);
+    assert(again.load(&reloaded, flash.reader()));
+    assert(memcmp(&imported, &reloaded, sizeof(reloaded)) == 0);
+
+    std::cout << "✓ PASSED: Only the outdated section imported" << std::endl;
+}
+
+void testCommitOrder() {
+    std::cout << "Testing: Records collected earlier do not overwrite newer ones" << std::endl;
+
+    Flash flash;
+    TestConfig config = {};
+    auto store = makeStore();
+    assert(save(store, config, flash));
+
+    config.Mqtt.Port = 1;
+    auto older = store.collect(&config);
+    config.Mqtt.Port = 2;
+    auto newer = store.collect(&config);
+
+    flash.Written.clear();
+    assert(store.commit(newer, flash.writer()));
+    assert(store.commit(older, flash.writer()));
+    assert(flash.Written.size() == 1);
+
+    TestConfig loaded = {};
+    auto reloaded = makeStore();
+    assert(reloaded.load(&loaded, flash.reader()));
+    assert(loaded.Mqtt.Port == 2);
+
+    // a failed write leaves the section dirty
+    config.Mqtt.Port = 3;
+    flash.Fail = true;
+    assert(!save(store, config, flash));
+    flash.Fail = false;
+    flash.Written.clear();
+    assert(save(store, config, flash));
+    assert(flash.Written.size() == 1 && flash.Written[0] == "mqtt");
+
+    std::cout << "✓ PASSED: Newest record kept" << std::endl;
+}
+
+int main() {
+    std::cout << "=== OpenDTU-OnBattery Config Store Tests ===" << std::endl;
+    std::cout << std::endl;
+
+    try {
+        testCrc();
+        testRoundTrip();
+        testDirtySections();
+        testDiffers();
+        testInvalidRecords();
+        testPartialLoad();
+        testCommitOrder();
+
+        std::cout << std::endl;
+        std::cout << "✓ ALL TESTS PASSED!" << std::endl;
+
+        return 0;
+    } catch (const std::exception& e) {
+        std::cout << "❌ TEST FAILED: " << e.what() << std::endl;
+        return 1;
+    } catch (...) {
+        std::cout << "❌ TEST FAILED: Unknown error" << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,176 @@
+#include <iostream>
+#include <cassert>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "LogRing.h"
+
+template <size_t Capacity, size_t LineSize>
+static int logf(LogRing<Capacity, LineSize>& ring, const char* fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    int ret = ring.vprintf(fmt, args);
+    va_end(args);
+    return ret;
+}
+
+template <size_t Capacity, size_t LineSize>
+static std::vector<std::string> drain(LogRing<Capacity, LineSize>& ring)
+{
+    std::vector<std::string> lines;
+    while (ring.consume([&lines](char const* text, size_t length) {
+        lines.emplace_back(text, length);
+    })) { }
+    return lines;
+}
+
+void testFifo() {
+    std::cout << "Testing: Messages are consumed in order across wrap-around" << std::endl;
+
+    // the lines take 24 to 28 bytes each, so they wrap around several times
+    LogRing<128, 32> ring;
+    assert(drain(ring).empty());
+
+    int next = 0;
+    for (int i = 0; i < 20; ++i) {
+        assert(logf(ring, "I (%d) test: line %d\n", i * 10, i) > 0);
+        if (i % 2 == 1) {
+            for (auto const& line : drain(ring)) {
+                assert(line == "I (" + std::to_string(next * 10) + ") test: line " + std::to_string(next) + "\n");
+                ++next;
+            }
+        }
+    }
+    assert(next == 20);
+    assert(ring.takeDropped() == 0);
+
+    std::cout << "✓ PASSED: FIFO order" << std::endl;
+}
+
+void testTruncateAndOverrun() {
+    std::cout << "Testing: Long messages are truncated, a full ring drops messages" << std::endl;
+
+    // a record takes the header and the terminated line, rounded up to
+    // multiples of 4 bytes: 20 bytes for a line of 15 characters
+    LogRing<64, 16> ring;
+    assert(logf(ring, "%s", "0123456789abcdefXYZ") == 19);
+    assert(logf(ring, "%s", "") == 0);
+    assert(logf(ring, "b") == 1);
+    assert(logf(ring, "c") == 1);
+    assert(logf(ring, "d") == 1);
+
+    // 52 bytes are taken, the space for another long line is lacking
+    assert(logf(ring, "e") == -1);
+    assert(logf(ring, "f") == -1);
+    assert(ring.takeDropped() == 2);
+    assert(ring.takeDropped() == 0);
+
+    // the empty message occupies space but is not passed on
+    auto lines = drain(ring);
+    assert(lines.size() == 4);
+    assert(lines[0] == "0123456789abcde");
+    assert(lines[1] == "b" && lines[2] == "c" && lines[3] == "d");
+
+    // the end of the buffer is skipped, as a record never wraps around
+    assert(logf(ring, "%s", "ghijklmnopqrstuvw") == 17);
+    assert(logf(ring, "h") == 1);
+    lines = drain(ring);
+    assert(lines.size() == 2 && lines[0] == "ghijklmnopqrstu" && lines[1] == "h");
+
+    std::cout << "✓ PASSED: Truncation and overrun" << std::endl;
+}
+
+void testCapacity() {
+    std::cout << "Testing: Short lines take less space than long ones" << std::endl;
+
+    LogRing<8192, 256> ring;
+    int accepted = 0;
+    while (logf(ring, "I (%06d) main: Initialize module %03d... done\n", accepted * 10, accepted % 1000) > 0) {
+        ++accepted;
+    }
+    assert(ring.takeDropped() == 1);
+
+    // lines of 47 characters take 52 bytes each, and the space for a line
+    // of 256 characters must remain
+    assert(accepted == (8192 - 260) / 52 + 1);
+
+    char last[64];
+    snprintf(last, sizeof(last), "I (%06d) main: Initialize module %03d... done\n", (accepted - 1) * 10, accepted - 1);
+    auto lines = drain(ring);
+    assert(static_cast<int>(lines.size()) == accepted);
+    assert(lines.back() == last);
+
+    std::cout << "✓ PASSED: " << accepted << " lines in 8 KB" << std::endl;
+}
+
+void testConcurrent() {
+    std::cout << "Testing: Several producer threads and one consumer" << std::endl;
+
+    LogRing<512, 64> ring;
+    constexpr int producers = 4;
+    constexpr int count = 20000;
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&ring, p]() {
+            for (int i = 0; i < count; ++i) {
+                // retry dropped messages to verify that none is lost or torn
+                while (logf(ring, "P%d %06d %06d\n", p, i, count - i) < 0) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::vector<int> next(producers, 0);
+    int total = 0;
+    while (total < producers * count) {
+        // skipping the end of the buffer consumes a record without a message
+        bool consumed = ring.consume([&next, &total](char const* text, size_t length) {
+            int p, i, check;
+            std::string line(text, length);
+            assert(sscanf(line.c_str(), "P%d %d %d", &p, &i, &check) == 3);
+            assert(p >= 0 && p < producers);
+            // messages of one producer keep their order
+            assert(i == next[p] && check == count - i);
+            ++next[p];
+            ++total;
+        });
+        if (!consumed) {
+            std::this_thread::yield();
+        }
+    }
+
+    for (auto& t : threads) { t.join(); }
+    assert(drain(ring).empty());
+
+    std::cout << "✓ PASSED: " << total << " messages from " << producers << " threads" << std::endl;
+}
+
+int main() {
+    std::cout << "=== OpenDTU-OnBattery Log Ring Tests ===" << std::endl;
+    std::cout << std::endl;
+
+    try {
+        testFifo();
+        testTruncateAndOverrun();
+        testCapacity();
+        testConcurrent();
+
+        std::cout << std::endl;
+        std::cout << "✓ ALL TESTS PASSED!" << std::endl;
+
+        return 0;
+    } catch (const std::exception& e) {
+        std::cout << "❌ TEST FAILED: " << e.what() << std::endl;
+        return 1;
+    } catch (...) {
+        std::cout << "❌ TEST FAILED: Unknown error" << std::endl;
+        return 1;
+    }
+}
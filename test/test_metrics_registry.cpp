@@ -0,0 +1,155 @@
+#include <iostream>
+#include <cassert>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "MetricsRegistry.h"
+
+void testCounterAndGauge() {
+    std::cout << "Testing: Counters and gauges hold their values" << std::endl;
+
+    Metrics::Registry registry;
+    auto counter = registry.addCounter("dropped", "dropped messages");
+    auto gauge = registry.addGauge("temperature", "temperature in °C");
+
+    counter->increment();
+    counter->increment(4);
+    gauge->set(21.5f);
+
+    assert(counter->get() == 5);
+    assert(gauge->get() == 21.5f);
+
+    auto entries = registry.getEntries();
+    assert(entries.size() == 2);
+    assert(entries[0].Value->getType() == Metrics::Type::Counter);
+    assert(entries[1].Value->getType() == Metrics::Type::Gauge);
+
+    // the registry reads the same instance the subsystem updates
+    counter->increment();
+    auto const& read = static_cast<Metrics::Counter const&>(*entries[0].Value);
+    assert(read.get() == 6);
+
+    std::cout << "✓ PASSED: Counter 6, gauge 21.5" << std::endl;
+}
+
+void testHistogram() {
+    std::cout << "Testing: Histogram buckets, sum and max" << std::endl;
+
+    Metrics::Histogram histogram({ 10, 100, 1000 });
+    assert(histogram.getBoundCount() == 3);
+
+    for (uint32_t value : { 0u, 10u, 11u, 100u, 500u, 1000u, 1001u, 50000u }) {
+        histogram.observe(value);
+    }
+
+    // upper bounds are inclusive, as the le label in Prometheus
+    assert(histogram.getBucket(0) == 2);
+    assert(histogram.getBucket(1) == 2);
+    assert(histogram.getBucket(2) == 2);
+    assert(histogram.getBucket(3) == 2);
+    assert(histogram.getCount() == 8);
+    assert(histogram.getSum() == 52622);
+    assert(histogram.getMax() == 50000);
+
+    // excess bounds are ignored
+    Metrics::Histogram large({ 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14 });
+    assert(large.getBoundCount() == Metrics::Histogram::MaxBounds);
+    large.observe(13);
+    assert(large.getBucket(Metrics::Histogram::MaxBounds) == 1);
+
+    std::cout << "✓ PASSED: 8 observations in 4 buckets" << std::endl;
+}
+
+void testConcurrentUpdates() {
+    std::cout << "Testing: Updates from several threads are not lost" << std::endl;
+
+    Metrics::Registry registry;
+    auto counter = registry.addCounter("events", "events");
+    auto histogram = registry.addHistogram("duration_us", "duration", Metrics::DurationBoundsUs);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&counter, &histogram, t]() {
+            for (uint32_t i = 0; i < 10000; ++i) {
+                counter->increment();
+                histogram->observe(i * (t + 1));
+            }
+        });
+    }
+    for (auto& thread : threads) { thread.join(); }
+
+    assert(counter->get() == 40000);
+    assert(histogram->getCount() == 40000);
+
+    uint32_t total = 0;
+    for (size_t b = 0; b <= histogram->getBoundCount(); ++b) {
+        total += histogram->getBucket(b);
+    }
+    assert(total == 40000);
+    assert(histogram->getMax() == 9999 * 4);
+
+    std::cout << "✓ PASSED: 40000 updates" << std::endl;
+}
+
+void testRegistration() {
+    std::cout << "Testing: Entries are grouped by name and can be removed" << std::endl;
+
+    Metrics::Registry registry;
+    auto a = registry.addCounter("timeouts", "update timeouts", { "serial", "1" });
+    auto other = registry.addGauge("mode", "mode");
+    auto b = registry.addCounter("timeouts", "update timeouts", { "serial", "2" });
+
+    auto entries = registry.getEntries();
+    assert(entries.size() == 3);
+    assert(strcmp(entries[0].Name, "timeouts") == 0 && entries[0].Instance.Value == "1");
+    assert(strcmp(entries[1].Name, "timeouts") == 0 && entries[1].Instance.Value == "2");
+    assert(strcmp(entries[2].Name, "mode") == 0 && entries[2].Instance.Name == nullptr);
+
+    registry.remove(a);
+    entries = registry.getEntries();
+    assert(entries.size() == 2);
+    assert(strcmp(entries[0].Name, "mode") == 0);
+    assert(entries[1].Instance.Value == "2");
+
+    // a reader's copy keeps a removed metric alive
+    b->increment();
+    registry.remove(b);
+    b.reset();
+    assert(static_cast<Metrics::Counter const&>(*entries[1].Value).get() == 1);
+    assert(registry.getEntries().size() == 1);
+
+    // metrics with static storage duration are not owned
+    static Metrics::Counter external;
+    external.increment();
+    registry.add("external", "external counter", external);
+    entries = registry.getEntries();
+    assert(entries.size() == 2 && entries[1].Value.get() == &external);
+    registry.remove(external);
+    assert(registry.getEntries().size() == 1);
+
+    std::cout << "✓ PASSED: Grouped and removed" << std::endl;
+}
+
+int main() {
+    std::cout << "=== OpenDTU-OnBattery Metrics Registry Tests ===" << std::endl;
+    std::cout << std::endl;
+
+    try {
+        testCounterAndGauge();
+        testHistogram();
+        testConcurrentUpdates();
+        testRegistration();
+
+        std::cout << std::endl;
+        std::cout << "✓ ALL TESTS PASSED!" << std::endl;
+
+        return 0;
+    } catch (const std::exception& e) {
+        std::cout << "❌ TEST FAILED: " << e.what() << std::endl;
+        return 1;
+    } catch (...) {
+        std::cout << "❌ TEST FAILED: Unknown error" << std::endl;
+        return 1;
+    }
+}
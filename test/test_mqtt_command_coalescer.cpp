@@ -0,0 +1,124 @@
+#include <iostream>
+#include <cassert>
+#include <vector>
+
+#include "MqttCommandCoalescer.h"
+
+using Command = MqttCommandCoalescer::Command;
+
+static std::vector<Command> poll(MqttCommandCoalescer& coalescer, uint32_t now, uint32_t interval)
+{
+    std::vector<Command> applied;
+    coalescer.poll(now, interval, [&applied](Command const& cmd) { applied.push_back(cmd); });
+    return applied;
+}
+
+void testLatestValueWins() {
+    std::cout << "Testing: Only the latest value per command and target is applied" << std::endl;
+
+    MqttCommandCoalescer coalescer(8);
+
+    // e.g., a home automation sending limits at 10 Hz
+    for (int i = 1; i <= 10; ++i) {
+        assert(coalescer.push({ 0, 0x1234, i * 100.0f, false }));
+    }
+    assert(coalescer.push({ 0, 0x5678, 42.0f, false }));
+    assert(coalescer.push({ 1, 0x1234, 1.0f, true }));
+
+    auto applied = poll(coalescer, 1000, 500);
+    assert(applied.size() == 3);
+    assert(applied[0].Id == 0 && applied[0].Target == 0x1234 && applied[0].Value == 1000.0f);
+    assert(applied[1].Id == 0 && applied[1].Target == 0x5678 && applied[1].Value == 42.0f);
+    assert(applied[2].Id == 1 && applied[2].Retain);
+
+    assert(poll(coalescer, 1000, 500).empty());
+
+    auto stats = coalescer.getStats();
+    assert(stats.Received == 12);
+    assert(stats.Applied == 3);
+    assert(stats.Coalesced == 9);
+    assert(stats.Dropped == 0);
+
+    std::cout << "✓ PASSED: Applied 3, coalesced 9" << std::endl;
+}
+
+void testRateLimit() {
+    std::cout << "Testing: Each command is applied at most once per interval" << std::endl;
+
+    MqttCommandCoalescer coalescer(4);
+
+    assert(coalescer.push({ 0, 0, 1.0f, false }));
+    assert(poll(coalescer, 0, 1000).size() == 1);
+
+    assert(coalescer.push({ 0, 0, 2.0f, false }));
+    assert(coalescer.push({ 0, 0, 3.0f, false }));
+    assert(poll(coalescer, 500, 1000).empty());
+    assert(poll(coalescer, 999, 1000).empty());
+
+    // other commands are not held back
+    assert(coalescer.push({ 1, 0, 7.0f, false }));
+    auto applied = poll(coalescer, 999, 1000);
+    assert(applied.size() == 1 && applied[0].Id == 1);
+
+    applied = poll(coalescer, 1000, 1000);
+    assert(applied.size() == 1 && applied[0].Value == 3.0f);
+
+    // wrap-around of the millisecond counter
+    assert(coalescer.push({ 2, 0, 1.0f, false }));
+    assert(poll(coalescer, UINT32_MAX - 100, 1000).size() == 1);
+    assert(coalescer.push({ 2, 0, 2.0f, false }));
+    assert(poll(coalescer, 500, 1000).empty());
+    assert(poll(coalescer, 900, 1000).size() == 1);
+
+    // no rate limit
+    assert(coalescer.push({ 0, 0, 4.0f, false }));
+    assert(poll(coalescer, 1000, 0).size() == 1);
+
+    std::cout << "✓ PASSED: Rate limited per command" << std::endl;
+}
+
+void testCapacity() {
+    std::cout << "Testing: Commands are dropped if all slots are pending" << std::endl;
+
+    MqttCommandCoalescer coalescer(2);
+
+    assert(coalescer.push({ 0, 1, 1.0f, false }));
+    assert(coalescer.push({ 0, 2, 1.0f, false }));
+    assert(!coalescer.push({ 0, 3, 1.0f, false }));
+    assert(coalescer.getStats().Dropped == 1);
+
+    // applied commands make room for others
+    assert(poll(coalescer, 0, 1000).size() == 2);
+    assert(coalescer.push({ 0, 3, 1.0f, false }));
+    auto applied = poll(coalescer, 0, 1000);
+    assert(applied.size() == 1 && applied[0].Target == 3);
+
+    coalescer.clear();
+    assert(coalescer.push({ 0, 1, 1.0f, false }));
+    assert(coalescer.push({ 0, 2, 1.0f, false }));
+    assert(poll(coalescer, 0, 1000).size() == 2);
+
+    std::cout << "✓ PASSED: Dropped 1" << std::endl;
+}
+
+int main() {
+    std::cout << "=== OpenDTU-OnBattery MQTT Command Coalescer Tests ===" << std::endl;
+    std::cout << std::endl;
+
+    try {
+        testLatestValueWins();
+        testRateLimit();
+        testCapacity();
+
+        std::cout << std::endl;
+        std::cout << "✓ ALL TESTS PASSED!" << std::endl;
+
+        return 0;
+    } catch (const std::exception& e) {
+        std::cout << "❌ TEST FAILED: " << e.what() << std::endl;
+        return 1;
+    } catch (...) {
+        std::cout << "❌ TEST FAILED: Unknown error" << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,117 @@
+#include <iostream>
+#include <cassert>
+#include <string>
+
+#include "MqttPublishQueue.h"
+
+void testFifo() {
+    std::cout << "Testing: Messages are popped in order across wrap-around" << std::endl;
+
+    MqttPublishQueue queue(4);
+    MqttPublishQueue::Message msg;
+
+    size_t next = 0;
+    for (size_t i = 0; i < 10; ++i) {
+        assert(queue.push("solar/" + std::to_string(i), std::to_string(i), i % 2, i % 3));
+        if (i % 2 == 1) {
+            for (size_t j = 0; j < 2; ++j) {
+                assert(queue.pop(msg));
+                assert(msg.Topic == "solar/" + std::to_string(next));
+                assert(msg.Payload == std::to_string(next));
+                assert(msg.Retain == (next % 2 == 1));
+                assert(msg.Qos == next % 3);
+                ++next;
+            }
+        }
+    }
+    assert(!queue.pop(msg));
+
+    auto stats = queue.getStats();
+    assert(stats.Queued == 10);
+    assert(stats.Depth == 0);
+    assert(stats.HighWater == 2);
+    assert(stats.Dropped == 0);
+
+    std::cout << "✓ PASSED: FIFO order, flags and counters" << std::endl;
+}
+
+void testCoalesceWhenFull() {
+    std::cout << "Testing: A full queue coalesces by topic and drops otherwise" << std::endl;
+
+    MqttPublishQueue queue(3);
+    assert(queue.push("solar/a", "1", false, 0));
+    assert(queue.push("solar/b", "1", false, 0));
+    assert(queue.push("solar/c", "1", false, 0));
+
+    // replaces the queued payload in place
+    assert(queue.push("solar/b", "2", false, 0));
+    // different flags are not coalesced
+    assert(!queue.push("solar/a", "2", true, 0));
+    assert(!queue.push("solar/d", "1", false, 0));
+
+    auto stats = queue.getStats();
+    assert(stats.Queued == 3);
+    assert(stats.Coalesced == 1);
+    assert(stats.Dropped == 2);
+    assert(stats.Depth == 3);
+    assert(stats.Capacity == 3);
+
+    MqttPublishQueue::Message msg;
+    assert(queue.pop(msg) && msg.Topic == "solar/a" && msg.Payload == "1");
+    assert(queue.pop(msg) && msg.Topic == "solar/b" && msg.Payload == "2");
+    assert(queue.pop(msg) && msg.Topic == "solar/c" && msg.Payload == "1");
+    assert(!queue.pop(msg));
+
+    // space is available again
+    assert(queue.push("solar/d", "1", false, 0));
+
+    queue.clear();
+    assert(!queue.pop(msg));
+    assert(queue.getStats().Depth == 0);
+
+    std::cout << "✓ PASSED: Coalesced 1, dropped 2" << std::endl;
+}
+
+void testLargePayloadReleased() {
+    std::cout << "Testing: Large payload buffers are not recycled" << std::endl;
+
+    MqttPublishQueue queue(2);
+    MqttPublishQueue::Message msg;
+
+    std::string large(4 * MqttPublishQueue::MaxRecycledCapacity, 'x');
+    assert(queue.push("homeassistant/sensor/config", large, true, 0));
+    assert(queue.pop(msg) && msg.Payload == large);
+
+    // the large buffer would be handed to the slot by the next pop
+    assert(queue.push("solar/a", "1", false, 0));
+    assert(queue.pop(msg) && msg.Payload == "1");
+    assert(queue.push("solar/b", "2", false, 0));
+    assert(queue.pop(msg) && msg.Payload == "2");
+    assert(queue.push("solar/c", "3", false, 0));
+    assert(queue.pop(msg) && msg.Payload == "3");
+    assert(msg.Payload.capacity() <= MqttPublishQueue::MaxRecycledCapacity);
+
+    std::cout << "✓ PASSED: Slots keep small buffers only" << std::endl;
+}
+
+int main() {
+    std::cout << "=== OpenDTU-OnBattery MQTT Publish Queue Tests ===" << std::endl;
+    std::cout << std::endl;
+
+    try {
+        testFifo();
+        testCoalesceWhenFull();
+        testLargePayloadReleased();
+
+        std::cout << std::endl;
+        std::cout << "✓ ALL TESTS PASSED!" << std::endl;
+
+        return 0;
+    } catch (const std::exception& e) {
+        std::cout << "❌ TEST FAILED: " << e.what() << std::endl;
+        return 1;
+    } catch (...) {
+        std::cout << "❌ TEST FAILED: Unknown error" << std::endl;
+        return 1;
+    }
+}
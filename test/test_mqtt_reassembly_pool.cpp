@@ -0,0 +1,151 @@
+#include <iostream>
+#include <cassert>
+#include <string>
+
+#include "MqttReassemblyPool.h"
+
+using Slot = MqttReassemblyPool::Slot;
+
+static const uint8_t* bytes(const std::string& str)
+{
+    return reinterpret_cast<const uint8_t*>(str.data());
+}
+
+static std::string contents(const Slot* slot)
+{
+    return std::string(reinterpret_cast<const char*>(slot->data()), slot->length());
+}
+
+void testInterleaved() {
+    std::cout << "Testing: Interleaved fragments of two topics are reassembled" << std::endl;
+
+    MqttReassemblyPool pool(2, 16, 256);
+
+    assert(pool.add("meter/a", bytes("{\"p\":"), 5, 0, 9) == nullptr);
+    assert(pool.add("meter/b", bytes("{\"q\":"), 5, 0, 8) == nullptr);
+
+    Slot* b = pool.add("meter/b", bytes("12}"), 3, 5, 8);
+    assert(b != nullptr);
+    assert(contents(b) == "{\"q\":12}");
+
+    Slot* a = pool.add("meter/a", bytes("123}"), 4, 5, 9);
+    assert(a != nullptr);
+    assert(contents(a) == "{\"p\":123}");
+    assert(contents(b) == "{\"q\":12}");
+    pool.release(a);
+    pool.release(b);
+
+    auto stats = pool.getStats();
+    assert(stats.Reassembled == 2);
+    assert(stats.Evicted == 0);
+
+    std::cout << "✓ PASSED: Both messages reassembled" << std::endl;
+}
+
+void testSlotKeptUntilReleased() {
+    std::cout << "Testing: A complete message is not overwritten before it is released" << std::endl;
+
+    MqttReassemblyPool pool(1, 16, 256);
+
+    assert(pool.add("meter/a", bytes("abc"), 3, 0, 6) == nullptr);
+    Slot* a = pool.add("meter/a", bytes("def"), 3, 3, 6);
+    assert(a != nullptr);
+
+    // e.g., a message arriving while the handler of the first one runs
+    assert(pool.add("meter/b", bytes("xyz"), 3, 0, 6) == nullptr);
+    assert(contents(a) == "abcdef");
+    assert(pool.getStats().Dropped == 1);
+
+    pool.release(a);
+    assert(pool.add("meter/b", bytes("xyz"), 3, 0, 6) == nullptr);
+    Slot* b = pool.add("meter/b", bytes("uvw"), 3, 3, 6);
+    assert(b != nullptr && contents(b) == "xyzuvw");
+    pool.release(b);
+
+    std::cout << "✓ PASSED: Slot kept until released" << std::endl;
+}
+
+void testEvictOldest() {
+    std::cout << "Testing: The oldest incomplete message is evicted" << std::endl;
+
+    MqttReassemblyPool pool(2, 16, 256);
+
+    assert(pool.add("meter/a", bytes("a"), 1, 0, 2) == nullptr);
+    assert(pool.add("meter/b", bytes("b"), 1, 0, 2) == nullptr);
+    assert(pool.add("meter/c", bytes("c"), 1, 0, 2) == nullptr);
+    assert(pool.getStats().Evicted == 1);
+
+    // a was evicted, its last fragment is ignored
+    assert(pool.add("meter/a", bytes("a"), 1, 1, 2) == nullptr);
+
+    Slot* b = pool.add("meter/b", bytes("b"), 1, 1, 2);
+    assert(b != nullptr && contents(b) == "bb");
+    pool.release(b);
+
+    Slot* c = pool.add("meter/c", bytes("c"), 1, 1, 2);
+    assert(c != nullptr && contents(c) == "cc");
+    pool.release(c);
+
+    std::cout << "✓ PASSED: Evicted 1" << std::endl;
+}
+
+void testInvalid() {
+    std::cout << "Testing: Oversized and out-of-order messages are dropped" << std::endl;
+
+    MqttReassemblyPool pool(2, 8, 256);
+
+    // too large for a slot
+    assert(pool.add("meter/a", bytes("01234"), 5, 0, 10) == nullptr);
+    assert(pool.add("meter/a", bytes("56789"), 5, 5, 10) == nullptr);
+
+    // missing fragment
+    assert(pool.add("meter/b", bytes("01"), 2, 0, 6) == nullptr);
+    assert(pool.add("meter/b", bytes("45"), 2, 4, 6) == nullptr);
+    assert(pool.add("meter/b", bytes("23"), 2, 2, 6) == nullptr);
+
+    // topic too long
+    std::string topic(pool.getMaxTopicLength() + 1, 't');
+    assert(pool.add(topic, bytes("01"), 2, 0, 4) == nullptr);
+
+    // the longest topic allowed
+    topic.pop_back();
+    assert(pool.add(topic, bytes("01"), 2, 0, 4) == nullptr);
+    Slot* t = pool.add(topic, bytes("23"), 2, 2, 4);
+    assert(t != nullptr && contents(t) == "0123");
+    pool.release(t);
+
+    auto stats = pool.getStats();
+    assert(stats.Reassembled == 1);
+    assert(stats.Dropped == 3);
+
+    // a new message on the same topic starts over
+    assert(pool.add("meter/b", bytes("012"), 3, 0, 6) == nullptr);
+    Slot* b = pool.add("meter/b", bytes("345"), 3, 3, 6);
+    assert(b != nullptr && contents(b) == "012345");
+    pool.release(b);
+
+    std::cout << "✓ PASSED: Dropped 3" << std::endl;
+}
+
+int main() {
+    std::cout << "=== OpenDTU-OnBattery MQTT Reassembly Pool Tests ===" << std::endl;
+    std::cout << std::endl;
+
+    try {
+        testInterleaved();
+        testSlotKeptUntilReleased();
+        testEvictOldest();
+        testInvalid();
+
+        std::cout << std::endl;
+        std::cout << "✓ ALL TESTS PASSED!" << std::endl;
+
+        return 0;
+    } catch (const std::exception& e) {
+        std::cout << "❌ TEST FAILED: " << e.what() << std::endl;
+        return 1;
+    } catch (...) {
+        std::cout << "❌ TEST FAILED: Unknown error" << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,192 @@
+#include <iostream>
+#include <cassert>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "MqttSubscribeParser.h"
+
+static const std::vector<std::string> subscriptions = {
+    "solar/+/cmd/limit_persistent_relative",
+    "solar/116491234567/cmd/power",
+    "solar/powerlimiter/cmd/mode",
+    "solar/#",
+    "#",
+    "+",
+    "+/#",
+    "+/+",
+    "foo",
+    "foo/#",
+    "foo/+/#",
+    "foo/bar",
+    "foo//baz",
+    "foo/+/baz",
+    "$SYS/#",
+    "$SYS/broker/+",
+    "+/broker/uptime",
+    "meter/+/power",
+    "meter/house/+",
+    // invalid, never match
+    "foo+",
+    "foo/#/bar",
+    "foo/b#",
+    "+foo/bar",
+};
+
+static const std::vector<std::string> topics = {
+    "solar/116491234567/cmd/limit_persistent_relative",
+    "solar/116491234567/cmd/power",
+    "solar/powerlimiter/cmd/mode",
+    "solar/powerlimiter/cmd",
+    "solar",
+    "foo",
+    "foo/",
+    "foo/bar",
+    "foo/bar/baz",
+    "foo//baz",
+    "foo/bar/baz/qux",
+    "/foo",
+    "/",
+    "$SYS/broker/uptime",
+    "$SYS",
+    "$other/broker/uptime",
+    "meter/house/power",
+    "meter/garage/power",
+    "meter/house/voltage",
+    "foo+",
+    "foo/b#",
+};
+
+std::vector<size_t> dispatch(MqttSubscribeParser& parser, std::vector<size_t>& hits, const std::string& topic)
+{
+    hits.clear();
+    espMqttClientTypes::MessageProperties properties = {};
+    parser.handle_message(properties, topic.c_str(), nullptr, 0);
+    std::sort(hits.begin(), hits.end());
+    return hits;
+}
+
+std::vector<size_t> reference(const std::string& topic, const std::vector<bool>& registered)
+{
+    std::vector<size_t> res;
+    for (size_t i = 0; i < subscriptions.size(); ++i) {
+        if (!registered[i]) { continue; }
+        bool match = false;
+        if (MqttSubscribeParser::mosquitto_topic_matches_sub(subscriptions[i].c_str(), topic.c_str(), &match) == MqttSubscribeParser::MOSQ_ERR_SUCCESS && match) {
+            res.push_back(i);
+        }
+    }
+    return res;
+}
+
+void registerAll(MqttSubscribeParser& parser, std::vector<size_t>& hits)
+{
+    for (size_t i = 0; i < subscriptions.size(); ++i) {
+        parser.register_callback(subscriptions[i], 0,
+            [&hits, i](const espMqttClientTypes::MessageProperties&, const char*, const uint8_t*, size_t) {
+                hits.push_back(i);
+            });
+    }
+}
+
+void testMatchesReference() {
+    std::cout << "Testing: Trie dispatch matches the mosquitto topic matcher" << std::endl;
+
+    MqttSubscribeParser parser;
+    std::vector<size_t> hits;
+    registerAll(parser, hits);
+    std::vector<bool> registered(subscriptions.size(), true);
+
+    for (auto const& topic : topics) {
+        assert(dispatch(parser, hits, topic) == reference(topic, registered));
+    }
+
+    // wildcards in the topic are invalid
+    assert(dispatch(parser, hits, "foo/+").empty());
+    assert(dispatch(parser, hits, "#").empty());
+    assert(dispatch(parser, hits, "").empty());
+
+    assert(parser.get_callbacks().size() == subscriptions.size());
+
+    std::cout << "✓ PASSED: " << topics.size() << " topics against " << subscriptions.size() << " subscriptions" << std::endl;
+}
+
+void testUnregister() {
+    std::cout << "Testing: Unregistered subscriptions no longer match" << std::endl;
+
+    MqttSubscribeParser parser;
+    std::vector<size_t> hits;
+    registerAll(parser, hits);
+    std::vector<bool> registered(subscriptions.size(), true);
+
+    // remove every other subscription, then the rest
+    for (size_t pass = 0; pass < 2; ++pass) {
+        for (size_t i = pass; i < subscriptions.size(); i += 2) {
+            parser.unregister_callback(subscriptions[i]);
+            registered[i] = false;
+        }
+
+        for (auto const& topic : topics) {
+            assert(dispatch(parser, hits, topic) == reference(topic, registered));
+        }
+    }
+
+    assert(parser.get_callbacks().empty());
+
+    // registering again after the trie was pruned
+    parser.register_callback("foo/+", 0,
+        [&hits](const espMqttClientTypes::MessageProperties&, const char*, const uint8_t*, size_t) {
+            hits.push_back(42);
+        });
+    assert(dispatch(parser, hits, "foo/bar") == std::vector<size_t>{42});
+
+    std::cout << "✓ PASSED: Unregistering prunes the trie consistently" << std::endl;
+}
+
+void testDuplicates() {
+    std::cout << "Testing: Duplicate subscriptions are dispatched and removed together" << std::endl;
+
+    MqttSubscribeParser parser;
+    std::vector<size_t> hits;
+    for (size_t i = 0; i < 2; ++i) {
+        parser.register_callback("meter/+/power", 0,
+            [&hits, i](const espMqttClientTypes::MessageProperties&, const char*, const uint8_t*, size_t) {
+                hits.push_back(i);
+            });
+    }
+    parser.register_callback("meter/+/power/total", 0,
+        [&hits](const espMqttClientTypes::MessageProperties&, const char*, const uint8_t*, size_t) {
+            hits.push_back(2);
+        });
+
+    assert((dispatch(parser, hits, "meter/house/power") == std::vector<size_t>{0, 1}));
+
+    parser.unregister_callback("meter/+/power");
+    assert(dispatch(parser, hits, "meter/house/power").empty());
+    assert(dispatch(parser, hits, "meter/house/power/total") == std::vector<size_t>{2});
+    assert(parser.get_callbacks().size() == 1);
+
+    std::cout << "✓ PASSED: Both callbacks invoked, interior node kept" << std::endl;
+}
+
+int main() {
+    std::cout << "=== OpenDTU-OnBattery MQTT Subscribe Parser Tests ===" << std::endl;
+    std::cout << std::endl;
+
+    try {
+        testMatchesReference();
+        testUnregister();
+        testDuplicates();
+
+        std::cout << std::endl;
+        std::cout << "✓ ALL TESTS PASSED!" << std::endl;
+
+        return 0;
+    } catch (const std::exception& e) {
+        std::cout << "❌ TEST FAILED: " << e.what() << std::endl;
+        return 1;
+    } catch (...) {
+        std::cout << "❌ TEST FAILED: Unknown error" << std::endl;
+        return 1;
+    }
+}
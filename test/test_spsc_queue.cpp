@@ -0,0 +1,124 @@
+#include <iostream>
+#include <cassert>
+#include <cstdint>
+#include <thread>
+
+#include "SpscQueue.h"
+
+void testFifo() {
+    std::cout << "Testing: Items are popped in order across wrap-around" << std::endl;
+
+    SpscQueue<uint32_t, 4> queue;
+    assert(!queue.pop());
+    assert(queue.size() == 0);
+
+    uint32_t next = 0;
+    for (uint32_t i = 0; i < 10; ++i) {
+        assert(queue.push(i));
+        if (i % 3 == 2) {
+            while (auto item = queue.pop()) {
+                assert(*item == next);
+                ++next;
+            }
+        }
+    }
+    assert(queue.size() == 1);
+    assert(*queue.pop() == 9);
+    assert(!queue.pop());
+    assert(queue.getDropped() == 0);
+
+    std::cout << "✓ PASSED: FIFO order" << std::endl;
+}
+
+void testFull() {
+    std::cout << "Testing: A full queue rejects and counts items" << std::endl;
+
+    SpscQueue<uint32_t, 4> queue;
+    for (uint32_t i = 0; i < 4; ++i) {
+        assert(queue.push(i));
+    }
+    assert(queue.size() == queue.capacity());
+
+    assert(!queue.push(4));
+    assert(!queue.push(5));
+    assert(queue.getDropped() == 2);
+
+    // the queued items are unaffected
+    assert(*queue.pop() == 0);
+    assert(queue.push(6));
+    assert(*queue.pop() == 1);
+    assert(*queue.pop() == 2);
+    assert(*queue.pop() == 3);
+    assert(*queue.pop() == 6);
+
+    // e.g., when the producer is restarted
+    assert(queue.push(7));
+    assert(queue.push(8));
+    queue.clear();
+    assert(queue.size() == 0 && !queue.pop());
+    assert(queue.getDropped() == 0);
+    assert(queue.push(9));
+    assert(*queue.pop() == 9);
+
+    std::cout << "✓ PASSED: Full queue" << std::endl;
+}
+
+void testConcurrent() {
+    std::cout << "Testing: One producer and one consumer thread" << std::endl;
+
+    struct Frame {
+        uint32_t Sequence;
+        uint32_t Check;
+    };
+
+    SpscQueue<Frame, 16> queue;
+    uint32_t constexpr count = 200000;
+
+    std::thread producer([&queue]() {
+        for (uint32_t i = 0; i < count; ++i) {
+            while (!queue.push({ i, ~i })) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    uint32_t next = 0;
+    while (next < count) {
+        auto frame = queue.pop();
+        if (!frame) {
+            std::this_thread::yield();
+            continue;
+        }
+        // neither reordered nor torn
+        assert(frame->Sequence == next);
+        assert(frame->Check == ~next);
+        ++next;
+    }
+
+    producer.join();
+    assert(!queue.pop());
+
+    std::cout << "✓ PASSED: " << count << " items handed over in order" << std::endl;
+}
+
+int main() {
+    std::cout << "=== OpenDTU-OnBattery SPSC Queue Tests ===" << std::endl;
+    std::cout << std::endl;
+
+    try {
+        testFifo();
+        testFull();
+        testConcurrent();
+
+        std::cout << std::endl;
+        std::cout << "✓ ALL TESTS PASSED!" << std::endl;
+
+        return 0;
+    } catch (const std::exception& e) {
+        std::cout << "❌ TEST FAILED: " << e.what() << std::endl;
+        return 1;
+    } catch (...) {
+        std::cout << "❌ TEST FAILED: Unknown error" << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,185 @@
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+#include "../include/gridcharger/SurplusController.h"
+
+using GridChargers::PowerActuator;
+using GridChargers::SurplusController;
+
+// grid charger model: the drawn power follows the commanded power with a
+// first order lag, and may be capped (battery in absorption phase).
+class SimulatedCharger : public PowerActuator {
+public:
+    std::optional<float> getInputPower() const final { return inputPower; }
+    float getMinInputPower() const final { return minPower; }
+    float getMaxInputPower() const final { return maxPower; }
+    void setInputPower(float watts) final { commanded = watts; }
+
+    void step(float dt) {
+        float target = std::min(commanded, acceptedPower);
+        inputPower += (target - inputPower) * std::min(dt / timeConstant, 1.0f);
+    }
+
+    float minPower = 100;
+    float maxPower = 3000;
+    float acceptedPower = 1e6; // what the battery takes
+    float timeConstant = 2.0f; // seconds
+    float commanded = 0;
+    float inputPower = 0;
+};
+
+// household with a power meter which reports every second
+struct Simulation {
+    SimulatedCharger charger;
+    SurplusController controller;
+    float surplus = 0;
+    float target = 0;
+    uint32_t now = 0;
+    std::vector<float> grid;
+    std::vector<float> commands;
+
+    void run(uint32_t seconds) {
+        for (uint32_t s = 0; s < seconds; ++s) {
+            for (int i = 0; i < 10; ++i) { charger.step(0.1f); }
+            now += 1000;
+            float gridPower = -surplus + charger.inputPower;
+            grid.push_back(gridPower);
+            commands.push_back(controller.update(charger, target, gridPower, now));
+        }
+    }
+};
+
+void testTracksSurplus() {
+    std::cout << "Testing: Charger settles on a constant surplus without oscillation" << std::endl;
+
+    Simulation sim;
+    sim.surplus = 1500;
+    sim.run(120);
+
+    // settled within the second minute
+    for (size_t i = 60; i < sim.grid.size(); ++i) {
+        assert(std::fabs(sim.grid[i]) < 10);
+    }
+
+    // never drew (noticeably) more than the surplus, i.e., no grid import
+    for (auto g : sim.grid) { assert(g < 50); }
+
+    // no sign changes of the command slope once settled
+    for (size_t i = 61; i < sim.commands.size(); ++i) {
+        assert(std::fabs(sim.commands[i] - sim.commands[i - 1]) < 5);
+    }
+
+    std::cout << "✓ PASSED: Settled at " << sim.commands.back() << " W" << std::endl;
+}
+
+void testRampRates() {
+    std::cout << "Testing: Configured ramp rates are honored" << std::endl;
+
+    Simulation sim;
+    auto params = sim.controller.getParameters();
+    params.RampUpWattsPerSecond = 50;
+    params.RampDownWattsPerSecond = 200;
+    params.TrackingHeadroomWatts = 0;
+    sim.controller.setParameters(params);
+
+    sim.surplus = 2000;
+    sim.run(60);
+    for (size_t i = 2; i < sim.commands.size(); ++i) {
+        assert(sim.commands[i] - sim.commands[i - 1] <= 50.01f);
+    }
+
+    sim.surplus = 200;
+    size_t start = sim.commands.size();
+    sim.run(30);
+    for (size_t i = start; i < sim.commands.size(); ++i) {
+        assert(sim.commands[i - 1] - sim.commands[i] <= 200.01f);
+    }
+
+    std::cout << "✓ PASSED: Steps limited to +50 W/s and -200 W/s" << std::endl;
+}
+
+void testAntiWindup() {
+    std::cout << "Testing: Integrator does not wind up while the output is limited" << std::endl;
+
+    Simulation sim;
+    sim.charger.maxPower = 800; // e.g., BMS charge current limit
+    sim.surplus = 2500;
+    sim.run(120);
+    assert(std::fabs(sim.commands.back() - 800) < 1);
+
+    // once the surplus drops below the limit, the charger follows at once
+    sim.surplus = 500;
+    size_t start = sim.commands.size();
+    sim.run(30);
+    assert(sim.commands[start] < 800);
+    assert(std::fabs(sim.commands.back() - 500) < 15);
+
+    // battery does not accept more than 400 W (absorption phase)
+    sim.charger.maxPower = 3000;
+    sim.charger.acceptedPower = 400;
+    sim.surplus = 2500;
+    sim.run(120);
+    assert(sim.commands.back() <= 400 + sim.controller.getParameters().TrackingHeadroomWatts + 1);
+
+    // surplus vanishes, the charger must back off quickly
+    sim.charger.acceptedPower = 1e6;
+    sim.surplus = 300;
+    start = sim.commands.size();
+    sim.run(5);
+    assert(sim.commands.back() <= 400);
+
+    std::cout << "✓ PASSED: Output follows the surplus immediately after saturation" << std::endl;
+}
+
+void testMinimumPower() {
+    std::cout << "Testing: Charger stays off while the surplus is below the minimum" << std::endl;
+
+    Simulation sim;
+    sim.charger.minPower = 500;
+    sim.surplus = 400;
+    sim.run(300);
+    for (auto c : sim.commands) { assert(c == 0); }
+
+    sim.surplus = 700;
+    sim.run(60);
+    assert(sim.controller.isActive());
+    assert(std::fabs(sim.grid.back()) < 10);
+
+    // dropping below the minimum switches off once, without toggling
+    sim.surplus = 300;
+    size_t start = sim.commands.size();
+    sim.run(120);
+    size_t switches = 0;
+    for (size_t i = start; i < sim.commands.size(); ++i) {
+        if ((sim.commands[i] > 0) != (sim.commands[i - 1] > 0)) { ++switches; }
+    }
+    assert(switches == 1);
+    assert(!sim.controller.isActive());
+
+    std::cout << "✓ PASSED: No on/off cycling around the minimum power" << std::endl;
+}
+
+int main() {
+    std::cout << "=== OpenDTU-OnBattery Grid Charger Surplus Controller Tests ===" << std::endl;
+    std::cout << std::endl;
+
+    try {
+        testTracksSurplus();
+        testRampRates();
+        testAntiWindup();
+        testMinimumPower();
+
+        std::cout << std::endl;
+        std::cout << "✓ ALL TESTS PASSED!" << std::endl;
+
+        return 0;
+    } catch (const std::exception& e) {
+        std::cout << "❌ TEST FAILED: " << e.what() << std::endl;
+        return 1;
+    } catch (...) {
+        std::cout << "❌ TEST FAILED: Unknown error" << std::endl;
+        return 1;
+    }
+}
@@ -28,6 +28,8 @@ export interface GridChargerConfig {
     emergency_charge_enabled: boolean;
     stop_batterysoc_threshold: number;
     target_power_consumption: number;
+    ramp_up_rate: number;
+    ramp_down_rate: number;
     can: GridChargerCanConfig;
     huawei: GridChargerHuaweiConfig;
     trucki: GridChargerTruckiConfig;
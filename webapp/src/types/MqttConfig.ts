@@ -7,7 +7,11 @@ export interface MqttConfig {
     mqtt_password: string;
     mqtt_topic: string;
     mqtt_publish_interval: number;
+    mqtt_command_interval: number;
+    mqtt_config_save_delay: number;
     mqtt_clean_session: boolean;
+    mqtt_publish_mode: number;
+    mqtt_batch_encoding: number;
     mqtt_retain: boolean;
     mqtt_tls: boolean;
     mqtt_root_ca_cert: string;
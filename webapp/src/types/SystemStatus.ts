@@ -31,6 +31,13 @@ export interface SystemStatus {
     resetreason_0: string;
     resetreason_1: string;
     cfgsavecount: number;
+    cfg_persistence: {
+        saves_since_boot: number;
+        saves_per_hour: number;
+        write_requests: number;
+        coalesced: number;
+        pending: boolean;
+    };
     uptime: number;
     update_text: string;
     update_url: string;
@@ -0,0 +1,122 @@
+// Decoder for the MessagePack frames sent by the live data websocket. Only
+// the types produced by ArduinoJson are supported, i.e., no binary data and
+// no extension types.
+
+/* eslint-disable  @typescript-eslint/no-explicit-any */
+class Reader {
+    private view: DataView;
+    private pos = 0;
+    private textDecoder = new TextDecoder();
+
+    constructor(data: ArrayBuffer) {
+        this.view = new DataView(data);
+    }
+
+    public read(): any {
+        const type = this.uint(1);
+
+        if (type <= 0x7f) return type;
+        if (type >= 0xe0) return type - 0x100;
+        if (type >= 0x80 && type <= 0x8f) return this.map(type & 0x0f);
+        if (type >= 0x90 && type <= 0x9f) return this.array(type & 0x0f);
+        if (type >= 0xa0 && type <= 0xbf) return this.str(type & 0x1f);
+
+        switch (type) {
+            case 0xc0:
+                return null;
+            case 0xc2:
+                return false;
+            case 0xc3:
+                return true;
+            case 0xca:
+                return this.float(4);
+            case 0xcb:
+                return this.float(8);
+            case 0xcc:
+                return this.uint(1);
+            case 0xcd:
+                return this.uint(2);
+            case 0xce:
+                return this.uint(4);
+            case 0xcf:
+                return this.uint(8);
+            case 0xd0:
+                return this.int(1);
+            case 0xd1:
+                return this.int(2);
+            case 0xd2:
+                return this.int(4);
+            case 0xd3:
+                return this.int(8);
+            case 0xd9:
+                return this.str(this.uint(1));
+            case 0xda:
+                return this.str(this.uint(2));
+            case 0xdb:
+                return this.str(this.uint(4));
+            case 0xdc:
+                return this.array(this.uint(2));
+            case 0xdd:
+                return this.array(this.uint(4));
+            case 0xde:
+                return this.map(this.uint(2));
+            case 0xdf:
+                return this.map(this.uint(4));
+        }
+
+        throw new Error(`Unsupported MessagePack type 0x${type.toString(16)}`);
+    }
+
+    private uint(size: number): number {
+        let value: number;
+        if (size === 1) value = this.view.getUint8(this.pos);
+        else if (size === 2) value = this.view.getUint16(this.pos);
+        else if (size === 4) value = this.view.getUint32(this.pos);
+        else value = Number(this.view.getBigUint64(this.pos));
+        this.pos += size;
+        return value;
+    }
+
+    private int(size: number): number {
+        let value: number;
+        if (size === 1) value = this.view.getInt8(this.pos);
+        else if (size === 2) value = this.view.getInt16(this.pos);
+        else if (size === 4) value = this.view.getInt32(this.pos);
+        else value = Number(this.view.getBigInt64(this.pos));
+        this.pos += size;
+        return value;
+    }
+
+    private float(size: number): number {
+        const value = size === 4 ? this.view.getFloat32(this.pos) : this.view.getFloat64(this.pos);
+        this.pos += size;
+        return value;
+    }
+
+    private str(length: number): string {
+        const bytes = new Uint8Array(this.view.buffer, this.view.byteOffset + this.pos, length);
+        this.pos += length;
+        return this.textDecoder.decode(bytes);
+    }
+
+    private array(length: number): any[] {
+        const result = [];
+        for (let i = 0; i < length; i++) {
+            result.push(this.read());
+        }
+        return result;
+    }
+
+    private map(length: number): Record<string, any> {
+        const result: Record<string, any> = {};
+        for (let i = 0; i < length; i++) {
+            const key = this.read();
+            result[key] = this.read();
+        }
+        return result;
+    }
+}
+
+export function decodeMsgPack(data: ArrayBuffer): any {
+    return new Reader(data).read();
+}
@@ -23,3 +23,23 @@ export function hasStructure(obj: any, schema: Schema): boolean {
 
     return true;
 }
+
+// merges the members of source into target, recursing into nested objects
+export function mergeDeep(target: any, source: any): any {
+    for (const key in source) {
+        const value = source[key];
+        if (
+            typeof value === 'object' &&
+            value !== null &&
+            !Array.isArray(value) &&
+            typeof target[key] === 'object' &&
+            target[key] !== null
+        ) {
+            mergeDeep(target[key], value);
+        } else {
+            target[key] = value;
+        }
+    }
+
+    return target;
+}
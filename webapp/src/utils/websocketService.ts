@@ -46,6 +46,7 @@ export default class WebSocketService {
     private openSocket(): void {
         try {
             this.socket = new WebSocket(this.url);
+            this.socket.binaryType = 'arraybuffer';
 
             this.socket.onopen = (event: Event) => {
                 this.reconnectDelay = 200; // reset backoff
@@ -101,6 +102,13 @@ export default class WebSocketService {
         }
     }
 
+    /** Sends a message if the socket is open */
+    public send(data: string): void {
+        if (this.socket?.readyState === WebSocket.OPEN) {
+            this.socket.send(data);
+        }
+    }
+
     /** Explicit close function */
     public close(): void {
         this.stopHeartbeat();